@@ -0,0 +1,290 @@
+#include "ChainedDict.hpp"
+#include "Hash.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <utility>
+
+// HashEntry
+size_t HashEntry::allocSize(size_t key_len, size_t value_cap) {
+    return std::max(sizeof(HashEntry), offsetof(HashEntry, data) + key_len + value_cap);
+}
+
+HashEntry* HashEntry::create(std::string_view key, std::string_view value, uint64_t hash) {
+    // 按 16 字节取整（malloc 和小对象分配器都按这个粒度给内存），多出的尾部留给 value 原地增长
+    size_t size = (allocSize(key.size(), value.size()) + 15) & ~size_t(15);
+    auto* entry = static_cast<HashEntry*>(::operator new(size));
+    entry->next = nullptr;
+    entry->hash = hash;
+    entry->key_len = static_cast<uint32_t>(key.size());
+    entry->value_len = static_cast<uint32_t>(value.size());
+    entry->value_cap = static_cast<uint32_t>(size - offsetof(HashEntry, data) - key.size());
+    // 空串的 data() 可能是 nullptr，不能交给 memcpy
+    if (!key.empty()) std::memcpy(entry->data, key.data(), key.size());
+    if (!value.empty()) std::memcpy(entry->data + key.size(), value.data(), value.size());
+    return entry;
+}
+
+void HashEntry::destroy(HashEntry* entry) {
+    ::operator delete(entry);
+}
+
+// ChainedDict
+ChainedDict::ChainedDict() {
+    ht_[0].resize(INIT_HT_SIZE);
+    ht_[1].clear(); // 空
+    rehashidx_ = -1;
+}
+
+ChainedDict::~ChainedDict() {
+    free_table(ht_[0]);
+    free_table(ht_[1]);
+}
+
+ChainedDict::ChainedDict(ChainedDict&& other) noexcept
+    : used_(other.used_), rehashidx_(other.rehashidx_), entry_bytes_(other.entry_bytes_) {
+    ht_[0].swap(other.ht_[0]);
+    ht_[1].swap(other.ht_[1]);
+    other.used_ = 0;
+    other.rehashidx_ = -1;
+    other.entry_bytes_ = 0;
+}
+
+ChainedDict& ChainedDict::operator=(ChainedDict&& other) noexcept {
+    if (this != &other) {
+        free_table(ht_[0]);
+        free_table(ht_[1]);
+        ht_[0].swap(other.ht_[0]);
+        ht_[1].swap(other.ht_[1]);
+        used_ = std::exchange(other.used_, 0);
+        rehashidx_ = std::exchange(other.rehashidx_, -1);
+        entry_bytes_ = std::exchange(other.entry_bytes_, 0);
+    }
+    return *this;
+}
+
+void ChainedDict::free_table(std::vector<HashEntry*>& table) {
+    for (HashEntry* head : table) {
+        while (head) {
+            HashEntry* next = head->next;
+            HashEntry::destroy(head);
+            head = next;
+        }
+    }
+    table.clear();
+}
+
+// 带随机种子的 wyhash：每个 key 只算一次，结果缓存在 HashEntry::hash
+uint64_t ChainedDict::hash_key(std::string_view key) {
+    return hashString(key);
+}
+
+// rehash 期间，key 可能在 ht[0] 或 ht[1]，所以要查两张表。
+HashEntry* ChainedDict::find_entry(std::string_view key, uint64_t hash) const {
+    for (int table = 0; table <= 1; ++table) {
+        if (ht_[table].empty()) continue;
+        size_t idx = bucket_index(hash, ht_[table].size());
+        for (HashEntry* p = ht_[table][idx]; p; p = p->next) {
+            if (p->hash == hash && p->key() == key) {
+                return p;
+            }
+        }
+        if (!is_rehashing()) break; // 只查 ht[0]
+    }
+    return nullptr;
+}
+
+void ChainedDict::set_field(std::string_view key, std::string_view value) {
+    // 如果正在 rehash，先迁移一个 bucket
+    if (is_rehashing()) {
+        rehash_step(1);
+    }
+
+    uint64_t hash = hash_key(key);
+
+    // 查找是否已存在：放得下就原地改写，否则换成新节点、接回原来的位置
+    for (int table = 0; table <= 1; ++table) {
+        if (ht_[table].empty()) continue;
+        HashEntry** link = &ht_[table][bucket_index(hash, ht_[table].size())];
+        for (; *link; link = &(*link)->next) {
+            HashEntry* p = *link;
+            if (p->hash != hash || p->key() != key) continue;
+            if (value.size() <= p->value_cap) {
+                std::memmove(p->data + p->key_len, value.data(), value.size());
+                p->value_len = static_cast<uint32_t>(value.size());
+                return;
+            }
+            HashEntry* entry = HashEntry::create(key, value, hash);
+            entry->next = p->next;
+            *link = entry;
+            entry_bytes_ += entry->bytes();
+            entry_bytes_ -= p->bytes();
+            HashEntry::destroy(p);
+            return;
+        }
+        if (!is_rehashing()) break;
+    }
+
+    // 不存在，插入新节点（头插）。rehash 期间直接插入新表，
+    // 否则可能落在已迁移过的 bucket 里而永远不会被搬走
+    auto& table = ht_[is_rehashing() ? 1 : 0];
+    HashEntry*& head = table[bucket_index(hash, table.size())];
+    HashEntry* new_entry = HashEntry::create(key, value, hash);
+    entry_bytes_ += new_entry->bytes();
+    new_entry->next = head;
+    head = new_entry;
+    used_++;
+
+    // 检查是否需要扩容
+    expand_if_needed();
+}
+
+// 扩容检查
+void ChainedDict::expand_if_needed() {
+    if (is_rehashing()) return;
+    if (ht_[0].empty()) return;
+
+    // 负载因子 > 1 时扩容（Redis 默认）
+    if (used_ >= static_cast<long long>(ht_[0].size())) {
+        size_t new_size = ht_[0].size() * 2;
+        ht_[1].resize(new_size);
+        rehashidx_ = 0; // 开始 rehash
+    }
+}
+
+bool ChainedDict::get_field(std::string_view key, std::string& out_value) const {
+    std::string_view value;
+    if (!find_value(key, value)) return false;
+    out_value.assign(value);
+    return true;
+}
+
+bool ChainedDict::find_value(std::string_view key, std::string_view& out) const {
+    // 注意：const 函数不能修改 rehashidx_，所以不能主动 rehash_step
+    // 但 Redis 在读操作也会推进 rehash，我们这里简化：不推进（或可加 mutable）
+    // 为简单，假设调用者会在非 const 操作中推进
+    HashEntry* entry = find_entry(key, hash_key(key));
+    if (!entry) return false;
+    out = entry->value();
+    return true;
+}
+
+bool ChainedDict::del_field(std::string_view key) {
+    if (is_rehashing()) {
+        rehash_step(1);
+    }
+
+    uint64_t hash = hash_key(key);
+    for (int table = 0; table <= 1; ++table) {
+        if (ht_[table].empty()) continue;
+        HashEntry** link = &ht_[table][bucket_index(hash, ht_[table].size())];
+        for (; *link; link = &(*link)->next) {
+            HashEntry* p = *link;
+            if (p->hash == hash && p->key() == key) {
+                // 删除 p
+                entry_bytes_ -= p->bytes();
+                *link = p->next;
+                HashEntry::destroy(p);
+                used_--;
+                shrink_if_needed();
+                return true;
+            }
+        }
+        if (!is_rehashing()) break;
+    }
+    return false;
+}
+
+// 缩容检查
+void ChainedDict::shrink_if_needed() {
+    if (is_rehashing()) return;
+    if (ht_[0].size() <= INIT_HT_SIZE) return;
+    if (used_ * 100 / ht_[0].size() < HASHTABLE_MIN_FILL) {
+        size_t new_size = std::max(INIT_HT_SIZE, ht_[0].size() / 2);
+        ht_[1].resize(new_size);
+        rehashidx_ = 0;
+    }
+}
+
+// 实现 渐进式 rehash,每次只迁移一个 bucket（或限制空 bucket 跳跃次数）。
+int ChainedDict::rehash_step(int n) {
+    if (!is_rehashing()) return 0;
+    if (ht_[0].empty()) {
+        rehashidx_ = -1;
+        return 0;
+    }
+
+    int empty_visits = n * 10;
+    while (n-- && used_ > 0) {
+        // 跳过空 bucket（本次调用最多跳 10 * n 次）
+        while (rehashidx_ < static_cast<long long>(ht_[0].size()) &&
+               ht_[0][rehashidx_] == nullptr) {
+            rehashidx_++;
+            if (--empty_visits == 0) return 1;
+        }
+
+        if (rehashidx_ >= static_cast<long long>(ht_[0].size())) {
+            // rehash 完成
+            ht_[0] = std::move(ht_[1]);
+            ht_[1].clear();
+            rehashidx_ = -1;
+            return 0;
+        }
+
+        // 迁移整个 bucket
+        HashEntry*& old_bucket = ht_[0][rehashidx_];
+        while (old_bucket) {
+            HashEntry* entry = old_bucket;
+            old_bucket = entry->next;
+
+            // 插入 ht[1]：用缓存的哈希，不重新计算
+            size_t new_idx = bucket_index(entry->hash, ht_[1].size());
+            entry->next = ht_[1][new_idx];
+            ht_[1][new_idx] = entry;
+        }
+        rehashidx_++;
+    }
+    return 1; // 仍在 rehash
+}
+
+void ChainedDict::try_rehash_for_ms(int ms) {
+    if (!is_rehashing()) return;
+
+    auto start = Clock::now();
+    auto end = start + std::chrono::milliseconds(ms);
+
+    int batch = 100; // 每次迁移 100 个 bucket（可调）
+    while (is_rehashing()) {
+        rehash_step(batch);
+        if (Clock::now() >= end) break;
+    }
+}
+
+size_t ChainedDict::memory_usage() const {
+    size_t total = sizeof(*this);
+    total += ht_[0].capacity() * sizeof(HashEntry*);
+    total += ht_[1].capacity() * sizeof(HashEntry*);
+    total += entry_bytes_;
+    return total;
+}
+
+std::vector<std::pair<std::string, std::string>> ChainedDict::get_all() const {
+    std::vector<std::pair<std::string, std::string>> result;
+    result.reserve(used_); // 预分配空间
+
+    // 遍历 ht_[0] 和 ht_[1]
+    for (int table = 0; table <= 1; ++table) {
+        const auto& ht = ht_[table];
+        if (ht.empty()) continue;
+
+        for (const auto& head : ht) {
+            // 遍历链表
+            for (const HashEntry* p = head; p != nullptr; p = p->next) {
+                result.emplace_back(p->key(), p->value());
+            }
+        }
+    }
+
+    return result;
+}
\ No newline at end of file
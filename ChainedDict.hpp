@@ -0,0 +1,85 @@
+// ChainedDict.hpp
+#pragma once
+#include <vector>
+#include <string>
+#include <string_view>
+#include <functional>
+#include <chrono>
+#include <cstdint>
+
+// 节点与 field、value 一次分配：两者的字节紧跟在节点头后面（field 在前）
+// value 变长时只要不超过 value_cap 就原地改写，否则换一个新节点
+struct HashEntry {
+    HashEntry* next;     // 链地址法
+    uint64_t hash;       // key 的完整哈希：rehash 时不必重算，遍历链表时先比哈希再比字符串
+    uint32_t key_len;
+    uint32_t value_len;
+    uint32_t value_cap;  // 为 value 预留的字节数
+    char data[1];        // 实际长度为 key_len + value_cap，延伸到节点之后
+
+    std::string_view key() const { return {data, key_len}; }
+    std::string_view value() const { return {data + key_len, value_len}; }
+
+    static HashEntry* create(std::string_view key, std::string_view value, uint64_t hash);
+    static void destroy(HashEntry* entry);
+    static size_t allocSize(size_t key_len, size_t value_cap);
+    // 节点（含 field / value）占用的字节数
+    size_t bytes() const { return allocSize(key_len, value_cap); }
+};
+
+// 链地址法哈希表：每个 field 一个堆上节点（只分配一次），两张表之间渐进式 rehash
+class ChainedDict {
+public:
+    ChainedDict();
+    ~ChainedDict();
+
+    // 禁用拷贝
+    ChainedDict(const ChainedDict&) = delete;
+    ChainedDict& operator=(const ChainedDict&) = delete;
+
+    // 启用移动
+    ChainedDict(ChainedDict&& other) noexcept;
+    ChainedDict& operator=(ChainedDict&& other) noexcept;
+
+    // key / value 只在写入节点时拷贝一次
+    void set_field(std::string_view key, std::string_view value);
+    bool get_field(std::string_view key, std::string& out_value) const;
+    // 不拷贝：out 指向表内的 value，下次修改前有效
+    bool find_value(std::string_view key, std::string_view& out) const;
+    bool del_field(std::string_view key);
+    size_t size() const { return used_; }
+
+    // rehash 相关
+    bool is_rehashing() const { return rehashidx_ != -1; }
+    void enable_rehash(); // 开始 rehash（分配新表）
+    int rehash_step(int n); // 迁移 n 个 bucket
+
+    // 尝试在指定毫秒内推进 rehash
+    void try_rehash_for_ms(int ms);
+
+    // O(1)：节点字节数随增删改累计
+    size_t memory_usage() const;
+
+    std::vector<std::pair<std::string, std::string>> get_all() const;
+
+private:
+    static inline constexpr size_t INIT_HT_SIZE = 4;
+    static inline constexpr size_t HASHTABLE_MIN_FILL = 10; // 缩容阈值（used / size < 10%）
+
+    using Clock = std::chrono::steady_clock;
+    using TimePoint = std::chrono::time_point<Clock>;
+
+    // 表大小始终是 2 的幂，bucket = hash & (size - 1)
+    std::vector<HashEntry*> ht_[2]; // ht[0] 主表，ht[1] 新表（rehash 时用）
+    long long used_ = 0;       // 总元素数
+    long long rehashidx_ = -1; // -1 表示未 rehash，否则表示下一个要迁移的 bucket index
+    size_t entry_bytes_ = 0;   // 所有节点的 HashEntry::bytes() 之和
+
+    static uint64_t hash_key(std::string_view key);
+    static size_t bucket_index(uint64_t hash, size_t table_size) { return hash & (table_size - 1); }
+    HashEntry* find_entry(std::string_view key, uint64_t hash) const;
+    void expand_if_needed();
+    void shrink_if_needed();
+    void do_rehash(int n); // 实际迁移逻辑
+    static void free_table(std::vector<HashEntry*>& table);
+};
\ No newline at end of file
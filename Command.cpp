@@ -1,137 +1,1061 @@
 // Command.cpp
 #include "Command.hpp"
 #include "Database.hpp"
-#include <algorithm>
+#include "ZSetObject.hpp" // ZAddFlag
+#include "IoBuffer.hpp"
+#include "Memory.hpp"
+#include "LazyFree.hpp"
 #include <cctype>
+#include <climits>
+#include <cstdio>
 #include <string>
 
-static std::string toUpper(std::string s) {
-    std::transform(s.begin(), s.end(), s.begin(),
-        [](unsigned char c) { return std::toupper(c); });
-    return s;
+// ========== 命令表 ==========
+
+CommandTable::CommandTable() {
+    using H = CommandHandler;
+    using M = ShardFanout::Merge;
+    commands_ = {
+        // name      proc               arity flags                              keys     merge
+        {"ping",     &H::handlePing,    -1, CMD_FAST,                            0, 0, 0, M::FORWARD},
+        {"set",      &H::handleSet,     -3, CMD_WRITE | CMD_DENYOOM,             1, 1, 1, M::FORWARD},
+        {"get",      &H::handleGet,      2, CMD_READONLY | CMD_FAST,             1, 1, 1, M::FORWARD},
+        {"hset",     &H::handleHSet,    -4, CMD_WRITE | CMD_DENYOOM | CMD_FAST,  1, 1, 1, M::FORWARD},
+        {"hget",     &H::handleHGet,     3, CMD_READONLY | CMD_FAST,             1, 1, 1, M::FORWARD},
+        {"lpush",    &H::handleLPush,   -3, CMD_WRITE | CMD_DENYOOM | CMD_FAST,  1, 1, 1, M::FORWARD},
+        {"rpush",    &H::handleRPush,   -3, CMD_WRITE | CMD_DENYOOM | CMD_FAST,  1, 1, 1, M::FORWARD},
+        {"lpop",     &H::handleLPop,    -2, CMD_WRITE | CMD_FAST,                1, 1, 1, M::FORWARD},
+        {"rpop",     &H::handleRPop,    -2, CMD_WRITE | CMD_FAST,                1, 1, 1, M::FORWARD},
+        {"llen",     &H::handleLLen,     2, CMD_READONLY | CMD_FAST,             1, 1, 1, M::FORWARD},
+        {"lrange",   &H::handleLRange,   4, CMD_READONLY,                        1, 1, 1, M::FORWARD},
+        {"lindex",   &H::handleLIndex,   3, CMD_READONLY,                        1, 1, 1, M::FORWARD},
+        {"ltrim",    &H::handleLTrim,    4, CMD_WRITE,                           1, 1, 1, M::FORWARD},
+        {"lrem",     &H::handleLRem,     4, CMD_WRITE,                           1, 1, 1, M::FORWARD},
+        {"linsert",  &H::handleLInsert,  5, CMD_WRITE | CMD_DENYOOM,             1, 1, 1, M::FORWARD},
+        {"sadd",     &H::handleSAdd,    -3, CMD_WRITE | CMD_DENYOOM | CMD_FAST,  1, 1, 1, M::FORWARD},
+        {"srem",     &H::handleSRem,    -3, CMD_WRITE | CMD_FAST,                1, 1, 1, M::FORWARD},
+        {"sismember", &H::handleSIsMember, 3, CMD_READONLY | CMD_FAST,           1, 1, 1, M::FORWARD},
+        {"scard",    &H::handleSCard,    2, CMD_READONLY | CMD_FAST,             1, 1, 1, M::FORWARD},
+        {"smembers", &H::handleSMembers, 2, CMD_READONLY,                        1, 1, 1, M::FORWARD},
+        {"sinter",   &H::handleSInter,  -2, CMD_READONLY,                        1, -1, 1, M::FORWARD},
+        {"sunion",   &H::handleSUnion,  -2, CMD_READONLY,                        1, -1, 1, M::FORWARD},
+        {"sdiff",    &H::handleSDiff,   -2, CMD_READONLY,                        1, -1, 1, M::FORWARD},
+        {"zadd",     &H::handleZAdd,    -4, CMD_WRITE | CMD_DENYOOM | CMD_FAST,  1, 1, 1, M::FORWARD},
+        {"zincrby",  &H::handleZIncrBy,  4, CMD_WRITE | CMD_DENYOOM | CMD_FAST,  1, 1, 1, M::FORWARD},
+        {"zrem",     &H::handleZRem,    -3, CMD_WRITE | CMD_FAST,                1, 1, 1, M::FORWARD},
+        {"zscore",   &H::handleZScore,   3, CMD_READONLY | CMD_FAST,             1, 1, 1, M::FORWARD},
+        {"zcard",    &H::handleZCard,    2, CMD_READONLY | CMD_FAST,             1, 1, 1, M::FORWARD},
+        {"zrank",    &H::handleZRank,    3, CMD_READONLY | CMD_FAST,             1, 1, 1, M::FORWARD},
+        {"zrevrank", &H::handleZRevRank, 3, CMD_READONLY | CMD_FAST,             1, 1, 1, M::FORWARD},
+        {"zrange",   &H::handleZRange,  -4, CMD_READONLY,                        1, 1, 1, M::FORWARD},
+        {"zrevrange", &H::handleZRevRange, -4, CMD_READONLY,                     1, 1, 1, M::FORWARD},
+        {"zrangebyscore", &H::handleZRangeByScore, -4, CMD_READONLY,             1, 1, 1, M::FORWARD},
+        {"zrevrangebyscore", &H::handleZRevRangeByScore, -4, CMD_READONLY,       1, 1, 1, M::FORWARD},
+        {"zcount",   &H::handleZCount,   4, CMD_READONLY | CMD_FAST,             1, 1, 1, M::FORWARD},
+        {"del",      &H::handleDel,     -2, CMD_WRITE,                           1, -1, 1, M::SUM},
+        {"unlink",   &H::handleUnlink,  -2, CMD_WRITE | CMD_FAST,                1, -1, 1, M::SUM},
+        {"exists",   &H::handleExists,  -2, CMD_READONLY | CMD_FAST,             1, -1, 1, M::SUM},
+        {"expire",   &H::handleExpire,   3, CMD_WRITE | CMD_FAST,                1, 1, 1, M::FORWARD},
+        {"pexpire",  &H::handlePExpire,  3, CMD_WRITE | CMD_FAST,                1, 1, 1, M::FORWARD},
+        {"expireat", &H::handleExpireAt, 3, CMD_WRITE | CMD_FAST,                1, 1, 1, M::FORWARD},
+        {"pexpireat", &H::handlePExpireAt, 3, CMD_WRITE | CMD_FAST,              1, 1, 1, M::FORWARD},
+        {"ttl",      &H::handleTtl,      2, CMD_READONLY | CMD_FAST,             1, 1, 1, M::FORWARD},
+        {"pttl",     &H::handlePTtl,     2, CMD_READONLY | CMD_FAST,             1, 1, 1, M::FORWARD},
+        {"persist",  &H::handlePersist,  2, CMD_WRITE | CMD_FAST,                1, 1, 1, M::FORWARD},
+        {"keys",     &H::handleKeys,     2, CMD_READONLY | CMD_ALL_SHARDS,       0, 0, 0, M::CONCAT},
+        {"flushall", &H::handleFlush,   -1, CMD_WRITE | CMD_ALL_SHARDS,          0, 0, 0, M::STATUS},
+        {"flushdb",  &H::handleFlush,   -1, CMD_WRITE | CMD_ALL_SHARDS,          0, 0, 0, M::STATUS},
+        {"save",     &H::handleSave,     1, CMD_ADMIN | CMD_ALL_SHARDS,          0, 0, 0, M::STATUS},
+        {"bgsave",   &H::handleBgSave,   1, CMD_ADMIN | CMD_ALL_SHARDS,          0, 0, 0, M::STATUS},
+        {"lastsave", &H::handleLastSave, 1, CMD_FAST,                            0, 0, 0, M::FORWARD},
+        {"command",  &H::handleCommand, -1, 0,                                   0, 0, 0, M::FORWARD},
+        {"info",     &H::handleInfo,    -1, 0,                                   0, 0, 0, M::FORWARD},
+        {"memory",   &H::handleMemory,  -2, CMD_READONLY,                        2, 2, 1, M::FORWARD},
+    };
+    for (size_t i = 0; i < commands_.size(); ++i) {
+        commands_[i].id = static_cast<int>(i);
+    }
+
+    // 槽数取不小于 4 倍命令数的 2 的幂，依次尝试种子直到没有冲突
+    size_t size = 1;
+    while (size < commands_.size() * 4) size <<= 1;
+    mask_ = size - 1;
+    for (uint32_t seed = 1;; ++seed) {
+        if (buildSlots(seed)) {
+            seed_ = seed;
+            break;
+        }
+    }
+}
+
+const CommandTable& CommandTable::instance() {
+    static const CommandTable table;
+    return table;
+}
+
+// FNV-1a，字母按小写折叠（'A'..'Z' | 0x20），大小写不同的名字落在同一个槽
+uint32_t CommandTable::hash(std::string_view name, uint32_t seed) {
+    uint32_t h = 2166136261u ^ seed;
+    for (unsigned char c : name) {
+        h ^= (c >= 'A' && c <= 'Z') ? (c | 0x20) : c;
+        h *= 16777619u;
+    }
+    return h ^ (h >> 15);
 }
 
-std::string CommandHandler::execute(const std::vector<std::string>& args) {
+bool CommandTable::buildSlots(uint32_t seed) {
+    slots_.assign(mask_ + 1, -1);
+    for (size_t i = 0; i < commands_.size(); ++i) {
+        int16_t& slot = slots_[hash(commands_[i].name, seed) & mask_];
+        if (slot != -1) return false;
+        slot = static_cast<int16_t>(i);
+    }
+    return true;
+}
+
+const CommandSpec* CommandTable::lookup(std::string_view name) const {
+    if (name.empty() || name.size() > MAX_NAME_LEN) return nullptr;
+    int16_t idx = slots_[hash(name, seed_) & mask_];
+    if (idx < 0) return nullptr;
+
+    const CommandSpec& cmd = commands_[idx];
+    const char* expected = cmd.name;
+    for (unsigned char c : name) {
+        unsigned char lower = (c >= 'A' && c <= 'Z') ? (c | 0x20) : c;
+        if (*expected == '\0' || lower != static_cast<unsigned char>(*expected)) return nullptr;
+        ++expected;
+    }
+    return *expected == '\0' ? &cmd : nullptr;
+}
+
+// ========== 执行 ==========
+
+std::string CommandHandler::execute(const std::vector<std::string_view>& args) {
+    OutputBuffer out;
+    execute(args, out);
+    return out.take();
+}
+
+void CommandHandler::execute(const std::vector<std::string_view>& args, OutputBuffer& out) {
     if (args.empty()) {
-        return RespParser::encodeError("empty command");
-    }
-
-    std::string cmd = toUpper(args[0]);
-
-    if (cmd == "PING") {
-        return handlePing(args);
-    } else if (cmd == "SET") {
-        return handleSet(args);
-    } else if (cmd == "GET") {
-        return handleGet(args);
-    } else if (cmd == "HSET") {
-        return handleHSet(args);
-    } else if (cmd == "HGET") {
-        return handleHGet(args);
-    } else if (cmd == "DEL") {
-        return handleDel(args);
-    } else if (cmd == "EXISTS") {
-        return handleExists(args);
-    } else if (cmd == "KEYS") {
-        return handleKeys(args);
-    } else if (cmd == "SAVE") {
-        return handleSave(args);
-    } else {
-        return RespParser::encodeError("unknown command `" + args[0] + "`");
+        RespParser::writeError(out, "empty command");
+        return;
+    }
+
+    const CommandSpec* cmd = CommandTable::instance().lookup(args[0]);
+    if (!cmd) {
+        RespParser::writeError(out, "unknown command `" + std::string(args[0]) + "`");
+        return;
+    }
+    if (!cmd->arityOk(args.size())) {
+        RespParser::writeError(out, std::string("wrong number of arguments for '") + cmd->name + "' command");
+        return;
     }
+    // 写命令前先腾出内存；仍然超限时只拒绝可能增加内存的命令（DEL 之类照常执行）
+    if ((cmd->flags & CMD_WRITE) && !db_.performEvictions() && (cmd->flags & CMD_DENYOOM)) {
+        RespParser::writeRaw(out, shared::OOM_ERR);
+        return;
+    }
+    (this->*cmd->proc)(args, out);
 }
 
-std::string CommandHandler::handlePing(const std::vector<std::string>& /*args*/) {
-    return RespParser::encodeSimpleString("PONG");
+static bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i])))
+            return false;
+    }
+    return true;
 }
 
-std::string CommandHandler::handleSet(const std::vector<std::string>& args) {
-    if (args.size() < 3) {
-        return RespParser::encodeError("wrong number of arguments for 'SET'");
+static constexpr std::string_view NOT_INTEGER = "value is not an integer or out of range";
+
+void CommandHandler::handlePing(const std::vector<std::string_view>& /*args*/, OutputBuffer& out) {
+    RespParser::writeRaw(out, shared::PONG);
+}
+
+// 过期时间参数换算成 Unix 毫秒：seconds 为秒（否则毫秒），absolute 为时间点（否则相对现在），溢出返回 false
+static bool toUnixTimeMs(long long n, bool seconds, bool absolute, int64_t& out) {
+    if (seconds) {
+        if (n > LLONG_MAX / 1000 || n < LLONG_MIN / 1000) return false;
+        n *= 1000;
+    }
+    if (!absolute) {
+        int64_t now = unixTimeMs();
+        if (n > LLONG_MAX - now) return false;
+        n += now;
     }
-    // 支持 SET key value [EX seconds] ... 但阶段三只取前两个
-    db_.set(args[1], args[2]);
-    return RespParser::encodeSimpleString("OK");
+    out = n;
+    return true;
 }
 
-std::string CommandHandler::handleGet(const std::vector<std::string>& args) {
-    if (args.size() != 2) {
-        return RespParser::encodeError("wrong number of arguments for 'GET'");
+// SET key value [NX|XX] [EX seconds|PX milliseconds|EXAT unix-seconds|PXAT unix-milliseconds|KEEPTTL]
+void CommandHandler::handleSet(const std::vector<std::string_view>& args, OutputBuffer& out) {
+    int flags = 0;
+    int64_t expire_at = ExpireTable::NONE;
+    for (size_t i = 3; i < args.size(); ++i) {
+        std::string_view opt = args[i];
+        bool ex = equalsIgnoreCase(opt, "ex");
+        bool exat = equalsIgnoreCase(opt, "exat");
+        bool absolute = exat || equalsIgnoreCase(opt, "pxat");
+        bool is_expire = ex || exat || absolute || equalsIgnoreCase(opt, "px");
+        if (equalsIgnoreCase(opt, "nx") && !(flags & SET_XX)) {
+            flags |= SET_NX;
+        } else if (equalsIgnoreCase(opt, "xx") && !(flags & SET_NX)) {
+            flags |= SET_XX;
+        } else if (equalsIgnoreCase(opt, "keepttl") && expire_at == ExpireTable::NONE) {
+            flags |= SET_KEEPTTL;
+        } else if (is_expire && !(flags & SET_KEEPTTL) && expire_at == ExpireTable::NONE &&
+                   i + 1 < args.size()) {
+            long long n;
+            if (!string2ll(args[++i], n)) {
+                RespParser::writeError(out, NOT_INTEGER);
+                return;
+            }
+            if (n <= 0 || !toUnixTimeMs(n, ex || exat, absolute, expire_at)) {
+                RespParser::writeError(out, "invalid expire time in 'set' command");
+                return;
+            }
+        } else {
+            RespParser::writeError(out, "syntax error");
+            return;
+        }
+    }
+
+    if (flags == 0 && expire_at == ExpireTable::NONE) {
+        db_.set(args[1], args[2]);
+    } else if (!db_.set(args[1], args[2], flags, expire_at)) {
+        RespParser::writeNullBulkString(out); // 被 NX / XX 拦下
+        return;
     }
-    std::string value;
+    RespParser::writeRaw(out, shared::OK);
+}
+
+void CommandHandler::handleGet(const std::vector<std::string_view>& args, OutputBuffer& out) {
+    std::string_view value;
     if (db_.get(args[1], value)) {
-        return RespParser::encodeBulkString(value);
+        RespParser::writeBulkString(out, value);
     } else {
-        return RespParser::encodeNullBulkString(); // $-1\r\n
+        RespParser::writeNullBulkString(out); // $-1\r\n
     }
 }
 
 // 在 Command.cpp 中添加
-std::string CommandHandler::handleHSet(const std::vector<std::string>& args) {
-    if (args.size() < 4 || (args.size() - 2) % 2 != 0) {
-        return RespParser::encodeError("wrong number of arguments for 'HSET'");
+void CommandHandler::handleHSet(const std::vector<std::string_view>& args, OutputBuffer& out) {
+    if ((args.size() - 2) % 2 != 0) {
+        RespParser::writeError(out, "wrong number of arguments for 'hset' command");
+        return;
     }
     try {
         // 阶段四只处理第一个 field-value 对（简化）
         db_.hset(args[1], args[2], args[3]);
-        return RespParser::encodeInteger(1); // Redis 返回新增 field 数
+        RespParser::writeInteger(out, 1); // Redis 返回新增 field 数
     } catch (const std::exception& e) {
-        return RespParser::encodeError(e.what());
+        RespParser::writeError(out, e.what());
     }
 }
 
-std::string CommandHandler::handleHGet(const std::vector<std::string>& args) {
-    if (args.size() != 3) {
-        return RespParser::encodeError("wrong number of arguments for 'HGET'");
-    }
-    std::string value;
+void CommandHandler::handleHGet(const std::vector<std::string_view>& args, OutputBuffer& out) {
+    std::string_view value;
     if (db_.hget(args[1], args[2], value)) {
-        return RespParser::encodeBulkString(value);
+        RespParser::writeBulkString(out, value);
     } else {
-        return RespParser::encodeNullBulkString();
+        RespParser::writeNullBulkString(out);
     }
 }
 
-std::string CommandHandler::handleDel(const std::vector<std::string>& args) {
-    if (args.size() < 2) {
-        return RespParser::encodeError("wrong number of arguments for 'DEL'");
+static void writeStringArray(OutputBuffer& out, const std::vector<std::string>& values) {
+    RespParser::writeArrayHeader(out, values.size());
+    for (const auto& value : values) {
+        RespParser::writeBulkString(out, value);
     }
-    std::vector<std::string> keys(args.begin() + 1, args.end());
-    size_t deleted = db_.del(keys);
-    return RespParser::encodeInteger(static_cast<long long>(deleted));
 }
 
-std::string CommandHandler::handleExists(const std::vector<std::string>& args) {
-    if (args.size() < 2) {
-        return RespParser::encodeError("wrong number of arguments for 'EXISTS'");
+// ========== List ==========
+
+// LPUSH / RPUSH key element [element ...]
+void CommandHandler::push(const std::vector<std::string_view>& args, OutputBuffer& out, bool front) {
+    std::vector<std::string_view> values(args.begin() + 2, args.end());
+    try {
+        RespParser::writeInteger(out, static_cast<long long>(db_.push(args[1], values, front)));
+    } catch (const std::exception& e) {
+        RespParser::writeError(out, e.what());
+    }
+}
+
+// LPOP / RPOP key [count]：不带 count 回复单个元素，带 count 回复数组
+void CommandHandler::pop(const std::vector<std::string_view>& args, OutputBuffer& out, bool front) {
+    if (args.size() > 3) {
+        RespParser::writeError(out, "syntax error");
+        return;
+    }
+    long long count = 1;
+    if (args.size() == 3 && (!string2ll(args[2], count) || count < 0)) {
+        RespParser::writeError(out, "value is out of range, must be positive");
+        return;
+    }
+    try {
+        std::vector<std::string> values;
+        if (!db_.pop(args[1], front, static_cast<size_t>(count), values)) {
+            RespParser::writeRaw(out, args.size() == 3 ? shared::NULL_ARRAY : shared::NULL_BULK);
+        } else if (args.size() == 3) {
+            writeStringArray(out, values);
+        } else {
+            RespParser::writeBulkString(out, values.front());
+        }
+    } catch (const std::exception& e) {
+        RespParser::writeError(out, e.what());
+    }
+}
+
+void CommandHandler::handleLPush(const std::vector<std::string_view>& args, OutputBuffer& out) {
+    push(args, out, true);
+}
+
+void CommandHandler::handleRPush(const std::vector<std::string_view>& args, OutputBuffer& out) {
+    push(args, out, false);
+}
+
+void CommandHandler::handleLPop(const std::vector<std::string_view>& args, OutputBuffer& out) {
+    pop(args, out, true);
+}
+
+void CommandHandler::handleRPop(const std::vector<std::string_view>& args, OutputBuffer& out) {
+    pop(args, out, false);
+}
+
+void CommandHandler::handleLLen(const std::vector<std::string_view>& args, OutputBuffer& out) {
+    try {
+        RespParser::writeInteger(out, static_cast<long long>(db_.llen(args[1])));
+    } catch (const std::exception& e) {
+        RespParser::writeError(out, e.what());
+    }
+}
+
+// LRANGE key start stop
+void CommandHandler::handleLRange(const std::vector<std::string_view>& args, OutputBuffer& out) {
+    long long start, stop;
+    if (!string2ll(args[2], start) || !string2ll(args[3], stop)) {
+        RespParser::writeError(out, NOT_INTEGER);
+        return;
+    }
+    try {
+        std::vector<std::string> values;
+        db_.lrange(args[1], start, stop, values);
+        writeStringArray(out, values);
+    } catch (const std::exception& e) {
+        RespParser::writeError(out, e.what());
+    }
+}
+
+// LINDEX key index
+void CommandHandler::handleLIndex(const std::vector<std::string_view>& args, OutputBuffer& out) {
+    long long index;
+    if (!string2ll(args[2], index)) {
+        RespParser::writeError(out, NOT_INTEGER);
+        return;
+    }
+    try {
+        std::string value;
+        if (db_.lindex(args[1], index, value)) {
+            RespParser::writeBulkString(out, value);
+        } else {
+            RespParser::writeNullBulkString(out);
+        }
+    } catch (const std::exception& e) {
+        RespParser::writeError(out, e.what());
+    }
+}
+
+// LTRIM key start stop
+void CommandHandler::handleLTrim(const std::vector<std::string_view>& args, OutputBuffer& out) {
+    long long start, stop;
+    if (!string2ll(args[2], start) || !string2ll(args[3], stop)) {
+        RespParser::writeError(out, NOT_INTEGER);
+        return;
+    }
+    try {
+        db_.ltrim(args[1], start, stop);
+        RespParser::writeRaw(out, shared::OK);
+    } catch (const std::exception& e) {
+        RespParser::writeError(out, e.what());
+    }
+}
+
+// LREM key count element
+void CommandHandler::handleLRem(const std::vector<std::string_view>& args, OutputBuffer& out) {
+    long long count;
+    if (!string2ll(args[2], count)) {
+        RespParser::writeError(out, NOT_INTEGER);
+        return;
+    }
+    try {
+        RespParser::writeInteger(out, static_cast<long long>(db_.lrem(args[1], count, args[3])));
+    } catch (const std::exception& e) {
+        RespParser::writeError(out, e.what());
+    }
+}
+
+// LINSERT key BEFORE|AFTER pivot element
+void CommandHandler::handleLInsert(const std::vector<std::string_view>& args, OutputBuffer& out) {
+    bool after;
+    if (equalsIgnoreCase(args[2], "after")) {
+        after = true;
+    } else if (equalsIgnoreCase(args[2], "before")) {
+        after = false;
+    } else {
+        RespParser::writeError(out, "syntax error");
+        return;
+    }
+    try {
+        RespParser::writeInteger(out, db_.linsert(args[1], after, args[3], args[4]));
+    } catch (const std::exception& e) {
+        RespParser::writeError(out, e.what());
+    }
+}
+
+// ========== Set ==========
+
+void CommandHandler::handleSAdd(const std::vector<std::string_view>& args, OutputBuffer& out) {
+    std::vector<std::string_view> members(args.begin() + 2, args.end());
+    try {
+        RespParser::writeInteger(out, static_cast<long long>(db_.sadd(args[1], members)));
+    } catch (const std::exception& e) {
+        RespParser::writeError(out, e.what());
+    }
+}
+
+void CommandHandler::handleSRem(const std::vector<std::string_view>& args, OutputBuffer& out) {
+    std::vector<std::string_view> members(args.begin() + 2, args.end());
+    try {
+        RespParser::writeInteger(out, static_cast<long long>(db_.srem(args[1], members)));
+    } catch (const std::exception& e) {
+        RespParser::writeError(out, e.what());
+    }
+}
+
+void CommandHandler::handleSIsMember(const std::vector<std::string_view>& args, OutputBuffer& out) {
+    try {
+        RespParser::writeRaw(out, db_.sismember(args[1], args[2]) ? shared::CONE : shared::CZERO);
+    } catch (const std::exception& e) {
+        RespParser::writeError(out, e.what());
+    }
+}
+
+void CommandHandler::handleSCard(const std::vector<std::string_view>& args, OutputBuffer& out) {
+    try {
+        RespParser::writeInteger(out, static_cast<long long>(db_.scard(args[1])));
+    } catch (const std::exception& e) {
+        RespParser::writeError(out, e.what());
+    }
+}
+
+void CommandHandler::handleSMembers(const std::vector<std::string_view>& args, OutputBuffer& out) {
+    try {
+        writeStringArray(out, db_.smembers(args[1]));
+    } catch (const std::exception& e) {
+        RespParser::writeError(out, e.what());
+    }
+}
+
+// SINTER / SUNION / SDIFF key [key ...]：多分片模式下 key 必须在同一个分片
+void CommandHandler::handleSInter(const std::vector<std::string_view>& args, OutputBuffer& out) {
+    std::vector<std::string_view> keys(args.begin() + 1, args.end());
+    try {
+        writeStringArray(out, db_.sinter(keys));
+    } catch (const std::exception& e) {
+        RespParser::writeError(out, e.what());
+    }
+}
+
+void CommandHandler::handleSUnion(const std::vector<std::string_view>& args, OutputBuffer& out) {
+    std::vector<std::string_view> keys(args.begin() + 1, args.end());
+    try {
+        writeStringArray(out, db_.sunion(keys));
+    } catch (const std::exception& e) {
+        RespParser::writeError(out, e.what());
+    }
+}
+
+void CommandHandler::handleSDiff(const std::vector<std::string_view>& args, OutputBuffer& out) {
+    std::vector<std::string_view> keys(args.begin() + 1, args.end());
+    try {
+        writeStringArray(out, db_.sdiff(keys));
+    } catch (const std::exception& e) {
+        RespParser::writeError(out, e.what());
+    }
+}
+
+// ========== Sorted set ==========
+
+static constexpr std::string_view NOT_FLOAT = "value is not a valid float";
+
+static void writeScore(OutputBuffer& out, double score) {
+    char buf[MAX_D2STRING_CHARS];
+    RespParser::writeBulkString(out, {buf, d2string(buf, score)});
+}
+
+// WITHSCORES 时 member、score 交替输出
+static void writeScoredMembers(OutputBuffer& out, const Database::ScoredMembers& values, bool withscores) {
+    RespParser::writeArrayHeader(out, withscores ? values.size() * 2 : values.size());
+    for (const auto& [member, score] : values) {
+        RespParser::writeBulkString(out, member);
+        if (withscores) writeScore(out, score);
+    }
+}
+
+// 分数区间的一端："1.5"、"(1.5"（不含）、"-inf"、"+inf"
+static bool parseScoreBound(std::string_view s, double& value, bool& exclusive) {
+    exclusive = !s.empty() && s[0] == '(';
+    if (exclusive) s.remove_prefix(1);
+    return string2d(s, value);
+}
+
+static bool parseScoreRange(std::string_view min, std::string_view max, ZRangeSpec& range) {
+    return parseScoreBound(min, range.min, range.minex) && parseScoreBound(max, range.max, range.maxex);
+}
+
+// ZADD key [NX|XX] [GT|LT] [CH] [INCR] score member [score member ...]
+void CommandHandler::handleZAdd(const std::vector<std::string_view>& args, OutputBuffer& out) {
+    int flags = 0;
+    bool ch = false;
+    size_t i = 2;
+    for (; i < args.size(); ++i) {
+        if (equalsIgnoreCase(args[i], "nx")) {
+            flags |= ZADD_NX;
+        } else if (equalsIgnoreCase(args[i], "xx")) {
+            flags |= ZADD_XX;
+        } else if (equalsIgnoreCase(args[i], "gt")) {
+            flags |= ZADD_GT;
+        } else if (equalsIgnoreCase(args[i], "lt")) {
+            flags |= ZADD_LT;
+        } else if (equalsIgnoreCase(args[i], "ch")) {
+            ch = true;
+        } else if (equalsIgnoreCase(args[i], "incr")) {
+            flags |= ZADD_INCR;
+        } else {
+            break;
+        }
+    }
+    size_t remaining = args.size() - i;
+    if (remaining == 0 || remaining % 2 != 0) {
+        RespParser::writeError(out, "syntax error");
+        return;
+    }
+    if ((flags & ZADD_NX) && (flags & ZADD_XX)) {
+        RespParser::writeError(out, "XX and NX options at the same time are not compatible");
+        return;
+    }
+    if (((flags & ZADD_GT) && (flags & ZADD_LT)) || ((flags & (ZADD_GT | ZADD_LT)) && (flags & ZADD_NX))) {
+        RespParser::writeError(out, "GT, LT, and/or NX options at the same time are not compatible");
+        return;
+    }
+    if ((flags & ZADD_INCR) && remaining > 2) {
+        RespParser::writeError(out, "INCR option supports a single increment-element pair");
+        return;
+    }
+    // 先解析全部分数，有错时不做任何修改
+    std::vector<std::pair<double, std::string_view>> items(remaining / 2);
+    for (size_t j = 0; j < items.size(); ++j, i += 2) {
+        if (!string2d(args[i], items[j].first)) {
+            RespParser::writeError(out, NOT_FLOAT);
+            return;
+        }
+        items[j].second = args[i + 1];
+    }
+    try {
+        size_t added, changed;
+        double newscore;
+        bool done = db_.zadd(args[1], flags, items, added, changed, newscore);
+        if (flags & ZADD_INCR) {
+            if (done) {
+                writeScore(out, newscore);
+            } else {
+                RespParser::writeNullBulkString(out);
+            }
+        } else {
+            RespParser::writeInteger(out, static_cast<long long>(ch ? changed : added));
+        }
+    } catch (const std::exception& e) {
+        RespParser::writeError(out, e.what());
+    }
+}
+
+// ZINCRBY key increment member
+void CommandHandler::handleZIncrBy(const std::vector<std::string_view>& args, OutputBuffer& out) {
+    double increment;
+    if (!string2d(args[2], increment)) {
+        RespParser::writeError(out, NOT_FLOAT);
+        return;
+    }
+    try {
+        size_t added, changed;
+        double newscore;
+        db_.zadd(args[1], ZADD_INCR, {{increment, args[3]}}, added, changed, newscore);
+        writeScore(out, newscore);
+    } catch (const std::exception& e) {
+        RespParser::writeError(out, e.what());
+    }
+}
+
+void CommandHandler::handleZRem(const std::vector<std::string_view>& args, OutputBuffer& out) {
+    std::vector<std::string_view> members(args.begin() + 2, args.end());
+    try {
+        RespParser::writeInteger(out, static_cast<long long>(db_.zrem(args[1], members)));
+    } catch (const std::exception& e) {
+        RespParser::writeError(out, e.what());
+    }
+}
+
+void CommandHandler::handleZScore(const std::vector<std::string_view>& args, OutputBuffer& out) {
+    try {
+        double score;
+        if (db_.zscore(args[1], args[2], score)) {
+            writeScore(out, score);
+        } else {
+            RespParser::writeNullBulkString(out);
+        }
+    } catch (const std::exception& e) {
+        RespParser::writeError(out, e.what());
+    }
+}
+
+void CommandHandler::handleZCard(const std::vector<std::string_view>& args, OutputBuffer& out) {
+    try {
+        RespParser::writeInteger(out, static_cast<long long>(db_.zcard(args[1])));
+    } catch (const std::exception& e) {
+        RespParser::writeError(out, e.what());
+    }
+}
+
+// ZRANK / ZREVRANK key member
+void CommandHandler::zrank(const std::vector<std::string_view>& args, OutputBuffer& out, bool reverse) {
+    try {
+        size_t rank;
+        if (db_.zrank(args[1], args[2], reverse, rank)) {
+            RespParser::writeInteger(out, static_cast<long long>(rank));
+        } else {
+            RespParser::writeNullBulkString(out);
+        }
+    } catch (const std::exception& e) {
+        RespParser::writeError(out, e.what());
+    }
+}
+
+void CommandHandler::handleZRank(const std::vector<std::string_view>& args, OutputBuffer& out) {
+    zrank(args, out, false);
+}
+
+void CommandHandler::handleZRevRank(const std::vector<std::string_view>& args, OutputBuffer& out) {
+    zrank(args, out, true);
+}
+
+// ZRANGE / ZREVRANGE key start stop [WITHSCORES]
+void CommandHandler::zrange(const std::vector<std::string_view>& args, OutputBuffer& out, bool reverse) {
+    bool withscores = args.size() == 5 && equalsIgnoreCase(args[4], "withscores");
+    if (args.size() > 5 || (args.size() == 5 && !withscores)) {
+        RespParser::writeError(out, "syntax error");
+        return;
+    }
+    long long start, stop;
+    if (!string2ll(args[2], start) || !string2ll(args[3], stop)) {
+        RespParser::writeError(out, NOT_INTEGER);
+        return;
+    }
+    try {
+        Database::ScoredMembers values;
+        db_.zrange(args[1], start, stop, reverse, values);
+        writeScoredMembers(out, values, withscores);
+    } catch (const std::exception& e) {
+        RespParser::writeError(out, e.what());
+    }
+}
+
+void CommandHandler::handleZRange(const std::vector<std::string_view>& args, OutputBuffer& out) {
+    zrange(args, out, false);
+}
+
+void CommandHandler::handleZRevRange(const std::vector<std::string_view>& args, OutputBuffer& out) {
+    zrange(args, out, true);
+}
+
+// ZRANGEBYSCORE key min max / ZREVRANGEBYSCORE key max min，之后可跟 [WITHSCORES] [LIMIT offset count]
+void CommandHandler::zrangeByScore(const std::vector<std::string_view>& args, OutputBuffer& out, bool reverse) {
+    ZRangeSpec range;
+    if (!(reverse ? parseScoreRange(args[3], args[2], range) : parseScoreRange(args[2], args[3], range))) {
+        RespParser::writeError(out, "min or max is not a float");
+        return;
+    }
+    bool withscores = false;
+    long long offset = 0, count = -1;
+    for (size_t i = 4; i < args.size(); ++i) {
+        if (equalsIgnoreCase(args[i], "withscores")) {
+            withscores = true;
+        } else if (equalsIgnoreCase(args[i], "limit") && i + 2 < args.size()) {
+            if (!string2ll(args[i + 1], offset) || !string2ll(args[i + 2], count)) {
+                RespParser::writeError(out, NOT_INTEGER);
+                return;
+            }
+            i += 2;
+        } else {
+            RespParser::writeError(out, "syntax error");
+            return;
+        }
+    }
+    try {
+        Database::ScoredMembers values;
+        // 与 Redis 一致：offset 为负返回空
+        if (offset >= 0) {
+            db_.zrangebyscore(args[1], range, reverse, static_cast<size_t>(offset), count, values);
+        }
+        writeScoredMembers(out, values, withscores);
+    } catch (const std::exception& e) {
+        RespParser::writeError(out, e.what());
+    }
+}
+
+void CommandHandler::handleZRangeByScore(const std::vector<std::string_view>& args, OutputBuffer& out) {
+    zrangeByScore(args, out, false);
+}
+
+void CommandHandler::handleZRevRangeByScore(const std::vector<std::string_view>& args, OutputBuffer& out) {
+    zrangeByScore(args, out, true);
+}
+
+// ZCOUNT key min max
+void CommandHandler::handleZCount(const std::vector<std::string_view>& args, OutputBuffer& out) {
+    ZRangeSpec range;
+    if (!parseScoreRange(args[2], args[3], range)) {
+        RespParser::writeError(out, "min or max is not a float");
+        return;
     }
-    std::vector<std::string> keys(args.begin() + 1, args.end());
+    try {
+        RespParser::writeInteger(out, static_cast<long long>(db_.zcount(args[1], range)));
+    } catch (const std::exception& e) {
+        RespParser::writeError(out, e.what());
+    }
+}
+
+void CommandHandler::handleDel(const std::vector<std::string_view>& args, OutputBuffer& out) {
+    std::vector<std::string_view> keys(args.begin() + 1, args.end());
+    size_t deleted = db_.del(keys);
+    RespParser::writeInteger(out, static_cast<long long>(deleted));
+}
+
+void CommandHandler::handleUnlink(const std::vector<std::string_view>& args, OutputBuffer& out) {
+    std::vector<std::string_view> keys(args.begin() + 1, args.end());
+    size_t deleted = db_.unlink(keys);
+    RespParser::writeInteger(out, static_cast<long long>(deleted));
+}
+
+void CommandHandler::handleExists(const std::vector<std::string_view>& args, OutputBuffer& out) {
+    std::vector<std::string_view> keys(args.begin() + 1, args.end());
     size_t count = db_.exists(keys);
-    return RespParser::encodeInteger(static_cast<long long>(count));
+    RespParser::writeInteger(out, static_cast<long long>(count));
 }
 
-std::string CommandHandler::handleKeys(const std::vector<std::string>& args) {
-    if (args.size() != 2) {
-        return RespParser::encodeError("wrong number of arguments for 'KEYS'");
+// EXPIRE / PEXPIRE key ttl，EXPIREAT / PEXPIREAT key unix-time：key 不存在返回 0
+// 时间已过的 key 直接删除（仍返回 1）
+void CommandHandler::expire(const std::vector<std::string_view>& args, OutputBuffer& out,
+                            bool seconds, bool absolute) {
+    long long n;
+    if (!string2ll(args[2], n)) {
+        RespParser::writeError(out, NOT_INTEGER);
+        return;
+    }
+    int64_t when;
+    if (!toUnixTimeMs(n, seconds, absolute, when)) {
+        RespParser::writeError(out, "invalid expire time in '" + std::string(args[0]) + "' command");
+        return;
     }
-    std::string pattern = args[1];
-    auto key_list = db_.getAllKeys(pattern);
+    RespParser::writeInteger(out, db_.expire(args[1], when) ? 1 : 0);
+}
+
+void CommandHandler::handleExpire(const std::vector<std::string_view>& args, OutputBuffer& out) {
+    expire(args, out, true, false);
+}
+
+void CommandHandler::handlePExpire(const std::vector<std::string_view>& args, OutputBuffer& out) {
+    expire(args, out, false, false);
+}
+
+void CommandHandler::handleExpireAt(const std::vector<std::string_view>& args, OutputBuffer& out) {
+    expire(args, out, true, true);
+}
+
+void CommandHandler::handlePExpireAt(const std::vector<std::string_view>& args, OutputBuffer& out) {
+    expire(args, out, false, true);
+}
+
+// TTL / PTTL key：key 不存在返回 -2，没有过期时间返回 -1
+void CommandHandler::ttl(const std::vector<std::string_view>& args, OutputBuffer& out, bool seconds) {
+    long long ms = db_.pttl(args[1]);
+    if (ms >= 0 && seconds) ms = (ms + 500) / 1000; // 与 Redis 相同，四舍五入到秒
+    RespParser::writeInteger(out, ms);
+}
+
+void CommandHandler::handleTtl(const std::vector<std::string_view>& args, OutputBuffer& out) {
+    ttl(args, out, true);
+}
+
+void CommandHandler::handlePTtl(const std::vector<std::string_view>& args, OutputBuffer& out) {
+    ttl(args, out, false);
+}
+
+void CommandHandler::handlePersist(const std::vector<std::string_view>& args, OutputBuffer& out) {
+    RespParser::writeInteger(out, db_.persist(args[1]) ? 1 : 0);
+}
+
+void CommandHandler::handleKeys(const std::vector<std::string_view>& args, OutputBuffer& out) {
+    auto key_list = db_.getAllKeys(std::string(args[1]));
 
     // RESP 数组格式：*N\r\n$M\r\nkey1\r\n$M\r\nkey2\r\n...
-    std::string resp = "*" + std::to_string(key_list.size()) + "\r\n";
+    RespParser::writeArrayHeader(out, key_list.size());
     for (const auto& key : key_list) {
-        resp += RespParser::encodeBulkString(key);
+        RespParser::writeBulkString(out, key);
+    }
+}
+
+// FLUSHALL / FLUSHDB [ASYNC | SYNC]：只有一个库，两者相同；不指定时按 lazyfree-lazy-user-flush
+void CommandHandler::handleFlush(const std::vector<std::string_view>& args, OutputBuffer& out) {
+    bool async = Database::lazyfreeUserFlush();
+    if (args.size() > 2) {
+        RespParser::writeError(out, "syntax error");
+        return;
+    }
+    if (args.size() == 2) {
+        if (equalsIgnoreCase(args[1], "async")) {
+            async = true;
+        } else if (equalsIgnoreCase(args[1], "sync")) {
+            async = false;
+        } else {
+            RespParser::writeError(out, "syntax error");
+            return;
+        }
     }
-    return resp;
+    db_.flush(async);
+    RespParser::writeRaw(out, shared::OK);
 }
 
-std::string CommandHandler::handleSave(const std::vector<std::string>& args) {
-    if (args.size() != 1) {
-        return RespParser::encodeError("SAVE command takes no arguments");
+void CommandHandler::handleSave(const std::vector<std::string_view>& /*args*/, OutputBuffer& out) {
+    // 与子进程同时写同一个文件没有意义，结果取决于谁后 rename
+    if (db_.hasChild()) {
+        RespParser::writeError(out, "Background save already in progress");
+        return;
     }
     if (db_.saveRdb()) {
-        return RespParser::encodeSimpleString("OK");
+        RespParser::writeRaw(out, shared::OK);
     } else {
-        return RespParser::encodeError("ERR Failed to save RDB");
+        RespParser::writeError(out, "Failed to save RDB");
     }
-}
\ No newline at end of file
+}
+
+// BGSAVE：每个分片 fork 一个子进程写自己的 RDB 文件，立即返回
+void CommandHandler::handleBgSave(const std::vector<std::string_view>& /*args*/, OutputBuffer& out) {
+    std::string err;
+    if (db_.bgsaveRdb(err)) {
+        RespParser::writeSimpleString(out, "Background saving started");
+    } else {
+        RespParser::writeError(out, err);
+    }
+}
+
+// LASTSAVE：上次成功保存（SAVE，或所有分片都成功的 BGSAVE）的 Unix 时间
+void CommandHandler::handleLastSave(const std::vector<std::string_view>& /*args*/, OutputBuffer& out) {
+    RespParser::writeInteger(out, Database::lastSave());
+}
+
+// 与 Redis bytesToHuman 相同：1023B、1.50K、12.00M ...
+static std::string bytesToHuman(long long n) {
+    static const char UNITS[] = "BKMGTP";
+    double value = static_cast<double>(n);
+    int unit = 0;
+    while (value >= 1024 && unit < 5) {
+        value /= 1024;
+        ++unit;
+    }
+    char buf[32];
+    if (unit == 0) {
+        std::snprintf(buf, sizeof(buf), "%lldB", n);
+    } else {
+        std::snprintf(buf, sizeof(buf), "%.2f%c", value, UNITS[unit]);
+    }
+    return buf;
+}
+
+// INFO [section]：支持 memory / stats，不带参数或 all / default 时全部输出，未知 section 返回空串
+// 多分片时为整个进程的值（见 Database::stats）
+void CommandHandler::handleInfo(const std::vector<std::string_view>& args, OutputBuffer& out) {
+    bool all = args.size() == 1 || equalsIgnoreCase(args[1], "all") || equalsIgnoreCase(args[1], "default");
+    DatasetStats stats = db_.stats();
+    std::string info;
+    auto field = [&](const char* name, const std::string& value) {
+        info.append(name).append(":").append(value).append("\r\n");
+    };
+
+    if (all || equalsIgnoreCase(args[1], "memory")) {
+        size_t used = usedMemory();
+        size_t peak = usedMemoryPeak();
+        size_t rss = residentMemory();
+        long long dataset = stats.objectBytes();
+        size_t maxmemory = Database::maxmemory();
+        char ratio[32];
+        std::snprintf(ratio, sizeof(ratio), "%.2f", used ? static_cast<double>(rss) / used : 0.0);
+
+        info.append("# Memory\r\n");
+        field("used_memory", std::to_string(used));
+        field("used_memory_human", bytesToHuman(static_cast<long long>(used)));
+        field("used_memory_rss", std::to_string(rss));
+        field("used_memory_rss_human", bytesToHuman(static_cast<long long>(rss)));
+        field("used_memory_peak", std::to_string(peak));
+        field("used_memory_peak_human", bytesToHuman(static_cast<long long>(peak)));
+        field("used_memory_overhead", std::to_string(stats.values[DatasetStats::OVERHEAD_BYTES]));
+        field("used_memory_dataset", std::to_string(dataset));
+        field("maxmemory", std::to_string(maxmemory));
+        field("maxmemory_human", bytesToHuman(static_cast<long long>(maxmemory)));
+        field("maxmemory_policy", maxmemoryPolicyName(Database::maxmemoryPolicy()));
+        field("mem_fragmentation_ratio", ratio);
+        field("lazyfree_pending_objects", std::to_string(lazyfreePendingObjects()));
+    }
+    PersistenceInfo persistence = Database::persistenceInfo();
+    if (all || equalsIgnoreCase(args[1], "persistence")) {
+        if (!info.empty()) info.append("\r\n");
+        info.append("# Persistence\r\n");
+        field("rdb_bgsave_in_progress", persistence.bgsave_in_progress ? "1" : "0");
+        field("rdb_last_save_time", std::to_string(persistence.lastsave));
+        field("rdb_last_bgsave_status", persistence.last_bgsave_ok ? "ok" : "err");
+        field("rdb_last_bgsave_time_sec", std::to_string(persistence.last_bgsave_time_sec));
+        field("rdb_current_bgsave_time_sec", std::to_string(persistence.current_bgsave_time_sec));
+        field("current_cow_size", std::to_string(persistence.current_cow_size));
+        field("current_cow_size_human", bytesToHuman(persistence.current_cow_size));
+        field("rdb_last_cow_size", std::to_string(persistence.last_cow_size));
+    }
+    if (all || equalsIgnoreCase(args[1], "stats")) {
+        if (!info.empty()) info.append("\r\n");
+        info.append("# Stats\r\n");
+        field("expired_keys", std::to_string(stats.values[DatasetStats::EXPIRED_KEYS]));
+        field("evicted_keys", std::to_string(stats.values[DatasetStats::EVICTED_KEYS]));
+        field("lazyfreed_objects", std::to_string(lazyfreedObjects()));
+        field("latest_fork_usec", std::to_string(persistence.latest_fork_usec));
+    }
+    RespParser::writeBulkString(out, info);
+}
+
+// MEMORY USAGE key [SAMPLES count]   key 占用的字节数，不存在为 nil
+//   各对象自己增量维护大小，结果是精确值；SAMPLES 只为兼容 Redis，取值不影响结果
+// MEMORY STATS                       进程内存与数据集按类型 / 编码的分布
+void CommandHandler::handleMemory(const std::vector<std::string_view>& args, OutputBuffer& out) {
+    if (equalsIgnoreCase(args[1], "usage") && (args.size() == 3 || args.size() == 5)) {
+        if (args.size() == 5) {
+            long long samples;
+            if (!equalsIgnoreCase(args[3], "samples") || !string2ll(args[4], samples) || samples < 0) {
+                RespParser::writeError(out, "syntax error");
+                return;
+            }
+        }
+        size_t bytes;
+        if (db_.keyMemoryUsage(args[2], bytes)) {
+            RespParser::writeInteger(out, static_cast<long long>(bytes));
+        } else {
+            RespParser::writeNullBulkString(out);
+        }
+    } else if (equalsIgnoreCase(args[1], "stats") && args.size() == 2) {
+        DatasetStats stats = db_.stats();
+        long long keys = 0;
+        size_t groups = 0;
+        for (int i = 0; i < DatasetStats::TYPES * DatasetStats::ENCODINGS; ++i) {
+            long long n = stats.values[DatasetStats::OBJECT_KEYS + i];
+            keys += n;
+            if (n > 0) ++groups;
+        }
+
+        // 扁平的 name, value 数组；每个 "类型.编码" 的值是 [keys, n, bytes, n]
+        RespParser::writeArrayHeader(out, (7 + groups) * 2);
+        RespParser::writeBulkString(out, "peak.allocated");
+        RespParser::writeInteger(out, static_cast<long long>(usedMemoryPeak()));
+        RespParser::writeBulkString(out, "total.allocated");
+        RespParser::writeInteger(out, static_cast<long long>(usedMemory()));
+        RespParser::writeBulkString(out, "rss");
+        RespParser::writeInteger(out, static_cast<long long>(residentMemory()));
+        RespParser::writeBulkString(out, "overhead.total");
+        RespParser::writeInteger(out, stats.values[DatasetStats::OVERHEAD_BYTES]);
+        RespParser::writeBulkString(out, "keys.count");
+        RespParser::writeInteger(out, keys);
+        RespParser::writeBulkString(out, "keys.bytes-per-key");
+        RespParser::writeInteger(out, keys ? (stats.objectBytes() + stats.values[DatasetStats::OVERHEAD_BYTES]) / keys : 0);
+        RespParser::writeBulkString(out, "dataset.bytes");
+        RespParser::writeInteger(out, stats.objectBytes());
+        for (int t = 0; t < DatasetStats::TYPES; ++t) {
+            for (int e = 0; e < DatasetStats::ENCODINGS; ++e) {
+                auto type = static_cast<ObjectType>(t);
+                auto encoding = static_cast<ObjectEncoding>(e);
+                if (stats.keys(type, encoding) <= 0) continue;
+                RespParser::writeBulkString(out, std::string(objectTypeName(type)) + "." + objectEncodingName(encoding));
+                RespParser::writeArrayHeader(out, 4);
+                RespParser::writeBulkString(out, "keys");
+                RespParser::writeInteger(out, stats.keys(type, encoding));
+                RespParser::writeBulkString(out, "bytes");
+                RespParser::writeInteger(out, stats.bytes(type, encoding));
+            }
+        }
+    } else {
+        RespParser::writeError(out, "unknown subcommand or wrong number of arguments for 'memory'");
+    }
+}
+
+// COMMAND                    所有命令的元数据
+// COMMAND COUNT              命令个数
+// COMMAND INFO name [...]    指定命令的元数据，不存在的为 nil
+// 每条元数据：[name, arity, [flags...], first_key, last_key, key_step]
+static void writeCommandInfo(OutputBuffer& out, const CommandSpec& cmd) {
+    static const std::pair<uint32_t, const char*> FLAG_NAMES[] = {
+        {CMD_WRITE, "write"},
+        {CMD_READONLY, "readonly"},
+        {CMD_FAST, "fast"},
+        {CMD_ADMIN, "admin"},
+        {CMD_DENYOOM, "denyoom"},
+        {CMD_ALL_SHARDS, "all_shards"},
+    };
+
+    RespParser::writeArrayHeader(out, 6);
+    RespParser::writeBulkString(out, cmd.name);
+    RespParser::writeInteger(out, cmd.arity);
+
+    size_t nflags = 0;
+    for (const auto& f : FLAG_NAMES) {
+        if (cmd.flags & f.first) ++nflags;
+    }
+    RespParser::writeArrayHeader(out, nflags);
+    for (const auto& f : FLAG_NAMES) {
+        if (cmd.flags & f.first) RespParser::writeSimpleString(out, f.second);
+    }
+
+    RespParser::writeInteger(out, cmd.first_key);
+    RespParser::writeInteger(out, cmd.last_key);
+    RespParser::writeInteger(out, cmd.key_step);
+}
+
+void CommandHandler::handleCommand(const std::vector<std::string_view>& args, OutputBuffer& out) {
+    const CommandTable& table = CommandTable::instance();
+
+    if (args.size() == 1) {
+        RespParser::writeArrayHeader(out, table.all().size());
+        for (const auto& cmd : table.all()) {
+            writeCommandInfo(out, cmd);
+        }
+    } else if (equalsIgnoreCase(args[1], "count") && args.size() == 2) {
+        RespParser::writeInteger(out, static_cast<long long>(table.all().size()));
+    } else if (equalsIgnoreCase(args[1], "info")) {
+        RespParser::writeArrayHeader(out, args.size() - 2);
+        for (size_t i = 2; i < args.size(); ++i) {
+            const CommandSpec* cmd = table.lookup(args[i]);
+            if (cmd) {
+                writeCommandInfo(out, *cmd);
+            } else {
+                RespParser::writeNullBulkString(out);
+            }
+        }
+    } else {
+        RespParser::writeError(out, "unknown subcommand or wrong number of arguments for 'command'");
+    }
+}
@@ -2,32 +2,159 @@
 #pragma once
 #include <vector>
 #include <string>
+#include <string_view>
+#include <cstdint>
 #include "Protocol.hpp"  // 用于编码响应
+#include "Shard.hpp"     // ShardFanout::Merge
 
 class Database;
+class OutputBuffer;
 
 class CommandHandler {
 public:
     explicit CommandHandler(Database& db) : db_(db) {}
 
-    // 执行命令，返回 RESP 响应字符串
-    std::string execute(const std::vector<std::string>& args);
+    // 执行命令，RESP 响应直接编码进 out（通常是连接的输出缓冲区）
+    // args 为指向连接读缓冲区的视图，处理函数只在需要持久化时才拷贝
+    void execute(const std::vector<std::string_view>& args, OutputBuffer& out);
+
+    // 执行命令并返回独立的响应字符串（跨分片请求 / 合并时使用）
+    std::string execute(const std::vector<std::string_view>& args);
+
+    Database& database() { return db_; }
     
 private:
+    friend class CommandTable;
+
     Database& db_;
 
     // 具体命令处理函数
-    std::string handlePing(const std::vector<std::string>& args);
-    std::string handleSet(const std::vector<std::string>& args);
-    std::string handleGet(const std::vector<std::string>& args);
+    void handlePing(const std::vector<std::string_view>& args, OutputBuffer& out);
+    void handleSet(const std::vector<std::string_view>& args, OutputBuffer& out);
+    void handleGet(const std::vector<std::string_view>& args, OutputBuffer& out);
+
+    void handleHSet(const std::vector<std::string_view>& args, OutputBuffer& out);
+    void handleHGet(const std::vector<std::string_view>& args, OutputBuffer& out);
+
+    void handleLPush(const std::vector<std::string_view>& args, OutputBuffer& out);
+    void handleRPush(const std::vector<std::string_view>& args, OutputBuffer& out);
+    void handleLPop(const std::vector<std::string_view>& args, OutputBuffer& out);
+    void handleRPop(const std::vector<std::string_view>& args, OutputBuffer& out);
+    void handleLLen(const std::vector<std::string_view>& args, OutputBuffer& out);
+    void handleLRange(const std::vector<std::string_view>& args, OutputBuffer& out);
+    void handleLIndex(const std::vector<std::string_view>& args, OutputBuffer& out);
+    void handleLTrim(const std::vector<std::string_view>& args, OutputBuffer& out);
+    void handleLRem(const std::vector<std::string_view>& args, OutputBuffer& out);
+    void handleLInsert(const std::vector<std::string_view>& args, OutputBuffer& out);
+    void push(const std::vector<std::string_view>& args, OutputBuffer& out, bool front);
+    void pop(const std::vector<std::string_view>& args, OutputBuffer& out, bool front);
+
+    void handleSAdd(const std::vector<std::string_view>& args, OutputBuffer& out);
+    void handleSRem(const std::vector<std::string_view>& args, OutputBuffer& out);
+    void handleSIsMember(const std::vector<std::string_view>& args, OutputBuffer& out);
+    void handleSCard(const std::vector<std::string_view>& args, OutputBuffer& out);
+    void handleSMembers(const std::vector<std::string_view>& args, OutputBuffer& out);
+    void handleSInter(const std::vector<std::string_view>& args, OutputBuffer& out);
+    void handleSUnion(const std::vector<std::string_view>& args, OutputBuffer& out);
+    void handleSDiff(const std::vector<std::string_view>& args, OutputBuffer& out);
+
+    void handleZAdd(const std::vector<std::string_view>& args, OutputBuffer& out);
+    void handleZIncrBy(const std::vector<std::string_view>& args, OutputBuffer& out);
+    void handleZRem(const std::vector<std::string_view>& args, OutputBuffer& out);
+    void handleZScore(const std::vector<std::string_view>& args, OutputBuffer& out);
+    void handleZCard(const std::vector<std::string_view>& args, OutputBuffer& out);
+    void handleZRank(const std::vector<std::string_view>& args, OutputBuffer& out);
+    void handleZRevRank(const std::vector<std::string_view>& args, OutputBuffer& out);
+    void handleZRange(const std::vector<std::string_view>& args, OutputBuffer& out);
+    void handleZRevRange(const std::vector<std::string_view>& args, OutputBuffer& out);
+    void handleZRangeByScore(const std::vector<std::string_view>& args, OutputBuffer& out);
+    void handleZRevRangeByScore(const std::vector<std::string_view>& args, OutputBuffer& out);
+    void handleZCount(const std::vector<std::string_view>& args, OutputBuffer& out);
+    void zrank(const std::vector<std::string_view>& args, OutputBuffer& out, bool reverse);
+    void zrange(const std::vector<std::string_view>& args, OutputBuffer& out, bool reverse);
+    void zrangeByScore(const std::vector<std::string_view>& args, OutputBuffer& out, bool reverse);
+
+    void handleDel(const std::vector<std::string_view>& args, OutputBuffer& out);
+    void handleUnlink(const std::vector<std::string_view>& args, OutputBuffer& out);
+    void handleExists(const std::vector<std::string_view>& args, OutputBuffer& out);
+    void handleKeys(const std::vector<std::string_view>& args, OutputBuffer& out);
+
+    void handleExpire(const std::vector<std::string_view>& args, OutputBuffer& out);
+    void handlePExpire(const std::vector<std::string_view>& args, OutputBuffer& out);
+    void handleExpireAt(const std::vector<std::string_view>& args, OutputBuffer& out);
+    void handlePExpireAt(const std::vector<std::string_view>& args, OutputBuffer& out);
+    void handleTtl(const std::vector<std::string_view>& args, OutputBuffer& out);
+    void handlePTtl(const std::vector<std::string_view>& args, OutputBuffer& out);
+    void handlePersist(const std::vector<std::string_view>& args, OutputBuffer& out);
+    void expire(const std::vector<std::string_view>& args, OutputBuffer& out, bool seconds, bool absolute);
+    void ttl(const std::vector<std::string_view>& args, OutputBuffer& out, bool seconds);
+
+    void handleFlush(const std::vector<std::string_view>& args, OutputBuffer& out);
+    void handleSave(const std::vector<std::string_view>& args, OutputBuffer& out);
+    void handleBgSave(const std::vector<std::string_view>& args, OutputBuffer& out);
+    void handleLastSave(const std::vector<std::string_view>& args, OutputBuffer& out);
+    void handleCommand(const std::vector<std::string_view>& args, OutputBuffer& out);
+    void handleInfo(const std::vector<std::string_view>& args, OutputBuffer& out);
+    void handleMemory(const std::vector<std::string_view>& args, OutputBuffer& out);
 
-    std::string handleHSet(const std::vector<std::string>& args);
-    std::string handleHGet(const std::vector<std::string>& args);
+};
 
-    std::string handleDel(const std::vector<std::string>& args);
-    std::string handleExists(const std::vector<std::string>& args);
-    std::string handleKeys(const std::vector<std::string>& args);
+// 命令标志（COMMAND 回复中以小写名字列出）
+enum CommandFlag : uint32_t {
+    CMD_WRITE      = 1u << 0,  // 修改数据
+    CMD_READONLY   = 1u << 1,  // 只读
+    CMD_FAST       = 1u << 2,  // O(1) / O(log N)，不会长时间占用事件循环
+    CMD_ADMIN      = 1u << 3,  // 管理命令
+    CMD_DENYOOM    = 1u << 4,  // 可能增加内存占用
+    CMD_ALL_SHARDS = 1u << 5,  // 作用于整个 keyspace，多分片模式下发给所有分片
+};
+
+// 命令表中的一项
+struct CommandSpec {
+    using Proc = void (CommandHandler::*)(const std::vector<std::string_view>&, OutputBuffer&);
+
+    const char* name;   // 小写
+    Proc proc;
+    int arity;          // >0：参数个数（含命令名）必须等于 arity；<0：至少 -arity 个
+    uint32_t flags;
+    int first_key;      // 第一个 key 的下标，0 表示不涉及 key
+    int last_key;       // 最后一个 key 的下标，-1 表示最后一个参数
+    int key_step;       // 相邻 key 的间隔（MSET 之类为 2）
+    ShardFanout::Merge merge; // 多分片模式下拆分执行后如何合并回复
+    int id = -1;        // 在命令表中的下标，用于按命令统计
+
+    bool arityOk(size_t argc) const {
+        return arity > 0 ? argc == static_cast<size_t>(arity) : argc >= static_cast<size_t>(-arity);
+    }
+
+    // 本次调用中最后一个 key 的下标（没有 key 返回 0）
+    int lastKeyIndex(size_t argc) const {
+        if (first_key == 0) return 0;
+        return last_key < 0 ? static_cast<int>(argc) + last_key : last_key;
+    }
+};
+
+// 命令表：启动时构建，之后只读，多个分片共享
+// 查找不区分大小写、不分配内存：名字按小写折叠哈希，启动时选一个让全部命令
+// 互不冲突的种子（完美哈希），查找只需一次哈希 + 一次比较
+class CommandTable {
+public:
+    static const CommandTable& instance();
+
+    // 按名字查找，不存在返回 nullptr
+    const CommandSpec* lookup(std::string_view name) const;
+
+    const std::vector<CommandSpec>& all() const { return commands_; }
+
+private:
+    static constexpr size_t MAX_NAME_LEN = 32;
 
-    std::string handleSave(const std::vector<std::string>& args);
+    CommandTable();
+    static uint32_t hash(std::string_view name, uint32_t seed);
+    bool buildSlots(uint32_t seed);
 
-};
\ No newline at end of file
+    std::vector<CommandSpec> commands_;
+    std::vector<int16_t> slots_; // 哈希槽 -> commands_ 下标，-1 为空
+    size_t mask_ = 0;
+    uint32_t seed_ = 0;
+};
@@ -0,0 +1,253 @@
+// Config.cpp
+#include "Config.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+
+bool parseMemorySize(const std::string& s, size_t& out) {
+    if (s.empty()) return false;
+
+    size_t i = 0;
+    unsigned long long value = 0;
+    while (i < s.size() && std::isdigit(static_cast<unsigned char>(s[i]))) {
+        value = value * 10 + (s[i] - '0');
+        ++i;
+    }
+    if (i == 0) return false;
+
+    std::string unit = s.substr(i);
+    std::transform(unit.begin(), unit.end(), unit.begin(),
+        [](unsigned char c) { return std::tolower(c); });
+
+    unsigned long long mul = 1;
+    if (unit.empty() || unit == "b") {
+        mul = 1;
+    } else if (unit == "k" || unit == "kb") {
+        mul = 1024ULL;
+    } else if (unit == "m" || unit == "mb") {
+        mul = 1024ULL * 1024;
+    } else if (unit == "g" || unit == "gb") {
+        mul = 1024ULL * 1024 * 1024;
+    } else {
+        return false;
+    }
+    out = static_cast<size_t>(value * mul);
+    return true;
+}
+
+static bool parseClientClass(const std::string& name, ClientClass& out) {
+    if (name == "normal") {
+        out = ClientClass::NORMAL;
+    } else if (name == "replica" || name == "slave") {
+        out = ClientClass::REPLICA;
+    } else if (name == "pubsub") {
+        out = ClientClass::PUBSUB;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static bool parseMaxmemoryPolicy(const std::string& name, MaxmemoryPolicy& out) {
+    if (name == "noeviction") {
+        out = MaxmemoryPolicy::NOEVICTION;
+    } else if (name == "allkeys-lru") {
+        out = MaxmemoryPolicy::ALLKEYS_LRU;
+    } else if (name == "allkeys-lfu") {
+        out = MaxmemoryPolicy::ALLKEYS_LFU;
+    } else if (name == "volatile-ttl") {
+        out = MaxmemoryPolicy::VOLATILE_TTL;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static bool parseYesNo(const std::string& s, bool& out) {
+    if (s == "yes") {
+        out = true;
+    } else if (s == "no") {
+        out = false;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* maxmemoryPolicyName(MaxmemoryPolicy policy) {
+    switch (policy) {
+    case MaxmemoryPolicy::ALLKEYS_LRU:  return "allkeys-lru";
+    case MaxmemoryPolicy::ALLKEYS_LFU:  return "allkeys-lfu";
+    case MaxmemoryPolicy::VOLATILE_TTL: return "volatile-ttl";
+    default:                            return "noeviction";
+    }
+}
+
+bool parseCommandLine(int argc, char* argv[], ServerConfig& config) {
+    for (int i = 1; i < argc; ++i) {
+        std::string opt = argv[i];
+        auto need = [&](int n) {
+            if (i + n >= argc) {
+                std::cerr << "[ERROR] option " << opt << " requires " << n << " argument(s)" << std::endl;
+                return false;
+            }
+            return true;
+        };
+
+        if (opt == "--port") {
+            if (!need(1)) return false;
+            config.port = std::atoi(argv[++i]);
+            if (config.port <= 0 || config.port > 65535) {
+                std::cerr << "[ERROR] invalid port: " << argv[i] << std::endl;
+                return false;
+            }
+        } else if (opt == "--io-threads") {
+            if (!need(1)) return false;
+            config.io_threads = std::atoi(argv[++i]);
+            if (config.io_threads < 1 || config.io_threads > 128) {
+                std::cerr << "[ERROR] invalid io-threads: " << argv[i] << std::endl;
+                return false;
+            }
+        } else if (opt == "--shards") {
+            if (!need(1)) return false;
+            config.shards = std::atoi(argv[++i]);
+            if (config.shards < 1 || config.shards > 256) {
+                std::cerr << "[ERROR] invalid shards: " << argv[i] << std::endl;
+                return false;
+            }
+        } else if (opt == "--event-loop") {
+            if (!need(1)) return false;
+            std::string name = argv[++i];
+            if (name == "epoll") {
+                config.event_loop = EventLoopBackend::EPOLL;
+            } else if (name == "io_uring" || name == "io-uring") {
+                config.event_loop = EventLoopBackend::IO_URING;
+            } else {
+                std::cerr << "[ERROR] invalid event-loop: " << name << " (epoll|io_uring)" << std::endl;
+                return false;
+            }
+        } else if (opt == "--client-output-buffer-limit") {
+            if (!need(4)) return false;
+            ClientClass cls;
+            OutputBufferLimit limit;
+            if (!parseClientClass(argv[i + 1], cls) ||
+                !parseMemorySize(argv[i + 2], limit.hard_bytes) ||
+                !parseMemorySize(argv[i + 3], limit.soft_bytes)) {
+                std::cerr << "[ERROR] invalid client-output-buffer-limit" << std::endl;
+                return false;
+            }
+            limit.soft_seconds = std::atoi(argv[i + 4]);
+            config.output_limits[static_cast<size_t>(cls)] = limit;
+            i += 4;
+        } else if (opt == "--list-max-listpack-size") {
+            if (!need(1)) return false;
+            config.list_max_listpack_size = std::atoi(argv[++i]);
+            if (config.list_max_listpack_size == 0 || config.list_max_listpack_size < -5) {
+                std::cerr << "[ERROR] invalid list-max-listpack-size: " << argv[i] << std::endl;
+                return false;
+            }
+        } else if (opt == "--list-compress-depth") {
+            if (!need(1)) return false;
+            config.list_compress_depth = std::atoi(argv[++i]);
+            if (config.list_compress_depth < 0) {
+                std::cerr << "[ERROR] invalid list-compress-depth: " << argv[i] << std::endl;
+                return false;
+            }
+        } else if (opt == "--set-max-intset-entries") {
+            if (!need(1)) return false;
+            long long n = std::atoll(argv[++i]);
+            if (n < 0 || n > UINT32_MAX) {
+                std::cerr << "[ERROR] invalid set-max-intset-entries: " << argv[i] << std::endl;
+                return false;
+            }
+            config.set_max_intset_entries = static_cast<size_t>(n);
+        } else if (opt == "--zset-max-listpack-entries") {
+            if (!need(1)) return false;
+            // 每个成员占两个元素，listpack 的元素数在 16 位内时 size() 才是 O(1)
+            long long n = std::atoll(argv[++i]);
+            if (n < 0 || n > UINT16_MAX / 2) {
+                std::cerr << "[ERROR] invalid zset-max-listpack-entries: " << argv[i] << std::endl;
+                return false;
+            }
+            config.zset_max_listpack_entries = static_cast<size_t>(n);
+        } else if (opt == "--zset-max-listpack-value") {
+            if (!need(1)) return false;
+            long long n = std::atoll(argv[++i]);
+            if (n < 0 || n > UINT32_MAX) {
+                std::cerr << "[ERROR] invalid zset-max-listpack-value: " << argv[i] << std::endl;
+                return false;
+            }
+            config.zset_max_listpack_value = static_cast<size_t>(n);
+        } else if (opt == "--hz") {
+            if (!need(1)) return false;
+            config.hz = std::atoi(argv[++i]);
+            if (config.hz < 1 || config.hz > 500) {
+                std::cerr << "[ERROR] invalid hz: " << argv[i] << " (1-500)" << std::endl;
+                return false;
+            }
+        } else if (opt == "--active-rehash-us") {
+            if (!need(1)) return false;
+            config.active_rehash_us = std::atoi(argv[++i]);
+            // 不超过一个周期（hz 最小为 1）
+            if (config.active_rehash_us < 0 || config.active_rehash_us > 1000000) {
+                std::cerr << "[ERROR] invalid active-rehash-us: " << argv[i] << std::endl;
+                return false;
+            }
+        } else if (opt == "--active-expire-effort") {
+            if (!need(1)) return false;
+            config.active_expire_effort = std::atoi(argv[++i]);
+            if (config.active_expire_effort < 1 || config.active_expire_effort > 10) {
+                std::cerr << "[ERROR] invalid active-expire-effort: " << argv[i] << " (1-10)" << std::endl;
+                return false;
+            }
+        } else if (opt == "--maxmemory") {
+            if (!need(1)) return false;
+            if (!parseMemorySize(argv[++i], config.maxmemory)) {
+                std::cerr << "[ERROR] invalid maxmemory: " << argv[i] << std::endl;
+                return false;
+            }
+        } else if (opt == "--maxmemory-policy") {
+            if (!need(1)) return false;
+            if (!parseMaxmemoryPolicy(argv[++i], config.maxmemory_policy)) {
+                std::cerr << "[ERROR] invalid maxmemory-policy: " << argv[i]
+                          << " (noeviction|allkeys-lru|allkeys-lfu|volatile-ttl)" << std::endl;
+                return false;
+            }
+        } else if (opt == "--maxmemory-samples") {
+            if (!need(1)) return false;
+            config.maxmemory_samples = std::atoi(argv[++i]);
+            if (config.maxmemory_samples < 1 || config.maxmemory_samples > 64) {
+                std::cerr << "[ERROR] invalid maxmemory-samples: " << argv[i] << " (1-64)" << std::endl;
+                return false;
+            }
+        } else if (opt == "--lazyfree-lazy-eviction" || opt == "--lazyfree-lazy-expire" ||
+                   opt == "--lazyfree-lazy-server-del" || opt == "--lazyfree-lazy-user-del" ||
+                   opt == "--lazyfree-lazy-user-flush") {
+            if (!need(1)) return false;
+            bool* flag = opt == "--lazyfree-lazy-eviction"     ? &config.lazyfree_lazy_eviction
+                       : opt == "--lazyfree-lazy-expire"       ? &config.lazyfree_lazy_expire
+                       : opt == "--lazyfree-lazy-server-del"   ? &config.lazyfree_lazy_server_del
+                       : opt == "--lazyfree-lazy-user-del"     ? &config.lazyfree_lazy_user_del
+                                                               : &config.lazyfree_lazy_user_flush;
+            if (!parseYesNo(argv[++i], *flag)) {
+                std::cerr << "[ERROR] invalid " << opt.substr(2) << ": " << argv[i] << " (yes|no)" << std::endl;
+                return false;
+            }
+        } else {
+            std::cerr << "[ERROR] unknown option: " << opt << std::endl;
+            return false;
+        }
+    }
+
+    if (config.shards > 1 && config.io_threads > 1) {
+        std::cerr << "[ERROR] --shards and --io-threads cannot be combined" << std::endl;
+        return false;
+    }
+    if (config.event_loop == EventLoopBackend::IO_URING && config.io_threads > 1) {
+        std::cerr << "[ERROR] --event-loop io_uring and --io-threads cannot be combined" << std::endl;
+        return false;
+    }
+    return true;
+}
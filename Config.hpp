@@ -0,0 +1,126 @@
+// Config.hpp
+#pragma once
+#include <string>
+#include <cstddef>
+
+// 客户端类别（对应 Redis client-output-buffer-limit 的 class）
+// 目前只有普通客户端，REPLICA / PUBSUB 为后续复制、发布订阅预留
+enum class ClientClass {
+    NORMAL,
+    REPLICA,
+    PUBSUB,
+    COUNT
+};
+
+// 输出缓冲区限制：超过 hard 立即断开；持续超过 soft 达 soft_seconds 秒也断开
+// 0 表示不限制
+struct OutputBufferLimit {
+    size_t hard_bytes = 0;
+    size_t soft_bytes = 0;
+    int soft_seconds = 0;
+};
+
+// 事件循环后端
+enum class EventLoopBackend {
+    EPOLL,     // 就绪通知 + readv/writev，默认
+    IO_URING   // 完成通知：multishot accept/recv + 批量提交 send，不可用时回退 epoll
+};
+
+// 内存超过 maxmemory 时的淘汰策略（名字同 Redis maxmemory-policy）
+enum class MaxmemoryPolicy {
+    NOEVICTION,    // 不淘汰，可能增加内存的写命令返回 OOM 错误
+    ALLKEYS_LRU,   // 所有 key 中淘汰最久未访问的（近似）
+    ALLKEYS_LFU,   // 所有 key 中淘汰访问频率最低的（近似）
+    VOLATILE_TTL   // 设置了过期时间的 key 中淘汰最快过期的
+};
+
+struct ServerConfig {
+    int port = 6379;
+
+    // I/O 线程数（包含主线程）。>1 时 socket 读、RESP 解析和写由多个线程并行，
+    // 命令仍在主线程串行执行
+    int io_threads = 1;
+
+    // 分片数（shared-nothing 多 reactor）。>1 时每个分片独立的事件循环、监听 socket
+    // （SO_REUSEPORT）和 Database，key 按哈希路由；与 io_threads > 1 互斥
+    int shards = 1;
+
+    // 事件循环后端；io_uring 与 io_threads > 1 互斥（读写由内核异步完成，不需要 I/O 线程）
+    EventLoopBackend event_loop = EventLoopBackend::EPOLL;
+
+    // 列表（quicklist）参数，与 Redis 同名配置含义相同：
+    // list_max_listpack_size > 0 为每个节点的元素数上限，-1 ~ -5 为节点字节上限 4KB ~ 64KB；
+    // list_compress_depth > 0 时两端各保留这么多个节点不压缩，其余节点用 LZF 压缩
+    int list_max_listpack_size = -2;
+    int list_compress_depth = 0;
+
+    // 全是整数的集合不超过这么多个成员时用 intset（有序整数数组），超过后转为哈希表
+    size_t set_max_intset_entries = 512;
+
+    // 有序集合成员数不超过 zset_max_listpack_entries、且每个 member 不超过
+    // zset_max_listpack_value 字节时用 listpack，否则转为跳表
+    size_t zset_max_listpack_entries = 128;
+    size_t zset_max_listpack_value = 64;
+
+    // 定时任务（serverCron）每秒执行 hz 次
+    int hz = 10;
+
+    // 每次定时任务用于推进渐进式 rehash（键空间及 hash / set / zset 的内部哈希表）的
+    // 时间上限（微秒），0 表示关闭，只在访问时迁移
+    int active_rehash_us = 1000;
+
+    // 主动过期的力度 1-10（同 Redis active-expire-effort）：越大每轮取样越多、
+    // 每次允许占用的时间越长，内存中残留的已过期 key 越少
+    int active_expire_effort = 1;
+
+    // 内存上限（字节，按 usedMemory() 统计），0 表示不限制；超过后写命令执行前按
+    // maxmemory_policy 淘汰 key，每次从键空间取样 maxmemory_samples 个放入候选池
+    // （多分片模式下为整个进程的上限，各分片淘汰自己的 key，见 Database::performEvictions）
+    size_t maxmemory = 0;
+    MaxmemoryPolicy maxmemory_policy = MaxmemoryPolicy::NOEVICTION;
+    int maxmemory_samples = 5;
+
+    // 后台释放（同 Redis 的 lazyfree-lazy-* 配置，默认都关闭）：打开后对应场景下删除的大对象
+    // 只从键空间摘下，由后台线程释放（见 LazyFree.hpp）。UNLINK / FLUSHALL ASYNC 总是后台释放
+    bool lazyfree_lazy_eviction = false;    // 淘汰
+    bool lazyfree_lazy_expire = false;      // 过期删除
+    bool lazyfree_lazy_server_del = false;  // 覆盖已有的 key 时释放旧值
+    bool lazyfree_lazy_user_del = false;    // DEL 等同于 UNLINK
+    bool lazyfree_lazy_user_flush = false;  // 不带 ASYNC / SYNC 的 FLUSHALL / FLUSHDB 按 ASYNC 执行
+
+    // 默认值与 Redis 一致：普通客户端是请求/响应模式，不限制
+    OutputBufferLimit output_limits[static_cast<size_t>(ClientClass::COUNT)] = {
+        {0, 0, 0},                                          // normal
+        {256ULL * 1024 * 1024, 64ULL * 1024 * 1024, 60},    // replica
+        {32ULL * 1024 * 1024, 8ULL * 1024 * 1024, 60},      // pubsub
+    };
+
+    const OutputBufferLimit& outputLimit(ClientClass cls) const {
+        return output_limits[static_cast<size_t>(cls)];
+    }
+};
+
+// 解析 "100", "64kb", "256mb", "1gb"，失败返回 false
+bool parseMemorySize(const std::string& s, size_t& out);
+
+// 策略名（INFO 输出用，与命令行参数相同）
+const char* maxmemoryPolicyName(MaxmemoryPolicy policy);
+
+// 解析命令行参数，例如：
+//   --port 6380
+//   --io-threads 4
+//   --shards 4
+//   --event-loop io_uring
+//   --client-output-buffer-limit normal 64mb 16mb 30
+//   --list-max-listpack-size -2
+//   --list-compress-depth 1
+//   --set-max-intset-entries 512
+//   --zset-max-listpack-entries 128
+//   --zset-max-listpack-value 64
+//   --hz 10
+//   --active-rehash-us 1000
+//   --active-expire-effort 1
+//   --maxmemory 100mb --maxmemory-policy allkeys-lru --maxmemory-samples 5
+//   --lazyfree-lazy-eviction yes（以及 -expire / -server-del / -user-del / -user-flush）
+// 出错时打印原因并返回 false
+bool parseCommandLine(int argc, char* argv[], ServerConfig& config);
@@ -1,28 +1,32 @@
 // Connection.cpp
 #include "Connection.hpp"
 #include "utils.hpp"
+#include "Shard.hpp"
 #include <unistd.h>
 #include <cerrno>
 #include <cstring>
 
-Connection::Connection(int sockfd) : sockfd_(sockfd) {}
+Connection::Connection(int sockfd, uint64_t id) : sockfd_(sockfd), id_(id) {}
 
 Connection::~Connection() {
     if (sockfd_ != -1) close(sockfd_);
 }
 
 bool Connection::readFromSocket() {
-    char buf[1024];
-    ssize_t n;
-    while ((n = read(sockfd_, buf, sizeof(buf))) > 0) {
-        read_buffer_.append(buf, n);
-    }
-    if (n == 0) {
-        // 对端关闭
-        closed_ = true;
-        return false;
-    }
-    if (n < 0) {
+    while (true) {
+        ssize_t n = read_buffer_.readFrom(sockfd_);
+        if (n > 0) {
+            // readv 每次至少提供 EXTRA_READ_SIZE 的空间，读不满说明 socket 已读空，
+            // 省掉一次必然返回 EAGAIN 的系统调用
+            if (static_cast<size_t>(n) < InputBuffer::EXTRA_READ_SIZE) return true;
+            continue;
+        }
+        if (n == 0) {
+            // 对端关闭
+            closed_ = true;
+            return false;
+        }
+        if (errno == EINTR) continue;
         if (errno == EAGAIN || errno == EWOULDBLOCK) {
             return true; // 正常，无更多数据
         }
@@ -30,28 +34,25 @@ bool Connection::readFromSocket() {
         closed_ = true;
         return false;
     }
-    return true;
 }
 
 void Connection::sendResponse(const std::string& resp) {
-    write_buffer_ += resp;
+    write_buffer_.append(resp.data(), resp.size());
     // 实际发送在 writeToSocket() 中进行（由 Server 调用）
 }
 
+void Connection::sendResponse(std::string&& resp) {
+    write_buffer_.append(std::move(resp));
+}
+
 bool Connection::writeToSocket() {
     if (write_buffer_.empty()) return true;
 
-    ssize_t n = write(sockfd_, write_buffer_.data(), write_buffer_.size());
-    if (n <= 0) {
-        if (errno == EAGAIN || errno == EWOULDBLOCK) {
-            return true; // 下次再试
-        }
+    // 写到内核缓冲区满（EAGAIN）为止，已发送部分只推进块偏移
+    if (write_buffer_.writeTo(sockfd_) < 0) {
         closed_ = true;
         return false;
     }
-
-    // 移除已发送部分
-    write_buffer_.erase(0, n);
     return true;
 }
 
@@ -60,9 +61,99 @@ bool Connection::hasCompleteCommand() const {
 }
 
 void Connection::consumeInput(size_t n) {
-    if (n >= read_buffer_.size()) {
-        read_buffer_.clear();
-    } else {
-        read_buffer_.erase(0, n);
+    read_buffer_.consume(n);
+}
+
+void Connection::parseInput() {
+    std::string_view input = read_buffer_.view();
+    if (input.data() != parse_base_) {
+        // 阻塞期间读入数据使缓冲区扩容或搬移：未消费数据整体移动，命令内偏移不变
+        uintptr_t old_base = reinterpret_cast<uintptr_t>(parse_base_);
+        for (size_t i = next_command_; i < command_count_; ++i) {
+            for (auto& arg : commands_[i]) {
+                arg = std::string_view(input.data() + (reinterpret_cast<uintptr_t>(arg.data()) - old_base),
+                                       arg.size());
+            }
+        }
+        parse_base_ = input.data();
+    }
+    // 协议错误之后无法重新定位命令边界，本批结束前到达的数据一并丢弃
+    if (protocol_error_) {
+        parsed_bytes_ = input.size();
+        return;
+    }
+
+    size_t offset = parsed_bytes_;
+    size_t consumed = 0;
+
+    while (offset < input.size()) {
+        if (command_count_ == commands_.size()) {
+            commands_.emplace_back();
+            command_ends_.emplace_back();
+        }
+        auto& args = commands_[command_count_];
+
+        auto result = parser_.parse(input.substr(offset), args, consumed);
+        if (result == RespParser::ParseResult::COMPLETE) {
+            offset += consumed;
+            if (!args.empty()) command_ends_[command_count_++] = offset;
+        } else if (result == RespParser::ParseResult::ERROR) {
+            // 协议错误后无法重新定位命令边界，丢弃剩余数据
+            protocol_error_ = true;
+            parser_.reset();
+            offset = input.size();
+        } else {
+            break; // INCOMPLETE: 保留残余字节，等待更多数据
+        }
+    }
+    parsed_bytes_ = offset;
+}
+
+void Connection::finishCommands() {
+    // 只在本批末尾一次性移除已解析的字节，避免每条命令（或每次阻塞）都 memmove
+    // 之后未完成命令位于缓冲区起点，与解析器保存的相对偏移一致
+    read_buffer_.consume(parsed_bytes_);
+    if (size_t need = parser_.expectedCommandSize()) {
+        read_buffer_.reserve(need);
+    }
+
+    parsed_bytes_ = 0;
+    command_count_ = 0;
+    next_command_ = 0;
+    protocol_error_ = false;
+    parse_base_ = read_buffer_.view().data();
+    if (commands_.size() > MAX_CACHED_COMMANDS) {
+        commands_.resize(MAX_CACHED_COMMANDS);
+        command_ends_.resize(MAX_CACHED_COMMANDS);
+    }
+}
+
+void Connection::blockOn(std::unique_ptr<ShardFanout> fanout) {
+    fanout_ = std::move(fanout);
+}
+
+bool Connection::addShardReply(std::string_view reply) {
+    if (!fanout_ || !fanout_->add(reply)) return false;
+    sendResponse(fanout_->result());
+    fanout_.reset();
+    return true;
+}
+
+bool Connection::outputLimitReached(const OutputBufferLimit& limit) {
+    size_t used = write_buffer_.size();
+
+    if (limit.hard_bytes && used >= limit.hard_bytes) return true;
+
+    if (limit.soft_bytes && used >= limit.soft_bytes) {
+        auto now = std::chrono::steady_clock::now();
+        if (!soft_limit_reached_) {
+            soft_limit_reached_ = true;
+            soft_limit_since_ = now;
+            return limit.soft_seconds == 0;
+        }
+        return now - soft_limit_since_ >= std::chrono::seconds(limit.soft_seconds);
     }
-}
\ No newline at end of file
+
+    soft_limit_reached_ = false;
+    return false;
+}
@@ -1,39 +1,119 @@
 // Connection.hpp（更新版）
 #pragma once
 #include <string>
+#include <string_view>
 #include <memory>
+#include "Protocol.hpp"
+#include "IoBuffer.hpp"
+#include "Config.hpp"
+#include <chrono>
+#include <vector>
+#include <cstdint>
+
+class ShardFanout;
 
 class Connection {
 public:
-    explicit Connection(int sockfd);
+    explicit Connection(int sockfd, uint64_t id = 0);
     ~Connection();
 
     int get_fd() const { return sockfd_; }
+    uint64_t id() const { return id_; }
 
-    // 从 socket 读取数据到 read_buffer_
+    // 从 socket 读取数据到 read_buffer_（readv，读到 EAGAIN 为止）
     bool readFromSocket();
 
-    // 将响应加入 write_buffer_，并尝试发送
+    // 将响应加入 write_buffer_（实际发送在 writeToSocket 中进行）
     void sendResponse(const std::string& resp);
+    void sendResponse(std::string&& resp); // 大响应直接移入，不拷贝
 
-    // 尝试将 write_buffer_ 中的数据写出
+    // 尝试将 write_buffer_ 中的数据写出（writev）
     bool writeToSocket();
 
+    // 待发送的字节数
+    size_t pendingOutput() const { return write_buffer_.size(); }
+
+    // 输出缓冲区：命令处理函数通过 RespParser::writeXxx 直接编码到这里
+    OutputBuffer& output() { return write_buffer_; }
+
+    // ---- 完成通知式 I/O（io_uring）：读写由内核完成，连接只负责缓冲 ----
+    // 收到的数据追加到读缓冲区
+    void appendInput(const char* data, size_t len) { read_buffer_.append(data, len); }
+    // 填充待发送数据的 iovec，内存在 completeSend 之前保持有效
+    int prepareSend(struct iovec* iov, int max) const { return write_buffer_.fillIov(iov, max); }
+    // 内核已发送 n 字节
+    void completeSend(size_t n) { write_buffer_.consume(n); }
+
     // 检查 read_buffer_ 是否包含完整命令
     bool hasCompleteCommand() const;
 
     // 获取当前读缓冲区内容（供 parser 使用）
-    const std::string& getReadBuffer() const { return read_buffer_; }
+    std::string_view getReadBuffer() const { return read_buffer_.view(); }
 
     // 消费已解析的字节数（parser 成功后调用）
     void consumeInput(size_t n);
 
+    // 增量解析读缓冲区中新到达的完整命令，追加到本批命令之后（可在 I/O 线程中调用）
+    // 结果保存在连接内，参数是指向读缓冲区的视图，finishCommands 之前有效；
+    // 读入数据使缓冲区搬移时，已解析命令的视图在这里按新地址重新定位
+    void parseInput();
+
+    // 本批中下一条待执行的命令。被跨分片请求阻塞时停在这里，
+    // 阻塞期间读到的数据继续解析追加到本批，解除阻塞后从这里接着执行
+    bool hasPendingCommand() const { return next_command_ < command_count_; }
+    const std::vector<std::string_view>& nextCommand() { return commands_[next_command_++]; }
+
+    // 解析过程中是否遇到协议错误（错误之后的数据已丢弃）
+    bool hasProtocolError() const { return protocol_error_; }
+
+    // 本批命令全部执行完毕：一次性消费已解析的字节，为未完成的大参数预留空间
+    void finishCommands();
+
+    // 多分片模式：等待其他分片回复期间连接被阻塞，保证响应顺序与命令顺序一致
+    bool blocked() const { return fanout_ != nullptr; }
+    void blockOn(std::unique_ptr<ShardFanout> fanout);
+    // 收到一个分片的回复；全部收齐时把合并结果加入输出并解除阻塞，返回 true
+    bool addShardReply(std::string_view reply);
+
     // 检查连接是否应关闭（如对端关闭）
     bool shouldClose() const { return closed_; }
 
+    // 标记连接需要关闭（如输出缓冲区超限），由 Server 在本轮事件处理后关闭
+    void markClosed() { closed_ = true; }
+
+    ClientClass clientClass() const { return client_class_; }
+
+    // 检查输出缓冲区是否超过限制；soft limit 需要持续超过 soft_seconds 秒才算超限
+    bool outputLimitReached(const OutputBufferLimit& limit);
+
+    // 是否已在 epoll 中注册 EPOLLOUT
+    bool writeArmed() const { return write_armed_; }
+    void setWriteArmed(bool armed) { write_armed_ = armed; }
+
 private:
     int sockfd_;
-    std::string read_buffer_;
-    std::string write_buffer_;
+    uint64_t id_;
+    InputBuffer read_buffer_;
+    OutputBuffer write_buffer_;
+    RespParser parser_; // 每个连接独立，保存未完成命令的解析进度
+
+    // parseInput 的结果：commands_ 跨批次保留（最多 MAX_CACHED_COMMANDS 个），复用内部 vector 的内存
+    static constexpr size_t MAX_CACHED_COMMANDS = 1024;
+    std::vector<std::vector<std::string_view>> commands_;
+    std::vector<size_t> command_ends_; // 每条命令结束处相对缓冲区起点的偏移
+    size_t command_count_ = 0;
+    size_t next_command_ = 0;
+    size_t parsed_bytes_ = 0;
+    const char* parse_base_ = nullptr; // 上次解析时未消费数据的起点，commands_ 的视图基于它
+    bool protocol_error_ = false;
+
+    std::unique_ptr<ShardFanout> fanout_; // 非空表示正在等待其他分片的回复
+
+    ClientClass client_class_ = ClientClass::NORMAL;
     bool closed_ = false;
+    bool write_armed_ = false;
+
+    // 持续超过 soft limit 的起始时间（soft_limit_reached_ 为 true 时有效）
+    bool soft_limit_reached_ = false;
+    std::chrono::steady_clock::time_point soft_limit_since_;
 };
\ No newline at end of file
@@ -2,114 +2,749 @@
 // Database.cpp
 #include "Database.hpp"
 #include "RedisObject.hpp"      // 定义 ObjectType, ObjectEncoding
-#include "StringObject.hpp"     // 用于 dynamic_cast / make_shared
-#include "HashObject.hpp"       // 同上
-#include "Dict.hpp"             // 用于 get_rehashing_dicts()
+#include "HashObject.hpp"
+#include "ListObject.hpp"
+#include "SetObject.hpp"
+#include "ZSetObject.hpp"
 #include "Rdb.hpp"
+#include "Memory.hpp"
+#include "LazyFree.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
 #include <stdexcept>
+#include <cerrno>
+#include <cstdio>
+#include <csignal>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+[[noreturn]] void throwWrongType() {
+    throw std::runtime_error("WRONGTYPE Operation against a key holding the wrong kind of value");
+}
+
+// 定时任务每迁移这么多个 bucket 检查一次时间（与 KeySpace::rehash_for_ms 相同）
+constexpr int REHASH_BATCH = 100;
+
+// 主动过期参数，均为 effort = 1 时的值（同 Redis expire.c）
+constexpr size_t ACTIVE_EXPIRE_KEYS_PER_LOOP = 20;  // 每轮取样数
+constexpr int64_t ACTIVE_EXPIRE_FAST_DURATION = 1000; // 快速周期的时间片（微秒）
+constexpr int ACTIVE_EXPIRE_SLOW_TIME_PERC = 25;    // 慢速周期最多占 cron 周期的百分比
+constexpr int ACTIVE_EXPIRE_ACCEPTABLE_STALE = 10;  // 取样中已过期的比例不超过它就停止（百分比）
+
+// 一次 performEvictions 最多占用的时间（微秒，同 Redis maxmemory-eviction-tenacity 默认值 10 时）
+constexpr int64_t EVICTION_TIME_LIMIT_US = 500;
+
+int64_t monotonicUs() {
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// 淘汰时的内存用量：已交给后台线程、还没释放完的部分视为已释放，
+// 否则开启 lazyfree-lazy-eviction 后会一直淘汰到后台线程赶上为止
+size_t evictionUsedMemory() {
+    size_t used = usedMemory();
+    size_t pending = lazyfreePendingBytes();
+    return used > pending ? used - pending : 0;
+}
+
+// 只有 hash / set / zset 有内部哈希表
+bool isRehashing(const RedisObject* obj) {
+    switch (obj->type()) {
+    case ObjectType::HASH: return obj->hash()->is_rehashing();
+    case ObjectType::SET:  return obj->set()->is_rehashing();
+    case ObjectType::ZSET: return obj->zset()->is_rehashing();
+    default: return false;
+    }
+}
+
+bool rehashStep(RedisObject* obj, int n) {
+    switch (obj->type()) {
+    case ObjectType::HASH: return obj->hash()->rehash_step(n);
+    case ObjectType::SET:  return obj->set()->rehash_step(n);
+    case ObjectType::ZSET: return obj->zset()->rehash_step(n);
+    default: return false;
+    }
+}
+
+} // namespace
 
 Database::Database() {
     // 尝试从 dump.rdb 恢复数据
-    auto loaded_data = RdbEncoder::loadFromFile("dump.rdb");
-    data_ = std::move(loaded_data);
+    loadRdb("dump.rdb");
 }
 
 Database::Database(bool disable_rdb_load) {
     if (!disable_rdb_load) {
-        auto loaded_data = RdbEncoder::loadFromFile("dump.rdb");
-        data_ = std::move(loaded_data);
+        loadRdb("dump.rdb");
     }
     // 否则 data_ 保持空
 }
 
-void Database::set(const std::string& key, const std::string& value) {
-    auto obj = std::make_shared<StringObject>(value);
-    storeKey(key, std::move(obj));
+Database::Database(const std::string& rdb_filename, bool load) : rdb_filename_(rdb_filename) {
+    if (load) {
+        loadRdb(rdb_filename_);
+    }
+}
+
+void Database::loadRdb(const std::string& filename) {
+    RdbEncoder::loadFromFile(filename, data_, expires_);
+    trackAllRehashing();
+    recountAll();
+}
+
+void Database::set(std::string_view key, std::string_view value) {
+    // 唯一一次拷贝 value：从读缓冲区进入对象（整数不拷贝，短字符串与对象头同一次分配）
+    storeKey(key, ObjectPtr::createString(value));
+    if (expires_.size() > 0) expires_.erase(key);
+}
+
+bool Database::set(std::string_view key, std::string_view value, int flags, int64_t expire_at) {
+    if (flags & (SET_NX | SET_XX)) {
+        bool exists = lookupKeyNoTouch(key) != nullptr;
+        if ((flags & SET_NX) ? exists : !exists) return false;
+    }
+    storeKey(key, ObjectPtr::createString(value));
+    if (expire_at != ExpireTable::NONE) {
+        expires_.set(key, expire_at);
+    } else if (!(flags & SET_KEEPTTL) && expires_.size() > 0) {
+        expires_.erase(key);
+    }
+    return true;
+}
+
+bool Database::get(std::string_view key, std::string& out_value) {
+    std::string_view value;
+    if (!get(key, value)) {
+        return false;
+    }
+    out_value.assign(value);
+    return true;
 }
 
-bool Database::get(const std::string& key, std::string& out_value) const {
-    auto obj = lookupKey(key);
+bool Database::get(std::string_view key, std::string_view& out_value) {
+    auto* obj = lookupKey(key);
     if (!obj || obj->type() != ObjectType::STRING) {
         return false;
     }
-    out_value = static_cast<StringObject*>(obj.get())->value();
+    out_value = obj->stringView(int_buf_);
     return true;
 }
 
-void Database::hset(const std::string& key, const std::string& field, const std::string& value) {
-    auto obj = lookupKey(key);
+void Database::hset(std::string_view key, std::string_view field, std::string_view value) {
+    auto* obj = lookupKey(key);
     if (!obj) {
         // key 不存在，创建新 Hash
-        auto hash_obj = std::make_shared<HashObject>();
-        hash_obj->set_field(field, value);
-        storeKey(key, hash_obj);
+        auto hash_obj = ObjectPtr::createHash();
+        hash_obj->hash()->set_field(field, value);
+        storeKey(key, std::move(hash_obj));
     } else {
         if (obj->type() != ObjectType::HASH) {
-            throw std::runtime_error("WRONGTYPE Operation against a key holding the wrong kind of value");
+            throwWrongType();
         }
-        static_cast<HashObject*>(obj.get())->set_field(field, value);
+        bool was_rehashing = obj->hash()->is_rehashing();
+        countObject(obj, -1);
+        obj->hash()->set_field(field, value);
+        countObject(obj, 1);
+        trackRehashing(key, obj, was_rehashing);
     }
 }
 
-bool Database::hget(const std::string& key, const std::string& field, std::string& out_value) const {
-    auto obj = lookupKey(key);
+bool Database::hget(std::string_view key, std::string_view field, std::string& out_value) {
+    auto* obj = lookupKey(key);
     if (!obj || obj->type() != ObjectType::HASH) {
         return false;
     }
-    return static_cast<HashObject*>(obj.get())->get_field(field, out_value);
+    return obj->hash()->get_field(field, out_value);
 }
 
-// --- 辅助函数 ---
-std::shared_ptr<RedisObject> Database::lookupKey(const std::string& key) const {
-    auto it = data_.find(key);
-    return (it != data_.end()) ? it->second : nullptr;
+bool Database::hget(std::string_view key, std::string_view field, std::string_view& out_value) {
+    auto* obj = lookupKey(key);
+    if (!obj || obj->type() != ObjectType::HASH) {
+        return false;
+    }
+    return obj->hash()->find_field(field, out_value, int_buf_);
+}
+
+// --- List ---
+
+size_t Database::push(std::string_view key, const std::vector<std::string_view>& values, bool front) {
+    auto* obj = lookupKeyOfType(key, ObjectType::LIST);
+    if (!obj) {
+        auto list_obj = ObjectPtr::createList();
+        obj = list_obj.get();
+        storeKey(key, std::move(list_obj));
+    }
+    ListObject* list = obj->list();
+    countObject(obj, -1);
+    for (auto value : values) {
+        if (front) {
+            list->push_front(value);
+        } else {
+            list->push_back(value);
+        }
+    }
+    countObject(obj, 1);
+    return list->size();
 }
 
-void Database::storeKey(const std::string& key, std::shared_ptr<RedisObject> obj) {
-    data_[key] = std::move(obj);
+bool Database::pop(std::string_view key, bool front, size_t count, std::vector<std::string>& out) {
+    auto* obj = lookupKeyOfType(key, ObjectType::LIST);
+    if (!obj) return false;
+    ListObject* list = obj->list();
+    std::string value;
+    countObject(obj, -1);
+    for (size_t i = 0; i < count; ++i) {
+        if (!(front ? list->pop_front(value) : list->pop_back(value))) break;
+        out.push_back(std::move(value));
+    }
+    countObject(obj, 1);
+    if (list->size() == 0) deleteKey(key);
+    return true;
 }
 
-bool Database::keyExists(const std::string& key) const {
-    return data_.count(key) > 0;
+size_t Database::llen(std::string_view key) {
+    auto* obj = lookupKeyOfType(key, ObjectType::LIST);
+    return obj ? obj->list()->size() : 0;
 }
 
-bool Database::checkType(const std::string& key, ObjectType expected) const {
-    auto obj = lookupKey(key);
-    return obj && obj->type() == expected;
+bool Database::lindex(std::string_view key, long long index, std::string& out_value) {
+    auto* obj = lookupKeyOfType(key, ObjectType::LIST);
+    return obj && obj->list()->index(index, out_value);
 }
 
-// Database.cpp
-std::vector<Dict*> Database::get_rehashing_dicts() {
-    std::vector<Dict*> result;
-    for (auto& [key, obj] : data_) {
-        if (obj->type() == ObjectType::HASH) {
-            auto* hash_obj = static_cast<HashObject*>(obj.get());
-            if (hash_obj->encoding() == ObjectEncoding::HASHTABLE) {
-                Dict& d = hash_obj->get_hashtable(); // 需要 non-const getter
-                if (d.is_rehashing()) {
-                    result.push_back(&d);
-                }
-            }
+void Database::lrange(std::string_view key, long long start, long long stop, std::vector<std::string>& out) {
+    auto* obj = lookupKeyOfType(key, ObjectType::LIST);
+    if (obj) obj->list()->range(start, stop, out);
+}
+
+void Database::ltrim(std::string_view key, long long start, long long stop) {
+    auto* obj = lookupKeyOfType(key, ObjectType::LIST);
+    if (!obj) return;
+    countObject(obj, -1);
+    obj->list()->trim(start, stop);
+    countObject(obj, 1);
+    if (obj->list()->size() == 0) deleteKey(key);
+}
+
+size_t Database::lrem(std::string_view key, long long count, std::string_view value) {
+    auto* obj = lookupKeyOfType(key, ObjectType::LIST);
+    if (!obj) return 0;
+    countObject(obj, -1);
+    size_t removed = obj->list()->remove(count, value);
+    countObject(obj, 1);
+    if (obj->list()->size() == 0) deleteKey(key);
+    return removed;
+}
+
+long long Database::linsert(std::string_view key, bool after, std::string_view pivot, std::string_view value) {
+    auto* obj = lookupKeyOfType(key, ObjectType::LIST);
+    if (!obj) return 0;
+    ListObject* list = obj->list();
+    countObject(obj, -1);
+    bool inserted = list->insert(pivot, value, after);
+    countObject(obj, 1);
+    if (!inserted) return -1;
+    return static_cast<long long>(list->size());
+}
+
+// --- Set ---
+
+size_t Database::sadd(std::string_view key, const std::vector<std::string_view>& members) {
+    auto* obj = lookupKeyOfType(key, ObjectType::SET);
+    if (!obj) {
+        auto set_obj = ObjectPtr::createSet();
+        obj = set_obj.get();
+        storeKey(key, std::move(set_obj));
+    }
+    bool was_rehashing = obj->set()->is_rehashing();
+    size_t added = 0;
+    countObject(obj, -1);
+    for (auto member : members) {
+        added += obj->set()->add(member);
+    }
+    countObject(obj, 1);
+    trackRehashing(key, obj, was_rehashing);
+    return added;
+}
+
+size_t Database::srem(std::string_view key, const std::vector<std::string_view>& members) {
+    auto* obj = lookupKeyOfType(key, ObjectType::SET);
+    if (!obj) return 0;
+    bool was_rehashing = obj->set()->is_rehashing();
+    size_t removed = 0;
+    countObject(obj, -1);
+    for (auto member : members) {
+        removed += obj->set()->remove(member);
+    }
+    countObject(obj, 1);
+    trackRehashing(key, obj, was_rehashing);
+    if (obj->set()->size() == 0) deleteKey(key);
+    return removed;
+}
+
+bool Database::sismember(std::string_view key, std::string_view member) {
+    auto* obj = lookupKeyOfType(key, ObjectType::SET);
+    return obj && obj->set()->contains(member);
+}
+
+size_t Database::scard(std::string_view key) {
+    auto* obj = lookupKeyOfType(key, ObjectType::SET);
+    return obj ? obj->set()->size() : 0;
+}
+
+std::vector<std::string> Database::smembers(std::string_view key) {
+    auto* obj = lookupKeyOfType(key, ObjectType::SET);
+    return obj ? obj->set()->members() : std::vector<std::string>{};
+}
+
+std::vector<std::string> Database::sinter(const std::vector<std::string_view>& keys) {
+    std::vector<const SetObject*> sets;
+    for (auto key : keys) {
+        auto* obj = lookupKeyOfType(key, ObjectType::SET);
+        if (!obj) return {}; // 与空集合求交，结果为空
+        sets.push_back(obj->set());
+    }
+    std::vector<std::string> result;
+    SetObject::intersect(std::move(sets), result);
+    return result;
+}
+
+std::vector<std::string> Database::sunion(const std::vector<std::string_view>& keys) {
+    std::vector<const SetObject*> sets;
+    for (auto key : keys) {
+        if (auto* obj = lookupKeyOfType(key, ObjectType::SET)) sets.push_back(obj->set());
+    }
+    std::vector<std::string> result;
+    SetObject::unite(sets, result);
+    return result;
+}
+
+std::vector<std::string> Database::sdiff(const std::vector<std::string_view>& keys) {
+    std::vector<const SetObject*> sets;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        auto* obj = lookupKeyOfType(keys[i], ObjectType::SET);
+        if (obj) {
+            sets.push_back(obj->set());
+        } else if (i == 0) {
+            return {};
         }
-        // TODO: 未来添加 SetObject、ZSetObject 的 rehash 检查
     }
+    std::vector<std::string> result;
+    SetObject::difference(sets, result);
     return result;
 }
 
-size_t Database::del(const std::vector<std::string>& keys) {
+// --- Sorted set ---
+bool Database::zadd(std::string_view key, int flags, const std::vector<std::pair<double, std::string_view>>& items,
+                    size_t& added, size_t& changed, double& newscore) {
+    added = changed = 0;
+    auto* obj = lookupKeyOfType(key, ObjectType::ZSET);
+    if (!obj) {
+        if (flags & ZADD_XX) return false; // XX 不创建 key
+        ObjectPtr zset = ObjectPtr::createZSet();
+        obj = zset.get();
+        storeKey(key, std::move(zset));
+    }
+    bool was_rehashing = obj->zset()->is_rehashing();
+    bool done = true;
+    countObject(obj, -1);
+    for (const auto& [score, member] : items) {
+        // NaN 只会出现在已有成员的 INCR 上，抛出时 key 不会是空的，也还没有修改
+        ZAddResult result;
+        try {
+            result = obj->zset()->add(score, member, flags, newscore);
+        } catch (...) {
+            countObject(obj, 1);
+            throw;
+        }
+        switch (result) {
+        case ZAddResult::ADDED:
+            added++;
+            changed++;
+            break;
+        case ZAddResult::UPDATED:
+            changed++;
+            break;
+        case ZAddResult::UNCHANGED:
+            break;
+        case ZAddResult::SKIPPED:
+            done = false;
+            break;
+        }
+    }
+    countObject(obj, 1);
+    trackRehashing(key, obj, was_rehashing);
+    // NX / GT 之类全部拦下时不留空 key
+    if (obj->zset()->size() == 0) deleteKey(key);
+    return done;
+}
+
+size_t Database::zrem(std::string_view key, const std::vector<std::string_view>& members) {
+    auto* obj = lookupKeyOfType(key, ObjectType::ZSET);
+    if (!obj) return 0;
+    bool was_rehashing = obj->zset()->is_rehashing();
+    size_t removed = 0;
+    countObject(obj, -1);
+    for (auto member : members) {
+        removed += obj->zset()->remove(member);
+    }
+    countObject(obj, 1);
+    trackRehashing(key, obj, was_rehashing);
+    if (obj->zset()->size() == 0) deleteKey(key);
+    return removed;
+}
+
+bool Database::zscore(std::string_view key, std::string_view member, double& out) {
+    auto* obj = lookupKeyOfType(key, ObjectType::ZSET);
+    return obj && obj->zset()->score(member, out);
+}
+
+size_t Database::zcard(std::string_view key) {
+    auto* obj = lookupKeyOfType(key, ObjectType::ZSET);
+    return obj ? obj->zset()->size() : 0;
+}
+
+bool Database::zrank(std::string_view key, std::string_view member, bool reverse, size_t& out) {
+    auto* obj = lookupKeyOfType(key, ObjectType::ZSET);
+    return obj && obj->zset()->rank(member, reverse, out);
+}
+
+void Database::zrange(std::string_view key, long long start, long long stop, bool reverse,
+                      ScoredMembers& out) {
+    auto* obj = lookupKeyOfType(key, ObjectType::ZSET);
+    if (!obj) return;
+    long long len = static_cast<long long>(obj->zset()->size());
+    if (start < 0) start += len;
+    if (stop < 0) stop += len;
+    if (start < 0) start = 0;
+    if (stop >= len) stop = len - 1;
+    if (start > stop) return;
+    out.reserve(static_cast<size_t>(stop - start + 1));
+    obj->zset()->range(static_cast<size_t>(start), static_cast<size_t>(stop), reverse,
+                       [&](std::string_view member, double score) { out.emplace_back(member, score); });
+}
+
+void Database::zrangebyscore(std::string_view key, const ZRangeSpec& range, bool reverse,
+                             size_t offset, long long count, ScoredMembers& out) {
+    auto* obj = lookupKeyOfType(key, ObjectType::ZSET);
+    if (!obj) return;
+    obj->zset()->rangeByScore(range, reverse, offset, count,
+                              [&](std::string_view member, double score) { out.emplace_back(member, score); });
+}
+
+size_t Database::zcount(std::string_view key, const ZRangeSpec& range) {
+    auto* obj = lookupKeyOfType(key, ObjectType::ZSET);
+    return obj ? obj->zset()->count(range) : 0;
+}
+
+// --- Expire ---
+
+bool Database::expire(std::string_view key, int64_t when) {
+    if (!lookupKeyNoTouch(key)) return false;
+    if (when <= unixTimeMs()) {
+        deleteKey(key, lazyfree_expire_);
+    } else {
+        expires_.set(key, when);
+    }
+    return true;
+}
+
+long long Database::pttl(std::string_view key) {
+    if (!lookupKeyNoTouch(key)) return -2;
+    int64_t when = expires_.get(key);
+    if (when == ExpireTable::NONE) return -1;
+    return std::max<int64_t>(when - unixTimeMs(), 0);
+}
+
+bool Database::persist(std::string_view key) {
+    return lookupKeyNoTouch(key) && expires_.erase(key);
+}
+
+void Database::activeExpireCycle(bool fast, int effort, int hz) {
+    int e = effort - 1;
+    size_t keys_per_loop = ACTIVE_EXPIRE_KEYS_PER_LOOP + ACTIVE_EXPIRE_KEYS_PER_LOOP / 4 * e;
+    int64_t fast_duration = ACTIVE_EXPIRE_FAST_DURATION + ACTIVE_EXPIRE_FAST_DURATION / 4 * e;
+    int slow_time_perc = ACTIVE_EXPIRE_SLOW_TIME_PERC + 2 * e;
+    int acceptable_stale = ACTIVE_EXPIRE_ACCEPTABLE_STALE - e;
+
+    int64_t start = monotonicUs();
+    int64_t timelimit;
+    if (fast) {
+        // 上个周期没有用完时间片、过期比例也不高时不需要加速；
+        // 两个快速周期之间至少间隔两个时间片，给正常请求留出时间
+        if (!expire_timelimit_exit_ && expired_stale_perc_ < acceptable_stale) return;
+        if (start < last_fast_expire_us_ + fast_duration * 2) return;
+        last_fast_expire_us_ = start;
+        timelimit = fast_duration;
+    } else {
+        timelimit = 1000000LL * slow_time_perc / 100 / hz;
+    }
+
+    std::vector<ExpireTable::Entry*> batch(keys_per_loop);
+    int64_t now = unixTimeMs();
+    size_t total_sampled = 0;
+    size_t total_expired = 0;
+    expire_timelimit_exit_ = false;
+    while (true) {
+        if (expires_.size() == 0) break;
+        // 扫到的都是空 bucket 时继续（由时间片兜底），同 Redis
+        size_t sampled = expires_.sample(batch.data(), keys_per_loop, expire_cursor_);
+        size_t expired = 0;
+        for (size_t i = 0; i < sampled; ++i) {
+            // 删除只释放这一个节点，同批的其他节点仍然有效
+            if (now > batch[i]->when) {
+                deleteExpiredKey(batch[i]->key());
+                expired++;
+            }
+        }
+        total_sampled += sampled;
+        total_expired += expired;
+
+        if (monotonicUs() - start > timelimit) {
+            expire_timelimit_exit_ = true;
+            break;
+        }
+        // 已过期的比例不高了，剩下的留给下个周期
+        if (sampled > 0 && expired * 100 <= sampled * acceptable_stale) break;
+    }
+
+    // 指数平均，本次占 5%（同 Redis stat_expired_stale_perc）
+    double current = total_sampled ? total_expired * 100.0 / total_sampled : 0;
+    expired_stale_perc_ = current * 0.05 + expired_stale_perc_ * 0.95;
+}
+
+bool Database::performEvictions() {
+    if (maxmemory_ == 0) return true;
+    if (shards_ > 1) publishKeyCount(false);
+    size_t used = evictionUsedMemory();
+    if (used <= maxmemory_) return true;
+    if (maxmemory_policy_ == MaxmemoryPolicy::NOEVICTION) return false;
+
+    size_t excess = used - maxmemory_;
+    if (shards_ > 1) {
+        publishKeyCount(true);
+        long long total = total_keys_.load(std::memory_order_relaxed);
+        if (total > 0) excess = static_cast<size_t>(static_cast<double>(excess) * data_.size() / total) + 1;
+    }
+    size_t target = used - std::min(excess, used);
+    int64_t start = monotonicUs();
+    std::string key;
+    for (size_t evicted = 1; evictionUsedMemory() > target; ++evicted) {
+        if (!nextEvictionCandidate(key)) return false;
+        deleteKey(key, lazyfree_eviction_);
+        stats_.values[DatasetStats::EVICTED_KEYS]++;
+        // 每淘汰 16 个检查一次时间
+        if (evicted % 16 == 0 && monotonicUs() - start > EVICTION_TIME_LIMIT_US) break;
+    }
+    return true;
+}
+
+void Database::publishKeyCount(bool force) {
+    size_t size = data_.size();
+    size_t diff = size > published_keys_ ? size - published_keys_ : published_keys_ - size;
+    if (diff == 0 || (!force && diff < 64)) return;
+    total_keys_.fetch_add(static_cast<long long>(size) - static_cast<long long>(published_keys_),
+                          std::memory_order_relaxed);
+    published_keys_ = size;
+}
+
+bool Database::nextEvictionCandidate(std::string& key) {
+    bool volatile_ttl = maxmemory_policy_ == MaxmemoryPolicy::VOLATILE_TTL;
+    KeySpace::Entry* keys[64];          // maxmemory-samples 不超过 64
+    ExpireTable::Entry* expires[64];
+    size_t samples = static_cast<size_t>(maxmemory_samples_);
+    while (true) {
+        // 取样补充候选池：volatile-ttl 按过期时间（越早越该淘汰），否则按对象的 LRU / LFU 信息
+        size_t sampled;
+        if (volatile_ttl) {
+            sampled = expires_.sample(expires, samples, evict_cursor_);
+            for (size_t i = 0; i < sampled; ++i) {
+                eviction_pool_.insert(expires[i]->key(), ~static_cast<unsigned long long>(expires[i]->when));
+            }
+        } else {
+            sampled = data_.sample(keys, samples);
+            for (size_t i = 0; i < sampled; ++i) {
+                eviction_pool_.insert(keys[i]->key(), evictionIdle(keys[i]->value.get()));
+            }
+        }
+
+        // 池中的候选可能已被删除、覆盖或去掉了过期时间，取出时重新确认
+        bool popped = false;
+        while (eviction_pool_.popBest(key)) {
+            popped = true;
+            if (volatile_ttl ? expires_.get(key) != ExpireTable::NONE : data_.find(key) != nullptr) {
+                return true;
+            }
+        }
+        // 没有符合策略的 key；否则只是这次取样落空（表很稀疏）或候选都已失效，再取一次
+        if (!popped && (volatile_ttl ? expires_.size() : data_.size()) == 0) return false;
+    }
+}
+
+// --- 辅助函数 ---
+// KeySpace 直接按视图查找，每次访问顺带迁移一个 bucket
+RedisObject* Database::lookupKey(std::string_view key) {
+    RedisObject* obj = lookupKeyNoTouch(key);
+    if (obj) obj->touch();
+    return obj;
+}
+
+RedisObject* Database::lookupKeyNoTouch(std::string_view key) {
+    auto* obj = data_.find(key);
+    if (!obj || expireIfNeeded(key)) return nullptr;
+    return obj->get();
+}
+
+void Database::storeKey(std::string_view key, ObjectPtr obj) {
+    countObject(obj.get(), 1);
+    ObjectPtr old;
+    if (!data_.set(key, std::move(obj), &old)) {
+        countObject(old.get(), -1);
+        if (lazyfree_server_del_) freeObjectAsync(std::move(old));
+    }
+}
+
+bool Database::deleteKey(std::string_view key, bool lazy) {
+    // key 可能指向过期表的节点（主动过期），先删键空间
+    ObjectPtr old;
+    bool removed = data_.erase(key, &old);
+    if (removed) {
+        countObject(old.get(), -1);
+        if (lazy) freeObjectAsync(std::move(old));
+    }
+    if (expires_.size() > 0) expires_.erase(key);
+    return removed;
+}
+
+size_t Database::deleteKeys(const std::vector<std::string_view>& keys, bool lazy) {
     size_t count = 0;
     for (const auto& key : keys) {
-        if (data_.erase(key) > 0) {
+        // 已过期的 key 不计入删除数
+        if (!expireIfNeeded(key) && deleteKey(key, lazy)) {
             ++count;
         }
     }
     return count;
 }
 
-size_t Database::exists(const std::vector<std::string>& keys) const {
+void Database::deleteExpiredKey(std::string_view key) {
+    deleteKey(key, lazyfree_expire_);
+    stats_.values[DatasetStats::EXPIRED_KEYS]++;
+}
+
+void Database::countObject(const RedisObject* obj, long long sign) {
+    ObjectType type = obj->type();
+    ObjectEncoding encoding = obj->encoding();
+    stats_.bytes(type, encoding) += sign * static_cast<long long>(obj->memory_usage());
+    stats_.keys(type, encoding) += sign;
+}
+
+void Database::recountAll() {
+    for (int i = DatasetStats::OBJECT_BYTES; i < DatasetStats::FIELDS; ++i) stats_.values[i] = 0;
+    data_.for_each([&](std::string_view, const ObjectPtr& obj) { countObject(obj.get(), 1); });
+}
+
+bool Database::isExpired(std::string_view key) const {
+    if (expires_.size() == 0) return false;
+    int64_t when = expires_.get(key);
+    return when != ExpireTable::NONE && unixTimeMs() > when;
+}
+
+bool Database::expireIfNeeded(std::string_view key) {
+    if (!isExpired(key)) return false;
+    deleteExpiredKey(key);
+    return true;
+}
+
+RedisObject* Database::lookupKeyOfType(std::string_view key, ObjectType type) {
+    auto* obj = lookupKey(key);
+    if (obj && obj->type() != type) {
+        throwWrongType();
+    }
+    return obj;
+}
+
+bool Database::keyExists(std::string_view key) {
+    return lookupKeyNoTouch(key) != nullptr;
+}
+
+bool Database::checkType(std::string_view key, ObjectType expected) {
+    auto* obj = lookupKey(key);
+    return obj && obj->type() == expected;
+}
+
+// --- 后台任务 ---
+
+void Database::trackRehashing(std::string_view key, const RedisObject* obj, bool was_rehashing) {
+    if (!was_rehashing && isRehashing(obj)) {
+        rehashing_keys_.emplace_back(key);
+    }
+}
+
+void Database::trackAllRehashing() {
+    data_.for_each([&](std::string_view key, const ObjectPtr& obj) {
+        trackRehashing(key, obj.get(), false);
+    });
+}
+
+bool Database::activeRehash(int budget_us) {
+    using Clock = std::chrono::steady_clock;
+    auto deadline = Clock::now() + std::chrono::microseconds(budget_us);
+
+    while (data_.rehash_step(REHASH_BATCH)) {
+        if (Clock::now() >= deadline) return true;
+    }
+    while (expires_.rehash_step(REHASH_BATCH)) {
+        if (Clock::now() >= deadline) return true;
+    }
+
+    // 直接查 KeySpace：后台推进不算访问，不更新 LRU 时钟
+    while (!rehashing_keys_.empty()) {
+        ObjectPtr* obj = data_.find(rehashing_keys_.back());
+        // 已完成（被访问推进完，或 key 已删除、被覆盖）的直接移除
+        if (!obj || !rehashStep(obj->get(), REHASH_BATCH)) {
+            rehashing_keys_.pop_back();
+        }
+        if (Clock::now() >= deadline) break;
+    }
+    return !rehashing_keys_.empty();
+}
+
+size_t Database::del(const std::vector<std::string_view>& keys) {
+    return deleteKeys(keys, lazyfree_user_del_);
+}
+
+size_t Database::unlink(const std::vector<std::string_view>& keys) {
+    return deleteKeys(keys, true);
+}
+
+void Database::flush(bool async) {
+    if (async) {
+        size_t bytes = data_.memory_usage() + expires_.memory_usage() + static_cast<size_t>(stats_.objectBytes());
+        freeKeySpaceAsync(std::move(data_), std::move(expires_), bytes);
+        data_ = KeySpace();
+        expires_ = ExpireTable();
+    } else {
+        data_.clear();
+        expires_.clear();
+    }
+    // 候选池和待推进 rehash 的 key 都是按 key 重新查找的，清掉只是为了不做无用功
+    rehashing_keys_.clear();
+    eviction_pool_ = EvictionPool();
+    recountAll();
+}
+
+size_t Database::exists(const std::vector<std::string_view>& keys) {
     size_t count = 0;
     for (const auto& key : keys) {
-        if (data_.count(key) > 0) {
+        if (lookupKeyNoTouch(key)) {
             ++count;
         }
     }
@@ -124,21 +759,216 @@ std::vector<std::string> Database::getAllKeys(const std::string& pattern) const
     }
     std::vector<std::string> result;
     result.reserve(data_.size());
-    for (const auto& pair : data_) {
-        result.push_back(pair.first);
-    }
+    data_.for_each([&](std::string_view key, const ObjectPtr&) {
+        // 遍历期间不能删除，已过期的只跳过
+        if (!isExpired(key)) result.emplace_back(key);
+    });
     return result;
 }
 
+bool Database::saveRdb() {
+    if (!saveRdb(rdb_filename_)) return false;
+    lastsave_.store(static_cast<long long>(std::time(nullptr)), std::memory_order_relaxed);
+    return true;
+}
+
 bool Database::saveRdb(const std::string& filename) const {
-    return RdbEncoder::saveToFile(filename, data_);
+    return RdbEncoder::saveToFile(filename, data_, expires_);
+}
+
+// --- BGSAVE ---
+
+bool Database::bgsaveRdb(std::string& err) {
+    if (child_pid_ > 0) {
+        err = "Background save already in progress";
+        return false;
+    }
+    // 子进程通过管道上报写时复制量；写端在子进程 exec 前不会关闭，读端设为非阻塞在 cron 里读
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC | O_NONBLOCK) != 0) {
+        err = std::string("Can't create pipe: ") + std::strerror(errno);
+        return false;
+    }
+
+    int64_t start = monotonicUs();
+    pid_t pid = fork();
+    if (pid == 0) {
+        // 子进程：恢复默认信号处理（父进程的处理函数只会唤醒已不存在的事件循环），写完即退出
+        std::signal(SIGINT, SIG_DFL);
+        std::signal(SIGTERM, SIG_DFL);
+        close(fds[0]);
+        int out = fds[1];
+        auto report = [out] {
+            long long cow = static_cast<long long>(privateDirtyMemory());
+            ssize_t n = write(out, &cow, sizeof(cow));
+            (void)n;
+        };
+        // 读 smaps 要遍历页表，每秒最多一次
+        int64_t last_report = monotonicUs();
+        bool ok = RdbEncoder::saveToFile(rdb_filename_, data_, expires_, [&] {
+            int64_t now = monotonicUs();
+            if (now - last_report >= 1000000) {
+                report();
+                last_report = now;
+            }
+        });
+        report();
+        // 不执行静态对象析构和 atexit（后台释放线程在子进程里并不存在）
+        _exit(ok ? 0 : 1);
+    }
+
+    close(fds[1]);
+    if (pid < 0) {
+        close(fds[0]);
+        err = std::string("Can't fork: ") + std::strerror(errno);
+        return false;
+    }
+
+    latest_fork_usec_.store(monotonicUs() - start, std::memory_order_relaxed);
+    child_pid_ = pid;
+    child_pipe_ = fds[0];
+    child_cow_bytes_ = 0;
+    if (active_children_.fetch_add(1, std::memory_order_relaxed) == 0) {
+        // 本轮第一个子进程（BGSAVE 在所有分片上执行，每个分片各一个）
+        bgsave_start_sec_.store(static_cast<long long>(std::time(nullptr)), std::memory_order_relaxed);
+        bgsave_round_ok_.store(true, std::memory_order_relaxed);
+    }
+    std::cout << "[INFO] Background saving started by pid " << pid << std::endl;
+    return true;
+}
+
+void Database::readChildInfo() {
+    long long cow;
+    long long latest = -1;
+    while (read(child_pipe_, &cow, sizeof(cow)) == static_cast<ssize_t>(sizeof(cow))) latest = cow;
+    if (latest < 0) return;
+    current_cow_bytes_.fetch_add(latest - child_cow_bytes_, std::memory_order_relaxed);
+    child_cow_bytes_ = latest;
+}
+
+void Database::checkBackgroundSave() {
+    if (child_pid_ <= 0) return;
+    readChildInfo();
+
+    int status = 0;
+    pid_t pid = waitpid(child_pid_, &status, WNOHANG);
+    if (pid == 0) return;
+    if (pid < 0) {
+        std::cerr << "[ERROR] waitpid() failed for background save child " << child_pid_ << ": "
+                  << std::strerror(errno) << std::endl;
+        finishBackgroundSave(false);
+        return;
+    }
+
+    readChildInfo();  // 退出前最后一次上报
+    bool ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    if (ok) {
+        std::cout << "[INFO] Background saving terminated with success (pid " << pid << ")" << std::endl;
+    } else if (WIFSIGNALED(status)) {
+        std::cerr << "[WARN] Background saving terminated by signal " << WTERMSIG(status) << " (pid " << pid
+                  << ")" << std::endl;
+    } else {
+        std::cerr << "[WARN] Background saving error (pid " << pid << ")" << std::endl;
+    }
+    if (!ok) std::remove(RdbEncoder::tempFilename(rdb_filename_, pid).c_str());
+    finishBackgroundSave(ok);
+}
+
+void Database::killBackgroundSave() {
+    if (child_pid_ <= 0) return;
+    pid_t pid = child_pid_;
+    std::cout << "[INFO] Killing background save child " << pid << std::endl;
+    kill(pid, SIGKILL);
+    int status;
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {}
+    std::remove(RdbEncoder::tempFilename(rdb_filename_, pid).c_str());
+    finishBackgroundSave(false);
+}
+
+void Database::finishBackgroundSave(bool ok) {
+    close(child_pipe_);
+    child_pipe_ = -1;
+    child_pid_ = -1;
+
+    // 本分片的写时复制量从“当前”移到“上次”
+    current_cow_bytes_.fetch_sub(child_cow_bytes_, std::memory_order_relaxed);
+    total_last_cow_bytes_.fetch_add(child_cow_bytes_ - last_cow_bytes_, std::memory_order_relaxed);
+    last_cow_bytes_ = child_cow_bytes_;
+    child_cow_bytes_ = 0;
+
+    if (!ok) bgsave_round_ok_.store(false, std::memory_order_relaxed);
+    if (active_children_.fetch_sub(1, std::memory_order_relaxed) == 1) {
+        // 本轮最后一个子进程结束
+        long long now = static_cast<long long>(std::time(nullptr));
+        bool round_ok = bgsave_round_ok_.load(std::memory_order_relaxed);
+        last_bgsave_ok_.store(round_ok, std::memory_order_relaxed);
+        last_bgsave_time_sec_.store(now - bgsave_start_sec_.load(std::memory_order_relaxed),
+                                    std::memory_order_relaxed);
+        bgsave_start_sec_.store(-1, std::memory_order_relaxed);
+        if (round_ok) lastsave_.store(now, std::memory_order_relaxed);
+    }
 }
 
-size_t Database::memory_usage() const {
-    size_t total = sizeof(*this) + data_.bucket_count() * sizeof(void*);
-    for (const auto& [key, obj] : data_) {
-        total += key.capacity(); // key 字符串内存
-        total += obj->memory_usage();
+PersistenceInfo Database::persistenceInfo() {
+    PersistenceInfo info;
+    info.bgsave_in_progress = childActive();
+    info.lastsave = lastsave_.load(std::memory_order_relaxed);
+    info.last_bgsave_ok = last_bgsave_ok_.load(std::memory_order_relaxed);
+    info.last_bgsave_time_sec = last_bgsave_time_sec_.load(std::memory_order_relaxed);
+    long long start = bgsave_start_sec_.load(std::memory_order_relaxed);
+    if (info.bgsave_in_progress && start >= 0) {
+        info.current_bgsave_time_sec = static_cast<long long>(std::time(nullptr)) - start;
     }
+    info.latest_fork_usec = latest_fork_usec_.load(std::memory_order_relaxed);
+    info.current_cow_size = current_cow_bytes_.load(std::memory_order_relaxed);
+    info.last_cow_size = total_last_cow_bytes_.load(std::memory_order_relaxed);
+    return info;
+}
+
+// --- 内存统计 ---
+
+long long DatasetStats::objectBytes() const {
+    long long total = 0;
+    for (int i = OBJECT_BYTES; i < OBJECT_KEYS; ++i) total += values[i];
     return total;
-}
\ No newline at end of file
+}
+
+void Database::updateOverhead() {
+    stats_.values[DatasetStats::OVERHEAD_BYTES] =
+        static_cast<long long>(data_.memory_usage() + expires_.memory_usage());
+}
+
+size_t Database::memory_usage() {
+    updateOverhead();
+    return static_cast<size_t>(stats_.objectBytes() + stats_.values[DatasetStats::OVERHEAD_BYTES]);
+}
+
+bool Database::keyMemoryUsage(std::string_view key, size_t& out) {
+    RedisObject* obj = lookupKeyNoTouch(key);
+    if (!obj) return false;
+    out = obj->memory_usage() + KeySpace::Entry::allocSize(key.size());
+    if (expires_.size() > 0 && expires_.get(key) != ExpireTable::NONE) {
+        out += ExpireTable::Entry::allocSize(key.size());
+    }
+    return true;
+}
+
+void Database::publishStats() {
+    updateOverhead();
+    for (int i = 0; i < DatasetStats::FIELDS; ++i) {
+        long long diff = stats_.values[i] - published_stats_.values[i];
+        if (diff != 0) total_stats_[i].fetch_add(diff, std::memory_order_relaxed);
+    }
+    published_stats_ = stats_;
+}
+
+DatasetStats Database::stats() {
+    // 本分片用最新的值：合计 + 尚未发布的变化量
+    updateOverhead();
+    DatasetStats result;
+    for (int i = 0; i < DatasetStats::FIELDS; ++i) {
+        result.values[i] = total_stats_[i].load(std::memory_order_relaxed) + stats_.values[i] -
+                           published_stats_.values[i];
+    }
+    return result;
+}
@@ -1,49 +1,320 @@
 // Database.hpp
 #pragma once
 #include <string>
+#include <string_view>
 #include <vector>
-#include <memory>               // for std::shared_ptr
-#include <unordered_map>        // for data_ storage
+#include <atomic>
+#include <ctime>
+#include <sys/types.h>
+#include "KeySpace.hpp"
+#include "ExpireTable.hpp"
+#include "Evict.hpp"
+#include "Config.hpp"          // MaxmemoryPolicy
+#include "RedisObject.hpp"
+#include "Skiplist.hpp"        // ZRangeSpec
 
-class RedisObject;
-class StringObject;         // 实际可以不用，因为只通过 RedisObject* 使用
 class HashObject;
-class Dict; 
 
-enum class ObjectType;
+// SET 的选项
+enum SetFlag : int {
+    SET_NX      = 1 << 0, // 只在 key 不存在时设置
+    SET_XX      = 1 << 1, // 只在 key 存在时设置
+    SET_KEEPTTL = 1 << 2, // 保留原有的过期时间
+};
+
+// 数据集统计（INFO / MEMORY STATS）：按对象类型和编码分别累计内存与 key 数，
+// 写入时增量维护，读取不遍历键空间。各项都是 long long，按下标整体累加（多分片合计时用）
+struct DatasetStats {
+    static constexpr int TYPES = 5;      // ObjectType 的个数
+    static constexpr int ENCODINGS = 8;  // ObjectEncoding 的个数
+    enum Field {
+        OVERHEAD_BYTES, // 键空间和过期表本身（bucket 数组 + 节点），读取前现算
+        EXPIRED_KEYS,   // 累计过期删除的 key 数
+        EVICTED_KEYS,   // 累计淘汰的 key 数
+        OBJECT_BYTES,
+        OBJECT_KEYS = OBJECT_BYTES + TYPES * ENCODINGS,
+        FIELDS = OBJECT_KEYS + TYPES * ENCODINGS
+    };
+    long long values[FIELDS] = {};
+
+    static int slot(ObjectType type, ObjectEncoding encoding) {
+        return static_cast<int>(type) * ENCODINGS + static_cast<int>(encoding);
+    }
+    long long& bytes(ObjectType type, ObjectEncoding encoding) { return values[OBJECT_BYTES + slot(type, encoding)]; }
+    long long& keys(ObjectType type, ObjectEncoding encoding) { return values[OBJECT_KEYS + slot(type, encoding)]; }
+    long long bytes(ObjectType type, ObjectEncoding encoding) const { return values[OBJECT_BYTES + slot(type, encoding)]; }
+    long long keys(ObjectType type, ObjectEncoding encoding) const { return values[OBJECT_KEYS + slot(type, encoding)]; }
+    // 所有对象的字节数（不含键空间本身）
+    long long objectBytes() const;
+};
+
+// 持久化状态（INFO persistence），整个进程（所有分片）合计
+struct PersistenceInfo {
+    bool bgsave_in_progress = false;
+    long long lastsave = 0;                  // 上次成功保存的 Unix 时间（秒）
+    bool last_bgsave_ok = true;
+    long long last_bgsave_time_sec = -1;     // 上次 BGSAVE 用时，-1 表示还没有过
+    long long current_bgsave_time_sec = -1;  // 正在进行的 BGSAVE 已用时
+    long long latest_fork_usec = 0;          // 上次 fork 调用本身的耗时（复制页表）
+    long long current_cow_size = 0;          // 正在进行的 BGSAVE 子进程目前的写时复制字节数
+    long long last_cow_size = 0;             // 上次 BGSAVE 结束时的写时复制字节数
+};
 
 class Database {
 public:
     Database();
     explicit Database(bool disable_rdb_load);
+    // 指定持久化文件（多分片模式下每个分片一个文件），load 为 true 时启动即加载
+    Database(const std::string& rdb_filename, bool load);
+
+    // 参数均为视图：value 只在写入对象时拷贝一次
 
     // --- String ---
-    void set(const std::string& key, const std::string& value);
-    bool get(const std::string& key, std::string& out_value) const;
+    // 覆盖时清除原有的过期时间
+    void set(std::string_view key, std::string_view value);
+    // 带选项：flags 为 SetFlag 的组合，expire_at 为过期时间（ExpireTable::NONE 表示不设置）；
+    // 被 NX / XX 拦下返回 false
+    bool set(std::string_view key, std::string_view value, int flags, int64_t expire_at);
+    bool get(std::string_view key, std::string& out_value);
+    // 不拷贝：out_value 指向库中的值，只在下一次读写操作前有效（用于直接编码响应）；
+    // 整数编码的值格式化到内部缓冲区
+    bool get(std::string_view key, std::string_view& out_value);
 
     // --- Hash ---
-    void hset(const std::string& key, const std::string& field, const std::string& value);
-    bool hget(const std::string& key, const std::string& field, std::string& out_value) const;
+    void hset(std::string_view key, std::string_view field, std::string_view value);
+    bool hget(std::string_view key, std::string_view field, std::string& out_value);
+    // 与 get() 一样，整数编码的 value 格式化到内部缓冲区
+    bool hget(std::string_view key, std::string_view field, std::string_view& out_value);
+
+    // --- List ---
+    // 对非列表的 key 抛出 WRONGTYPE；列表被删空时 key 一并删除
+    // 依次插入 values（LPUSH 逐个插到头部，结果顺序与参数相反），返回插入后的长度
+    size_t push(std::string_view key, const std::vector<std::string_view>& values, bool front);
+    // 弹出最多 count 个元素追加到 out，key 不存在返回 false
+    bool pop(std::string_view key, bool front, size_t count, std::vector<std::string>& out);
+    size_t llen(std::string_view key);
+    bool lindex(std::string_view key, long long index, std::string& out_value);
+    void lrange(std::string_view key, long long start, long long stop, std::vector<std::string>& out);
+    void ltrim(std::string_view key, long long start, long long stop);
+    size_t lrem(std::string_view key, long long count, std::string_view value);
+    // 返回插入后的长度；pivot 不存在返回 -1，key 不存在返回 0
+    long long linsert(std::string_view key, bool after, std::string_view pivot, std::string_view value);
+
+    // --- Set ---
+    // 对非集合的 key 抛出 WRONGTYPE；集合被删空时 key 一并删除
+    size_t sadd(std::string_view key, const std::vector<std::string_view>& members);
+    size_t srem(std::string_view key, const std::vector<std::string_view>& members);
+    bool sismember(std::string_view key, std::string_view member);
+    size_t scard(std::string_view key);
+    std::vector<std::string> smembers(std::string_view key);
+    // 不存在的 key 视为空集合
+    std::vector<std::string> sinter(const std::vector<std::string_view>& keys);
+    std::vector<std::string> sunion(const std::vector<std::string_view>& keys);
+    std::vector<std::string> sdiff(const std::vector<std::string_view>& keys);
+
+    // --- Sorted set ---
+    // 对非有序集合的 key 抛出 WRONGTYPE；被删空时 key 一并删除
+    // 返回结果中每项为 (member, score)
+    using ScoredMembers = std::vector<std::pair<std::string, double>>;
+    // 依次添加 / 更新 items，flags 为 ZAddFlag 的组合：added 为新增数，changed 为新增 + 分数变化数；
+    // INCR 时只有一项，newscore 为增加后的分数，被 NX/XX/GT/LT 拦下返回 false
+    bool zadd(std::string_view key, int flags, const std::vector<std::pair<double, std::string_view>>& items,
+              size_t& added, size_t& changed, double& newscore);
+    size_t zrem(std::string_view key, const std::vector<std::string_view>& members);
+    bool zscore(std::string_view key, std::string_view member, double& out);
+    size_t zcard(std::string_view key);
+    bool zrank(std::string_view key, std::string_view member, bool reverse, size_t& out);
+    // 按排名的闭区间 [start, stop]，负数从尾部数起
+    void zrange(std::string_view key, long long start, long long stop, bool reverse, ScoredMembers& out);
+    // 按分数区间，跳过 offset 个后最多 count 个（count < 0 不限）
+    void zrangebyscore(std::string_view key, const ZRangeSpec& range, bool reverse,
+                       size_t offset, long long count, ScoredMembers& out);
+    size_t zcount(std::string_view key, const ZRangeSpec& range);
 
     // --- Key management ---
-    size_t del(const std::vector<std::string>& keys);
-    size_t exists(const std::vector<std::string>& keys) const;
+    // lazyfree-lazy-user-del 打开时与 unlink 相同
+    size_t del(const std::vector<std::string_view>& keys);
+    // 只从键空间摘下，大对象交给后台线程释放
+    size_t unlink(const std::vector<std::string_view>& keys);
+    // 清空本分片；async 时整个键空间和过期表交给后台线程释放，本线程只换上空表
+    void flush(bool async);
+    size_t exists(const std::vector<std::string_view>& keys);
     std::vector<std::string> getAllKeys(const std::string& pattern = "*") const;
-    bool keyExists(const std::string& key) const;
-    bool checkType(const std::string& key, ObjectType expected) const;
+    bool keyExists(std::string_view key);
+    bool checkType(std::string_view key, ObjectType expected);
+
+    // --- Expire ---
+    // 过期时间为 Unix 毫秒。过期的 key 在被访问时删除（惰性过期），
+    // 另由 activeExpireCycle 随机取样删除（主动过期），不再被访问的 key 也会被清理
+    // 设置过期时间，key 不存在返回 false；时间已过则直接删除 key
+    bool expire(std::string_view key, int64_t when);
+    // 剩余毫秒数：key 不存在返回 -2，没有过期时间返回 -1
+    long long pttl(std::string_view key);
+    // 去掉过期时间，返回是否去掉了
+    bool persist(std::string_view key);
+
+    // 主动过期（同 Redis activeExpireCycle）：每轮取样一批有过期时间的 key，删除其中已过期的，
+    // 过期比例超过可接受值就继续下一轮，直到用完时间片。
+    // - 慢速周期由定时任务调用，时间片为 cron 周期的 25% 左右
+    // - 快速周期每轮事件循环结束时调用，时间片 1ms，只在过期 key 比例偏高时才运行
+    // effort 1-10（同 Redis active-expire-effort），越大每轮取样越多、时间片越长、可接受的比例越低
+    void activeExpireCycle(bool fast, int effort, int hz);
+
+    // --- Eviction ---
+    // 启动时设置一次，所有分片共用（maxmemory 为 0 表示不限制）
+    static void setMaxmemory(size_t maxmemory, MaxmemoryPolicy policy, int samples, int shards) {
+        maxmemory_ = maxmemory;
+        maxmemory_policy_ = policy;
+        maxmemory_samples_ = samples;
+        shards_ = shards;
+    }
+    // 写命令执行前调用（定时任务也会调用）：usedMemory() 超过 maxmemory 时按策略逐个淘汰 key。
+    // 多分片时上限是整个进程的，每个分片只负责超出部分中按自己 key 数占比的一份：否则先执行写命令
+    // 的分片会替其他分片把内存腾出来，自己的 key 越淘汰越少，而其他分片从不淘汰。返回 false 表示仍然超限且无法淘汰（noeviction，或没有符合策略的 key），
+    // 调用方应拒绝可能增加内存的命令；一次最多占用 EVICTION_TIME_LIMIT_US，用完时返回 true，
+    // 剩下的由之后的命令和定时任务继续
+    bool performEvictions();
 
     // --- Persistence ---
-    bool saveRdb(const std::string& filename = "dump.rdb") const;
+    // 保存到构造时指定的文件，成功时更新 LASTSAVE
+    bool saveRdb();
+    bool saveRdb(const std::string& filename) const;
+
+    // BGSAVE：fork 出子进程写快照，父进程继续处理请求，两边的内存由内核写时复制隔开。
+    // 多分片时每个分片 fork 自己的子进程、写自己的文件：子进程里只有 fork 的那个线程，
+    // 其他分片的数据可能正被修改到一半，只有本分片的是一致的。
+    // 已有子进程在运行或 fork 失败时返回 false，err 为原因
+    bool bgsaveRdb(std::string& err);
+    // 定时任务调用：读取子进程上报的写时复制量，子进程结束时回收并记录结果
+    void checkBackgroundSave();
+    // 关机前调用：结束正在运行的子进程并删除它的临时文件（随后做一次前台保存）
+    void killBackgroundSave();
+    bool hasChild() const { return child_pid_ > 0; }
+    // 任一分片有子进程在运行：此时暂停主动 rehash，迁移会写遍新旧两张表，导致大量页被复制
+    static bool childActive() { return active_children_.load(std::memory_order_relaxed) > 0; }
+    static long long lastSave() { return lastsave_.load(std::memory_order_relaxed); }
+    static PersistenceInfo persistenceInfo();
 
     // --- 后台任务支持 ---
-    std::vector<Dict*> get_rehashing_dicts();
+    // 定时任务调用：在 budget_us 微秒内推进渐进式 rehash，先键空间，
+    // 再逐个推进 hash / set / zset 的内部哈希表；返回是否还有未完成的 rehash
+    bool activeRehash(int budget_us);
 
     // --- 内存统计 ---
-    size_t memory_usage() const;
+    // 键空间（对象 + 节点 + bucket 数组 + 过期表）占用的字节数，O(1)
+    size_t memory_usage();
+    // 单个 key 占用的字节数（对象 + 节点 + 过期表节点），key 不存在返回 false；
+    // 各对象自己维护大小，聚合类型也不需要取样
+    bool keyMemoryUsage(std::string_view key, size_t& out);
+    // 整个进程（所有分片）的统计：其他分片的部分由定时任务发布，最多滞后一个 cron 周期
+    DatasetStats stats();
+    // 定时任务调用：把本分片统计的变化量计入进程合计
+    void publishStats();
+
+    // --- 后台释放 ---
+    // 启动时设置一次（含义见 ServerConfig 的 lazyfree_lazy_*）
+    static void setLazyfree(bool eviction, bool expire, bool server_del, bool user_del, bool user_flush) {
+        lazyfree_eviction_ = eviction;
+        lazyfree_expire_ = expire;
+        lazyfree_server_del_ = server_del;
+        lazyfree_user_del_ = user_del;
+        lazyfree_user_flush_ = user_flush;
+    }
+    static bool lazyfreeUserFlush() { return lazyfree_user_flush_; }
+
+    static size_t maxmemory() { return maxmemory_; }
+    static MaxmemoryPolicy maxmemoryPolicy() { return maxmemory_policy_; }
 
 private:
-    std::unordered_map<std::string, std::shared_ptr<RedisObject>> data_;
+    std::string rdb_filename_ = "dump.rdb";
+    KeySpace data_;
+    ExpireTable expires_;     // 只收录有过期时间的 key
+
+    // 主动过期的状态
+    double expired_stale_perc_ = 0;     // 取样中已过期 key 的百分比（指数平均）
+    bool expire_timelimit_exit_ = false;// 上一个周期是否因时间片用完而退出
+    int64_t last_fast_expire_us_ = 0;   // 上一个快速周期的开始时间（单调时钟，微秒）
+    size_t expire_cursor_ = 0;          // 过期表的扫描位置，各周期接着上次往下扫
+
+    static inline size_t maxmemory_ = 0;
+    static inline MaxmemoryPolicy maxmemory_policy_ = MaxmemoryPolicy::NOEVICTION;
+    static inline int maxmemory_samples_ = 5;
+    static inline int shards_ = 1;
+    static inline bool lazyfree_eviction_ = false;
+    static inline bool lazyfree_expire_ = false;
+    static inline bool lazyfree_server_del_ = false;
+    static inline bool lazyfree_user_del_ = false;
+    static inline bool lazyfree_user_flush_ = false;
+    // 各分片 key 数之和（各自定期累加变化量），用于分摊淘汰量
+    static inline std::atomic<long long> total_keys_{0};
+    size_t published_keys_ = 0;         // 本分片已计入 total_keys_ 的 key 数
+
+    // 本分片的统计，以及已计入进程合计 total_stats_ 的值
+    DatasetStats stats_;
+    DatasetStats published_stats_;
+    static inline std::atomic<long long> total_stats_[DatasetStats::FIELDS] = {};
+
+    // BGSAVE 子进程：pid 和上报写时复制量的管道（读端）
+    pid_t child_pid_ = -1;
+    int child_pipe_ = -1;
+    long long child_cow_bytes_ = 0;     // 本分片子进程已计入 current_cow_bytes_ 的值
+    long long last_cow_bytes_ = 0;      // 本分片上次 BGSAVE 已计入 total_last_cow_bytes_ 的值
+    static inline std::atomic<int> active_children_{0};
+    static inline std::atomic<long long> lastsave_{static_cast<long long>(std::time(nullptr))};
+    static inline std::atomic<bool> last_bgsave_ok_{true};
+    static inline std::atomic<bool> bgsave_round_ok_{true};  // 本轮各分片的子进程是否都成功
+    static inline std::atomic<long long> last_bgsave_time_sec_{-1};
+    static inline std::atomic<long long> bgsave_start_sec_{-1};
+    static inline std::atomic<long long> latest_fork_usec_{0};
+    static inline std::atomic<long long> current_cow_bytes_{0};
+    static inline std::atomic<long long> total_last_cow_bytes_{0};
+
+    EvictionPool eviction_pool_;
+    size_t evict_cursor_ = 0;           // volatile-ttl 取样时过期表的扫描位置
+
+    // 内部哈希表正在 rehash 的 key：写入使对象开始 rehash 时登记，activeRehash 推进完成后移除。
+    // 只记 key 不记指针，key 之后被删除或覆盖也无妨（推进时重新查找）
+    std::vector<std::string> rehashing_keys_;
+
+    // 整数编码的字符串 / hash value 在 get() / hget() 时格式化到这里
+    mutable char int_buf_[RedisObject::LONG_STR_SIZE];
+
+    void loadRdb(const std::string& filename);
+    // 读取管道中子进程上报的写时复制量（非阻塞），计入 current_cow_bytes_
+    void readChildInfo();
+    // 子进程结束后（回收或被杀）清理状态
+    void finishBackgroundSave(bool ok);
+
+    // 返回的指针在下一次写操作前有效；已过期的 key 顺带删除并视为不存在，命中时记录一次访问（LRU / LFU）
+    RedisObject* lookupKey(std::string_view key);
+    // 与 lookupKey 相同，但不记录访问（EXISTS / TTL 之类不算访问）
+    RedisObject* lookupKeyNoTouch(std::string_view key);
+    // 新 key，或覆盖已有的 key（过期时间由调用方处理）
+    void storeKey(std::string_view key, ObjectPtr obj);
+    // 查找指定类型的对象：不存在返回 nullptr，类型不符抛出 WRONGTYPE
+    RedisObject* lookupKeyOfType(std::string_view key, ObjectType type);
+    // 删除 key 及其过期时间；lazy 时值对象交给后台线程释放（工作量小的仍就地释放）
+    bool deleteKey(std::string_view key, bool lazy = false);
+    size_t deleteKeys(const std::vector<std::string_view>& keys, bool lazy);
+    // 已过期的 key 删除并计数
+    void deleteExpiredKey(std::string_view key);
+    // 把对象计入 / 移出统计（sign 为 1 或 -1）；原地修改对象前后各调用一次，编码变化也能正确归类
+    void countObject(const RedisObject* obj, long long sign);
+    // 重新统计所有 key（加载 RDB 后）
+    void recountAll();
+    // 现算 OVERHEAD_BYTES
+    void updateOverhead();
+    // 把 key 数的变化计入 total_keys_；force 为 false 时变化不多就跳过，减少跨分片写同一缓存行
+    void publishKeyCount(bool force);
+    // 按策略取样补充候选池，取出最该淘汰且仍然存在的 key；没有可淘汰的 key 返回 false
+    bool nextEvictionCandidate(std::string& key);
+    // key 有过期时间且已过期时删除它，返回是否删除
+    bool expireIfNeeded(std::string_view key);
+    bool isExpired(std::string_view key) const;
 
-    std::shared_ptr<RedisObject> lookupKey(const std::string& key) const;
-    void storeKey(const std::string& key, std::shared_ptr<RedisObject> obj);
+    // 写操作后调用（在可能删除空 key 之前）：was_rehashing 为写入前的状态，
+    // 对象因这次写入开始 rehash 时登记，已在 rehash 的不重复登记
+    void trackRehashing(std::string_view key, const RedisObject* obj, bool was_rehashing);
+    // 加载 RDB 后登记所有仍在 rehash 的对象
+    void trackAllRehashing();
 };
\ No newline at end of file
@@ -1,63 +1,12 @@
 // Dict.hpp
+// HashObject 等使用的哈希表，编译期选择实现（CMake 选项 MINI_REDIS_DICT_BACKEND）：
+// - chained（默认）：链地址法，见 ChainedDict.hpp
+// - swiss：开放寻址 + SSE2 控制字节组探测，见 SwissDict.hpp
 #pragma once
-#include <vector>
-#include <memory>
-#include <string>
-#include <functional>
-#include <chrono>
-
-struct HashEntry {
-    std::string key;
-    std::string value;
-    std::unique_ptr<HashEntry> next; // 链地址法
-
-    HashEntry(std::string k, std::string v)
-        : key(std::move(k)), value(std::move(v)) {}
-};
-
-class Dict {
-public:
-    Dict();
-    ~Dict() = default;
-
-    // 禁用拷贝
-    Dict(const Dict&) = delete;
-    Dict& operator=(const Dict&) = delete;
-
-    // 启用移动
-    Dict(Dict&&) noexcept = default;
-    Dict& operator=(Dict&&) noexcept = default;
-
-    void set_field(std::string key, std::string value);
-    bool get_field(const std::string& key, std::string& out_value) const;
-    bool del_field(const std::string& key);
-    size_t size() const { return used_; }
-
-    // rehash 相关
-    bool is_rehashing() const { return rehashidx_ != -1; }
-    void enable_rehash(); // 开始 rehash（分配新表）
-    int rehash_step(int n); // 迁移 n 个 bucket
-
-    // 尝试在指定毫秒内推进 rehash
-    void try_rehash_for_ms(int ms);
-
-    size_t memory_usage() const;
-
-    std::vector<std::pair<std::string, std::string>> get_all() const;
-
-private:
-    static inline constexpr size_t INIT_HT_SIZE = 4;
-    static inline constexpr size_t HASHTABLE_MIN_FILL = 10; // 缩容阈值（used / size < 10%）
-
-    using Clock = std::chrono::steady_clock;
-    using TimePoint = std::chrono::time_point<Clock>;
-
-    std::vector<std::unique_ptr<HashEntry>> ht_[2]; // ht[0] 主表，ht[1] 新表（rehash 时用）
-    long long used_ = 0;       // 总元素数
-    long long rehashidx_ = -1; // -1 表示未 rehash，否则表示下一个要迁移的 bucket index
-
-    size_t hash_key(const std::string& key) const;
-    void expand_if_needed();
-    void shrink_if_needed();
-    void do_rehash(int n); // 实际迁移逻辑
-};
\ No newline at end of file
+#if defined(MINI_REDIS_DICT_SWISS)
+#include "SwissDict.hpp"
+using Dict = SwissDict;
+#else
+#include "ChainedDict.hpp"
+using Dict = ChainedDict;
+#endif
@@ -0,0 +1,191 @@
+// EpollEventLoop.cpp
+#include "EpollEventLoop.hpp"
+#include "Server.hpp"
+#include "Connection.hpp"
+#include "utils.hpp"
+#include <sys/epoll.h>
+#include <netinet/in.h>
+#include <unistd.h>
+#include <iostream>
+#include <cstdint>
+#include <cstring>
+
+constexpr int MAX_EVENTS = 128;
+
+EpollEventLoop::EpollEventLoop(Server& server)
+    : EventLoop(server), epoll_fd_(-1), io_threads_(server.config().io_threads) {
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ == -1) handle_error("epoll_create1");
+    if (server.config().io_threads > 1) {
+        std::cout << "[INFO] Threaded I/O enabled, io-threads=" << server.config().io_threads << std::endl;
+    }
+}
+
+EpollEventLoop::~EpollEventLoop() {
+    if (epoll_fd_ != -1) close(epoll_fd_);
+}
+
+void EpollEventLoop::acceptClient() {
+    struct sockaddr_in client_addr;
+    socklen_t client_len = sizeof(client_addr);
+    int client_fd = accept(server_.listenFd(), (struct sockaddr*)&client_addr, &client_len);
+    if (client_fd == -1) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK)
+            std::cerr << "[WARN] accept failed: " << std::strerror(errno) << std::endl;
+        return;
+    }
+
+    set_nonblocking(client_fd);
+    set_nodelay(client_fd);
+    server_.addConnection(client_fd);
+
+    struct epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = client_fd;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, client_fd, &ev) == -1) {
+        std::cerr << "[WARN] epoll_ctl add client failed" << std::endl;
+        server_.closeConnection(client_fd);
+    }
+}
+
+void EpollEventLoop::run() {
+    int listen_fd = server_.listenFd();
+    int wake_fd = server_.wakeFd();
+    int timer_fd = server_.timerFd();
+
+    struct epoll_event ev{}, events[MAX_EVENTS];
+    ev.events = EPOLLIN;
+    ev.data.fd = listen_fd;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listen_fd, &ev) == -1)
+        handle_error("epoll_ctl listen_fd");
+
+    ev.events = EPOLLIN;
+    ev.data.fd = wake_fd;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd, &ev) == -1)
+        handle_error("epoll_ctl wake_fd");
+
+    ev.events = EPOLLIN;
+    ev.data.fd = timer_fd;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, timer_fd, &ev) == -1)
+        handle_error("epoll_ctl timer_fd");
+
+    while (!server_.stopRequested()) {
+        int nfds = epoll_wait(epoll_fd_, events, MAX_EVENTS, -1);
+        if (nfds == -1) {
+            if (errno == EINTR) continue; // 被信号中断，继续
+            handle_error("epoll_wait");
+        }
+
+        readable_.clear();
+        writable_.clear();
+        touched_.clear();
+        bool woken = false;
+        bool cron_due = false;
+
+        for (int i = 0; i < nfds; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == listen_fd) {
+                acceptClient();
+                continue;
+            }
+            if (fd == wake_fd) {
+                uint64_t count;
+                ssize_t n = read(wake_fd, &count, sizeof(count));
+                (void)n;
+                woken = true;
+                continue;
+            }
+            if (fd == timer_fd) {
+                uint64_t expirations;
+                ssize_t n = read(timer_fd, &expirations, sizeof(expirations));
+                (void)n;
+                cron_due = true; // 错过的周期不补跑
+                continue;
+            }
+
+            Connection* conn = server_.findConnection(fd);
+            if (!conn) continue;
+            uint32_t ev_mask = events[i].events;
+            touched_.push_back(fd);
+
+            if (ev_mask & EPOLLIN) {
+                readable_.push_back(conn);
+            } else if (ev_mask & (EPOLLERR | EPOLLHUP)) {
+                conn->markClosed();
+            } else if ((ev_mask & EPOLLOUT) && !conn->blocked()) {
+                writable_.push_back(conn);
+            }
+        }
+
+        // 1. 读取 + 解析（开启 I/O 线程时并行）
+        io_threads_.run(IoThreadPool::Op::READ, readable_);
+
+        // 2. 主线程串行执行命令，响应统一排队
+        for (Connection* conn : readable_) {
+            if (conn->shouldClose()) continue;
+            server_.processInputBuffer(conn);
+            // 等待其他分片回复的连接先不写：本批恢复执行后由 handleInbox 一次写出
+            if (!conn->shouldClose() && !conn->blocked() && conn->pendingOutput() > 0) {
+                writable_.push_back(conn);
+            }
+        }
+
+        // 3. 一次性发送本轮累积的所有响应（开启 I/O 线程时并行）
+        io_threads_.run(IoThreadPool::Op::WRITE, writable_);
+
+        // 4. 关闭失效连接；写不完的部分交给 EPOLLOUT，写完则注销
+        for (int fd : touched_) {
+            finalizeConnection(fd);
+        }
+
+        // 5. 其他分片投递的请求/回复
+        if (woken) {
+            server_.handleWakeup();
+        }
+
+        // 6. 周期任务（定时器到期时执行）
+        if (cron_due) {
+            server_.cron();
+        }
+
+        // 7. 进入 epoll_wait 之前
+        server_.beforeSleep();
+    }
+}
+
+void EpollEventLoop::flush(Connection* conn) {
+    if (!conn->shouldClose() && !conn->blocked()) {
+        conn->writeToSocket();
+    }
+    finalizeConnection(conn->get_fd());
+}
+
+void EpollEventLoop::finalizeConnection(int fd) {
+    Connection* conn = server_.findConnection(fd);
+    if (!conn) return;
+    if (conn->shouldClose()) {
+        std::cout << "[INFO] Client disconnected, fd=" << fd << std::endl;
+        closeConnection(fd);
+    } else {
+        updateWriteInterest(conn);
+    }
+}
+
+void EpollEventLoop::updateWriteInterest(Connection* conn) {
+    bool want_write = conn->pendingOutput() > 0 && !conn->blocked();
+    if (want_write == conn->writeArmed()) return;
+
+    struct epoll_event ev{};
+    ev.events = want_write ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+    ev.data.fd = conn->get_fd();
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, conn->get_fd(), &ev) == -1) {
+        std::cerr << "[WARN] epoll_ctl mod client failed: " << std::strerror(errno) << std::endl;
+        return;
+    }
+    conn->setWriteArmed(want_write);
+}
+
+void EpollEventLoop::closeConnection(int fd) {
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    server_.closeConnection(fd);
+}
@@ -0,0 +1,36 @@
+// EpollEventLoop.hpp
+#pragma once
+#include <vector>
+#include "EventLoop.hpp"
+#include "IoThreads.hpp"
+
+// epoll 后端（水平触发）
+// 每轮：收集就绪连接 -> 读取 + 解析（可并行）-> 主线程执行命令 -> 批量写出（可并行）
+// -> 关闭失效连接 / 按剩余输出注册 EPOLLOUT
+class EpollEventLoop : public EventLoop {
+public:
+    explicit EpollEventLoop(Server& server);
+    ~EpollEventLoop() override;
+
+    const char* name() const override { return "epoll"; }
+    void run() override;
+    void flush(Connection* conn) override;
+
+private:
+    void acceptClient();
+
+    // 事件处理收尾：关闭失效连接，或根据待发送数据更新 EPOLLOUT
+    void finalizeConnection(int fd);
+
+    // 根据是否还有待发送数据注册/注销 EPOLLOUT
+    void updateWriteInterest(Connection* conn);
+
+    void closeConnection(int fd);
+
+    int epoll_fd_;
+    IoThreadPool io_threads_; // 读/解析/写的并行化；命令执行始终在主线程
+
+    std::vector<Connection*> readable_;  // 本轮有 EPOLLIN 的连接
+    std::vector<Connection*> writable_;  // 本轮需要写出的连接
+    std::vector<int> touched_;           // 本轮涉及的全部 fd，统一收尾
+};
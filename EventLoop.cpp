@@ -0,0 +1,14 @@
+// EventLoop.cpp
+#include "EventLoop.hpp"
+#include "EpollEventLoop.hpp"
+#include "UringEventLoop.hpp"
+#include <iostream>
+
+std::unique_ptr<EventLoop> createEventLoop(EventLoopBackend backend, Server& server) {
+    if (backend == EventLoopBackend::IO_URING) {
+        std::unique_ptr<EventLoop> loop = UringEventLoop::create(server);
+        if (loop) return loop;
+        std::cerr << "[WARN] io_uring is not available, falling back to epoll" << std::endl;
+    }
+    return std::make_unique<EpollEventLoop>(server);
+}
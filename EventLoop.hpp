@@ -0,0 +1,37 @@
+// EventLoop.hpp
+#pragma once
+#include <memory>
+#include "Config.hpp"
+
+class Server;
+class Connection;
+
+// 事件循环后端
+// - 后端负责网络 I/O：接受连接、把收到的数据放进连接的读缓冲区、把输出缓冲区发出去、
+//   关闭失效连接，以及监听 Server 的 wake_fd（跨分片消息 / 请求停止）
+// - 命令的解析结果交给 Server::processInputBuffer 执行，连接生命周期由 Server 管理
+// - epoll：就绪通知，读写由用户态 readv/writev 完成，可配合 I/O 线程
+// - io_uring：完成通知，accept/recv/send 都由内核异步完成，每轮一次 io_uring_enter
+class EventLoop {
+public:
+    explicit EventLoop(Server& server) : server_(server) {}
+    virtual ~EventLoop() = default;
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    virtual const char* name() const = 0;
+
+    // 运行到 Server::stopRequested()
+    virtual void run() = 0;
+
+    // 连接在事件处理之外产生了输出（例如跨分片回复到达）：写出或安排写出；
+    // 连接已标记关闭时将其关闭，调用后 conn 可能失效
+    virtual void flush(Connection* conn) = 0;
+
+protected:
+    Server& server_;
+};
+
+// 按配置创建后端；io_uring 不可用（内核太旧、被 seccomp 禁止等）时打印警告并回退到 epoll
+std::unique_ptr<EventLoop> createEventLoop(EventLoopBackend backend, Server& server);
@@ -0,0 +1,39 @@
+// Evict.cpp
+#include "Evict.hpp"
+#include <utility>
+
+void EvictionPool::insert(std::string_view key, unsigned long long idle) {
+    // 第一个 idle 不小于它的位置
+    size_t k = 0;
+    while (k < count_ && entries_[k].idle < idle) k++;
+    for (size_t i = k; i < count_ && entries_[i].idle == idle; ++i) {
+        if (entries_[i].key == key) return;
+    }
+
+    if (count_ < SIZE) {
+        // 右移腾出 k；std::string 移动后保留原来的缓冲区，下次赋值可复用
+        for (size_t i = count_; i > k; --i) std::swap(entries_[i], entries_[i - 1]);
+        count_++;
+    } else {
+        // 池满：比最小的还小就放弃，否则丢掉最小的（左移），放到 k - 1
+        if (k == 0) return;
+        k--;
+        for (size_t i = 0; i < k; ++i) std::swap(entries_[i], entries_[i + 1]);
+    }
+    entries_[k].idle = idle;
+    entries_[k].key.assign(key.data(), key.size());
+}
+
+bool EvictionPool::popBest(std::string& key) {
+    if (count_ == 0) return false;
+    key.swap(entries_[--count_].key);
+    return true;
+}
+
+unsigned long long evictionIdle(const RedisObject* obj) {
+    if (RedisObject::lfuMode()) return 255 - obj->lfuCounter();
+    uint32_t now = lruClock();
+    uint32_t lru = obj->lru();
+    // 24 位时钟回绕
+    return now >= lru ? now - lru : RedisObject::LRU_CLOCK_MAX - lru + now;
+}
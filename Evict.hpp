@@ -0,0 +1,32 @@
+// Evict.hpp
+#pragma once
+#include <string>
+#include <string_view>
+#include <cstddef>
+#include "RedisObject.hpp"
+
+// 淘汰候选池（同 Redis evict.c 的 EvictionPoolLRU）
+// 每次淘汰前从键空间随机取样几个 key，按"可淘汰程度"（idle，越大越该淘汰）放进池中；
+// 池按 idle 升序保存最多 SIZE 个候选，跨多次淘汰保留，取样越多近似越接近真正的 LRU / LFU，
+// 不需要维护全局的访问链表
+// 池中只存 key 的副本，取出时由调用方重新查找（key 可能已被删除或覆盖）
+class EvictionPool {
+public:
+    static constexpr size_t SIZE = 16;
+
+    // 池未满，或 idle 大于池中最小的一个时加入（池满时挤掉最小的）；已在池中的 key 不重复加入
+    void insert(std::string_view key, unsigned long long idle);
+    // 取出 idle 最大的候选，池为空返回 false
+    bool popBest(std::string& key);
+
+private:
+    struct Candidate {
+        unsigned long long idle = 0;
+        std::string key;
+    };
+    Candidate entries_[SIZE];
+    size_t count_ = 0;
+};
+
+// LRU 模式：距上次访问的秒数；LFU 模式：255 - 衰减后的访问计数（都是越大越该淘汰）
+unsigned long long evictionIdle(const RedisObject* obj);
@@ -0,0 +1,101 @@
+// ExpireTable.cpp
+#include "ExpireTable.hpp"
+#include "Hash.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <ctime>
+#include <new>
+#include <utility>
+
+int64_t unixTimeMs() {
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
+size_t ExpireTable::Entry::allocSize(size_t key_len) {
+    return std::max(sizeof(Entry), offsetof(Entry, key_data) + key_len);
+}
+
+ExpireTable::Entry* ExpireTable::createEntry(std::string_view key, int64_t when, uint64_t hash) {
+    auto* entry = new (::operator new(Entry::allocSize(key.size()))) Entry{nullptr, hash, when, static_cast<uint32_t>(key.size()), {}};
+    std::memcpy(entry->key_data, key.data(), key.size());
+    return entry;
+}
+
+ExpireTable::ExpireTable() = default;
+
+ExpireTable::~ExpireTable() {
+    table_.destroy_all(destroyEntry);
+}
+
+ExpireTable::ExpireTable(ExpireTable&& other) noexcept
+    : table_(std::move(other.table_)), entry_bytes_(std::exchange(other.entry_bytes_, 0)) {}
+
+ExpireTable& ExpireTable::operator=(ExpireTable&& other) noexcept {
+    if (this != &other) {
+        table_.destroy_all(destroyEntry);
+        table_ = std::move(other.table_);
+        entry_bytes_ = std::exchange(other.entry_bytes_, 0);
+    }
+    return *this;
+}
+
+void ExpireTable::clear() {
+    table_.clear(destroyEntry);
+    entry_bytes_ = 0;
+}
+
+int64_t ExpireTable::get(std::string_view key) const {
+    Entry* entry = table_.find(hashString(key), [&](const Entry* p) { return p->key() == key; });
+    return entry ? entry->when : NONE;
+}
+
+void ExpireTable::set(std::string_view key, int64_t when) {
+    uint64_t hash = hashString(key);
+    if (Entry* entry = table_.find(hash, [&](const Entry* p) { return p->key() == key; })) {
+        entry->when = when;
+        return;
+    }
+    table_.insert(createEntry(key, when, hash));
+    entry_bytes_ += Entry::allocSize(key.size());
+}
+
+bool ExpireTable::erase(std::string_view key) {
+    if (table_.is_rehashing()) table_.rehash_step(1);
+
+    Entry* entry = table_.remove(hashString(key), [&](const Entry* p) { return p->key() == key; });
+    if (!entry) return false;
+    entry_bytes_ -= Entry::allocSize(entry->key_len);
+    destroyEntry(entry);
+    return true;
+}
+
+size_t ExpireTable::sample(Entry** out, size_t n, size_t& cursor) const {
+    n = std::min(n, size());
+    if (n == 0) return 0;
+    // 先按取样数推进 rehash，减少要同时扫两张表的情况
+    if (is_rehashing()) rehash_step(static_cast<int>(n));
+
+    // 两张表用同一个下标（大表的掩码）顺序扫；rehash 期间 ht[0] 中 rehashidx 之前的
+    // bucket 已迁走。一次最多扫一圈，所以同一次调用不会重复
+    bool rehashing = is_rehashing();
+    size_t table_size = std::max(table_.table_size(0), rehashing ? table_.table_size(1) : 0);
+    size_t mask = table_size - 1;
+    size_t steps = std::min(n * 20, table_size);
+    size_t idx = cursor & mask;
+    size_t stored = 0;
+    for (; steps > 0 && stored < n; --steps, idx = (idx + 1) & mask) {
+        for (int table = 0; table < (rehashing ? 2 : 1); ++table) {
+            if (idx >= table_.table_size(table)) continue;
+            if (table == 0 && rehashing && static_cast<long long>(idx) < table_.rehash_index()) continue;
+            // 取满时这个 bucket 剩下的节点留到下一圈
+            for (Entry* p = table_.bucket(table, idx); p && stored < n; p = p->next) {
+                out[stored++] = p;
+            }
+        }
+    }
+    cursor = idx;
+    return stored;
+}
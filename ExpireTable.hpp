@@ -0,0 +1,72 @@
+// ExpireTable.hpp
+#pragma once
+#include <vector>
+#include <string_view>
+#include <cstddef>
+#include <cstdint>
+#include "IncrementalTable.hpp"
+
+// 当前 Unix 时间（毫秒），过期时间都以它为准（与 RDB 中保存的一致，重启后仍有效）
+int64_t unixTimeMs();
+
+// 过期表：key -> 过期时间（Unix 毫秒），只收录设置了过期时间的 key（对应 Redis 的 db->expires）
+// - 与 KeySpace 同一套结构：IncrementalTable（两张表渐进式 rehash），节点缓存哈希，key 的字节跟在节点后面
+// - sample() 从游标处顺序取节点，供主动过期取样（同 Redis 6+ 的 expires_cursor：
+//   已删空的 bucket 连成片时，随机取样会反复落空，顺序扫描不会）
+class ExpireTable {
+public:
+    struct Entry {
+        Entry* next;
+        uint64_t hash;
+        int64_t when;       // 过期时间（Unix 毫秒）
+        uint32_t key_len;
+        char key_data[1];   // 实际长度为 key_len，延伸到节点之后
+
+        std::string_view key() const { return {key_data, key_len}; }
+        // 节点（含 key）占用的字节数
+        static size_t allocSize(size_t key_len);
+    };
+
+    static constexpr int64_t NONE = -1; // get() 的返回值：没有过期时间
+
+    ExpireTable();
+    ~ExpireTable();
+
+    ExpireTable(const ExpireTable&) = delete;
+    ExpireTable& operator=(const ExpireTable&) = delete;
+    ExpireTable(ExpireTable&& other) noexcept;
+    ExpireTable& operator=(ExpireTable&& other) noexcept;
+
+    // 过期时间，没有返回 NONE；rehash 期间顺带迁移一个 bucket
+    int64_t get(std::string_view key) const;
+    // 设置或覆盖
+    void set(std::string_view key, int64_t when);
+    bool erase(std::string_view key);
+    void clear();
+
+    size_t size() const { return table_.size(); }
+    size_t bucket_count() const { return table_.bucket_count(); }
+    // bucket 数组 + 所有节点，O(1)
+    size_t memory_usage() const { return bucket_count() * sizeof(Entry*) + entry_bytes_; }
+
+    bool is_rehashing() const { return table_.is_rehashing(); }
+    // 迁移最多 n 个 bucket，返回是否仍在 rehash
+    bool rehash_step(int n) const { return table_.rehash_step(n); }
+
+    // 从 cursor 所在的 bucket 起顺序取最多 n 个节点写入 out（最多扫 n * 20 个 bucket），
+    // 返回实际个数并把 cursor 推进到下一个要扫的 bucket；一次调用内不重复，节点在删除前有效
+    size_t sample(Entry** out, size_t n, size_t& cursor) const;
+
+    // 遍历（遍历期间不能修改）：fn(std::string_view key, int64_t when)
+    template <typename F>
+    void for_each(F&& fn) const {
+        table_.for_each([&](const Entry* p) { fn(p->key(), p->when); });
+    }
+
+private:
+    IncrementalTable<Entry, &Entry::next, &Entry::hash> table_;
+    size_t entry_bytes_ = 0;
+
+    static Entry* createEntry(std::string_view key, int64_t when, uint64_t hash);
+    static void destroyEntry(Entry* entry) { ::operator delete(entry); }
+};
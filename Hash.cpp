@@ -0,0 +1,12 @@
+// Hash.cpp
+#include "Hash.hpp"
+#include <chrono>
+#include <random>
+
+uint64_t generateHashSeed() {
+    std::random_device rd;
+    uint64_t seed = (static_cast<uint64_t>(rd()) << 32) ^ rd();
+    // random_device 在个别平台上可能是确定性的，再混入启动时间
+    seed ^= static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+    return seed;
+}
@@ -0,0 +1,103 @@
+// Hash.hpp
+// 内存中哈希表使用的快速带种子哈希（wyhash final4 算法）
+// - 短 key（<=16 字节）只需一次 128 位乘法，明显快于 std::hash
+// - 种子在进程启动时随机生成，外部无法构造大量碰撞的 key
+// - 结果只在进程内使用，不写入 RDB；分片路由 (ShardRouter) 仍用 std::hash 以保证跨重启稳定
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+#include <string_view>
+
+namespace hash_detail {
+
+__extension__ typedef unsigned __int128 uint128_t;
+
+inline constexpr uint64_t SECRET[4] = {
+    0x2d358dccaa6c78a5ULL, 0x8bb84b93962eacc9ULL,
+    0x4b33a62ed433d4a3ULL, 0x4d5a2da51de1aa47ULL
+};
+
+inline void mum(uint64_t* a, uint64_t* b) {
+    uint128_t r = *a;
+    r *= *b;
+    *a = static_cast<uint64_t>(r);
+    *b = static_cast<uint64_t>(r >> 64);
+}
+
+inline uint64_t mix(uint64_t a, uint64_t b) {
+    mum(&a, &b);
+    return a ^ b;
+}
+
+inline uint64_t read8(const uint8_t* p) {
+    uint64_t v;
+    std::memcpy(&v, p, 8);
+    return v;
+}
+
+inline uint64_t read4(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, 4);
+    return v;
+}
+
+inline uint64_t read3(const uint8_t* p, size_t k) {
+    return (static_cast<uint64_t>(p[0]) << 16) | (static_cast<uint64_t>(p[k >> 1]) << 8) | p[k - 1];
+}
+
+} // namespace hash_detail
+
+// 进程级随机种子（首次调用时生成）
+uint64_t generateHashSeed();
+
+inline uint64_t hashSeed() {
+    static const uint64_t seed = generateHashSeed();
+    return seed;
+}
+
+inline uint64_t hashBytes(const void* key, size_t len, uint64_t seed) {
+    using namespace hash_detail;
+    const uint8_t* p = static_cast<const uint8_t*>(key);
+    seed ^= mix(seed ^ SECRET[0], SECRET[1]);
+    uint64_t a, b;
+    if (len <= 16) {
+        if (len >= 4) {
+            a = (read4(p) << 32) | read4(p + ((len >> 3) << 2));
+            b = (read4(p + len - 4) << 32) | read4(p + len - 4 - ((len >> 3) << 2));
+        } else if (len > 0) {
+            a = read3(p, len);
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t i = len;
+        if (i >= 48) {
+            uint64_t see1 = seed, see2 = seed;
+            do {
+                seed = mix(read8(p) ^ SECRET[1], read8(p + 8) ^ seed);
+                see1 = mix(read8(p + 16) ^ SECRET[2], read8(p + 24) ^ see1);
+                see2 = mix(read8(p + 32) ^ SECRET[3], read8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i >= 48);
+            seed ^= see1 ^ see2;
+        }
+        while (i > 16) {
+            seed = mix(read8(p) ^ SECRET[1], read8(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        a = read8(p + i - 16);
+        b = read8(p + i - 8);
+    }
+    a ^= SECRET[1];
+    b ^= seed;
+    mum(&a, &b);
+    return mix(a ^ SECRET[0] ^ len, b ^ SECRET[1]);
+}
+
+inline uint64_t hashString(std::string_view s) {
+    return hashBytes(s.data(), s.size(), hashSeed());
+}
@@ -2,105 +2,86 @@
 
 // HashObject 的实现
 HashObject::HashObject()
-    : RedisObject(ObjectType::HASH)
-    , encoding_(ObjectEncoding::ZIPLIST)
-    , storage_(std::vector<std::pair<std::string, std::string>>{}) 
+    : encoding_(ObjectEncoding::LISTPACK)
+    , storage_(Listpack{})
 {}
 
-// 判断是否应保持 ziplist
-bool HashObject::should_use_ziplist() const {
-    if (encoding_ != ObjectEncoding::ZIPLIST) return false;
-    const auto& zl = get_ziplist();
-    if (zl.size() >= ZIPLIST_MAX_ENTRIES) return false;
-    // 检查是否有 field 或 value 太大
-    for (const auto& kv : zl) {
-        if (kv.first.size() > ZIPLIST_MAX_ENTRY_SIZE ||
-            kv.second.size() > ZIPLIST_MAX_ENTRY_SIZE) {
-            return false;
-        }
-    }
-    return true;
-}
-
 // 升级到 hashtable
 void HashObject::promote_to_hashtable() {
-    if (encoding_ != ObjectEncoding::ZIPLIST) return;
+    if (encoding_ != ObjectEncoding::LISTPACK) return;
 
     Dict new_dict;
-    for (const auto& kv : get_ziplist()) {
-        new_dict.set_field(kv.first, kv.second);
+    const Listpack& lp = get_listpack();
+    char fbuf[Listpack::INT_BUF_SIZE], vbuf[Listpack::INT_BUF_SIZE];
+    for (size_t pos = lp.first(); pos != Listpack::NPOS; pos = lp.next(lp.next(pos))) {
+        new_dict.set_field(lp.get(pos, fbuf), lp.get(lp.next(pos), vbuf));
     }
 
     storage_ = std::move(new_dict);
     encoding_ = ObjectEncoding::HASHTABLE;
 }
 
-//实现 ziplist 查找辅助函数
-Ziplist::iterator HashObject::find_in_ziplist(const std::string& field) {
-    auto& zl = get_ziplist();
-    return std::find_if(zl.begin(), zl.end(),
-        [&](const auto& kv) { return kv.first == field; });
-}
-
-Ziplist::const_iterator HashObject::find_in_ziplist(const std::string& field) const {
-    const auto& zl = get_ziplist();
-    return std::find_if(zl.begin(), zl.end(),
-        [&](const auto& kv) { return kv.first == field; });
-}
-
-void HashObject::set_field(std::string field, std::string value) {
+void HashObject::set_field(std::string_view field, std::string_view value) {
     // 检查新 field/value 是否太大
-    if (encoding_ == ObjectEncoding::ZIPLIST) {
-        if (field.size() > ZIPLIST_MAX_ENTRY_SIZE ||
-            value.size() > ZIPLIST_MAX_ENTRY_SIZE) {
+    if (encoding_ == ObjectEncoding::LISTPACK) {
+        if (field.size() > LISTPACK_MAX_ENTRY_SIZE ||
+            value.size() > LISTPACK_MAX_ENTRY_SIZE) {
             promote_to_hashtable();
         }
     }
 
-    if (encoding_ == ObjectEncoding::ZIPLIST) {
-        auto it = find_in_ziplist(field);
-        if (it != get_ziplist().end()) {
+    if (encoding_ == ObjectEncoding::LISTPACK) {
+        Listpack& lp = get_listpack();
+        size_t pos = lp.find(field, 1);
+        if (pos != Listpack::NPOS) {
             // 更新 existing
-            it->second = std::move(value);
+            lp.replace(lp.next(pos), value);
         } else {
-            // 新增
-            get_ziplist().emplace_back(std::move(field), std::move(value));
-            // 插入后检查是否超标
-            if (!should_use_ziplist()) {
+            // 新增；已有元素都在阈值内，只需检查数量
+            std::string_view pair[2] = {field, value};
+            lp.insert(Listpack::NPOS, pair, 2);
+            if (lp.size() / 2 > LISTPACK_MAX_ENTRIES) {
                 promote_to_hashtable();
             }
         }
     } else {
-        get_hashtable().set_field(std::move(field), std::move(value)); 
+        get_hashtable().set_field(field, value);
     }
 }
 
-bool HashObject::get_field(const std::string& field, std::string& out_value) const {
-    if (encoding_ == ObjectEncoding::ZIPLIST) {
-        auto it = find_in_ziplist(field);
-        if (it != get_ziplist().end()) {
-            out_value = it->second;
-            return true;
-        }
-    } else {
-        return get_hashtable().get_field(field, out_value);
+bool HashObject::find_field(std::string_view field, std::string_view& out, char* buf) const {
+    if (encoding_ == ObjectEncoding::LISTPACK) {
+        const Listpack& lp = get_listpack();
+        size_t pos = lp.find(field, 1);
+        if (pos == Listpack::NPOS) return false;
+        out = lp.get(lp.next(pos), buf);
+        return true;
     }
-    return false;
+    return get_hashtable().find_value(field, out);
+}
+
+bool HashObject::get_field(std::string_view field, std::string& out_value) const {
+    char buf[Listpack::INT_BUF_SIZE];
+    std::string_view value;
+    if (!find_field(field, value, buf)) return false;
+    out_value.assign(value);
+    return true;
 }
 
 size_t HashObject::size() const {
-    if (encoding_ == ObjectEncoding::ZIPLIST) {
-        return get_ziplist().size();
+    if (encoding_ == ObjectEncoding::LISTPACK) {
+        return get_listpack().size() / 2;
     } else {
         return get_hashtable().size();
     }
 }
 
-bool HashObject::del_field(const std::string& field) {
-    if (encoding_ == ObjectEncoding::ZIPLIST) {
-        auto it = find_in_ziplist(field);
-        if (it != get_ziplist().end()) {
-            get_ziplist().erase(it);
+bool HashObject::del_field(std::string_view field) {
+    if (encoding_ == ObjectEncoding::LISTPACK) {
+        Listpack& lp = get_listpack();
+        size_t pos = lp.find(field, 1);
+        if (pos != Listpack::NPOS) {
+            lp.erase(pos, 2);
             return true;
         }
     } else {
@@ -109,38 +90,44 @@ bool HashObject::del_field(const std::string& field) {
     return false;
 }
 
-bool HashObject::exists(const std::string& field) const {
-    if (encoding_ == ObjectEncoding::ZIPLIST) {
-        return find_in_ziplist(field) != get_ziplist().end();
+bool HashObject::exists(std::string_view field) const {
+    if (encoding_ == ObjectEncoding::LISTPACK) {
+        return get_listpack().find(field, 1) != Listpack::NPOS;
     } else {
-        std::string out_value;
-        return get_hashtable().get_field(field, out_value);
+        std::string_view value;
+        return get_hashtable().find_value(field, value);
     }
 }
 
-void HashObject::try_rehash_for_ms(int ms) {
-    if (encoding_ == ObjectEncoding::HASHTABLE) {
-        get_hashtable().try_rehash_for_ms(ms);
-    }
+bool HashObject::is_rehashing() const {
+    return encoding_ == ObjectEncoding::HASHTABLE && get_hashtable().is_rehashing();
+}
+
+bool HashObject::rehash_step(int n) {
+    if (!is_rehashing()) return false;
+    get_hashtable().rehash_step(n);
+    return get_hashtable().is_rehashing();
 }
 
 size_t HashObject::memory_usage() const {
-    if (encoding_ == ObjectEncoding::ZIPLIST) {
-        size_t total = sizeof(*this);
-        const auto& zl = get_ziplist();
-        for (const auto& kv : zl) {
-            total += kv.first.capacity() + kv.second.capacity();
-        }
-        return total;
+    if (encoding_ == ObjectEncoding::LISTPACK) {
+        return sizeof(*this) + get_listpack().bytes();
     } else {
         return sizeof(*this) + get_hashtable().memory_usage();
     }
 }
 
 std::vector<std::pair<std::string, std::string>> HashObject::get_all_fields() const {
-    if (encoding_ == ObjectEncoding::ZIPLIST) {
-        return get_ziplist(); // ziplist 本身就是 vector<pair>
+    if (encoding_ == ObjectEncoding::LISTPACK) {
+        std::vector<std::pair<std::string, std::string>> result;
+        const Listpack& lp = get_listpack();
+        result.reserve(lp.size() / 2);
+        char fbuf[Listpack::INT_BUF_SIZE], vbuf[Listpack::INT_BUF_SIZE];
+        for (size_t pos = lp.first(); pos != Listpack::NPOS; pos = lp.next(lp.next(pos))) {
+            result.emplace_back(lp.get(pos, fbuf), lp.get(lp.next(pos), vbuf));
+        }
+        return result;
     } else {
         return get_hashtable().get_all(); // 需要 Dict 也提供 get_all()
     }
-}
\ No newline at end of file
+}
@@ -1,32 +1,32 @@
 #pragma once
 #include "RedisObject.hpp"
 #include "Dict.hpp"
+#include "Listpack.hpp"
 #include <variant>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <utility>
 
-enum class ObjectEncoding {
-    ZIPLIST,
-    HASHTABLE  // 原 LINKEDLIST 改为更通用的 HASHTABLE
-};
-
-using Ziplist = std::vector<std::pair<std::string, std::string>>;
-
-// 哈希对象
-class HashObject : public RedisObject {
+// 哈希对象的负载（由 RedisObject 的负载指针持有，对象头不在这里）
+// 小对象用 listpack：field、value 交替存放在一块连续内存里，查找时线性扫描；
+// field 数或单个 field/value 的长度超过阈值后转换为 Dict
+class HashObject {
 public:
-    static constexpr size_t ZIPLIST_MAX_ENTRIES = 512;
-    static constexpr size_t ZIPLIST_MAX_ENTRY_SIZE = 64;
+    // listpack 查找是线性扫描，field 数与 Redis 默认的 hash-max-listpack-entries 一致
+    static constexpr size_t LISTPACK_MAX_ENTRIES = 128;
+    static constexpr size_t LISTPACK_MAX_ENTRY_SIZE = 64;
 
     HashObject();
 
-    ObjectType type() const override { return ObjectType::HASH; }
-    size_t memory_usage() const override;
+    size_t memory_usage() const;
 
-    void set_field(std::string field, std::string value);
-    bool get_field(const std::string& field, std::string& out_value) const;
-    bool del_field(const std::string& field); // 可选：HDEL
+    void set_field(std::string_view field, std::string_view value);
+    bool get_field(std::string_view field, std::string& out_value) const;
+    // 不拷贝：out 指向对象内的 value，下次修改前有效；
+    // listpack 中整数编码的 value 格式化到 buf（至少 Listpack::INT_BUF_SIZE 字节）
+    bool find_field(std::string_view field, std::string_view& out, char* buf) const;
+    bool del_field(std::string_view field); // 可选：HDEL
     size_t size() const;
     ObjectEncoding encoding() const { return encoding_; }
 
@@ -36,25 +36,22 @@ public:
     auto& get_hashtable() { return std::get<1>(storage_); }
     const auto& get_hashtable() const { return std::get<1>(storage_); }
 
-    bool exists(const std::string& field) const; // 可选：HEXISTS
+    bool exists(std::string_view field) const; // 可选：HEXISTS
 
-    void try_rehash_for_ms(int ms); // 主动推进接口
-
-    Ziplist::iterator find_in_ziplist(const std::string& field);
-    Ziplist::const_iterator find_in_ziplist(const std::string& field) const;
+    // 内部 Dict 是否处于渐进式 rehash；迁移最多 n 个 bucket，返回是否仍在 rehash（定时任务调用）
+    bool is_rehashing() const;
+    bool rehash_step(int n);
 
 private:
     ObjectEncoding encoding_;
     std::variant<
-        std::vector<std::pair<std::string, std::string>>, // ziplist: [field1, value1, field2, value2, ...]
+        Listpack, // listpack: [field1, value1, field2, value2, ...]
         Dict      // hashtable
     > storage_;
 
-    // 辅助函数
-    bool should_use_ziplist() const;
     void promote_to_hashtable();
 
     // 安全访问 storage_
-    Ziplist& get_ziplist() { return std::get<0>(storage_); }
-    const Ziplist& get_ziplist() const { return std::get<0>(storage_); }
-};
\ No newline at end of file
+    Listpack& get_listpack() { return std::get<0>(storage_); }
+    const Listpack& get_listpack() const { return std::get<0>(storage_); }
+};
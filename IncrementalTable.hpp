@@ -0,0 +1,195 @@
+// IncrementalTable.hpp
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// 侵入式链地址哈希表 + 两张表渐进式 rehash（同 Redis dict），KeySpace、ExpireTable
+// 和 Skiplist 的 member 索引共用
+// - 节点由使用方分配和释放，表里只有 bucket 数组；节点自带链指针（Next）和缓存的哈希（Hash），
+//   迁移时不重算哈希，查找时先比哈希再交给使用方比较 key
+// - 负载因子 >= 1 时扩容到 2 倍，低于 MIN_FILL% 时缩到能装下现有元素的最小 2 的幂；
+//   扩缩容只分配新表，元素由 find 每次迁移一个 bucket、以及 rehash_step 按批迁移，
+//   不会像 std::unordered_map 那样在某一次插入时一次性重排所有元素
+// - 查找也会推进 rehash，所以表结构是 mutable；节点内容只由使用方修改
+// - 移动之后原对象没有 bucket，只能析构或被重新赋值
+template <typename Node, Node* Node::*Next, uint64_t Node::*Hash>
+class IncrementalTable {
+public:
+    static constexpr size_t INIT_SIZE = 4;
+    static constexpr size_t MIN_FILL = 10; // 缩容阈值（used / size < 10%）
+
+    IncrementalTable() { ht_[0].resize(INIT_SIZE); }
+
+    IncrementalTable(const IncrementalTable&) = delete;
+    IncrementalTable& operator=(const IncrementalTable&) = delete;
+
+    IncrementalTable(IncrementalTable&& other) noexcept
+        : rehashidx_(std::exchange(other.rehashidx_, -1)), used_(std::exchange(other.used_, 0)) {
+        ht_[0].swap(other.ht_[0]);
+        ht_[1].swap(other.ht_[1]);
+    }
+
+    // 节点不归表所有：赋值前使用方应已释放本表中的节点（destroy_all）
+    IncrementalTable& operator=(IncrementalTable&& other) noexcept {
+        if (this != &other) {
+            ht_[0] = std::move(other.ht_[0]);
+            ht_[1] = std::move(other.ht_[1]);
+            other.ht_[0].clear();
+            other.ht_[1].clear();
+            rehashidx_ = std::exchange(other.rehashidx_, -1);
+            used_ = std::exchange(other.used_, 0);
+        }
+        return *this;
+    }
+
+    size_t size() const { return used_; }
+    size_t bucket_count() const { return ht_[0].size() + ht_[1].size(); }
+    bool is_rehashing() const { return rehashidx_ != -1; }
+
+    // 查找哈希为 hash 且 match(node) 为真的节点；rehash 期间先迁移一个 bucket
+    template <typename Match>
+    Node* find(uint64_t hash, Match&& match) const {
+        if (is_rehashing()) rehash_step(1);
+        for (int table = 0; table <= 1; ++table) {
+            if (ht_[table].empty()) continue;
+            for (Node* p = ht_[table][hash & (ht_[table].size() - 1)]; p; p = p->*Next) {
+                if (p->*Hash == hash && match(p)) return p;
+            }
+            if (!is_rehashing()) break; // 只查 ht[0]
+        }
+        return nullptr;
+    }
+
+    // 插入（调用方保证不存在）：rehash 期间直接进新表，之后按需扩容
+    void insert(Node* node) {
+        Table& table = ht_[is_rehashing() ? 1 : 0];
+        Node*& head = table[node->*Hash & (table.size() - 1)];
+        node->*Next = head;
+        head = node;
+        used_++;
+        expand_if_needed();
+    }
+
+    // 摘下哈希为 hash 且 match(node) 为真的节点，交还调用方释放；之后按需缩容。不存在返回 nullptr
+    template <typename Match>
+    Node* remove(uint64_t hash, Match&& match) {
+        for (int table = 0; table <= 1; ++table) {
+            if (ht_[table].empty()) continue;
+            Node** link = &ht_[table][hash & (ht_[table].size() - 1)];
+            while (*link) {
+                Node* p = *link;
+                if (p->*Hash == hash && match(p)) {
+                    *link = p->*Next;
+                    used_--;
+                    shrink_if_needed();
+                    return p;
+                }
+                link = &(p->*Next);
+            }
+            if (!is_rehashing()) break;
+        }
+        return nullptr;
+    }
+
+    // 对每个节点调用 destroy(node)（先取下一个再调用），然后清空；clear 之后恢复初始大小
+    template <typename F>
+    void destroy_all(F&& destroy) {
+        for (Table& table : ht_) {
+            for (Node* head : table) {
+                while (head) {
+                    Node* next = head->*Next;
+                    destroy(head);
+                    head = next;
+                }
+            }
+            table.clear();
+        }
+        rehashidx_ = -1;
+        used_ = 0;
+    }
+    template <typename F>
+    void clear(F&& destroy) {
+        destroy_all(destroy);
+        ht_[0].resize(INIT_SIZE);
+    }
+
+    // 遍历所有节点（遍历期间不能修改）
+    template <typename F>
+    void for_each(F&& fn) const {
+        for (const Table& table : ht_) {
+            for (const Node* head : table) {
+                for (const Node* p = head; p; p = p->*Next) fn(p);
+            }
+        }
+    }
+
+    // 迁移最多 n 个 bucket（本次调用最多跳过 10 * n 个空 bucket），返回是否仍在 rehash
+    bool rehash_step(int n) const {
+        if (!is_rehashing()) return false;
+
+        int empty_visits = n * 10;
+        Table& from = ht_[0];
+        Table& to = ht_[1];
+        size_t mask = to.size() - 1;
+        while (n-- > 0 && rehashidx_ < static_cast<long long>(from.size())) {
+            while (rehashidx_ < static_cast<long long>(from.size()) && !from[rehashidx_]) {
+                rehashidx_++;
+                if (--empty_visits == 0) break;
+            }
+            if (rehashidx_ >= static_cast<long long>(from.size()) || !from[rehashidx_]) break;
+
+            // 迁移整个 bucket：用缓存的哈希，不重新计算
+            Node*& bucket = from[rehashidx_];
+            while (bucket) {
+                Node* node = bucket;
+                bucket = node->*Next;
+                Node*& dst = to[node->*Hash & mask];
+                node->*Next = dst;
+                dst = node;
+            }
+            rehashidx_++;
+        }
+
+        if (rehashidx_ >= static_cast<long long>(from.size())) {
+            // rehash 完成
+            ht_[0] = std::move(ht_[1]);
+            ht_[1].clear();
+            rehashidx_ = -1;
+            return false;
+        }
+        return true;
+    }
+
+    // 按 bucket 访问（取样用）：rehash 期间 ht[0] 中 rehash_index() 之前的 bucket 已迁走
+    size_t table_size(int table) const { return ht_[table].size(); }
+    Node* bucket(int table, size_t idx) const { return ht_[table][idx]; }
+    long long rehash_index() const { return rehashidx_; }
+
+private:
+    using Table = std::vector<Node*>;
+
+    mutable Table ht_[2];              // ht[0] 主表，ht[1] 新表（rehash 时用）
+    mutable long long rehashidx_ = -1; // -1 表示未 rehash，否则表示下一个要迁移的 bucket
+    size_t used_ = 0;
+
+    void expand_if_needed() {
+        if (is_rehashing()) return;
+        if (used_ >= ht_[0].size()) {
+            ht_[1].resize(ht_[0].size() * 2);
+            rehashidx_ = 0;
+        }
+    }
+
+    void shrink_if_needed() {
+        if (is_rehashing()) return;
+        if (ht_[0].size() <= INIT_SIZE) return;
+        if (used_ * 100 / ht_[0].size() < MIN_FILL) {
+            size_t size = INIT_SIZE;
+            while (size < used_) size *= 2;
+            ht_[1].resize(size);
+            rehashidx_ = 0;
+        }
+    }
+};
@@ -0,0 +1,198 @@
+// IoBuffer.cpp
+#include "IoBuffer.hpp"
+#include <sys/uio.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+// ========== InputBuffer ==========
+
+void InputBuffer::consume(size_t n) {
+    rpos_ += std::min(n, size());
+    if (rpos_ == wpos_) {
+        // 数据读尽，游标归零，下次读直接从头写入
+        rpos_ = wpos_ = 0;
+        shrinkIfIdle();
+    }
+}
+
+void InputBuffer::reserve(size_t n) {
+    if (n <= cap_ - rpos_) return;
+    makeSpace(n - size());
+}
+
+// 保证尾部至少有 len 字节可写
+void InputBuffer::makeSpace(size_t len) {
+    if (cap_ - wpos_ >= len) return;
+
+    size_t used = size();
+    if (cap_ - used >= len) {
+        // 总空间够，只是被已消费的前缀占着：把残余数据搬到开头
+        std::memmove(buf_.get(), buf_.get() + rpos_, used);
+    } else {
+        size_t new_cap = std::max({cap_ * 2, used + len, INITIAL_SIZE});
+        std::unique_ptr<char[]> new_buf(new char[new_cap]);
+        if (used > 0) std::memcpy(new_buf.get(), buf_.get() + rpos_, used);
+        buf_ = std::move(new_buf);
+        cap_ = new_cap;
+    }
+    rpos_ = 0;
+    wpos_ = used;
+}
+
+void InputBuffer::append(const char* data, size_t len) {
+    makeSpace(len);
+    std::memcpy(buf_.get() + wpos_, data, len);
+    wpos_ += len;
+    peak_ = std::max(peak_, size());
+}
+
+// 空闲时，如果最近一段时间的峰值远小于容量（例如一次大 SET 之后），释放多余内存
+void InputBuffer::shrinkIfIdle() {
+    if (cap_ > INITIAL_SIZE && peak_ < cap_ / 2) {
+        cap_ = std::max(INITIAL_SIZE, peak_);
+        buf_.reset(new char[cap_]);
+    }
+    peak_ = 0;
+}
+
+ssize_t InputBuffer::readFrom(int fd) {
+    // 栈上临时区：尾部空间不够时接住剩余数据，避免为偶发的大包预先分配
+    char extra[EXTRA_READ_SIZE];
+    size_t writable = cap_ - wpos_;
+
+    struct iovec vec[2];
+    vec[0].iov_base = buf_.get() + wpos_;
+    vec[0].iov_len = writable;
+    vec[1].iov_base = extra;
+    vec[1].iov_len = sizeof(extra);
+    int iovcnt = (writable < sizeof(extra)) ? 2 : 1;
+
+    ssize_t n = ::readv(fd, vec, iovcnt);
+    if (n > 0) {
+        if (static_cast<size_t>(n) <= writable) {
+            wpos_ += n;
+        } else {
+            wpos_ = cap_;
+            append(extra, n - writable);
+        }
+        peak_ = std::max(peak_, size());
+    }
+    return n;
+}
+
+// ========== OutputBuffer ==========
+
+void OutputBuffer::append(const char* data, size_t len) {
+    if (len == 0) return;
+    pending_ += len;
+
+    if (!chunks_.empty()) {
+        auto& tail = chunks_.back().data;
+        size_t room = tail.capacity() - tail.size();
+        size_t n = std::min(room, len);
+        tail.append(data, n);
+        data += n;
+        len -= n;
+        if (len == 0) return;
+        // 尾块写满仍有积压：后续块加倍，减少块数和 writev 段数
+        chunk_size_ = std::min(chunk_size_ * 2, MAX_CHUNK_SIZE);
+    }
+
+    Chunk chunk;
+    chunk.data.reserve(std::max(chunk_size_, len));
+    chunk.data.append(data, len);
+    chunks_.push_back(std::move(chunk));
+}
+
+void OutputBuffer::append(std::string&& data) {
+    if (data.size() < INITIAL_CHUNK_SIZE) {
+        append(data.data(), data.size());
+        return;
+    }
+    // 大响应直接接管 string 的内存
+    pending_ += data.size();
+    Chunk chunk;
+    chunk.data = std::move(data);
+    chunks_.push_back(std::move(chunk));
+}
+
+int OutputBuffer::fillIov(struct iovec* iov, int max) const {
+    int cnt = 0;
+    for (auto it = chunks_.begin(); it != chunks_.end() && cnt < max; ++it) {
+        size_t len = it->data.size() - it->start;
+        if (len == 0) continue;
+        iov[cnt].iov_base = const_cast<char*>(it->data.data()) + it->start;
+        iov[cnt].iov_len = len;
+        ++cnt;
+    }
+    return cnt;
+}
+
+void OutputBuffer::consume(size_t n) {
+    n = std::min(n, pending_);
+    pending_ -= n;
+
+    while (n > 0) {
+        auto& front = chunks_.front();
+        size_t len = front.data.size() - front.start;
+        if (n < len) {
+            front.start += n;
+            break;
+        }
+        n -= len;
+        if (chunks_.size() == 1) {
+            // 保留最后一块复用，避免每轮响应都重新分配
+            front.data.clear();
+            front.start = 0;
+        } else {
+            chunks_.pop_front();
+        }
+    }
+
+    if (pending_ == 0) releaseIdle();
+}
+
+ssize_t OutputBuffer::writeTo(int fd) {
+    ssize_t total = 0;
+
+    while (pending_ > 0) {
+        struct iovec iov[MAX_IOV];
+        int cnt = fillIov(iov, MAX_IOV);
+
+        ssize_t n = ::writev(fd, iov, cnt);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break; // 内核缓冲区已满，下次再写
+            return -1;
+        }
+        total += n;
+        consume(static_cast<size_t>(n));
+    }
+    return total;
+}
+
+std::string OutputBuffer::take() {
+    std::string result;
+    if (chunks_.size() == 1 && chunks_.front().start == 0) {
+        result = std::move(chunks_.front().data);
+    } else {
+        result.reserve(pending_);
+        for (const auto& chunk : chunks_) {
+            result.append(chunk.data, chunk.start, std::string::npos);
+        }
+    }
+    chunks_.clear();
+    pending_ = 0;
+    chunk_size_ = INITIAL_CHUNK_SIZE;
+    return result;
+}
+
+// 排空后只保留一个初始大小的块，释放积压时分配的大块
+void OutputBuffer::releaseIdle() {
+    while (chunks_.size() > 1) chunks_.pop_back();
+    if (!chunks_.empty() && chunks_.front().data.capacity() > INITIAL_CHUNK_SIZE) {
+        chunks_.clear();
+    }
+    chunk_size_ = INITIAL_CHUNK_SIZE;
+}
@@ -0,0 +1,97 @@
+// IoBuffer.hpp
+#pragma once
+#include <string>
+#include <string_view>
+#include <deque>
+#include <memory>
+#include <cstddef>
+#include <sys/types.h>
+
+struct iovec;
+
+// 读缓冲区：连续内存 + 读写游标
+// - 解析器需要连续字节（string_view 参数直接指向这里），所以不分段存储
+// - consume 只移动读游标，O(1)；只有尾部空间不足时才把残余数据搬到开头
+// - readv 同时读入尾部空闲区和栈上 64KB 临时区，一次系统调用读尽 socket，
+//   按实际流量自适应扩容；空闲时收缩回初始大小
+class InputBuffer {
+public:
+    static constexpr size_t INITIAL_SIZE = 16 * 1024;
+    static constexpr size_t EXTRA_READ_SIZE = 64 * 1024;
+
+    InputBuffer() = default;
+
+    // 未消费的数据
+    std::string_view view() const { return {buf_.get() + rpos_, wpos_ - rpos_}; }
+    size_t size() const { return wpos_ - rpos_; }
+    bool empty() const { return rpos_ == wpos_; }
+    size_t capacity() const { return cap_; }
+
+    // 丢弃开头 n 字节
+    void consume(size_t n);
+
+    // 保证未消费数据 + 后续写入共 n 字节能放进连续空间
+    void reserve(size_t n);
+
+    // 从 fd 读一次（readv），返回值同 read()
+    ssize_t readFrom(int fd);
+
+    // 追加已经读到的数据（io_uring 从 provided buffer 拷入）
+    void append(const char* data, size_t len);
+
+private:
+    void makeSpace(size_t len);
+    void shrinkIfIdle();
+
+    std::unique_ptr<char[]> buf_;
+    size_t cap_ = 0;
+    size_t rpos_ = 0;
+    size_t wpos_ = 0;
+    size_t peak_ = 0; // 上次收缩以来未消费数据的峰值
+};
+
+// 写缓冲区：分块链表
+// - 小响应追加到尾块，大响应（已是完整 std::string）直接移入成为独立块，不拷贝
+// - writev 一次提交多个块；部分写只推进块内偏移，不做 erase/memmove
+// - 连续积压时新块按倍数增大，排空后只保留一个初始大小的块复用
+class OutputBuffer {
+public:
+    static constexpr size_t INITIAL_CHUNK_SIZE = 4 * 1024;
+    static constexpr size_t MAX_CHUNK_SIZE = 64 * 1024;
+    static constexpr int MAX_IOV = 64;
+
+    OutputBuffer() = default;
+
+    void append(const char* data, size_t len);
+    void append(std::string&& data);
+
+    size_t size() const { return pending_; }
+    bool empty() const { return pending_ == 0; }
+
+    // 取出全部待发送数据（用于把响应转交给其他分片），缓冲区随之清空
+    std::string take();
+
+    // 尽量写出数据（writev，直到写完或 EAGAIN），返回本次写出的字节数；
+    // 出错返回 -1 并保留 errno
+    ssize_t writeTo(int fd);
+
+    // 异步发送（io_uring）：填充待发送数据的 iovec，返回段数。
+    // 在 consume 之前这些内存保持有效 —— append 只写入尾块的剩余容量或新增块，
+    // 不会移动已有数据
+    int fillIov(struct iovec* iov, int max) const;
+
+    // 开头 n 字节已发送：推进块偏移，弹出发完的块
+    void consume(size_t n);
+
+private:
+    struct Chunk {
+        std::string data;
+        size_t start = 0; // 已发送的偏移
+    };
+
+    void releaseIdle();
+
+    std::deque<Chunk> chunks_;
+    size_t pending_ = 0;
+    size_t chunk_size_ = INITIAL_CHUNK_SIZE;
+};
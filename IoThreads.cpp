@@ -0,0 +1,95 @@
+// IoThreads.cpp
+#include "IoThreads.hpp"
+#include "Connection.hpp"
+
+IoThreadPool::IoThreadPool(int num_threads) {
+    for (int i = 1; i < num_threads; ++i) {
+        auto w = std::make_unique<Worker>();
+        Worker* raw = w.get();
+        workers_.push_back(std::move(w));
+        raw->thread = std::thread([this, raw] { workerLoop(*raw); });
+    }
+}
+
+IoThreadPool::~IoThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_.store(true);
+    }
+    cv_.notify_all();
+    for (auto& w : workers_) {
+        if (w->thread.joinable()) w->thread.join();
+    }
+}
+
+void IoThreadPool::process(Op op, Connection* conn) {
+    if (op == Op::READ) {
+        if (conn->readFromSocket()) {
+            conn->parseInput();
+        }
+    } else {
+        conn->writeToSocket();
+    }
+}
+
+void IoThreadPool::run(Op op, const std::vector<Connection*>& conns) {
+    if (conns.empty()) return;
+
+    size_t nthreads = workers_.size() + 1;
+    if (workers_.empty() || conns.size() < nthreads * MIN_CONNS_PER_THREAD) {
+        for (Connection* conn : conns) process(op, conn);
+        return;
+    }
+
+    // 轮询分配：第 0 份留给主线程
+    main_jobs_.clear();
+    for (size_t i = 0; i < conns.size(); ++i) {
+        size_t t = i % nthreads;
+        if (t == 0) {
+            main_jobs_.push_back(conns[i]);
+        } else {
+            workers_[t - 1]->jobs.push_back(conns[i]);
+        }
+    }
+
+    op_ = op;
+    for (auto& w : workers_) {
+        // release 语义（seq_cst 包含）：jobs 和 op_ 对 worker 可见
+        w->pending.store(w->jobs.size());
+    }
+    if (sleeping_.load() > 0) {
+        // 加锁后再通知，避免 worker 检查条件与进入等待之间丢失唤醒
+        { std::lock_guard<std::mutex> lock(mutex_); }
+        cv_.notify_all();
+    }
+
+    for (Connection* conn : main_jobs_) process(op, conn);
+
+    // 等待所有 I/O 线程完成，之后主线程独占全部连接
+    for (auto& w : workers_) {
+        while (w->pending.load(std::memory_order_acquire) != 0) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void IoThreadPool::workerLoop(Worker& w) {
+    while (!stop_.load()) {
+        int spins = 0;
+        while (w.pending.load(std::memory_order_acquire) == 0 && spins < SPIN_ITERATIONS) {
+            ++spins;
+        }
+
+        if (w.pending.load() == 0) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            sleeping_.fetch_add(1);
+            cv_.wait(lock, [&] { return stop_.load() || w.pending.load() != 0; });
+            sleeping_.fetch_sub(1);
+            continue;
+        }
+
+        for (Connection* conn : w.jobs) process(op_, conn);
+        w.jobs.clear();
+        w.pending.store(0, std::memory_order_release);
+    }
+}
@@ -0,0 +1,59 @@
+// IoThreads.hpp
+#pragma once
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+
+class Connection;
+
+// Redis 6 风格的 I/O 线程池
+// - 主线程把本轮就绪的连接按轮询分给 N 个线程（主线程自己也承担一份），
+//   线程只做 socket 读 + RESP 解析，或者 socket 写
+// - 命令执行仍由主线程串行完成，Database 等数据结构无需加锁
+// - run() 返回时所有分片都已完成，主线程与 I/O 线程不会同时访问同一个连接
+class IoThreadPool {
+public:
+    enum class Op {
+        READ,   // readFromSocket + parseInput
+        WRITE   // writeToSocket
+    };
+
+    // num_threads 包含主线程，<= 1 时不创建线程，全部在主线程内联处理
+    explicit IoThreadPool(int num_threads);
+    ~IoThreadPool();
+
+    IoThreadPool(const IoThreadPool&) = delete;
+    IoThreadPool& operator=(const IoThreadPool&) = delete;
+
+    int size() const { return static_cast<int>(workers_.size()) + 1; }
+
+    // 对 conns 执行 op，阻塞直到全部完成
+    void run(Op op, const std::vector<Connection*>& conns);
+
+private:
+    // 就绪连接太少时线程间同步的开销超过收益，直接在主线程处理
+    static constexpr size_t MIN_CONNS_PER_THREAD = 2;
+    // 空闲时自旋的次数，之后在条件变量上休眠
+    static constexpr int SPIN_ITERATIONS = 1 << 16;
+
+    struct Worker {
+        std::thread thread;
+        std::vector<Connection*> jobs;
+        std::atomic<size_t> pending{0}; // 非 0 表示有待处理的任务
+    };
+
+    static void process(Op op, Connection* conn);
+    void workerLoop(Worker& w);
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<Connection*> main_jobs_;
+    Op op_ = Op::READ;
+
+    std::atomic<bool> stop_{false};
+    std::atomic<int> sleeping_{0};
+    std::mutex mutex_;
+    std::condition_variable cv_;
+};
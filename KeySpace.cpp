@@ -0,0 +1,137 @@
+// KeySpace.cpp
+#include "KeySpace.hpp"
+#include "RedisObject.hpp"
+#include "Hash.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <utility>
+
+// ========== Entry ==========
+
+size_t KeySpace::Entry::allocSize(size_t key_len) {
+    return std::max(sizeof(Entry), offsetof(Entry, key_data) + key_len);
+}
+
+KeySpace::Entry* KeySpace::Entry::create(std::string_view key, ObjectPtr value, uint64_t hash) {
+    void* mem = ::operator new(allocSize(key.size()));
+    auto* entry = new (mem) Entry{nullptr, hash, std::move(value), static_cast<uint32_t>(key.size()), {}};
+    std::memcpy(entry->key_data, key.data(), key.size());
+    return entry;
+}
+
+void KeySpace::Entry::destroy(Entry* entry) {
+    entry->~Entry();
+    ::operator delete(entry);
+}
+
+// ========== KeySpace ==========
+
+KeySpace::KeySpace() = default;
+
+KeySpace::~KeySpace() {
+    table_.destroy_all(Entry::destroy);
+}
+
+KeySpace::KeySpace(KeySpace&& other) noexcept
+    : table_(std::move(other.table_)), entry_bytes_(std::exchange(other.entry_bytes_, 0)) {}
+
+KeySpace& KeySpace::operator=(KeySpace&& other) noexcept {
+    if (this != &other) {
+        table_.destroy_all(Entry::destroy);
+        table_ = std::move(other.table_);
+        entry_bytes_ = std::exchange(other.entry_bytes_, 0);
+    }
+    return *this;
+}
+
+void KeySpace::clear() {
+    table_.clear(Entry::destroy);
+    entry_bytes_ = 0;
+}
+
+ObjectPtr* KeySpace::find(std::string_view key) const {
+    Entry* entry = table_.find(hashString(key), [&](const Entry* p) { return p->key() == key; });
+    return entry ? &entry->value : nullptr;
+}
+
+bool KeySpace::set(std::string_view key, ObjectPtr value, ObjectPtr* replaced) {
+    uint64_t hash = hashString(key);
+    if (Entry* entry = table_.find(hash, [&](const Entry* p) { return p->key() == key; })) {
+        if (replaced) *replaced = std::move(entry->value);
+        entry->value = std::move(value);
+        return false;
+    }
+
+    table_.insert(Entry::create(key, std::move(value), hash));
+    entry_bytes_ += Entry::allocSize(key.size());
+    return true;
+}
+
+bool KeySpace::erase(std::string_view key, ObjectPtr* removed) {
+    if (table_.is_rehashing()) table_.rehash_step(1);
+
+    Entry* entry = table_.remove(hashString(key), [&](const Entry* p) { return p->key() == key; });
+    if (!entry) return false;
+    if (removed) *removed = std::move(entry->value);
+    entry_bytes_ -= Entry::allocSize(entry->key_len);
+    Entry::destroy(entry);
+    return true;
+}
+
+bool KeySpace::rehash_for_ms(int ms) {
+    auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(ms);
+    while (rehash_step(100)) {
+        if (std::chrono::steady_clock::now() >= end) return true;
+    }
+    return false;
+}
+
+namespace {
+
+// xorshift64*，每个线程（分片）一份状态
+uint64_t randomBucket() {
+    thread_local uint64_t state = hashSeed() | 1;
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 0x2545F4914F6CDD1DULL;
+}
+
+} // namespace
+
+size_t KeySpace::sample(Entry** out, size_t n) const {
+    n = std::min(n, size());
+    if (n == 0) return 0;
+    if (is_rehashing()) rehash_step(static_cast<int>(n));
+
+    // 从随机 bucket 开始顺序取（同 Redis dictGetSomeKeys）；连续遇到多个空 bucket 时换一个随机位置，
+    // 因此可能回到已取过的 bucket，按指针去重（n 很小）
+    bool rehashing = is_rehashing();
+    size_t mask = std::max(table_.table_size(0), rehashing ? table_.table_size(1) : 0) - 1;
+    size_t idx = randomBucket() & mask;
+    size_t stored = 0;
+    size_t empty_run = 0;
+    for (size_t steps = n * 10; steps > 0 && stored < n; --steps) {
+        bool found = false;
+        for (int table = 0; table < (rehashing ? 2 : 1) && stored < n; ++table) {
+            if (idx >= table_.table_size(table)) continue;
+            if (table == 0 && rehashing && static_cast<long long>(idx) < table_.rehash_index()) continue;
+            for (Entry* p = table_.bucket(table, idx); p && stored < n; p = p->next) {
+                if (std::find(out, out + stored, p) != out + stored) continue;
+                out[stored++] = p;
+                found = true;
+            }
+        }
+        if (found) {
+            empty_run = 0;
+        } else if (++empty_run >= 5 && empty_run > n) {
+            idx = randomBucket() & mask;
+            empty_run = 0;
+            continue;
+        }
+        idx = (idx + 1) & mask;
+    }
+    return stored;
+}
@@ -0,0 +1,73 @@
+// KeySpace.hpp
+#pragma once
+#include <vector>
+#include <string>
+#include <string_view>
+#include <chrono>
+#include <cstdint>
+#include "RedisObject.hpp"
+#include "IncrementalTable.hpp"
+
+// 顶层键空间：key -> 对象，链地址法 + 两张表渐进式 rehash（IncrementalTable）
+// - 扩容/缩容只分配新表，元素由每次访问迁移一个 bucket、以及定时任务按时间片迁移
+// - 每个节点缓存 key 的哈希，迁移时不重算，查找时先比哈希再比字符串
+// - key 的字节直接跟在节点后面，节点（28 字节）和 key 只占一次分配
+class KeySpace {
+public:
+    struct Entry {
+        Entry* next;
+        uint64_t hash;
+        ObjectPtr value;
+        uint32_t key_len;
+        char key_data[1]; // 实际长度为 key_len，延伸到节点之后
+
+        std::string_view key() const { return {key_data, key_len}; }
+
+        static Entry* create(std::string_view key, ObjectPtr value, uint64_t hash);
+        static void destroy(Entry* entry);
+        // 节点（含 key）占用的字节数
+        static size_t allocSize(size_t key_len);
+    };
+
+    KeySpace();
+    ~KeySpace();
+
+    KeySpace(const KeySpace&) = delete;
+    KeySpace& operator=(const KeySpace&) = delete;
+    KeySpace(KeySpace&& other) noexcept;
+    KeySpace& operator=(KeySpace&& other) noexcept;
+
+    // 查找；rehash 期间顺带迁移一个 bucket（不改变内容，因此是 const）
+    // 返回的指针在下一次写操作前有效
+    ObjectPtr* find(std::string_view key) const;
+
+    // 插入或覆盖，返回是否为新 key；replaced 非空时覆盖掉的旧值移到这里（由调用方决定何时释放）
+    bool set(std::string_view key, ObjectPtr value, ObjectPtr* replaced = nullptr);
+    // removed 非空时删除的值移到这里
+    bool erase(std::string_view key, ObjectPtr* removed = nullptr);
+    void clear();
+
+    size_t size() const { return table_.size(); }
+    size_t bucket_count() const { return table_.bucket_count(); }
+    // 两张表的 bucket 数组 + 所有节点（不含值对象），O(1)
+    size_t memory_usage() const { return bucket_count() * sizeof(Entry*) + entry_bytes_; }
+
+    bool is_rehashing() const { return table_.is_rehashing(); }
+    // 迁移最多 n 个 bucket，返回是否仍在 rehash
+    bool rehash_step(int n) const { return table_.rehash_step(n); }
+    // 在 ms 毫秒内尽量推进 rehash，返回是否仍在 rehash
+    bool rehash_for_ms(int ms);
+
+    // 随机取最多 n 个不重复的节点写入 out（淘汰取样用），返回实际个数；节点在下一次写操作前有效
+    size_t sample(Entry** out, size_t n) const;
+
+    // 遍历所有 key（遍历期间不能修改）：fn(std::string_view key, const ObjectPtr& value)
+    template <typename F>
+    void for_each(F&& fn) const {
+        table_.for_each([&](const Entry* p) { fn(p->key(), p->value); });
+    }
+
+private:
+    IncrementalTable<Entry, &Entry::next, &Entry::hash> table_;
+    size_t entry_bytes_ = 0; // 所有节点的 allocSize 之和
+};
@@ -0,0 +1,134 @@
+// LazyFree.cpp
+#include "LazyFree.hpp"
+#include "HashObject.hpp"
+#include "ListObject.hpp"
+#include "SetObject.hpp"
+#include "ZSetObject.hpp"
+#include "Memory.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace {
+
+struct Job {
+    ObjectPtr obj;
+    std::unique_ptr<KeySpace> keys;
+    std::unique_ptr<ExpireTable> expires;
+    size_t objects = 0;
+    size_t bytes = 0;
+};
+
+std::atomic<size_t> g_pending_objects{0};
+std::atomic<size_t> g_pending_bytes{0};
+std::atomic<size_t> g_freed_objects{0};
+
+// 第一次有任务时启动；进程退出时（静态对象析构）处理完剩余任务再结束
+class Worker {
+public:
+    Worker() : thread_([this] { run(); }) {}
+
+    ~Worker() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_one();
+        thread_.join();
+    }
+
+    void submit(Job job) {
+        g_pending_objects.fetch_add(job.objects, std::memory_order_relaxed);
+        g_pending_bytes.fetch_add(job.bytes, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            jobs_.push_back(std::move(job));
+        }
+        cv_.notify_one();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Job> jobs_;
+    bool stop_ = false;
+    std::thread thread_;  // 最后初始化：线程启动时其他成员已就绪
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            cv_.wait(lock, [this] { return stop_ || !jobs_.empty(); });
+            if (jobs_.empty()) return;
+            Job job = std::move(jobs_.front());
+            jobs_.pop_front();
+            lock.unlock();
+
+            size_t objects = job.objects;
+            size_t bytes = job.bytes;
+            job = Job();  // 在锁外释放
+            g_pending_objects.fetch_sub(objects, std::memory_order_relaxed);
+            g_pending_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+            g_freed_objects.fetch_add(objects, std::memory_order_relaxed);
+            memReleaseThreadCache();
+
+            lock.lock();
+        }
+    }
+};
+
+Worker& worker() {
+    static Worker w;
+    return w;
+}
+
+} // namespace
+
+size_t lazyfreeEffort(const RedisObject* obj) {
+    switch (obj->type()) {
+    case ObjectType::HASH:
+        return obj->hash()->encoding() == ObjectEncoding::HASHTABLE ? obj->hash()->size() : 1;
+    case ObjectType::SET:
+        return obj->set()->encoding() == ObjectEncoding::HASHTABLE ? obj->set()->size() : 1;
+    case ObjectType::ZSET:
+        return obj->zset()->encoding() == ObjectEncoding::SKIPLIST ? obj->zset()->size() : 1;
+    case ObjectType::LIST:
+        return obj->list()->node_count();
+    default:
+        return 1;
+    }
+}
+
+bool freeObjectAsync(ObjectPtr obj) {
+    if (!obj || obj->refcount() != 1 || lazyfreeEffort(obj.get()) <= LAZYFREE_THRESHOLD) return false;
+    Job job;
+    job.objects = 1;
+    job.bytes = obj->memory_usage();
+    job.obj = std::move(obj);
+    worker().submit(std::move(job));
+    return true;
+}
+
+void freeKeySpaceAsync(KeySpace&& keys, ExpireTable&& expires, size_t bytes) {
+    Job job;
+    job.objects = keys.size();
+    job.bytes = bytes;
+    job.keys = std::make_unique<KeySpace>(std::move(keys));
+    job.expires = std::make_unique<ExpireTable>(std::move(expires));
+    worker().submit(std::move(job));
+}
+
+size_t lazyfreePendingObjects() {
+    return g_pending_objects.load(std::memory_order_relaxed);
+}
+
+size_t lazyfreePendingBytes() {
+    return g_pending_bytes.load(std::memory_order_relaxed);
+}
+
+size_t lazyfreedObjects() {
+    return g_freed_objects.load(std::memory_order_relaxed);
+}
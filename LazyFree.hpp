@@ -0,0 +1,31 @@
+// LazyFree.hpp
+#pragma once
+#include <cstddef>
+#include "RedisObject.hpp"
+#include "KeySpace.hpp"
+#include "ExpireTable.hpp"
+
+// 后台释放（同 Redis lazyfree.c）
+// - 删除大对象时逐个释放所有元素（一个 500 万 field 的 hash 就是 500 万个节点），
+//   在事件循环里做会让所有客户端卡住。这里只把对象从键空间摘下（O(1)），
+//   由进程内唯一的后台线程释放；FLUSHALL ASYNC 把整个键空间和过期表一起交过去
+// - 工作量不超过 LAZYFREE_THRESHOLD 的对象直接释放，比入队还便宜
+// - 交出的对象只剩键空间这一个引用（引用计数非原子，交出后分片线程不再访问它）；
+//   共享整数只读，后台线程遍历到也不会修改
+// - 后台线程释放的内存块由它交还分配器的公共池（memReleaseThreadCache），分片线程可以复用
+constexpr size_t LAZYFREE_THRESHOLD = 64;
+
+// 释放对象的工作量：hashtable / skiplist 编码为元素数，quicklist 为节点数，其余为 1
+size_t lazyfreeEffort(const RedisObject* obj);
+
+// 交给后台线程释放（工作量小或还有其他引用时就地释放），返回是否交给了后台
+bool freeObjectAsync(ObjectPtr obj);
+// 整个键空间和过期表交给后台线程；bytes 为其中对象和节点的字节数（计入 lazyfreePendingBytes）
+void freeKeySpaceAsync(KeySpace&& keys, ExpireTable&& expires, size_t bytes);
+
+// 已交出、尚未释放的对象数（键空间按 key 数计）和字节数（按 memory_usage 估算）。
+// 淘汰按 usedMemory() 减去待释放字节数判断是否还超限，否则后台还没来得及释放时会多淘汰
+size_t lazyfreePendingObjects();
+size_t lazyfreePendingBytes();
+// 累计由后台线程释放的对象数
+size_t lazyfreedObjects();
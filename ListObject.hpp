@@ -1,61 +1,47 @@
 #pragma once
 #include "RedisObject.hpp"
+#include "Quicklist.hpp"
 #include <string>
-#include <unordered_map>
-#include <memory>
-#include <variant>
+#include <string_view>
 #include <vector>
-#include <optional>
-#include <utility> // for pair
 
-enum class ObjectEncoding {
-    ZIPLIST,   // 小列表：用 vector 模拟
-    LINKEDLIST // 大列表：用 deque
-};
-
-// 列表对象（元素为二进制安全的字节序列，用 std::string 表示）
-class ListObject : public RedisObject {
+// 列表对象的负载（由 RedisObject 的负载指针持有，对象头不在这里）
+// 元素存在 quicklist 里：小列表只有一个 listpack 节点，大列表按节点大小切分，
+// 两端 push/pop 为 O(1)，按下标访问为 O(节点数)
+// 下标与 Redis 一致：从 0 开始，负数从尾部数起（-1 为最后一个）
+class ListObject {
 public:
-    static constexpr size_t ZIPLIST_MAX_ENTRIES = 512;
-    static constexpr size_t ZIPLIST_MAX_ENTRY_SIZE = 64; // 单个元素最大 64 字节
-
-    ListObject();
-
-    void push_front(std::string value);
-    void push_back(std::string value);
-    bool pop_front(std::string& out);
-    bool pop_back(std::string& out);
-    bool get(int index, std::string& out) const;
-    long long remove(long long count, const std::string& value);
-    void trim(int start, int stop);
-    bool insert(const std::string& pivot, const std::string& value, InsertPosition pos);
-    size_t size() const;
-
-    // 用于调试：查看当前编码
-    ObjectEncoding encoding() const { return encoding_; }
+    ListObject() = default;
+
+    size_t size() const { return ql_.size(); }
+    size_t node_count() const { return ql_.node_count(); }
+    ObjectEncoding encoding() const { return ObjectEncoding::QUICKLIST; }
+    size_t memory_usage() const;
+
+    void push_front(std::string_view value) { ql_.push_front(value); }
+    void push_back(std::string_view value) { ql_.push_back(value); }
+    bool pop_front(std::string& out) { return ql_.pop_front(out); }
+    bool pop_back(std::string& out) { return ql_.pop_back(out); }
+
+    bool index(long long index, std::string& out);
+    // 闭区间 [start, stop] 的元素（LRANGE），越界部分截掉
+    void range(long long start, long long stop, std::vector<std::string>& out);
+    // 只保留闭区间 [start, stop] 的元素（LTRIM）
+    void trim(long long start, long long stop);
+    // LREM：count > 0 从头删最多 count 个，< 0 从尾删，0 全部删除
+    size_t remove(long long count, std::string_view value) { return ql_.remove(count, value); }
+    // LINSERT：pivot 不存在返回 false
+    bool insert(std::string_view pivot, std::string_view value, bool after) {
+        return ql_.insert(pivot, value, after);
+    }
+
+    // 按顺序遍历所有元素（持久化用），视图只在回调内有效
+    template <typename F>
+    void for_each(F&& fn) { ql_.range(0, ql_.size(), fn); }
 
 private:
-    ObjectEncoding encoding_;
-    std::variant<
-        std::vector<std::string>,   // ziplist 模拟
-        std::deque<std::string>     // linkedlist 模拟
-    > storage_;
+    Quicklist ql_;
 
-    // 辅助：检查是否应保持 ziplist
-    bool should_use_ziplist() const;
-
-    // 升级：从 ziplist → linkedlist
-    void promote_to_linkedlist();
-
-    // 获取可变引用（用于修改）
-    std::vector<std::string>& get_ziplist();
-    std::deque<std::string>& get_linkedlist();
-
-    // 获取只读引用
-    const std::vector<std::string>& get_ziplist() const;
-    const std::deque<std::string>& get_linkedlist() const;
-
-    // 索引归一化（复用）
-    std::optional<size_t> normalize_index(int index, size_t size) const;
-    std::optional<std::pair<size_t, size_t>> normalize_range(int start, int stop, size_t sz) const;
-};
\ No newline at end of file
+    // 把 Redis 语义的闭区间转换为 [from, from + n)，区间为空返回 false
+    bool normalize_range(long long start, long long stop, size_t& from, size_t& n) const;
+};
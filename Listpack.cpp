@@ -0,0 +1,457 @@
+// Listpack.cpp
+#include "Listpack.hpp"
+#include "Protocol.hpp"
+#include "Memory.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <utility>
+
+namespace {
+
+constexpr size_t HEADER_SIZE = 6;       // 总字节数 u32 + 元素数 u16
+constexpr unsigned char LP_EOF = 0xFF;
+constexpr size_t COUNT_UNKNOWN = 0xFFFF; // 元素数超过 u16 时需要遍历统计
+
+// 编码字节
+constexpr unsigned char ENC_7BIT_UINT = 0x00;     // 0xxxxxxx
+constexpr unsigned char ENC_6BIT_STR = 0x80;      // 10xxxxxx + 数据
+constexpr unsigned char ENC_13BIT_INT = 0xC0;     // 110xxxxx yyyyyyyy
+constexpr unsigned char ENC_12BIT_STR = 0xE0;     // 1110xxxx yyyyyyyy + 数据
+constexpr unsigned char ENC_32BIT_STR = 0xF0;     // 11110000 + 4 字节长度 + 数据
+constexpr unsigned char ENC_16BIT_INT = 0xF1;
+constexpr unsigned char ENC_24BIT_INT = 0xF2;
+constexpr unsigned char ENC_32BIT_INT = 0xF3;
+constexpr unsigned char ENC_64BIT_INT = 0xF4;
+
+inline uint32_t readU32(const unsigned char* p) {
+    return uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 | uint32_t(p[3]) << 24;
+}
+
+inline void writeU32(unsigned char* p, uint32_t v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = (v >> 24) & 0xFF;
+}
+
+// 小端读 n 字节有符号整数
+inline long long readInt(const unsigned char* p, int n) {
+    uint64_t v = 0;
+    for (int i = 0; i < n; ++i) v |= uint64_t(p[i]) << (8 * i);
+    if (n < 8) {
+        uint64_t sign = uint64_t(1) << (8 * n - 1);
+        v = (v ^ sign) - sign; // 符号扩展
+    }
+    return static_cast<long long>(v);
+}
+
+inline void writeInt(unsigned char* p, long long value, int n) {
+    uint64_t v = static_cast<uint64_t>(value);
+    for (int i = 0; i < n; ++i) p[i] = (v >> (8 * i)) & 0xFF;
+}
+
+// backlen：每字节 7 位，从后往前读，最高位为 1 表示前面还有字节
+inline size_t backlenSize(size_t len) {
+    if (len <= 127) return 1;
+    if (len < 16383) return 2;
+    if (len < 2097151) return 3;
+    if (len < 268435455) return 4;
+    return 5;
+}
+
+inline void writeBacklen(unsigned char* p, size_t len) {
+    size_t n = backlenSize(len);
+    // p[n-1] 是最低 7 位，向前依次是更高的 7 位；除最前面的字节外都置最高位
+    for (size_t i = 0; i < n; ++i) {
+        unsigned char b = (len >> (7 * i)) & 0x7F;
+        if (i + 1 < n) b |= 0x80;
+        p[n - 1 - i] = b;
+    }
+}
+
+// p 指向 backlen 的最后一个字节
+inline size_t readBacklen(const unsigned char* p) {
+    size_t len = 0;
+    unsigned shift = 0;
+    while (true) {
+        len |= size_t(p[0] & 0x7F) << shift;
+        if (!(p[0] & 0x80)) break;
+        shift += 7;
+        --p;
+    }
+    return len;
+}
+
+// 解码后的元素
+struct Decoded {
+    const char* str;   // 字符串元素的数据；整数元素为 nullptr
+    size_t len;        // 字符串长度
+    long long value;   // 整数元素的值
+    size_t enc_len;    // 编码 + 数据的字节数（不含 backlen）
+};
+
+Decoded decode(const unsigned char* p) {
+    unsigned char b = p[0];
+    if ((b & 0x80) == ENC_7BIT_UINT) return {nullptr, 0, b, 1};
+    if ((b & 0xC0) == ENC_6BIT_STR) {
+        size_t len = b & 0x3F;
+        return {reinterpret_cast<const char*>(p + 1), len, 0, 1 + len};
+    }
+    if ((b & 0xE0) == ENC_13BIT_INT) {
+        long long v = ((b & 0x1F) << 8) | p[1];
+        if (v >= (1 << 12)) v -= (1 << 13);
+        return {nullptr, 0, v, 2};
+    }
+    if ((b & 0xF0) == ENC_12BIT_STR) {
+        size_t len = ((b & 0x0F) << 8) | p[1];
+        return {reinterpret_cast<const char*>(p + 2), len, 0, 2 + len};
+    }
+    switch (b) {
+    case ENC_32BIT_STR: {
+        size_t len = readU32(p + 1);
+        return {reinterpret_cast<const char*>(p + 5), len, 0, 5 + len};
+    }
+    case ENC_16BIT_INT: return {nullptr, 0, readInt(p + 1, 2), 3};
+    case ENC_24BIT_INT: return {nullptr, 0, readInt(p + 1, 3), 4};
+    case ENC_32BIT_INT: return {nullptr, 0, readInt(p + 1, 4), 5};
+    default:            return {nullptr, 0, readInt(p + 1, 8), 9}; // ENC_64BIT_INT
+    }
+}
+
+// 待写入的元素：编码头 + 数据（字符串）+ backlen
+struct Encoded {
+    unsigned char head[9];
+    size_t head_len;
+    const char* data;
+    size_t data_len;
+
+    size_t encLen() const { return head_len + data_len; }
+    size_t totalLen() const { return encLen() + backlenSize(encLen()); }
+
+    void write(unsigned char* p) const {
+        std::memcpy(p, head, head_len);
+        if (data_len) std::memcpy(p + head_len, data, data_len);
+        writeBacklen(p + head_len + data_len, encLen());
+    }
+};
+
+Encoded encode(std::string_view value) {
+    Encoded e{};
+    long long v;
+    if (string2ll(value, v)) {
+        if (v >= 0 && v <= 127) {
+            e.head[0] = static_cast<unsigned char>(v);
+            e.head_len = 1;
+        } else if (v >= -4096 && v <= 4095) {
+            unsigned uv = static_cast<unsigned>(v < 0 ? v + (1 << 13) : v);
+            e.head[0] = ENC_13BIT_INT | (uv >> 8);
+            e.head[1] = uv & 0xFF;
+            e.head_len = 2;
+        } else if (v >= INT16_MIN && v <= INT16_MAX) {
+            e.head[0] = ENC_16BIT_INT;
+            writeInt(e.head + 1, v, 2);
+            e.head_len = 3;
+        } else if (v >= -(1 << 23) && v < (1 << 23)) {
+            e.head[0] = ENC_24BIT_INT;
+            writeInt(e.head + 1, v, 3);
+            e.head_len = 4;
+        } else if (v >= INT32_MIN && v <= INT32_MAX) {
+            e.head[0] = ENC_32BIT_INT;
+            writeInt(e.head + 1, v, 4);
+            e.head_len = 5;
+        } else {
+            e.head[0] = ENC_64BIT_INT;
+            writeInt(e.head + 1, v, 8);
+            e.head_len = 9;
+        }
+        return e;
+    }
+
+    size_t len = value.size();
+    if (len < 64) {
+        e.head[0] = ENC_6BIT_STR | static_cast<unsigned char>(len);
+        e.head_len = 1;
+    } else if (len < 4096) {
+        e.head[0] = ENC_12BIT_STR | static_cast<unsigned char>(len >> 8);
+        e.head[1] = len & 0xFF;
+        e.head_len = 2;
+    } else {
+        e.head[0] = ENC_32BIT_STR;
+        writeU32(e.head + 1, static_cast<uint32_t>(len));
+        e.head_len = 5;
+    }
+    e.data = value.data();
+    e.data_len = len;
+    return e;
+}
+
+// 元素总长度（含 backlen），遍历和查找的热点，只看编码头
+inline size_t entryLen(const unsigned char* p) {
+    unsigned char b = p[0];
+    if (b < 0x80) return 2;                                    // 7 位整数
+    if ((b & 0xC0) == ENC_6BIT_STR) return (b & 0x3F) + 2;     // 短字符串，backlen 1 字节
+    if ((b & 0xE0) == ENC_13BIT_INT) return 3;
+    switch (b) {
+    case ENC_16BIT_INT: return 4;
+    case ENC_24BIT_INT: return 5;
+    case ENC_32BIT_INT: return 6;
+    case ENC_64BIT_INT: return 10;
+    default: {
+        size_t enc_len = decode(p).enc_len;
+        return enc_len + backlenSize(enc_len);
+    }
+    }
+}
+
+// 编码是唯一的（同一个值总是编码成同样的字节），相等比较可以直接比字节
+inline bool sameBytes(const unsigned char* p, const Encoded& e) {
+    return p[0] == e.head[0] &&
+           std::memcmp(p + 1, e.head + 1, e.head_len - 1) == 0 &&
+           (e.data_len == 0 || std::memcmp(p + e.head_len, e.data, e.data_len) == 0);
+}
+
+} // namespace
+
+// ========== 构造 / 析构 ==========
+
+Listpack::Listpack() : lp_(nullptr) {
+    resize(HEADER_SIZE + 1);
+    setCount(0);
+    lp_[HEADER_SIZE] = LP_EOF;
+}
+
+Listpack::~Listpack() {
+    memFree(lp_);
+}
+
+Listpack::Listpack(Listpack&& other) noexcept : lp_(std::exchange(other.lp_, nullptr)) {}
+
+Listpack& Listpack::operator=(Listpack&& other) noexcept {
+    if (this != &other) {
+        memFree(lp_);
+        lp_ = std::exchange(other.lp_, nullptr);
+    }
+    return *this;
+}
+
+unsigned char* Listpack::release() {
+    return std::exchange(lp_, nullptr);
+}
+
+Listpack Listpack::adopt(unsigned char* raw) {
+    return Listpack(raw);
+}
+
+// 小块按实际大小分配；超过 512 字节后按最高位的 1/8 向上取整（与 jemalloc 的 size class 类似），
+// 浪费不超过 12.5%，而连续追加（quicklist 节点）大多落在已分配的块里，不必每次 realloc 拷贝
+static size_t allocSize(size_t bytes) {
+    if (bytes <= 512) return bytes;
+    size_t step = (size_t(1) << (63 - __builtin_clzll(bytes))) / 8;
+    return (bytes + step - 1) & ~(step - 1);
+}
+
+// 分配器按 16 字节以上的粒度给内存，增长后仍放得下（或缩小不多）时不调用 realloc
+void Listpack::resize(size_t bytes) {
+    size_t want = allocSize(bytes);
+    if (lp_) {
+        size_t usable = memUsableSize(lp_);
+        if (bytes <= usable && usable < want + 16) {
+            setBytes(bytes);
+            return;
+        }
+    }
+    auto* p = static_cast<unsigned char*>(memRealloc(lp_, want));
+    if (!p) throw std::bad_alloc();
+    lp_ = p;
+    setBytes(bytes);
+}
+
+void Listpack::setBytes(size_t bytes) {
+    writeU32(lp_, static_cast<uint32_t>(bytes));
+}
+
+void Listpack::setCount(size_t count) {
+    if (count > COUNT_UNKNOWN) count = COUNT_UNKNOWN;
+    lp_[4] = count & 0xFF;
+    lp_[5] = (count >> 8) & 0xFF;
+}
+
+size_t Listpack::bytes() const {
+    return readU32(lp_);
+}
+
+size_t Listpack::size() const {
+    size_t count = lp_[4] | (size_t(lp_[5]) << 8);
+    if (count < COUNT_UNKNOWN) return count;
+    count = 0;
+    for (size_t pos = first(); pos != NPOS; pos = next(pos)) ++count;
+    return count;
+}
+
+bool Listpack::empty() const {
+    return lp_[HEADER_SIZE] == LP_EOF;
+}
+
+void Listpack::clear() {
+    resize(HEADER_SIZE + 1);
+    setCount(0);
+    lp_[HEADER_SIZE] = LP_EOF;
+}
+
+// ========== 遍历 ==========
+
+size_t Listpack::entrySize(size_t pos) const {
+    return entryLen(lp_ + pos);
+}
+
+size_t Listpack::first() const {
+    return empty() ? NPOS : HEADER_SIZE;
+}
+
+size_t Listpack::last() const {
+    return prev(bytes() - 1); // 从 EOF 往前一个
+}
+
+size_t Listpack::next(size_t pos) const {
+    pos += entrySize(pos);
+    return lp_[pos] == LP_EOF ? NPOS : pos;
+}
+
+size_t Listpack::prev(size_t pos) const {
+    if (pos <= HEADER_SIZE) return NPOS;
+    size_t enc_len = readBacklen(lp_ + pos - 1);
+    return pos - enc_len - backlenSize(enc_len);
+}
+
+size_t Listpack::seek(long long index) const {
+    size_t pos;
+    if (index >= 0) {
+        for (pos = first(); pos != NPOS && index > 0; --index) pos = next(pos);
+    } else {
+        for (pos = last(); pos != NPOS && index < -1; ++index) pos = prev(pos);
+    }
+    return pos;
+}
+
+// ========== 读取 ==========
+
+std::string_view Listpack::get(size_t pos, char* buf) const {
+    Decoded d = decode(lp_ + pos);
+    if (d.str) return {d.str, d.len};
+    return {buf, ll2string(buf, d.value)};
+}
+
+bool Listpack::getInteger(size_t pos, long long& out) const {
+    Decoded d = decode(lp_ + pos);
+    if (d.str) return false;
+    out = d.value;
+    return true;
+}
+
+bool Listpack::equals(size_t pos, std::string_view value) const {
+    return sameBytes(lp_ + pos, encode(value));
+}
+
+size_t Listpack::find(std::string_view value, unsigned skip) const {
+    // 只编码一次，之后逐个元素比较字节；每个元素只看一次编码头
+    Encoded e = encode(value);
+    const unsigned char* p = lp_ + HEADER_SIZE;
+    while (*p != LP_EOF) {
+        if (sameBytes(p, e)) return static_cast<size_t>(p - lp_);
+        p += entryLen(p);
+        for (unsigned i = 0; i < skip && *p != LP_EOF; ++i) p += entryLen(p);
+    }
+    return NPOS;
+}
+
+// ========== 修改 ==========
+
+size_t Listpack::insert(size_t pos, std::string_view value) {
+    return insert(pos, &value, 1);
+}
+
+size_t Listpack::insert(size_t pos, const std::string_view* values, size_t n) {
+    if (pos == NPOS) pos = bytes() - 1; // EOF 处
+    size_t first_pos = pos;
+
+    // 每批先编码、算出总长度，只 realloc 和 memmove 一次
+    constexpr size_t BATCH = 8;
+    Encoded encoded[BATCH];
+    std::string copy;
+    while (n > 0) {
+        size_t old_bytes = bytes();
+        const char* begin = reinterpret_cast<const char*>(lp_);
+        size_t batch = 0;
+        size_t total = 0;
+        while (batch < std::min(n, BATCH)) {
+            std::string_view value = values[batch];
+            bool inside = value.data() >= begin && value.data() < begin + old_bytes;
+            // 指向本列表内部的 value 在 realloc 后失效：拷出来，单独成一批
+            if (inside && batch > 0) break;
+            if (inside) {
+                copy.assign(value);
+                value = copy;
+            }
+            encoded[batch] = encode(value);
+            total += encoded[batch].totalLen();
+            ++batch;
+            if (inside) break;
+        }
+
+        size_t count = size();
+        resize(old_bytes + total);
+        std::memmove(lp_ + pos + total, lp_ + pos, old_bytes - pos);
+        for (size_t i = 0; i < batch; ++i) {
+            encoded[i].write(lp_ + pos);
+            pos += encoded[i].totalLen();
+        }
+        setCount(count + batch);
+        values += batch;
+        n -= batch;
+    }
+    return first_pos;
+}
+
+size_t Listpack::replace(size_t pos, std::string_view value) {
+    size_t old_bytes = bytes();
+    size_t old_len = entrySize(pos);
+
+    Encoded e = encode(value);
+    std::string copy;
+    if (e.data_len && e.data >= reinterpret_cast<const char*>(lp_) &&
+        e.data < reinterpret_cast<const char*>(lp_ + old_bytes)) {
+        copy.assign(e.data, e.data_len);
+        e.data = copy.data();
+    }
+
+    size_t new_len = e.totalLen();
+    size_t tail = pos + old_len;
+    if (new_len > old_len) {
+        resize(old_bytes + new_len - old_len);
+        std::memmove(lp_ + pos + new_len, lp_ + tail, old_bytes - tail);
+    } else if (new_len < old_len) {
+        std::memmove(lp_ + pos + new_len, lp_ + tail, old_bytes - tail);
+        resize(old_bytes - (old_len - new_len));
+    }
+    e.write(lp_ + pos);
+    return pos;
+}
+
+size_t Listpack::erase(size_t pos, size_t count) {
+    if (pos == NPOS || count == 0) return pos;
+    size_t total = size();
+    size_t end = pos;
+    size_t removed = 0;
+    while (removed < count && lp_[end] != LP_EOF) {
+        end += entrySize(end);
+        ++removed;
+    }
+    size_t old_bytes = bytes();
+    std::memmove(lp_ + pos, lp_ + end, old_bytes - end);
+    resize(old_bytes - (end - pos));
+    setCount(total - removed);
+    return lp_[pos] == LP_EOF ? NPOS : pos;
+}
@@ -0,0 +1,80 @@
+// Listpack.hpp
+#pragma once
+#include <string_view>
+#include <cstddef>
+#include <cstdint>
+
+// 紧凑列表（与 Redis listpack 相同的格式），整个列表是一块连续内存：
+//   <总字节数 u32> <元素数 u16> <元素> ... <元素> <0xFF>
+// 每个元素为 <编码+数据> <backlen>：
+// - 能严格解析为整数的值按整数存（1~9 字节），其余存为带长度前缀的字符串
+// - backlen 是本元素 <编码+数据> 的长度（1~5 字节，从后往前读），用于反向遍历；
+//   每个元素只记录自己的长度，插入删除不会像 ziplist 那样级联更新后面的元素
+// 位置用字节偏移表示（realloc 后仍有效），NPOS 表示不存在
+// 所有修改操作都会使之前取得的 string_view 失效
+class Listpack {
+public:
+    static constexpr size_t NPOS = static_cast<size_t>(-1);
+    // get() 格式化整数需要的缓冲区大小
+    static constexpr size_t INT_BUF_SIZE = 21;
+
+    Listpack();
+    ~Listpack();
+
+    Listpack(const Listpack&) = delete;
+    Listpack& operator=(const Listpack&) = delete;
+    Listpack(Listpack&& other) noexcept;
+    Listpack& operator=(Listpack&& other) noexcept;
+
+    size_t size() const;       // 元素数
+    size_t bytes() const;      // 整块内存的字节数
+    bool empty() const;
+
+    // --- 遍历 ---
+    size_t first() const;
+    size_t last() const;
+    size_t next(size_t pos) const;
+    size_t prev(size_t pos) const;
+    // 按下标定位，负数从尾部数起（-1 为最后一个）
+    size_t seek(long long index) const;
+
+    // --- 读取 ---
+    // 整数元素格式化到 buf（至少 INT_BUF_SIZE 字节），字符串元素直接指向列表内
+    std::string_view get(size_t pos, char* buf) const;
+    // 元素是整数时写入 out 并返回 true
+    bool getInteger(size_t pos, long long& out) const;
+    // 比较元素与 value 是否相等（整数按编码后的字节比较，不用格式化）
+    bool equals(size_t pos, std::string_view value) const;
+    // 从 first() 开始查找 value，每比较一个元素后跳过 skip 个（hash 中 skip=1 只比较 field）
+    size_t find(std::string_view value, unsigned skip = 0) const;
+
+    // --- 修改 ---
+    // 在 pos 之前插入（pos 为 NPOS 时追加到尾部），返回新元素的位置
+    size_t insert(size_t pos, std::string_view value);
+    // 一次插入多个（按顺序），只 realloc 一次，返回第一个新元素的位置
+    size_t insert(size_t pos, const std::string_view* values, size_t n);
+    size_t append(std::string_view value) { return insert(NPOS, value); }
+    size_t prepend(std::string_view value) { return insert(first(), value); }
+    // 替换 pos 处的元素，返回其位置（不变）
+    size_t replace(size_t pos, std::string_view value);
+    // 从 pos 开始删除 count 个元素，返回原来紧跟其后的元素的位置（没有则 NPOS）
+    size_t erase(size_t pos, size_t count = 1);
+    void clear();
+
+    // --- 底层内存块（quicklist 压缩节点用）---
+    const unsigned char* data() const { return lp_; }
+    // 交出内存块（memAlloc 分配，由调用方 memFree），之后对象处于移动后的状态，只能析构或重新赋值
+    unsigned char* release();
+    // 接管 release() 交出的（或内容相同的）内存块
+    static Listpack adopt(unsigned char* raw);
+
+private:
+    explicit Listpack(unsigned char* raw) : lp_(raw) {}
+
+    unsigned char* lp_;
+
+    void setBytes(size_t bytes);
+    void setCount(size_t count);
+    void resize(size_t bytes);
+    size_t entrySize(size_t pos) const;
+};
@@ -0,0 +1,135 @@
+// Lzf.cpp
+#include "Lzf.hpp"
+#include <cstdint>
+#include <cstring>
+
+namespace {
+
+constexpr unsigned HLOG = 13;                 // 哈希表 8K 项
+constexpr size_t MAX_LIT = 32;                // 一段字面量最多 32 字节
+constexpr size_t MAX_OFF = 1 << 13;           // 回引用最远 8KB
+constexpr size_t MAX_REF = (1 << 8) + (1 << 3); // 回引用最长 264 字节
+
+inline uint32_t hash3(const unsigned char* p) {
+    uint32_t v = uint32_t(p[0]) << 16 | uint32_t(p[1]) << 8 | p[2];
+    return (v * 2654435761u) >> (32 - HLOG);
+}
+
+} // namespace
+
+size_t lzfCompress(const void* in, size_t in_len, void* out, size_t out_len) {
+    // 表项是上一次见到同样 3 字节的位置；表不清零，旧内容只会被下面的字节比较淘汰
+    thread_local uint32_t htab[1u << HLOG];
+
+    const auto* ip = static_cast<const unsigned char*>(in);
+    const auto* in_end = ip + in_len;
+    auto* op = static_cast<unsigned char*>(out);
+    auto* out_end = op + out_len;
+    const auto* base = ip;
+
+    if (in_len == 0 || out_len < 2) return 0;
+
+    size_t lit = 0; // 当前字面量段的长度，段首的控制字节预留在 op[-lit-1]
+    op++;
+
+    while (ip + 2 < in_end) {
+        uint32_t& slot = htab[hash3(ip)];
+        const unsigned char* ref = base + slot;
+        slot = static_cast<uint32_t>(ip - base);
+
+        size_t off;
+        if (ref < ip && (off = static_cast<size_t>(ip - ref - 1)) < MAX_OFF &&
+            ref[0] == ip[0] && ref[1] == ip[1] && ref[2] == ip[2]) {
+            size_t max_len = static_cast<size_t>(in_end - ip);
+            if (max_len > MAX_REF) max_len = MAX_REF;
+            size_t len = 3;
+            while (len < max_len && ref[len] == ip[len]) ++len;
+
+            // 结束当前字面量段（空段收回预留的控制字节），写回引用，再预留下一段的控制字节
+            if (op + 3 + 1 >= out_end) return 0;
+            if (lit) {
+                op[-static_cast<ptrdiff_t>(lit) - 1] = static_cast<unsigned char>(lit - 1);
+            } else {
+                op--;
+            }
+            size_t l = len - 2;
+            if (l < 7) {
+                *op++ = static_cast<unsigned char>((off >> 8) + (l << 5));
+            } else {
+                *op++ = static_cast<unsigned char>((off >> 8) + (7 << 5));
+                *op++ = static_cast<unsigned char>(l - 7);
+            }
+            *op++ = static_cast<unsigned char>(off & 0xFF);
+            lit = 0;
+            op++;
+
+            ip += len;
+            // 匹配段最后两个位置也登记进表，提高后面的命中率
+            if (ip + 2 < in_end) {
+                htab[hash3(ip - 2)] = static_cast<uint32_t>(ip - 2 - base);
+                htab[hash3(ip - 1)] = static_cast<uint32_t>(ip - 1 - base);
+            }
+            continue;
+        }
+
+        if (op >= out_end) return 0;
+        *op++ = *ip++;
+        if (++lit == MAX_LIT) {
+            op[-static_cast<ptrdiff_t>(lit) - 1] = static_cast<unsigned char>(MAX_LIT - 1);
+            lit = 0;
+            op++;
+        }
+    }
+
+    // 最后不足 3 字节的部分按字面量输出
+    while (ip < in_end) {
+        if (op >= out_end) return 0;
+        *op++ = *ip++;
+        if (++lit == MAX_LIT) {
+            op[-static_cast<ptrdiff_t>(lit) - 1] = static_cast<unsigned char>(MAX_LIT - 1);
+            lit = 0;
+            op++;
+        }
+    }
+    if (lit) {
+        op[-static_cast<ptrdiff_t>(lit) - 1] = static_cast<unsigned char>(lit - 1);
+    } else {
+        op--;
+    }
+    if (op > out_end) return 0;
+    return static_cast<size_t>(op - static_cast<unsigned char*>(out));
+}
+
+size_t lzfDecompress(const void* in, size_t in_len, void* out, size_t out_len) {
+    const auto* ip = static_cast<const unsigned char*>(in);
+    const auto* in_end = ip + in_len;
+    auto* op = static_cast<unsigned char*>(out);
+    auto* out_begin = op;
+    auto* out_end = op + out_len;
+
+    while (ip < in_end) {
+        unsigned ctrl = *ip++;
+        if (ctrl < MAX_LIT) {
+            size_t len = ctrl + 1;
+            if (op + len > out_end || ip + len > in_end) return 0;
+            std::memcpy(op, ip, len);
+            op += len;
+            ip += len;
+        } else {
+            size_t len = ctrl >> 5;
+            if (len == 7) {
+                if (ip >= in_end) return 0;
+                len += *ip++;
+            }
+            len += 2;
+            if (ip >= in_end) return 0;
+            size_t back = ((ctrl & 0x1F) << 8) + *ip++ + 1;
+            if (back > static_cast<size_t>(op - out_begin) || op + len > out_end) return 0;
+            // 源和目标可能重叠（重复模式），逐字节复制
+            const unsigned char* ref = op - back;
+            for (size_t i = 0; i < len; ++i) op[i] = ref[i];
+            op += len;
+        }
+    }
+    return static_cast<size_t>(op - out_begin);
+}
@@ -0,0 +1,13 @@
+// Lzf.hpp
+#pragma once
+#include <cstddef>
+
+// LZF 格式的轻量压缩（与 Redis quicklist 压缩节点用的是同一种格式），压缩/解压都只用一趟：
+// - 字面量段：控制字节 000LLLLL，后跟 L+1 个原样字节
+// - 回引用：控制字节 LLLOOOOO [附加长度] 低 8 位偏移，表示复制前面 O+1 字节处的 L+2 个字节
+//   （L 为 7 时长度再加上附加字节）；最远回看 8KB，最长匹配 264 字节
+// 压缩结果放不进 out_len 时返回 0（调用方按"不值得压缩"处理）
+size_t lzfCompress(const void* in, size_t in_len, void* out, size_t out_len);
+
+// 返回解压后的长度；数据损坏或 out_len 不够时返回 0
+size_t lzfDecompress(const void* in, size_t in_len, void* out, size_t out_len);
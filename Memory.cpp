@@ -0,0 +1,367 @@
+// Memory.cpp
+#include "Memory.hpp"
+#include <malloc.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+
+namespace {
+
+// usedMemory() 每条写命令都会读一次，槽位不宜多（分片数、I/O 线程数通常在这以内）
+constexpr int MAX_THREAD_SLOTS = 16;
+
+struct alignas(64) Slot {
+    std::atomic<long long> bytes{0};
+};
+
+Slot g_slots[MAX_THREAD_SLOTS];
+std::atomic<int> g_next_slot{0};
+std::atomic<size_t> g_peak{0};
+
+// 线程第一次分配时取一个槽位；线程数超过槽位数时共用（原子加，结果仍然正确）
+Slot& threadSlot() {
+    thread_local int slot = -1;
+    if (slot < 0) {
+        slot = g_next_slot.fetch_add(1, std::memory_order_relaxed) % MAX_THREAD_SLOTS;
+    }
+    return g_slots[slot];
+}
+
+inline void countBytes(long long delta) {
+    threadSlot().bytes.fetch_add(delta, std::memory_order_relaxed);
+}
+
+#ifndef MINI_REDIS_NO_SLAB
+
+// ================== 小对象分配器 ==================
+// 不超过 SMALL_MAX 字节的请求按尺寸分级，从 64KB 的 slab 里切块：
+// - 启动时保留一段连续的虚拟地址（MAP_NORESERVE，用到的页才占物理内存），slab 从中顺序切出，
+//   旁表记录每个 slab 的分级；释放时按地址判断是否属于这段区域，块本身不带头部
+// - 每个线程一份空闲链表和当前 slab 的切分位置，分配 / 释放都不加锁；
+//   块在哪个线程释放就挂到哪个线程的链表上，之后由该线程复用；只释放不分配的线程（后台释放）
+//   调用 memReleaseThreadCache 把链表按批交到公共池，其他线程本地没有空闲块时先从池里取一批
+// - 块不会还给操作系统（与 Redis 不主动 purge 时的 jemalloc 类似），RSS 按历史峰值保持
+// - 区域用完或保留失败时退回 malloc
+constexpr size_t SMALL_MAX = 512;
+constexpr int CLASS_COUNT = 20;
+constexpr size_t SLAB_SIZE = 64 * 1024;
+constexpr size_t REGION_MAX = size_t(64) << 30;
+constexpr size_t REGION_MIN = size_t(1) << 30;
+
+// 16..256 每 16 字节一级，之后 320 / 384 / 448 / 512
+inline int classIndex(size_t size) {
+    if (size == 0) size = 1;
+    return size <= 256 ? static_cast<int>((size + 15) / 16) - 1 : 11 + static_cast<int>((size + 63) / 64);
+}
+
+inline size_t classSize(int cls) {
+    return cls < 16 ? size_t(cls + 1) * 16 : size_t(cls - 11) * 64;
+}
+
+struct Region {
+    char* base = nullptr;
+    size_t size = 0;
+    uint8_t* classes = nullptr;  // 每个 slab 一个字节
+    std::atomic<size_t> carved{0};
+};
+
+// 第一次切 slab 时初始化；释放时用下面三个做范围判断和查分级（未初始化时为空区间）
+std::atomic<char*> g_region_base{nullptr};
+std::atomic<char*> g_region_end{nullptr};
+std::atomic<uint8_t*> g_region_classes{nullptr};
+
+Region& region() {
+    static Region* r = [] {
+        static Region reg;
+        for (size_t size = REGION_MAX; size >= REGION_MIN; size /= 2) {
+            void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+            if (base == MAP_FAILED) continue;
+            void* classes = mmap(nullptr, size / SLAB_SIZE, PROT_READ | PROT_WRITE,
+                                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+            if (classes == MAP_FAILED) {
+                munmap(base, size);
+                continue;
+            }
+            reg.base = static_cast<char*>(base);
+            reg.size = size;
+            reg.classes = static_cast<uint8_t*>(classes);
+            g_region_classes.store(reg.classes, std::memory_order_relaxed);
+            g_region_end.store(reg.base + size, std::memory_order_relaxed);
+            g_region_base.store(reg.base, std::memory_order_release);
+            break;
+        }
+        return &reg;
+    }();
+    return *r;
+}
+
+struct FreeBlock {
+    FreeBlock* next;
+    FreeBlock* next_batch;  // 只在公共池中使用：下一批的第一块
+};
+
+// 公共池：每级一个批次栈，每批最多 DEPOT_BATCH 块。加锁期间不分配内存
+constexpr size_t DEPOT_BATCH = 256;
+
+struct Depot {
+    std::mutex mutex;
+    FreeBlock* batches[CLASS_COUNT] = {};
+    std::atomic<bool> nonempty[CLASS_COUNT] = {};  // 不加锁先看一眼
+};
+Depot g_depot;
+
+// fork（BGSAVE）时其他线程可能正持有池的锁，而子进程里没有那个线程，锁永远不会释放：
+// fork 前先拿到锁，父子进程各自解锁
+struct DepotForkGuard {
+    DepotForkGuard() {
+        pthread_atfork([] { g_depot.mutex.lock(); }, [] { g_depot.mutex.unlock(); },
+                       [] { g_depot.mutex.unlock(); });
+    }
+};
+DepotForkGuard g_depot_fork_guard;
+
+FreeBlock* depotPop(int cls) {
+    if (!g_depot.nonempty[cls].load(std::memory_order_relaxed)) return nullptr;
+    std::lock_guard<std::mutex> lock(g_depot.mutex);
+    FreeBlock* batch = g_depot.batches[cls];
+    if (!batch) return nullptr;
+    g_depot.batches[cls] = batch->next_batch;
+    if (!batch->next_batch) g_depot.nonempty[cls].store(false, std::memory_order_relaxed);
+    return batch;
+}
+
+// 全零初始化、平凡析构：访问 thread_local 不需要初始化检查。线程退出时缓存里的块不再被复用
+struct ThreadCache {
+    FreeBlock* free[CLASS_COUNT];
+    char* bump[CLASS_COUNT];
+    char* bump_end[CLASS_COUNT];
+};
+thread_local ThreadCache t_cache;
+
+// 新切一个 slab，返回其中第一块；区域用完返回 nullptr
+void* refill(ThreadCache& cache, int cls) {
+    Region& r = region();
+    if (!r.base) return nullptr;
+    size_t offset = r.carved.fetch_add(SLAB_SIZE, std::memory_order_relaxed);
+    if (offset + SLAB_SIZE > r.size) return nullptr;
+
+    char* slab = r.base + offset;
+    r.classes[offset / SLAB_SIZE] = static_cast<uint8_t>(cls);
+    size_t block = classSize(cls);
+    cache.bump[cls] = slab + block;
+    cache.bump_end[cls] = slab + (SLAB_SIZE / block) * block;
+    return slab;
+}
+
+inline void* slabAlloc(int cls) {
+    ThreadCache& cache = t_cache;
+    if (FreeBlock* block = cache.free[cls]) {
+        cache.free[cls] = block->next;
+        return block;
+    }
+    if (cache.bump[cls] != cache.bump_end[cls]) {
+        char* p = cache.bump[cls];
+        cache.bump[cls] += classSize(cls);
+        return p;
+    }
+    if (FreeBlock* batch = depotPop(cls)) {
+        cache.free[cls] = batch->next;
+        return batch;
+    }
+    return refill(cache, cls);
+}
+
+inline void slabFree(void* p, int cls) {
+    ThreadCache& cache = t_cache;
+    auto* block = static_cast<FreeBlock*>(p);
+    block->next = cache.free[cls];
+    cache.free[cls] = block;
+}
+
+// 不属于 slab 区域返回 -1
+inline int slabClassOf(const void* p) {
+    const char* c = static_cast<const char*>(p);
+    char* base = g_region_base.load(std::memory_order_acquire);
+    if (c < base || c >= g_region_end.load(std::memory_order_relaxed)) return -1;
+    return g_region_classes.load(std::memory_order_relaxed)[static_cast<size_t>(c - base) / SLAB_SIZE];
+}
+
+void releaseThreadCache() {
+    ThreadCache& cache = t_cache;
+    for (int cls = 0; cls < CLASS_COUNT; ++cls) {
+        FreeBlock* block = cache.free[cls];
+        if (!block) continue;
+        cache.free[cls] = nullptr;
+        // 按批切开后串成批次栈，最后一次性挂到池上
+        FreeBlock* first = nullptr;
+        FreeBlock* last = nullptr;
+        while (block) {
+            FreeBlock* batch = block;
+            for (size_t n = 1; n < DEPOT_BATCH && block->next; ++n) block = block->next;
+            FreeBlock* rest = block->next;
+            block->next = nullptr;
+            block = rest;
+            batch->next_batch = nullptr;
+            if (last) {
+                last->next_batch = batch;
+            } else {
+                first = batch;
+            }
+            last = batch;
+        }
+        std::lock_guard<std::mutex> lock(g_depot.mutex);
+        last->next_batch = g_depot.batches[cls];
+        g_depot.batches[cls] = first;
+        g_depot.nonempty[cls].store(true, std::memory_order_relaxed);
+    }
+}
+
+#else
+
+inline int slabClassOf(const void*) { return -1; }
+
+#endif // MINI_REDIS_NO_SLAB
+
+// 分配并计入；失败返回 nullptr
+void* rawAlloc(size_t size) {
+#ifndef MINI_REDIS_NO_SLAB
+    if (size <= SMALL_MAX) {
+        int cls = classIndex(size);
+        if (void* p = slabAlloc(cls)) {
+            countBytes(static_cast<long long>(classSize(cls)));
+            return p;
+        }
+    }
+#endif
+    void* p = std::malloc(size ? size : 1);
+    if (p) countBytes(static_cast<long long>(malloc_usable_size(p)));
+    return p;
+}
+
+void rawFree(void* p) {
+    if (!p) return;
+#ifndef MINI_REDIS_NO_SLAB
+    int cls = slabClassOf(p);
+    if (cls >= 0) {
+        countBytes(-static_cast<long long>(classSize(cls)));
+        slabFree(p, cls);
+        return;
+    }
+#endif
+    countBytes(-static_cast<long long>(malloc_usable_size(p)));
+    std::free(p);
+}
+
+} // namespace
+
+size_t usedMemory() {
+    long long total = 0;
+    for (const Slot& slot : g_slots) total += slot.bytes.load(std::memory_order_relaxed);
+    return total > 0 ? static_cast<size_t>(total) : 0;
+}
+
+size_t usedMemoryPeak() {
+    size_t used = usedMemory();
+    size_t peak = g_peak.load(std::memory_order_relaxed);
+    while (used > peak && !g_peak.compare_exchange_weak(peak, used, std::memory_order_relaxed)) {
+    }
+    return used > peak ? used : peak;
+}
+
+size_t residentMemory() {
+    // 第二列是常驻页数
+    FILE* fp = std::fopen("/proc/self/statm", "r");
+    if (!fp) return 0;
+    unsigned long pages = 0;
+    int n = std::fscanf(fp, "%*s %lu", &pages);
+    std::fclose(fp);
+    if (n != 1) return 0;
+    return static_cast<size_t>(pages) * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+void memReleaseThreadCache() {
+#ifndef MINI_REDIS_NO_SLAB
+    releaseThreadCache();
+#endif
+}
+
+size_t memUsableSize(void* ptr) {
+    if (!ptr) return 0;
+#ifndef MINI_REDIS_NO_SLAB
+    int cls = slabClassOf(ptr);
+    if (cls >= 0) return classSize(cls);
+#endif
+    return malloc_usable_size(ptr);
+}
+
+size_t privateDirtyMemory() {
+    // smaps_rollup 已汇总（Linux 4.14+）；没有时逐个映射累加 smaps
+    FILE* fp = std::fopen("/proc/self/smaps_rollup", "r");
+    if (!fp) fp = std::fopen("/proc/self/smaps", "r");
+    if (!fp) return 0;
+    char line[256];
+    size_t total_kb = 0;
+    while (std::fgets(line, sizeof(line), fp)) {
+        unsigned long kb;
+        if (std::sscanf(line, "Private_Dirty: %lu kB", &kb) == 1) total_kb += kb;
+    }
+    std::fclose(fp);
+    return total_kb * 1024;
+}
+
+void* memAlloc(size_t size) {
+    void* p = rawAlloc(size);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* memRealloc(void* ptr, size_t size) {
+    if (!ptr) return rawAlloc(size);
+#ifndef MINI_REDIS_NO_SLAB
+    // slab 块：仍落在同一级时原样返回，否则搬到新块（可能是 malloc）
+    int cls = slabClassOf(ptr);
+    if (cls >= 0) {
+        if (size <= SMALL_MAX && classIndex(size) == cls) return ptr;
+        void* p = rawAlloc(size);
+        if (!p) return nullptr;
+        std::memcpy(p, ptr, std::min(size, classSize(cls)));
+        rawFree(ptr);
+        return p;
+    }
+#endif
+    // realloc(ptr, 0) 会释放 ptr 并返回 NULL，与"失败时原内存块不变"矛盾
+    size_t old_size = malloc_usable_size(ptr);
+    void* p = std::realloc(ptr, size ? size : 1);
+    if (!p) return nullptr;
+    countBytes(static_cast<long long>(malloc_usable_size(p)) - static_cast<long long>(old_size));
+    return p;
+}
+
+void memFree(void* ptr) {
+    rawFree(ptr);
+}
+
+// ================== 全局 operator new / delete ==================
+// 数组、nothrow、sized 版本在 libstdc++ 中都转发到这两个；对齐版本不经过这里，也不计入
+
+void* operator new(size_t size) {
+    void* p = rawAlloc(size);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    rawFree(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    rawFree(p);
+}
@@ -0,0 +1,35 @@
+// Memory.hpp
+#pragma once
+#include <cstddef>
+
+// 内存计数（对应 Redis zmalloc 的 used_memory）
+// - 替换全局 operator new / delete，按块的实际大小累加 / 扣减，读取是 O(1)，
+//   淘汰策略每条写命令前都可以检查
+// - 不超过 512 字节的请求走按尺寸分级的 slab 分配器（线程本地空闲链表，见 Memory.cpp），
+//   dict 节点、短字符串、链表 / 跳表节点、小 listpack 都在这里；更大的走 malloc。
+//   构建时 -DMINI_REDIS_SLAB=OFF 可关闭（例如用 ASan 检查时）
+// - 直接用 malloc 管理内存块的结构（listpack / intset / quicklist 的压缩节点）改用下面的
+//   memAlloc / memRealloc / memFree，同样计入
+// - 每个线程累加到自己的槽位（按缓存行对齐），避免各分片争用同一个计数器；
+//   在另一个线程释放时对方槽位会变成负数，总和仍然正确
+size_t usedMemory();
+// 用 usedMemory() 更新并返回峰值（定时任务和 INFO 调用，不在每次分配时比较）
+size_t usedMemoryPeak();
+// 进程的常驻内存（/proc/self/statm），读取失败返回 0
+size_t residentMemory();
+// 进程私有的脏页字节数（/proc/self/smaps_rollup 的 Private_Dirty）。BGSAVE 子进程里调用：
+// fork 后父子共享的页被任何一方写过就会复制，子进程这边的副本计入这里，即写时复制的量。
+// 需要遍历页表，不适合频繁调用；读取失败返回 0
+size_t privateDirtyMemory();
+
+// 块的实际可用字节数（slab 块按所在分级，其余同 malloc_usable_size）
+size_t memUsableSize(void* ptr);
+
+void* memAlloc(size_t size);
+// 失败返回 nullptr，原内存块不变（与 realloc 相同）
+void* memRealloc(void* ptr, size_t size);
+void memFree(void* ptr);
+
+// 把本线程缓存的空闲小块交到公共池，供其他线程复用。
+// 只释放不分配的线程（后台释放线程）每做完一批释放后调用，否则这些块只能留给它自己
+void memReleaseThreadCache();
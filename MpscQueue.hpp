@@ -0,0 +1,80 @@
+// MpscQueue.hpp
+#pragma once
+#include <atomic>
+#include <utility>
+
+// 无锁多生产者单消费者队列（Vyukov 侵入式 MPSC 算法）
+// - push 可在任意线程调用，只有一次原子 exchange，无 CAS 循环
+// - pop 只能由唯一的消费者线程调用
+// - 生产者 push 了一半时（已 exchange、尚未链接 next），pop 暂时看不到该元素，
+//   消费者稍后重试即可（调用方会收到该生产者随后发出的唤醒）
+template <typename T>
+class MpscQueue {
+public:
+    MpscQueue() : head_(&stub_), tail_(&stub_) {}
+
+    ~MpscQueue() {
+        T tmp;
+        while (pop(tmp)) {}
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    void push(T value) {
+        Node* node = new Node(std::move(value));
+        pushNode(node);
+    }
+
+    bool pop(T& out) {
+        Node* tail = tail_;
+        Node* next = tail->next.load(std::memory_order_acquire);
+
+        if (tail == &stub_) {
+            if (next == nullptr) return false; // 队列为空
+            tail_ = next;
+            tail = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+
+        if (next != nullptr) {
+            tail_ = next;
+            out = std::move(tail->value);
+            delete tail;
+            return true;
+        }
+
+        // tail 是最后一个节点：若还有生产者正在入队，先等它完成
+        if (tail != head_.load(std::memory_order_acquire)) return false;
+
+        // 重新放入 stub，使 tail 可以被安全取出
+        pushNode(&stub_);
+        next = tail->next.load(std::memory_order_acquire);
+        if (next != nullptr) {
+            tail_ = next;
+            out = std::move(tail->value);
+            delete tail;
+            return true;
+        }
+        return false;
+    }
+
+private:
+    struct Node {
+        std::atomic<Node*> next{nullptr};
+        T value;
+
+        Node() = default;
+        explicit Node(T v) : value(std::move(v)) {}
+    };
+
+    void pushNode(Node* node) {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        Node* prev = head_.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    std::atomic<Node*> head_; // 生产者端
+    Node* tail_;              // 消费者端
+    Node stub_;
+};
@@ -1,67 +1,353 @@
 // Protocol.cpp
 #include "Protocol.hpp"
+#include "IoBuffer.hpp"
+#include <algorithm>
 #include <cctype>
+#include <cerrno>
+#include <climits>
+#include <cmath>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
 
 // 辅助：跳过空白（RESP 不允许空格，但安全起见）
-static size_t skipWhitespace(const std::string& s, size_t pos) {
+static size_t skipWhitespace(std::string_view s, size_t pos) {
     while (pos < s.size() && std::isspace(static_cast<unsigned char>(s[pos]))) ++pos;
     return pos;
 }
 
-RespParser::ParseResult RespParser::parse(const std::string& input, std::vector<std::string>& args) {
-    args.clear();
-    size_t pos = 0;
-    pos = skipWhitespace(input, pos);
-    if (pos >= input.size()) return ParseResult::INCOMPLETE;
+// 辅助：解析 "<prefix><integer>\r\n" 头部（prefix 为 '*' 或 '$'）
+// 不依赖 '\0' 结尾（atoi 需要），直接在视图上逐字节累加
+// 返回 INCOMPLETE / ERROR / COMPLETE，成功时 pos 指向 "\r\n" 之后
+static RespParser::ParseResult parseHeader(std::string_view s, size_t& pos, long long& out) {
+    const char* begin = s.data() + pos + 1; // 跳过前缀字符
+    const char* end = s.data() + s.size();
+    const char* cr = static_cast<const char*>(std::memchr(begin, '\r', end - begin));
+    if (cr == nullptr || cr + 1 >= end) return RespParser::ParseResult::INCOMPLETE;
+    if (cr[1] != '\n' || cr == begin) return RespParser::ParseResult::ERROR;
 
-    if (input[pos] != '*') {
-        return ParseResult::ERROR; // 只支持数组格式（redis-cli 默认发数组）
+    const char* p = begin;
+    bool negative = false;
+    if (*p == '-') {
+        negative = true;
+        ++p;
+        if (p == cr) return RespParser::ParseResult::ERROR;
+    }
+    long long value = 0;
+    for (; p < cr; ++p) {
+        if (*p < '0' || *p > '9') return RespParser::ParseResult::ERROR;
+        value = value * 10 + (*p - '0');
+        if (value > RespParser::MAX_BULK_LEN) return RespParser::ParseResult::ERROR;
     }
+    out = negative ? -value : value;
+    pos = static_cast<size_t>(cr + 2 - s.data());
+    return RespParser::ParseResult::COMPLETE;
+}
+
+RespParser::ParseResult RespParser::parse(std::string_view input,
+                                          std::vector<std::string_view>& args, size_t& consumed) {
+    args.clear();
+    consumed = 0;
 
-    // 解析 "*<number>\r\n"
-    size_t end = input.find("\r\n", pos);
-    if (end == std::string::npos) return ParseResult::INCOMPLETE;
+    if (multibulk_len_ < 0) {
+        size_t pos = skipWhitespace(input, 0);
+        if (pos >= input.size()) return ParseResult::INCOMPLETE;
+
+        if (input[pos] != '*') {
+            return ParseResult::ERROR; // 只支持数组格式（redis-cli 默认发数组）
+        }
 
-    int argc = std::atoi(input.c_str() + pos + 1);
-    if (argc < 0) return ParseResult::ERROR;
-    if (argc == 0) {
-        // 空命令
-        return ParseResult::COMPLETE;
+        // 解析 "*<number>\r\n"
+        long long argc = 0;
+        auto res = parseHeader(input, pos, argc);
+        if (res != ParseResult::COMPLETE) return res; // 头部很短，不完整时下次重扫即可
+        if (argc < 0 || argc > MAX_MULTIBULK_LEN) return ParseResult::ERROR;
+
+        multibulk_len_ = argc;
+        pos_ = pos;
+        arg_spans_.clear();
+        // 头部的个数不可信（一个 "*1048576\r\n" 就要预留 16MB），只预留有限的部分
+        arg_spans_.reserve(static_cast<size_t>(std::min(argc, MAX_ARGS_RESERVE)));
     }
 
-    pos = end + 2; // 跳过 "\r\n"
+    while (arg_spans_.size() < static_cast<size_t>(multibulk_len_)) {
+        if (bulk_len_ < 0) {
+            if (pos_ >= input.size()) return ParseResult::INCOMPLETE;
+            if (input[pos_] != '$') {
+                reset();
+                return ParseResult::ERROR;
+            }
 
-    for (int i = 0; i < argc; ++i) {
-        if (pos >= input.size()) return ParseResult::INCOMPLETE;
-        if (input[pos] != '$') return ParseResult::ERROR;
-
-        end = input.find("\r\n", pos);
-        if (end == std::string::npos) return ParseResult::INCOMPLETE;
-
-        int len = std::atoi(input.c_str() + pos + 1);
-        if (len < -1) return ParseResult::ERROR;
-
-        pos = end + 2; // 跳过 "\r\n"
-
-        if (len == -1) {
-            args.emplace_back(); // null string
-        } else {
-            if (pos + len > input.size()) return ParseResult::INCOMPLETE;
-            args.emplace_back(input.substr(pos, len));
-            pos += len;
-            // 检查是否有 \r\n
-            if (pos + 2 > input.size()) return ParseResult::INCOMPLETE;
-            if (input[pos] != '\r' || input[pos+1] != '\n') return ParseResult::ERROR;
-            pos += 2;
+            size_t pos = pos_;
+            long long len = 0;
+            auto res = parseHeader(input, pos, len);
+            if (res == ParseResult::INCOMPLETE) return res;
+            if (res == ParseResult::ERROR || len < -1) {
+                reset();
+                return ParseResult::ERROR;
+            }
+            pos_ = pos;
+
+            if (len == -1) {
+                arg_spans_.emplace_back(pos_, 0); // null string
+                continue;
+            }
+            bulk_len_ = len;
+        }
+
+        // payload 不完整时只比较长度，O(1)，不扫描已到达的部分
+        size_t n = static_cast<size_t>(bulk_len_);
+        if (pos_ + n + 2 > input.size()) return ParseResult::INCOMPLETE;
+        if (input[pos_ + n] != '\r' || input[pos_ + n + 1] != '\n') {
+            reset();
+            return ParseResult::ERROR;
         }
+        arg_spans_.emplace_back(pos_, n);
+        pos_ += n + 2;
+        bulk_len_ = -1;
     }
 
+    // 直接引用输入缓冲区，不拷贝 payload
+    args.reserve(arg_spans_.size());
+    for (const auto& [offset, len] : arg_spans_) {
+        args.emplace_back(input.data() + offset, len);
+    }
+    consumed = pos_;
+    reset();
     return ParseResult::COMPLETE;
 }
 
+void RespParser::reset() {
+    multibulk_len_ = -1;
+    bulk_len_ = -1;
+    pos_ = 0;
+    arg_spans_.clear();
+}
+
+size_t RespParser::expectedCommandSize() const {
+    if (bulk_len_ < BIG_ARG_LEN) return 0;
+    return pos_ + static_cast<size_t>(bulk_len_) + 2;
+}
+
 // ========== 编码函数 ==========
+// ========== 整数转字符串 ==========
+
+namespace {
+
+// "00" "01" ... "99"：每次查表输出两位，除法次数减半
+constexpr char DIGITS_LUT[201] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+size_t digits10(unsigned long long v) {
+    size_t n = 1;
+    while (true) {
+        if (v < 10) return n;
+        if (v < 100) return n + 1;
+        if (v < 1000) return n + 2;
+        if (v < 10000) return n + 3;
+        v /= 10000;
+        n += 4;
+    }
+}
+
+// 预编码的 "$<n>\r\n" / "*<n>\r\n" 头，覆盖最常见的短 value / 小数组
+constexpr size_t SHARED_HDR_COUNT = 32;
+
+struct SharedHeader {
+    char data[8];
+    size_t len;
+};
+
+struct SharedHeaders {
+    SharedHeader bulk[SHARED_HDR_COUNT];
+    SharedHeader mbulk[SHARED_HDR_COUNT];
+
+    SharedHeaders() {
+        for (size_t i = 0; i < SHARED_HDR_COUNT; ++i) {
+            fill(bulk[i], '$', i);
+            fill(mbulk[i], '*', i);
+        }
+    }
+
+    static void fill(SharedHeader& h, char prefix, size_t n) {
+        h.data[0] = prefix;
+        h.len = 1 + ull2string(h.data + 1, n);
+        h.data[h.len++] = '\r';
+        h.data[h.len++] = '\n';
+    }
+};
+
+const SharedHeaders& sharedHeaders() {
+    static const SharedHeaders headers;
+    return headers;
+}
+
+// 写 "<prefix><n>\r\n"
+void writeHeader(OutputBuffer& out, char prefix, long long n) {
+    char buf[32];
+    buf[0] = prefix;
+    size_t len = 1 + ll2string(buf + 1, n);
+    buf[len++] = '\r';
+    buf[len++] = '\n';
+    out.append(buf, len);
+}
+
+} // namespace
+
+size_t ull2string(char* dst, unsigned long long value) {
+    size_t len = digits10(value);
+    size_t pos = len - 1;
+    while (value >= 100) {
+        size_t i = (value % 100) * 2;
+        value /= 100;
+        dst[pos] = DIGITS_LUT[i + 1];
+        dst[pos - 1] = DIGITS_LUT[i];
+        pos -= 2;
+    }
+    if (value < 10) {
+        dst[pos] = static_cast<char>('0' + value);
+    } else {
+        size_t i = value * 2;
+        dst[pos] = DIGITS_LUT[i + 1];
+        dst[pos - 1] = DIGITS_LUT[i];
+    }
+    return len;
+}
+
+size_t ll2string(char* dst, long long value) {
+    if (value >= 0) return ull2string(dst, static_cast<unsigned long long>(value));
+    // 取反前先转无符号，LLONG_MIN 也不会溢出
+    dst[0] = '-';
+    return 1 + ull2string(dst + 1, 0ULL - static_cast<unsigned long long>(value));
+}
+
+bool string2ll(std::string_view s, long long& value) {
+    if (s.empty() || s.size() > 20) return false;
+    size_t i = 0;
+    bool negative = false;
+    if (s[0] == '-') {
+        negative = true;
+        if (++i == s.size()) return false;
+    }
+    // 首位必须是 1-9，"0" 单独处理
+    if (s[i] == '0') {
+        if (s.size() == 1) {
+            value = 0;
+            return true;
+        }
+        return false;
+    }
+    unsigned long long v = 0;
+    for (; i < s.size(); ++i) {
+        char c = s[i];
+        if (c < '0' || c > '9') return false;
+        unsigned digit = static_cast<unsigned>(c - '0');
+        if (v > (ULLONG_MAX - digit) / 10) return false;
+        v = v * 10 + digit;
+    }
+    if (negative) {
+        if (v > static_cast<unsigned long long>(LLONG_MAX) + 1) return false;
+        value = static_cast<long long>(0ULL - v);
+    } else {
+        if (v > static_cast<unsigned long long>(LLONG_MAX)) return false;
+        value = static_cast<long long>(v);
+    }
+    return true;
+}
+
+size_t d2string(char* dst, double value) {
+    if (std::isinf(value)) {
+        std::string_view s = value > 0 ? "inf" : "-inf";
+        std::memcpy(dst, s.data(), s.size());
+        return s.size();
+    }
+    // 2^53 以内的整数值直接按整数输出
+    if (value == std::trunc(value) && std::fabs(value) < 9007199254740992.0) {
+        return ll2string(dst, static_cast<long long>(value));
+    }
+    // 先试 15 位有效数字（多数十进制输入的分数能还原），不能还原再用 17 位
+    int len = std::snprintf(dst, MAX_D2STRING_CHARS, "%.15g", value);
+    if (std::strtod(dst, nullptr) != value) {
+        len = std::snprintf(dst, MAX_D2STRING_CHARS, "%.17g", value);
+    }
+    return static_cast<size_t>(len);
+}
+
+bool string2d(std::string_view s, double& value) {
+    char buf[MAX_D2STRING_CHARS * 4];
+    if (s.empty() || s.size() >= sizeof(buf) || std::isspace(static_cast<unsigned char>(s[0]))) return false;
+    std::memcpy(buf, s.data(), s.size());
+    buf[s.size()] = '\0';
+    char* end;
+    errno = 0;
+    double v = std::strtod(buf, &end);
+    // 下溢（极小的数）可以接受，上溢和 NaN 不行；字面量 "inf" 不设置 ERANGE
+    if (end != buf + s.size() || std::isnan(v) || (errno == ERANGE && std::isinf(v))) {
+        return false;
+    }
+    value = v;
+    return true;
+}
+
+// ========== 写入输出缓冲区 ==========
+
+void RespParser::writeRaw(OutputBuffer& out, std::string_view s) {
+    out.append(s.data(), s.size());
+}
+
+void RespParser::writeSimpleString(OutputBuffer& out, std::string_view s) {
+    out.append("+", 1);
+    out.append(s.data(), s.size());
+    out.append(shared::CRLF.data(), shared::CRLF.size());
+}
+
+void RespParser::writeBulkString(OutputBuffer& out, std::string_view s) {
+    if (s.size() < SHARED_HDR_COUNT) {
+        const SharedHeader& h = sharedHeaders().bulk[s.size()];
+        out.append(h.data, h.len);
+    } else {
+        writeHeader(out, '$', static_cast<long long>(s.size()));
+    }
+    out.append(s.data(), s.size());
+    out.append(shared::CRLF.data(), shared::CRLF.size());
+}
+
+void RespParser::writeError(OutputBuffer& out, std::string_view msg) {
+    out.append("-ERR ", 5);
+    out.append(msg.data(), msg.size());
+    out.append(shared::CRLF.data(), shared::CRLF.size());
+}
+
+void RespParser::writeInteger(OutputBuffer& out, long long n) {
+    if (n == 0) {
+        writeRaw(out, shared::CZERO);
+    } else if (n == 1) {
+        writeRaw(out, shared::CONE);
+    } else {
+        writeHeader(out, ':', n);
+    }
+}
+
+void RespParser::writeNullBulkString(OutputBuffer& out) {
+    writeRaw(out, shared::NULL_BULK);
+}
+
+void RespParser::writeArrayHeader(OutputBuffer& out, size_t n) {
+    if (n < SHARED_HDR_COUNT) {
+        const SharedHeader& h = sharedHeaders().mbulk[n];
+        out.append(h.data, h.len);
+    } else {
+        writeHeader(out, '*', static_cast<long long>(n));
+    }
+}
+
+// ========== 编码为独立字符串 ==========
+
 std::string RespParser::encodeSimpleString(const std::string& s) {
     return "+" + s + "\r\n";
 }
@@ -75,9 +361,14 @@ std::string RespParser::encodeError(const std::string& msg) {
 }
 
 std::string RespParser::encodeInteger(long long n) {
-    return ":" + std::to_string(n) + "\r\n";
+    char buf[32];
+    buf[0] = ':';
+    size_t len = 1 + ll2string(buf + 1, n);
+    buf[len++] = '\r';
+    buf[len++] = '\n';
+    return std::string(buf, len);
 }
 
 std::string RespParser::encodeNullBulkString() {
-    return "$-1\r\n";
-}
\ No newline at end of file
+    return std::string(shared::NULL_BULK);
+}
@@ -1,8 +1,39 @@
 // Protocol.hpp
 #pragma once
 #include <string>
+#include <string_view>
 #include <vector>
 #include <optional>
+#include <utility>
+#include <cstddef>
+
+class OutputBuffer;
+
+// 预编码的常用响应，直接拷入输出缓冲区，不再每次拼接
+namespace shared {
+inline constexpr std::string_view OK = "+OK\r\n";
+inline constexpr std::string_view PONG = "+PONG\r\n";
+inline constexpr std::string_view CZERO = ":0\r\n";
+inline constexpr std::string_view CONE = ":1\r\n";
+inline constexpr std::string_view NULL_BULK = "$-1\r\n";
+inline constexpr std::string_view EMPTY_ARRAY = "*0\r\n";
+inline constexpr std::string_view NULL_ARRAY = "*-1\r\n";
+inline constexpr std::string_view CRLF = "\r\n";
+inline constexpr std::string_view OOM_ERR = "-OOM command not allowed when used memory > 'maxmemory'.\r\n";
+} // namespace shared
+
+// 表驱动的整数转字符串（每次处理两位），dst 至少 21 字节，返回写入长度，不写 '\0'
+size_t ll2string(char* dst, long long value);
+size_t ull2string(char* dst, unsigned long long value);
+// 严格解析十进制整数：不允许空串、前导 0、"-0"、空白和溢出，
+// 成功时 ll2string(value) 与原字符串完全相同
+bool string2ll(std::string_view s, long long& value);
+// 浮点数格式化为能精确还原的最短形式：整数值不带小数点（"3"），无穷为 "inf" / "-inf"
+// dst 至少 MAX_D2STRING_CHARS 字节，返回写入长度，不写 '\0'
+inline constexpr size_t MAX_D2STRING_CHARS = 32;
+size_t d2string(char* dst, double value);
+// 解析浮点数（接受 "inf" / "-inf" / "+inf"），不允许空串、空白、多余字符和 NaN
+bool string2d(std::string_view s, double& value);
 
 
 class RespParser {
@@ -13,13 +44,50 @@ public:
         ERROR        // 协议错误
     };
 
-    // 解析输入缓冲区，返回结果 + 命令参数（如 {"SET", "key", "val"}）
-    ParseResult parse(const std::string& input, std::vector<std::string>& args);
+    static constexpr long long MAX_MULTIBULK_LEN = 1024 * 1024;      // 单条命令最多参数个数
+    static constexpr long long MAX_BULK_LEN = 512LL * 1024 * 1024;   // 单个参数最大 512MB
+    static constexpr long long MAX_ARGS_RESERVE = 1024;              // 按头部参数个数预留的上限，更多的随参数到达增长
+
+    static constexpr long long BIG_ARG_LEN = 32 * 1024;             // 超过此长度的参数预留缓冲区
+
+    // 解析 input 开头的一条命令，返回结果 + 命令参数（如 {"SET", "key", "val"}）
+    // 零拷贝：args 中的 string_view 直接指向 input（即连接的读缓冲区），
+    // 只在缓冲区被 consumeInput 修改前有效
+    // COMPLETE 时 consumed 为本条命令占用的字节数，调用方据此推进，支持 pipeline
+    //
+    // 可续传：返回 INCOMPLETE 时解析进度（数组长度、已完成参数、当前 bulk 长度）
+    // 保存在解析器中，下次以同一命令起点的 input 调用时从断点继续，不重新扫描。
+    // 因此每个连接应持有自己的 RespParser。
+    ParseResult parse(std::string_view input,
+                      std::vector<std::string_view>& args, size_t& consumed);
 
-    // --- 编码函数（用于构建响应） ---
+    // 丢弃未完成命令的解析进度
+    void reset();
+
+    // 正在等待大参数时，返回当前命令完整到达所需的总字节数（相对命令起点），否则 0
+    // 调用方据此一次性预留读缓冲区，避免大 value 分片到达时反复扩容拷贝
+    size_t expectedCommandSize() const;
+
+    // --- 直接写入输出缓冲区的编码函数（不分配临时 string） ---
+    // 长度头 / 整数走表驱动 itoa，小长度的 "$<n>\r\n" / "*<n>\r\n" 头预先编码
+    static void writeRaw(OutputBuffer& out, std::string_view s); // 已编码的响应，如 shared::OK
+    static void writeSimpleString(OutputBuffer& out, std::string_view s);
+    static void writeBulkString(OutputBuffer& out, std::string_view s);
+    static void writeError(OutputBuffer& out, std::string_view msg);  // "-ERR <msg>"
+    static void writeInteger(OutputBuffer& out, long long n);
+    static void writeNullBulkString(OutputBuffer& out);
+    static void writeArrayHeader(OutputBuffer& out, size_t n);
+
+    // --- 编码函数（构建独立的响应字符串，用于跨分片合并等） ---
     static std::string encodeSimpleString(const std::string& s);
     static std::string encodeBulkString(const std::string& s);
     static std::string encodeError(const std::string& msg);
     static std::string encodeInteger(long long n);
     static std::string encodeNullBulkString(); // "$-1\r\n"
+
+private:
+    long long multibulk_len_ = -1;  // -1：尚未解析 "*<n>" 头
+    long long bulk_len_ = -1;       // -1：尚未解析当前参数的 "$<len>" 头
+    size_t pos_ = 0;                // 已解析到的位置（相对命令起点）
+    std::vector<std::pair<size_t, size_t>> arg_spans_; // 已完成参数的 (offset, len)，缓冲区可能重新分配，故存偏移
 };
\ No newline at end of file
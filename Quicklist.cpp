@@ -0,0 +1,434 @@
+// Quicklist.cpp
+#include "Quicklist.hpp"
+#include "Lzf.hpp"
+#include "Memory.hpp"
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+// fill 为 -1 ~ -5 时每个节点的字节上限
+constexpr size_t FILL_SIZE_LIMITS[] = {4096, 8192, 16384, 32768, 65536};
+
+// 元素编码后大致要多出的字节（编码头 + backlen）
+constexpr size_t ENTRY_OVERHEAD = 11;
+
+Quicklist::Options& defaults() {
+    static Quicklist::Options options;
+    return options;
+}
+
+} // namespace
+
+void Quicklist::setDefaultOptions(const Options& options) {
+    defaults() = options;
+}
+
+const Quicklist::Options& Quicklist::defaultOptions() {
+    return defaults();
+}
+
+Quicklist::Node::~Node() {
+    memFree(compressed);
+}
+
+Quicklist::Quicklist(const Options& options)
+    : fill_(options.fill), compress_depth_(options.compress_depth) {
+    if (fill_ == 0) fill_ = 1;
+    if (fill_ < -5) fill_ = -5;
+    if (compress_depth_ < 0) compress_depth_ = 0;
+}
+
+Quicklist::~Quicklist() {
+    Node* node = head_;
+    while (node) {
+        Node* next = node->next;
+        delete node;
+        node = next;
+    }
+}
+
+Quicklist::Quicklist(Quicklist&& other) noexcept
+    : head_(std::exchange(other.head_, nullptr)),
+      tail_(std::exchange(other.tail_, nullptr)),
+      count_(std::exchange(other.count_, 0)),
+      len_(std::exchange(other.len_, 0)),
+      bytes_(std::exchange(other.bytes_, 0)),
+      fill_(other.fill_),
+      compress_depth_(other.compress_depth_) {}
+
+Quicklist& Quicklist::operator=(Quicklist&& other) noexcept {
+    if (this != &other) {
+        std::swap(head_, other.head_);
+        std::swap(tail_, other.tail_);
+        std::swap(count_, other.count_);
+        std::swap(len_, other.len_);
+        std::swap(bytes_, other.bytes_);
+        fill_ = other.fill_;
+        compress_depth_ = other.compress_depth_;
+    }
+    return *this;
+}
+
+// ================== 节点管理 ==================
+
+bool Quicklist::allowInsert(const Node* node, size_t value_len) const {
+    if (!node) return false;
+    size_t new_bytes = node->bytes() + value_len + ENTRY_OVERHEAD;
+    if (fill_ > 0) {
+        return node->count < static_cast<size_t>(fill_) && new_bytes <= SIZE_SAFETY_LIMIT;
+    }
+    return new_bytes <= FILL_SIZE_LIMITS[-fill_ - 1];
+}
+
+Quicklist::Node* Quicklist::createNode() {
+    return new Node();
+}
+
+void Quicklist::linkAfter(Node* node, Node* new_node) {
+    if (node) {
+        new_node->prev = node;
+        new_node->next = node->next;
+        if (node->next) node->next->prev = new_node;
+        node->next = new_node;
+        if (tail_ == node) tail_ = new_node;
+    } else {
+        new_node->prev = nullptr;
+        new_node->next = head_;
+        if (head_) head_->prev = new_node;
+        head_ = new_node;
+        if (!tail_) tail_ = new_node;
+    }
+    ++len_;
+    bytes_ += storedBytes(new_node);
+}
+
+void Quicklist::unlink(Node* node) {
+    if (node->prev) node->prev->next = node->next;
+    else head_ = node->next;
+    if (node->next) node->next->prev = node->prev;
+    else tail_ = node->prev;
+    --len_;
+    count_ -= node->count;
+    bytes_ -= storedBytes(node);
+    delete node;
+}
+
+Quicklist::Node* Quicklist::locate(size_t index, size_t& offset) const {
+    // 从离得近的一端开始数
+    if (index < count_ / 2) {
+        Node* node = head_;
+        while (node && index >= node->count) {
+            index -= node->count;
+            node = node->next;
+        }
+        offset = index;
+        return node;
+    }
+    size_t from_tail = count_ - 1 - index;
+    Node* node = tail_;
+    while (node && from_tail >= node->count) {
+        from_tail -= node->count;
+        node = node->prev;
+    }
+    if (!node) return nullptr;
+    offset = node->count - 1 - from_tail;
+    return node;
+}
+
+Quicklist::Node* Quicklist::split(Node* node, size_t offset) {
+    Node* new_node = createNode();
+    Listpack& lp = node->lp;
+    char buf[Listpack::INT_BUF_SIZE];
+    size_t pos = lp.seek(static_cast<long long>(offset));
+    size_t first = pos;
+    for (; pos != Listpack::NPOS; pos = lp.next(pos)) {
+        new_node->lp.append(lp.get(pos, buf));
+    }
+    new_node->count = node->count - static_cast<uint32_t>(offset);
+    size_t before = lp.bytes();
+    if (first != Listpack::NPOS) lp.erase(first, new_node->count);
+    bytes_ -= before - lp.bytes();
+    node->count = static_cast<uint32_t>(offset);
+    linkAfter(node, new_node);
+    return new_node;
+}
+
+// ================== 压缩 ==================
+
+bool Quicklist::open(Node* node) {
+    if (!node->compressed) return false;
+    decompressNode(node);
+    return true;
+}
+
+void Quicklist::compressNode(Node* node) {
+    if (compress_depth_ == 0 || node->compressed) return;
+    size_t raw_bytes = node->lp.bytes();
+    if (raw_bytes < MIN_COMPRESS_BYTES) return;
+
+    // 输出上限设为原大小减去最少收益，放不下说明不值得压缩
+    auto* out = static_cast<unsigned char*>(memAlloc(raw_bytes));
+    size_t len = lzfCompress(node->lp.data(), raw_bytes, out, raw_bytes - MIN_COMPRESS_IMPROVE);
+    if (len == 0) {
+        memFree(out);
+        return;
+    }
+    if (auto* shrunk = static_cast<unsigned char*>(memRealloc(out, len))) out = shrunk;
+    bytes_ += len - raw_bytes;
+    node->compressed = out;
+    node->compressed_len = static_cast<uint32_t>(len);
+    node->raw_bytes = static_cast<uint32_t>(raw_bytes);
+    memFree(node->lp.release());
+}
+
+void Quicklist::decompressNode(Node* node) {
+    auto* raw = static_cast<unsigned char*>(memAlloc(node->raw_bytes));
+    if (lzfDecompress(node->compressed, node->compressed_len, raw, node->raw_bytes) != node->raw_bytes) {
+        memFree(raw);
+        throw std::runtime_error("quicklist node is corrupted");
+    }
+    node->lp = Listpack::adopt(raw);
+    bytes_ += node->raw_bytes - node->compressed_len;
+    memFree(node->compressed);
+    node->compressed = nullptr;
+    node->compressed_len = 0;
+}
+
+// 与 Redis __quicklistCompress 相同：两端各 depth 个节点解压，node 不在其中则压缩，
+// 再把刚好越过 depth 的两个节点压缩（它们可能是刚从两端挤进中间的）
+void Quicklist::compress(Node* node) {
+    if (compress_depth_ == 0 || len_ < static_cast<size_t>(compress_depth_) * 2) return;
+
+    Node* forward = head_;
+    Node* reverse = tail_;
+    bool in_depth = false;
+    for (int depth = 0; depth < compress_depth_; ++depth) {
+        open(forward);
+        open(reverse);
+        if (forward == node || reverse == node) in_depth = true;
+        // 两端相遇，所有节点都在 depth 内
+        if (forward == reverse || forward->next == reverse) return;
+        forward = forward->next;
+        reverse = reverse->prev;
+    }
+
+    if (node && !in_depth) compressNode(node);
+    compressNode(forward);
+    compressNode(reverse);
+}
+
+// ================== 两端操作 ==================
+
+void Quicklist::push_front(std::string_view value) {
+    if (allowInsert(head_, value.size())) {
+        open(head_);
+        size_t before = head_->lp.bytes();
+        head_->lp.prepend(value);
+        bytes_ += head_->lp.bytes() - before;
+        ++head_->count;
+    } else {
+        Node* node = createNode();
+        node->lp.append(value);
+        node->count = 1;
+        linkAfter(nullptr, node);
+    }
+    ++count_;
+    compress(head_);
+}
+
+void Quicklist::push_back(std::string_view value) {
+    if (allowInsert(tail_, value.size())) {
+        open(tail_);
+        size_t before = tail_->lp.bytes();
+        tail_->lp.append(value);
+        bytes_ += tail_->lp.bytes() - before;
+        ++tail_->count;
+    } else {
+        Node* node = createNode();
+        node->lp.append(value);
+        node->count = 1;
+        linkAfter(tail_, node);
+    }
+    ++count_;
+    compress(tail_);
+}
+
+bool Quicklist::pop_front(std::string& out) {
+    if (!head_) return false;
+    Node* node = head_;
+    open(node);
+    char buf[Listpack::INT_BUF_SIZE];
+    size_t pos = node->lp.first();
+    out.assign(node->lp.get(pos, buf));
+    size_t before = node->lp.bytes();
+    node->lp.erase(pos);
+    bytes_ -= before - node->lp.bytes();
+    --node->count;
+    --count_;
+    if (node->count == 0) unlink(node);
+    compress(nullptr);
+    return true;
+}
+
+bool Quicklist::pop_back(std::string& out) {
+    if (!tail_) return false;
+    Node* node = tail_;
+    open(node);
+    char buf[Listpack::INT_BUF_SIZE];
+    size_t pos = node->lp.last();
+    out.assign(node->lp.get(pos, buf));
+    size_t before = node->lp.bytes();
+    node->lp.erase(pos);
+    bytes_ -= before - node->lp.bytes();
+    --node->count;
+    --count_;
+    if (node->count == 0) unlink(node);
+    compress(nullptr);
+    return true;
+}
+
+// ================== 按下标 / 按值 ==================
+
+void Quicklist::index(size_t index, std::string& out) {
+    size_t offset = 0;
+    Node* node = locate(index, offset);
+    bool was_compressed = open(node);
+    char buf[Listpack::INT_BUF_SIZE];
+    out.assign(node->lp.get(node->lp.seek(static_cast<long long>(offset)), buf));
+    if (was_compressed) compressNode(node);
+}
+
+void Quicklist::erase(size_t start, size_t n) {
+    if (start >= count_ || n == 0) return;
+    size_t offset = 0;
+    Node* node = locate(start, offset);
+    while (node && n > 0) {
+        Node* next = node->next;
+        size_t del = node->count - offset;
+        if (del > n) del = n;
+        if (del == node->count) {
+            unlink(node); // 整个节点删除，不用解压
+        } else {
+            bool was_compressed = open(node);
+            size_t before = node->lp.bytes();
+            node->lp.erase(node->lp.seek(static_cast<long long>(offset)), del);
+            bytes_ -= before - node->lp.bytes();
+            node->count -= static_cast<uint32_t>(del);
+            count_ -= del;
+            if (was_compressed) compressNode(node);
+        }
+        n -= del;
+        offset = 0;
+        node = next;
+    }
+    compress(nullptr);
+}
+
+size_t Quicklist::remove(long long count, std::string_view value) {
+    bool from_tail = count < 0;
+    size_t limit = count == 0 ? static_cast<size_t>(-1)
+                 : from_tail  ? static_cast<size_t>(-(count + 1)) + 1
+                              : static_cast<size_t>(count);
+    size_t removed = 0;
+    Node* node = from_tail ? tail_ : head_;
+    while (node && removed < limit) {
+        Node* following = from_tail ? node->prev : node->next;
+        bool was_compressed = open(node);
+        Listpack& lp = node->lp;
+        size_t before = lp.bytes();
+        size_t pos = from_tail ? lp.last() : lp.first();
+        while (pos != Listpack::NPOS && removed < limit) {
+            if (lp.equals(pos, value)) {
+                // 正向删除后 pos 指向原来的下一个元素；反向时前一个元素的位置不受影响
+                size_t after = lp.erase(pos);
+                --node->count;
+                --count_;
+                ++removed;
+                if (from_tail) {
+                    pos = after == Listpack::NPOS ? lp.last() : lp.prev(after);
+                } else {
+                    pos = after;
+                }
+            } else {
+                pos = from_tail ? lp.prev(pos) : lp.next(pos);
+            }
+        }
+        bytes_ -= before - lp.bytes();
+        if (node->count == 0) {
+            unlink(node);
+        } else if (was_compressed) {
+            compressNode(node);
+        }
+        node = following;
+    }
+    if (removed) compress(nullptr);
+    return removed;
+}
+
+bool Quicklist::insert(std::string_view pivot, std::string_view value, bool after) {
+    Node* node = head_;
+    size_t pos = Listpack::NPOS;
+    size_t offset = 0;
+    for (; node; node = node->next) {
+        bool was_compressed = open(node);
+        pos = node->lp.find(pivot);
+        if (pos != Listpack::NPOS) break;
+        if (was_compressed) compressNode(node);
+    }
+    if (!node) return false;
+
+    // 节点内的插入下标
+    for (size_t p = node->lp.first(); p != pos; p = node->lp.next(p)) ++offset;
+    if (after) ++offset;
+
+    if (allowInsert(node, value.size())) {
+        size_t before = node->lp.bytes();
+        node->lp.insert(node->lp.seek(static_cast<long long>(offset)), value);
+        bytes_ += node->lp.bytes() - before;
+        ++node->count;
+    } else if (offset == 0 && allowInsert(node->prev, value.size())) {
+        // 插在节点头部，且前一个节点还有空间
+        open(node->prev);
+        size_t before = node->prev->lp.bytes();
+        node->prev->lp.append(value);
+        bytes_ += node->prev->lp.bytes() - before;
+        ++node->prev->count;
+        compress(node->prev);
+    } else if (offset == node->count && allowInsert(node->next, value.size())) {
+        open(node->next);
+        size_t before = node->next->lp.bytes();
+        node->next->lp.prepend(value);
+        bytes_ += node->next->lp.bytes() - before;
+        ++node->next->count;
+        compress(node->next);
+    } else {
+        // 节点已满：在插入点拆开，新元素接到前半段末尾，放不下就单独成一个节点
+        Node* prev = node->prev;
+        if (offset > 0) {
+            if (offset < node->count) split(node, offset);
+            prev = node;
+        }
+        if (prev == node && allowInsert(node, value.size())) {
+            size_t before = node->lp.bytes();
+            node->lp.append(value);
+            bytes_ += node->lp.bytes() - before;
+            ++node->count;
+        } else {
+            Node* new_node = createNode();
+            new_node->lp.append(value);
+            new_node->count = 1;
+            linkAfter(prev, new_node);
+            compress(new_node);
+        }
+    }
+    ++count_;
+    compress(node);
+    return true;
+}
+
+size_t Quicklist::memory_usage() const {
+    return sizeof(Quicklist) + len_ * sizeof(Node) + bytes_;
+}
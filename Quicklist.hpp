@@ -0,0 +1,119 @@
+// Quicklist.hpp
+#pragma once
+#include "Listpack.hpp"
+#include <string>
+#include <string_view>
+#include <cstddef>
+#include <cstdint>
+
+// 快速列表（Redis quicklist）：listpack 节点组成的双向链表
+// - 每个节点是一块大小受限的 listpack，两端 push/pop 只动头尾节点，O(1)；
+//   元素开销约为 listpack 的 2~10 字节 + 每节点一个 48 字节的节点头
+// - fill > 0：每个节点最多 fill 个元素（同时不超过 8KB）；
+//   fill < 0：每个节点最多 4KB << (-fill - 1) 字节（-1 ~ -5，即 4KB ~ 64KB）
+// - compress_depth > 0：两端各 compress_depth 个节点保持原样，中间节点用 LZF 压缩，
+//   访问中间节点时临时解压，用完再压缩
+class Quicklist {
+public:
+    struct Options {
+        int fill = -2;          // 默认每个节点最多 8KB
+        int compress_depth = 0; // 默认不压缩
+    };
+
+    // 新建列表使用的默认参数（启动时按配置设置一次）
+    static void setDefaultOptions(const Options& options);
+    static const Options& defaultOptions();
+
+    explicit Quicklist(const Options& options = defaultOptions());
+    ~Quicklist();
+
+    Quicklist(const Quicklist&) = delete;
+    Quicklist& operator=(const Quicklist&) = delete;
+    Quicklist(Quicklist&& other) noexcept;
+    Quicklist& operator=(Quicklist&& other) noexcept;
+
+    size_t size() const { return count_; }
+    size_t node_count() const { return len_; }
+    bool empty() const { return count_ == 0; }
+
+    void push_front(std::string_view value);
+    void push_back(std::string_view value);
+    bool pop_front(std::string& out);
+    bool pop_back(std::string& out);
+
+    // 下标从 0 开始，必须在 [0, size()) 内
+    void index(size_t index, std::string& out);
+    // 对 [start, start + n) 的元素依次调用 fn(std::string_view)，视图只在回调内有效
+    template <typename F>
+    void range(size_t start, size_t n, F&& fn);
+    // 删除 [start, start + n) 的元素
+    void erase(size_t start, size_t n);
+    // 删除等于 value 的元素：count > 0 从头开始最多 count 个，< 0 从尾开始，0 全部；返回删除个数
+    size_t remove(long long count, std::string_view value);
+    // 在第一个等于 pivot 的元素前/后插入，pivot 不存在返回 false
+    bool insert(std::string_view pivot, std::string_view value, bool after);
+
+    size_t memory_usage() const;
+
+private:
+    static constexpr size_t SIZE_SAFETY_LIMIT = 8192; // fill > 0 时单个节点的字节上限
+    static constexpr size_t MIN_COMPRESS_BYTES = 48;  // 小于此大小的节点不压缩
+    static constexpr size_t MIN_COMPRESS_IMPROVE = 8; // 至少省下这么多字节才保留压缩结果
+
+    struct Node {
+        Node* prev = nullptr;
+        Node* next = nullptr;
+        Listpack lp;                         // 未压缩时的数据；压缩后已交出内存块
+        unsigned char* compressed = nullptr; // LZF 数据（memAlloc），非空表示已压缩
+        uint32_t compressed_len = 0;
+        uint32_t raw_bytes = 0;              // 压缩前 listpack 的大小
+        uint32_t count = 0;                  // 元素数
+
+        ~Node();
+        size_t bytes() const { return compressed ? raw_bytes : lp.bytes(); }
+    };
+
+    static size_t storedBytes(const Node* node) { return node->compressed ? node->compressed_len : node->lp.bytes(); }
+
+    Node* head_ = nullptr;
+    Node* tail_ = nullptr;
+    size_t count_ = 0; // 元素总数
+    size_t len_ = 0;   // 节点数
+    size_t bytes_ = 0; // 各节点实际占用的数据字节（压缩节点按压缩后大小），memory_usage 不用遍历
+    int fill_;
+    int compress_depth_;
+
+    bool allowInsert(const Node* node, size_t value_len) const;
+    Node* createNode();
+    void linkAfter(Node* node, Node* new_node);  // node 为空时插到头部
+    void unlink(Node* node);                     // 从链表摘下并释放
+    // 定位第 index 个元素所在节点，offset 为节点内下标
+    Node* locate(size_t index, size_t& offset) const;
+    // 把 node 中下标 >= offset 的元素移到紧跟其后的新节点，返回新节点
+    Node* split(Node* node, size_t offset);
+
+    // 访问前解压，返回节点原来是否是压缩的
+    bool open(Node* node);
+    void compressNode(Node* node);
+    void decompressNode(Node* node);
+    // 修改 node 后调用：保证两端各 compress_depth 个节点不压缩，node 若在中间则压缩
+    void compress(Node* node);
+};
+
+template <typename F>
+void Quicklist::range(size_t start, size_t n, F&& fn) {
+    size_t offset = 0;
+    Node* node = start < count_ ? locate(start, offset) : nullptr;
+    char buf[Listpack::INT_BUF_SIZE];
+    while (node && n > 0) {
+        bool was_compressed = open(node);
+        const Listpack& lp = node->lp;
+        for (size_t pos = lp.seek(static_cast<long long>(offset)); pos != Listpack::NPOS && n > 0;
+             pos = lp.next(pos), --n) {
+            fn(lp.get(pos, buf));
+        }
+        if (was_compressed) compressNode(node);
+        offset = 0;
+        node = node->next;
+    }
+}
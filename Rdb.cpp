@@ -1,16 +1,26 @@
 // Rdb.cpp
 #include "Rdb.hpp"
-#include "StringObject.hpp"   
-#include "HashObject.hpp" 
+#include "HashObject.hpp"
+#include "ListObject.hpp"
+#include "SetObject.hpp"
+#include "ZSetObject.hpp"
+#include <unistd.h>
 #include <cstdint>
+#include <cstdio>
 #include <cstring>
+#include <endian.h>
 #include <fstream>
 #include <stdexcept>
 
 
 // RDB 类型常量
 constexpr uint8_t RDB_TYPE_STRING = 0;
+constexpr uint8_t RDB_TYPE_LIST   = 1;
 constexpr uint8_t RDB_TYPE_HASH   = 2;
+constexpr uint8_t RDB_TYPE_SET    = 3; // Redis 的 SET 是 2，这里 2 早已用于 HASH
+constexpr uint8_t RDB_TYPE_ZSET_2 = 5; // 与 Redis 相同：分数为 8 字节小端 double
+constexpr uint8_t RDB_OPCODE_EXPIRETIME_MS = 0xFC; // 后跟 8 字节小端 Unix 毫秒，作用于下一个 key
+constexpr uint8_t RDB_OPCODE_EXPIRETIME    = 0xFD; // 旧格式：4 字节小端 Unix 秒（只读）
 constexpr uint8_t RDB_OPCODE_EOF  = 0xFF;
 constexpr uint8_t RDB_OPCODE_DB   = 0xFE;
 
@@ -19,46 +29,86 @@ void RdbEncoder::writeMagic(std::ofstream& out) {
     out.write("0009", 4); // RDB version 9
 }
 
+// 与 Redis 相同的长度编码：00 6 位 / 01 14 位 / 0x80 32 位 / 0x81 64 位，多字节部分为大端
 void RdbEncoder::writeLen(std::ofstream& out, uint64_t len) {
     if (len < (1 << 6)) {
-        uint8_t b = (len & 0x3F);
-        out.write(reinterpret_cast<char*>(&b), 1);
+        out.put(static_cast<char>(len));
     } else if (len < (1 << 14)) {
-        uint16_t b = (1 << 6) | (len & 0x3FFF);
-        b = htole16(b);
-        out.write(reinterpret_cast<char*>(&b), 2);
+        char buf[2] = {static_cast<char>(0x40 | (len >> 8)), static_cast<char>(len & 0xFF)};
+        out.write(buf, 2);
+    } else if (len <= UINT32_MAX) {
+        out.put(static_cast<char>(0x80));
+        uint32_t b = htobe32(static_cast<uint32_t>(len));
+        out.write(reinterpret_cast<char*>(&b), 4);
     } else {
-        // 简化：暂不支持超大字符串（>16KB）
-        throw std::runtime_error("RDB: large string not supported in stage5B");
+        out.put(static_cast<char>(0x81));
+        uint64_t b = htobe64(len);
+        out.write(reinterpret_cast<char*>(&b), 8);
     }
 }
 
-void RdbEncoder::writeString(std::ofstream& out, const std::string& s) {
+void RdbEncoder::writeString(std::ofstream& out, std::string_view s) {
     writeLen(out, s.size());
     out.write(s.data(), s.size());
 }
 
+void RdbEncoder::writeDouble(std::ofstream& out, double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    bits = htole64(bits);
+    out.write(reinterpret_cast<char*>(&bits), 8);
+}
+
+void RdbEncoder::writeExpireTime(std::ofstream& out, int64_t when) {
+    out.put(static_cast<char>(RDB_OPCODE_EXPIRETIME_MS));
+    uint64_t le = htole64(static_cast<uint64_t>(when));
+    out.write(reinterpret_cast<char*>(&le), 8);
+}
+
 void RdbEncoder::writeDatabaseHeader(std::ofstream& out, int db_number) {
     out.put(RDB_OPCODE_DB);
     writeLen(out, db_number);
     // key count 和 expire time 可省略（Redis 允许）
 }
 
-void RdbEncoder::writeKeyValuePair(std::ofstream& out, const std::string& key, RedisObject* obj) {
+void RdbEncoder::writeKeyValuePair(std::ofstream& out, std::string_view key, const RedisObject* obj) {
     if (obj->type() == ObjectType::STRING) {
         out.put(RDB_TYPE_STRING);
         writeString(out, key);
-        auto str_obj = static_cast<StringObject*>(obj);
-        writeString(out, str_obj->value());
+        char buf[RedisObject::LONG_STR_SIZE];
+        writeString(out, obj->stringView(buf));
     } else if (obj->type() == ObjectType::HASH) {
         out.put(RDB_TYPE_HASH);
         writeString(out, key);
-        auto hash_obj = static_cast<HashObject*>(obj);
+        auto hash_obj = obj->hash();
         writeLen(out, hash_obj->size());
         for (const auto& [field, value] : hash_obj->get_all_fields()) {
             writeString(out, field);
             writeString(out, value);
         }
+    } else if (obj->type() == ObjectType::LIST) {
+        out.put(RDB_TYPE_LIST);
+        writeString(out, key);
+        auto list_obj = obj->list();
+        writeLen(out, list_obj->size());
+        list_obj->for_each([&](std::string_view value) { writeString(out, value); });
+    } else if (obj->type() == ObjectType::SET) {
+        out.put(RDB_TYPE_SET);
+        writeString(out, key);
+        auto set_obj = obj->set();
+        writeLen(out, set_obj->size());
+        for (const auto& member : set_obj->members()) {
+            writeString(out, member);
+        }
+    } else if (obj->type() == ObjectType::ZSET) {
+        out.put(RDB_TYPE_ZSET_2);
+        writeString(out, key);
+        auto zset_obj = obj->zset();
+        writeLen(out, zset_obj->size());
+        zset_obj->for_each([&](std::string_view member, double score) {
+            writeString(out, member);
+            writeDouble(out, score);
+        });
     } else {
         throw std::runtime_error("Unsupported RDB type");
     }
@@ -74,37 +124,59 @@ void RdbEncoder::writeChecksum(std::ofstream& out) {
     out.write(reinterpret_cast<char*>(&zero), 8);
 }
 
-bool RdbEncoder::saveToFile(const std::string& filename,
-                           const std::unordered_map<std::string, std::shared_ptr<RedisObject>>& data) {
-    std::ofstream out(filename, std::ios::binary);
+std::string RdbEncoder::tempFilename(const std::string& filename, pid_t pid) {
+    return filename + ".temp-" + std::to_string(pid);
+}
+
+bool RdbEncoder::saveToFile(const std::string& filename, const KeySpace& data, const ExpireTable& expires,
+                            const std::function<void()>& progress) {
+    std::string tmp = tempFilename(filename, getpid());
+    std::ofstream out(tmp, std::ios::binary);
     if (!out) return false;
 
     try {
         writeMagic(out);
         writeDatabaseHeader(out, 0);
 
-        for (const auto& [key, obj] : data) {
+        size_t written = 0;
+        data.for_each([&](std::string_view key, const ObjectPtr& obj) {
+            if (expires.size() > 0) {
+                int64_t when = expires.get(key);
+                if (when != ExpireTable::NONE) writeExpireTime(out, when);
+            }
             writeKeyValuePair(out, key, obj.get());
-        }
+            if (progress && ++written % PROGRESS_KEYS == 0) progress();
+        });
 
         writeEOF(out);
         writeChecksum(out);
         out.close();
-        return true;
     } catch (const std::exception& e) {
         out.close();
+        std::remove(tmp.c_str());
         return false;
     }
+    // 写满磁盘之类的错误只体现在流状态上
+    if (out.fail() || std::rename(tmp.c_str(), filename.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        return false;
+    }
+    return true;
 }
 
 // Rdb.cpp（全局函数）
-std::unordered_map<std::string, std::shared_ptr<RedisObject>> RdbEncoder::loadFromFile(const std::string& filename) {
+bool RdbEncoder::loadFromFile(const std::string& filename, KeySpace& data, ExpireTable& expires) {
+    data.clear();
+    expires.clear();
     try {
         RdbDecoder decoder(filename);
-        return decoder.decodeAll();
+        decoder.decodeAll(data, expires);
+        return true;
     } catch (const std::exception& e) {
-        // 加载失败（文件不存在/损坏），返回空 map
-        return {};
+        // 加载失败（文件不存在/损坏），保持为空
+        data.clear();
+        expires.clear();
+        return false;
     }
 }
 
@@ -114,10 +186,10 @@ RdbDecoder::RdbDecoder(const std::string& filename) : in_(filename, std::ios::bi
     }
 }
 
-std::unordered_map<std::string, std::shared_ptr<RedisObject>> RdbDecoder::decodeAll() {
+void RdbDecoder::decodeAll(KeySpace& data, ExpireTable& expires) {
     readMagic();
     skipToDatabase(); // 跳过其他 DB（只处理 DB 0）
-    return readKeyValues();
+    readKeyValues(data, expires);
 }
 
 void RdbDecoder::readExact(char* buf, size_t len) {
@@ -145,12 +217,19 @@ uint64_t RdbDecoder::readLen() {
     if ((byte & 0xC0) == 0) {
         return byte & 0x3F;
     } else if ((byte & 0xC0) == 0x40) {
-        uint16_t len = byte & 0x3F;
-        readExact(reinterpret_cast<char*>(&len) + 1, 1); // 读第二个字节
-        len = le16toh(len);
-        return len;
+        uint8_t low;
+        readExact(reinterpret_cast<char*>(&low), 1);
+        return (static_cast<uint64_t>(byte & 0x3F) << 8) | low;
+    } else if (byte == 0x80) {
+        uint32_t len;
+        readExact(reinterpret_cast<char*>(&len), 4);
+        return be32toh(len);
+    } else if (byte == 0x81) {
+        uint64_t len;
+        readExact(reinterpret_cast<char*>(&len), 8);
+        return be64toh(len);
     } else {
-        throw std::runtime_error("RDB large length not supported");
+        throw std::runtime_error("RDB: unsupported length encoding");
     }
 }
 
@@ -163,6 +242,15 @@ std::string RdbDecoder::readString() {
     return s;
 }
 
+double RdbDecoder::readDouble() {
+    uint64_t bits;
+    readExact(reinterpret_cast<char*>(&bits), 8);
+    bits = le64toh(bits);
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
 void RdbDecoder::skipToDatabase() {
     while (true) {
         uint8_t opcode;
@@ -182,8 +270,8 @@ void RdbDecoder::skipToDatabase() {
     }
 }
 
-std::unordered_map<std::string, std::shared_ptr<RedisObject>> RdbDecoder::readKeyValues() {
-    std::unordered_map<std::string, std::shared_ptr<RedisObject>> data;
+void RdbDecoder::readKeyValues(KeySpace& data, ExpireTable& expires) {
+    int64_t now = unixTimeMs();
     while (true) {
         uint8_t type;
         readExact(reinterpret_cast<char*>(&type), 1);
@@ -191,28 +279,65 @@ std::unordered_map<std::string, std::shared_ptr<RedisObject>> RdbDecoder::readKe
             break;
         }
 
+        // 过期时间在它所属的 key 之前
+        int64_t when = ExpireTable::NONE;
+        if (type == RDB_OPCODE_EXPIRETIME_MS) {
+            uint64_t le;
+            readExact(reinterpret_cast<char*>(&le), 8);
+            when = static_cast<int64_t>(le64toh(le));
+            readExact(reinterpret_cast<char*>(&type), 1);
+        } else if (type == RDB_OPCODE_EXPIRETIME) {
+            uint32_t le;
+            readExact(reinterpret_cast<char*>(&le), 4);
+            when = static_cast<int64_t>(le32toh(le)) * 1000;
+            readExact(reinterpret_cast<char*>(&type), 1);
+        }
+
         std::string key = readString();
-        std::shared_ptr<RedisObject> obj;
+        ObjectPtr obj;
 
         if (type == RDB_TYPE_STRING) {
             std::string value = readString();
-            obj = std::make_shared<StringObject>(std::move(value));
+            obj = ObjectPtr::createString(value);
         } else if (type == RDB_TYPE_HASH) {
             uint64_t field_count = readLen();
-            auto hash_obj = std::make_shared<HashObject>();
+            obj = ObjectPtr::createHash();
             for (uint64_t i = 0; i < field_count; ++i) {
                 std::string field = readString();
                 std::string value = readString();
-                hash_obj->set_field(field, value);
+                obj->hash()->set_field(field, value);
+            }
+        } else if (type == RDB_TYPE_LIST) {
+            uint64_t len = readLen();
+            obj = ObjectPtr::createList();
+            for (uint64_t i = 0; i < len; ++i) {
+                obj->list()->push_back(readString());
+            }
+        } else if (type == RDB_TYPE_SET) {
+            uint64_t len = readLen();
+            obj = ObjectPtr::createSet();
+            for (uint64_t i = 0; i < len; ++i) {
+                obj->set()->add(readString());
+            }
+        } else if (type == RDB_TYPE_ZSET_2) {
+            uint64_t len = readLen();
+            obj = ObjectPtr::createZSet();
+            double newscore;
+            for (uint64_t i = 0; i < len; ++i) {
+                std::string member = readString();
+                obj->zset()->add(readDouble(), member, 0, newscore);
             }
-            obj = hash_obj;
         } else {
             throw std::runtime_error("Unsupported RDB type during load: " + std::to_string(type));
         }
 
-        data.emplace(std::move(key), std::move(obj));
+        // 保存后才过期的 key 读完就丢弃
+        if (when != ExpireTable::NONE) {
+            if (now > when) continue;
+            expires.set(key, when);
+        }
+        data.set(key, std::move(obj));
     }
     // 跳过 checksum（8 字节）
     in_.ignore(8);
-    return data;
 }
\ No newline at end of file
@@ -1,26 +1,38 @@
 // Rdb.hpp
 #pragma once
 #include <string>
+#include <string_view>
 #include <vector>
-#include <unordered_map>
 #include <fstream>
+#include <functional>
 #include <memory>
+#include <sys/types.h>
 #include "RedisObject.hpp"
+#include "KeySpace.hpp"
+#include "ExpireTable.hpp"
 
 class RdbEncoder {
 public:
-    static bool saveToFile(const std::string& filename,
-                          const std::unordered_map<std::string, std::shared_ptr<RedisObject>>& data);
+    // 先写到临时文件（tempFilename），完整写完再 rename 覆盖，中途失败或进程被杀不会破坏原文件；
+    // progress 非空时每写 PROGRESS_KEYS 个 key 调用一次（BGSAVE 子进程借此上报写时复制量）
+    static constexpr size_t PROGRESS_KEYS = 1024;
+    static bool saveToFile(const std::string& filename, const KeySpace& data, const ExpireTable& expires,
+                           const std::function<void()>& progress = {});
+    // pid 进程保存 filename 时用的临时文件
+    static std::string tempFilename(const std::string& filename, pid_t pid);
 
-    // 加载 RDB 文件，返回 key -> RedisObject 映射
-    static std::unordered_map<std::string, std::shared_ptr<RedisObject>> loadFromFile(const std::string& filename);
+    // 加载 RDB 文件到 data / expires（原有内容被替换），已过期的 key 不加载；
+    // 文件不存在或损坏时两者为空，返回 false
+    static bool loadFromFile(const std::string& filename, KeySpace& data, ExpireTable& expires);
 
 private:
     static void writeMagic(std::ofstream& out);
     static void writeDatabaseHeader(std::ofstream& out, int db_number = 0);
-    static void writeKeyValuePair(std::ofstream& out, const std::string& key, class RedisObject* obj);
-    static void writeString(std::ofstream& out, const std::string& s);
+    static void writeKeyValuePair(std::ofstream& out, std::string_view key, const RedisObject* obj);
+    static void writeString(std::ofstream& out, std::string_view s);
     static void writeLen(std::ofstream& out, uint64_t len);
+    static void writeDouble(std::ofstream& out, double value); // 8 字节小端
+    static void writeExpireTime(std::ofstream& out, int64_t when); // 过期时间操作码 + 8 字节小端毫秒
     static void writeEOF(std::ofstream& out);
     static void writeChecksum(std::ofstream& out); // 暂填 0
 };
@@ -28,15 +40,16 @@ private:
 class RdbDecoder {
 public:
     explicit RdbDecoder(const std::string& filename);
-    std::unordered_map<std::string, std::shared_ptr<RedisObject>> decodeAll();
+    void decodeAll(KeySpace& data, ExpireTable& expires);
 
 private:
     void readExact(char* buf, size_t len);
     std::string readMagic();
     uint64_t readLen();
     std::string readString();
+    double readDouble();
     void skipToDatabase();
-    std::unordered_map<std::string, std::shared_ptr<RedisObject>> readKeyValues();
+    void readKeyValues(KeySpace& data, ExpireTable& expires);
 
 private:
     std::ifstream in_;
@@ -1,8 +1,230 @@
+// RedisObject.cpp
 #include "RedisObject.hpp"
+#include "HashObject.hpp"
+#include "ListObject.hpp"
+#include "SetObject.hpp"
+#include "ZSetObject.hpp"
+#include "Protocol.hpp"
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <time.h>
 
-// RedisObject 的实现
-RedisObject::RedisObject(ObjectType type) : type_(type) {}
+// EMBSTR 的字符串从对象头第 9 字节开始（第 8 字节是长度）
+static constexpr size_t EMBSTR_OFFSET = 9;
 
-ObjectType RedisObject::type() const {
-    return type_;
+RedisObject::RedisObject(ObjectType type, ObjectEncoding encoding)
+    : type_(static_cast<uint32_t>(type))
+    , encoding_(static_cast<uint32_t>(encoding))
+    , lru_(lfu_mode_ ? (lfuTimeInMinutes() << 8) | LFU_INIT_VAL : lruClock())
+    , refcount_(1)
+{
+    u_.ptr = nullptr;
+}
+
+ObjectEncoding RedisObject::encoding() const {
+    // hash / set / zset 会转换编码，以负载记录的为准
+    if (type() == ObjectType::HASH) return hash()->encoding();
+    if (type() == ObjectType::SET) return set()->encoding();
+    if (type() == ObjectType::ZSET) return zset()->encoding();
+    return static_cast<ObjectEncoding>(encoding_);
+}
+
+size_t RedisObject::embstrAllocSize(size_t len) {
+    return std::max(sizeof(RedisObject), EMBSTR_OFFSET + len + 1);
+}
+
+std::string_view RedisObject::stringView(char* buf) const {
+    switch (static_cast<ObjectEncoding>(encoding_)) {
+    case ObjectEncoding::INT:
+        return {buf, ll2string(buf, u_.integer)};
+    case ObjectEncoding::EMBSTR:
+        return {reinterpret_cast<const char*>(this) + EMBSTR_OFFSET, u_.embstr.len};
+    default:
+        return *static_cast<const std::string*>(u_.ptr);
+    }
+}
+
+bool RedisObject::getLongLong(long long& out) const {
+    if (static_cast<ObjectEncoding>(encoding_) != ObjectEncoding::INT) return false;
+    out = u_.integer;
+    return true;
+}
+
+size_t RedisObject::memory_usage() const {
+    if (isShared()) return 0;
+    switch (type()) {
+    case ObjectType::STRING:
+        switch (static_cast<ObjectEncoding>(encoding_)) {
+        case ObjectEncoding::EMBSTR:
+            return embstrAllocSize(u_.embstr.len);
+        case ObjectEncoding::RAW:
+            return sizeof(*this) + sizeof(std::string) + static_cast<const std::string*>(u_.ptr)->capacity();
+        default:
+            return sizeof(*this);
+        }
+    case ObjectType::HASH:
+        return sizeof(*this) + hash()->memory_usage();
+    case ObjectType::LIST:
+        return sizeof(*this) + list()->memory_usage();
+    case ObjectType::SET:
+        return sizeof(*this) + set()->memory_usage();
+    case ObjectType::ZSET:
+        return sizeof(*this) + zset()->memory_usage();
+    default:
+        return sizeof(*this);
+    }
+}
+
+void RedisObject::free() {
+    switch (type()) {
+    case ObjectType::STRING:
+        if (static_cast<ObjectEncoding>(encoding_) == ObjectEncoding::RAW) {
+            delete static_cast<std::string*>(u_.ptr);
+        }
+        break;
+    case ObjectType::HASH:
+        delete hash();
+        break;
+    case ObjectType::LIST:
+        delete list();
+        break;
+    case ObjectType::SET:
+        delete set();
+        break;
+    case ObjectType::ZSET:
+        delete zset();
+        break;
+    default:
+        break;
+    }
+    // 对象头是平凡类型，直接释放整块内存（EMBSTR 的字符串在同一块里）
+    ::operator delete(this);
+}
+
+// ========== ObjectPtr 工厂 ==========
+
+ObjectPtr ObjectPtr::createString(std::string_view value) {
+    long long n;
+    if (value.size() <= 20 && string2ll(value, n)) {
+        return createStringFromLongLong(n);
+    }
+    if (value.size() <= RedisObject::EMBSTR_SIZE_LIMIT) {
+        void* mem = ::operator new(RedisObject::embstrAllocSize(value.size()));
+        auto* obj = new (mem) RedisObject(ObjectType::STRING, ObjectEncoding::EMBSTR);
+        obj->u_.embstr.len = static_cast<uint8_t>(value.size());
+        char* data = static_cast<char*>(mem) + EMBSTR_OFFSET;
+        std::memcpy(data, value.data(), value.size());
+        data[value.size()] = '\0';
+        return adopt(obj);
+    }
+    auto* obj = new RedisObject(ObjectType::STRING, ObjectEncoding::RAW);
+    obj->u_.ptr = new std::string(value);
+    return adopt(obj);
+}
+
+ObjectPtr ObjectPtr::createStringFromLongLong(long long value) {
+    if (shared_integers_ && value >= 0 && value < RedisObject::SHARED_INTEGERS) {
+        return adopt(sharedInteger(value));
+    }
+    auto* obj = new RedisObject(ObjectType::STRING, ObjectEncoding::INT);
+    obj->u_.integer = value;
+    return adopt(obj);
+}
+
+ObjectPtr ObjectPtr::createHash() {
+    auto* obj = new RedisObject(ObjectType::HASH, ObjectEncoding::LISTPACK);
+    obj->u_.ptr = new HashObject();
+    return adopt(obj);
+}
+
+ObjectPtr ObjectPtr::createList() {
+    auto* obj = new RedisObject(ObjectType::LIST, ObjectEncoding::QUICKLIST);
+    obj->u_.ptr = new ListObject();
+    return adopt(obj);
+}
+
+ObjectPtr ObjectPtr::createSet() {
+    auto* obj = new RedisObject(ObjectType::SET, ObjectEncoding::INTSET);
+    obj->u_.ptr = new SetObject();
+    return adopt(obj);
+}
+
+ObjectPtr ObjectPtr::createZSet() {
+    auto* obj = new RedisObject(ObjectType::ZSET, ObjectEncoding::LISTPACK);
+    obj->u_.ptr = new ZSetObject();
+    return adopt(obj);
+}
+
+// 共享整数在第一次使用时一次性创建（线程安全的局部静态），之后只读
+RedisObject* ObjectPtr::sharedInteger(long long value) {
+    struct SharedIntegers {
+        RedisObject* objects[RedisObject::SHARED_INTEGERS];
+        SharedIntegers() {
+            for (long long i = 0; i < RedisObject::SHARED_INTEGERS; ++i) {
+                auto* obj = new RedisObject(ObjectType::STRING, ObjectEncoding::INT);
+                obj->u_.integer = i;
+                obj->lru_ = 0;
+                obj->refcount_ = RedisObject::SHARED_REFCOUNT;
+                objects[i] = obj;
+            }
+        }
+    };
+    static const SharedIntegers shared;
+    return shared.objects[value];
+}
+
+uint32_t lruClock() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return static_cast<uint32_t>(ts.tv_sec) & RedisObject::LRU_CLOCK_MAX;
+}
+
+uint32_t lfuTimeInMinutes() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return static_cast<uint32_t>(ts.tv_sec / 60) & 0xFFFF;
+}
+
+const char* objectTypeName(ObjectType type) {
+    static const char* const NAMES[] = {"string", "list", "set", "hash", "zset"};
+    return NAMES[static_cast<int>(type)];
+}
+
+const char* objectEncodingName(ObjectEncoding encoding) {
+    static const char* const NAMES[] = {"raw", "int", "embstr", "listpack", "hashtable",
+                                        "quicklist", "intset", "skiplist"};
+    return NAMES[static_cast<int>(encoding)];
+}
+
+// ================== LRU / LFU ==================
+
+uint8_t RedisObject::lfuCounter() const {
+    uint32_t ldt = lru_ >> 8;
+    uint8_t counter = lru_ & 0xFF;
+    uint32_t now = lfuTimeInMinutes();
+    // 16 位分钟数回绕时按回绕处理
+    uint32_t elapsed = now >= ldt ? now - ldt : 65535 - ldt + now;
+    uint32_t periods = elapsed / LFU_DECAY_MINUTES;
+    return periods >= counter ? 0 : static_cast<uint8_t>(counter - periods);
+}
+
+void RedisObject::touch() {
+    if (isShared()) return;
+    if (!lfu_mode_) {
+        lru_ = lruClock();
+        return;
+    }
+    // 对数计数：当前计数越大，增加的概率 1 / ((counter - LFU_INIT_VAL) * factor + 1) 越小
+    uint8_t counter = lfuCounter();
+    if (counter < 255) {
+        thread_local uint64_t state = 0x9E3779B97F4A7C15ULL;
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        double r = static_cast<double>(state >> 11) / static_cast<double>(1ULL << 53);
+        double base = counter > LFU_INIT_VAL ? counter - LFU_INIT_VAL : 0;
+        if (r < 1.0 / (base * LFU_LOG_FACTOR + 1)) counter++;
+    }
+    lru_ = (lfuTimeInMinutes() << 8) | counter;
 }
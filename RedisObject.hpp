@@ -1,9 +1,17 @@
+// RedisObject.hpp
 #pragma once
 #include <string>
-#include <unordered_map>
-#include <memory>
+#include <string_view>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
 
-enum class ObjectType {
+class HashObject;
+class ListObject;
+class SetObject;
+class ZSetObject;
+
+enum class ObjectType : uint8_t {
     STRING,
     LIST,
     SET,
@@ -11,21 +19,169 @@ enum class ObjectType {
     ZSET
 };
 
+// 对象编码（各类型共用一套，与 Redis OBJECT ENCODING 对应）
+enum class ObjectEncoding : uint8_t {
+    RAW,        // 字符串：独立分配的 std::string
+    INT,        // 字符串：整数直接存在对象头里
+    EMBSTR,     // 字符串：与对象头同一次分配
+    LISTPACK,   // 紧凑列表（hash / list / zset 小对象）
+    HASHTABLE,  // 哈希表（hash / set）
+    QUICKLIST,  // list：listpack 节点组成的双向链表
+    INTSET,     // set：全是整数的小集合
+    SKIPLIST    // zset：跳表 + member 索引
+};
+
+// 值对象：紧凑的 16 字节对象头，不使用虚函数和 shared_ptr
+// - type(4 位) + encoding(4 位) + lru(24 位) 共 4 字节，引用计数 4 字节，后面 8 字节是负载：
+//   INT 编码直接存整数；EMBSTR 编码存长度和字符串开头，字符串紧跟在对象头后面（一次分配）；
+//   其余编码存指向具体结构（std::string / HashObject / ListObject / SetObject / ZSetObject）的指针
+// - 引用计数是侵入式的，由 ObjectPtr 管理；非原子，对象只在所属的线程（分片）内使用
+// - 0 ~ SHARED_INTEGERS-1 的整数字符串全局共享，引用计数固定为 SHARED_REFCOUNT，不会被释放，
+//   只读，可以跨分片使用；按 LRU / LFU 淘汰时关闭共享（见 ObjectPtr::setSharedIntegers）
+// - lru 字段在 LFU 模式下（maxmemory-policy 为 allkeys-lfu）另作他用，与 Redis 相同：
+//   高 16 位为上次衰减的时间（分钟），低 8 位为对数访问计数
 class RedisObject {
 public:
-    explicit RedisObject(ObjectType type);
-    virtual ~RedisObject() = default;
-    
-    virtual ObjectType type() const = 0;
-    virtual size_t memory_usage() const = 0;
-    
-    // 类型安全的 downcast 工具（可选）
-    template<typename T>
-    T* as() { return dynamic_cast<T*>(this); }
-
-    template<typename T>
-    const T* as() const { return dynamic_cast<const T*>(this); }
-
-protected:
-    ObjectType type_;
+    static constexpr unsigned LRU_BITS = 24;
+    static constexpr uint32_t LRU_CLOCK_MAX = (1u << LRU_BITS) - 1;
+    static constexpr uint32_t SHARED_REFCOUNT = UINT32_MAX;
+    static constexpr long long SHARED_INTEGERS = 10000;
+    // 不超过此长度的字符串用 EMBSTR，整个对象不超过 64 字节的分配
+    static constexpr size_t EMBSTR_SIZE_LIMIT = 44;
+    // stringView() 格式化整数需要的缓冲区大小
+    static constexpr size_t LONG_STR_SIZE = 21;
+
+    // LFU 参数（同 Redis 默认的 lfu-log-factor / lfu-decay-time）：新对象的计数为 LFU_INIT_VAL，
+    // 计数越大再增加的概率越低（factor 为 10 时约一百万次访问到 255），每空闲一分钟计数减 1
+    static constexpr uint8_t LFU_INIT_VAL = 5;
+    static constexpr int LFU_LOG_FACTOR = 10;
+    static constexpr int LFU_DECAY_MINUTES = 1;
+
+    // 启动时按 maxmemory-policy 设置一次，之后创建的对象按此初始化 lru 字段
+    static void setLfuMode(bool lfu) { lfu_mode_ = lfu; }
+    static bool lfuMode() { return lfu_mode_; }
+
+    RedisObject(const RedisObject&) = delete;
+    RedisObject& operator=(const RedisObject&) = delete;
+
+    ObjectType type() const { return static_cast<ObjectType>(type_); }
+    ObjectEncoding encoding() const;
+
+    // LRU 时钟（秒，取低 24 位），LFU 模式下为时间 + 计数
+    uint32_t lru() const { return lru_; }
+    // 记录一次访问：LRU 模式更新时钟，LFU 模式先按空闲时间衰减再按概率增加计数；共享对象不更新
+    void touch();
+    // LFU 模式下按当前时间衰减后的计数（不写回）
+    uint8_t lfuCounter() const;
+
+    bool isShared() const { return refcount_ == SHARED_REFCOUNT; }
+    uint32_t refcount() const { return refcount_; }
+    void incrRefCount() {
+        if (!isShared()) ++refcount_;
+    }
+    // 减到 0 时释放负载和对象本身
+    void decrRefCount() {
+        if (!isShared() && --refcount_ == 0) free();
+    }
+
+    // 字符串对象的内容；INT 编码会格式化到 buf（至少 LONG_STR_SIZE 字节），
+    // 其余编码直接指向对象内的数据
+    std::string_view stringView(char* buf) const;
+    // 是否为整数编码，是则写入 out
+    bool getLongLong(long long& out) const;
+
+    HashObject* hash() const { return static_cast<HashObject*>(u_.ptr); }
+    ListObject* list() const { return static_cast<ListObject*>(u_.ptr); }
+    SetObject* set() const { return static_cast<SetObject*>(u_.ptr); }
+    ZSetObject* zset() const { return static_cast<ZSetObject*>(u_.ptr); }
+
+    // 对象占用的内存（对象头 + 负载），共享对象为 0
+    size_t memory_usage() const;
+
+private:
+    RedisObject(ObjectType type, ObjectEncoding encoding);
+
+    friend class ObjectPtr;
+
+    uint32_t type_ : 4;
+    uint32_t encoding_ : 4;
+    uint32_t lru_ : LRU_BITS;
+    uint32_t refcount_;
+    static inline bool lfu_mode_ = false;
+    union Payload {
+        void* ptr;
+        long long integer;
+        struct {
+            uint8_t len;
+            char buf[7]; // 实际长度为 len + 1（含 '\0'），延伸到对象头之后
+        } embstr;
+    } u_;
+
+    static size_t embstrAllocSize(size_t len);
+
+    void free();
+};
+
+static_assert(sizeof(RedisObject) == 16, "RedisObject header should stay 16 bytes");
+
+// 侵入式智能指针：拷贝增加引用计数，析构减少引用计数
+class ObjectPtr {
+public:
+    ObjectPtr() = default;
+    ObjectPtr(std::nullptr_t) {}
+    ObjectPtr(const ObjectPtr& other) : obj_(other.obj_) {
+        if (obj_) obj_->incrRefCount();
+    }
+    ObjectPtr(ObjectPtr&& other) noexcept : obj_(std::exchange(other.obj_, nullptr)) {}
+    ~ObjectPtr() { reset(); }
+
+    ObjectPtr& operator=(ObjectPtr other) noexcept {
+        std::swap(obj_, other.obj_);
+        return *this;
+    }
+
+    // 接管一个引用（新创建的对象引用计数为 1）
+    static ObjectPtr adopt(RedisObject* obj) {
+        ObjectPtr p;
+        p.obj_ = obj;
+        return p;
+    }
+
+    void reset() {
+        if (obj_) std::exchange(obj_, nullptr)->decrRefCount();
+    }
+
+    RedisObject* get() const { return obj_; }
+    RedisObject* operator->() const { return obj_; }
+    RedisObject& operator*() const { return *obj_; }
+    explicit operator bool() const { return obj_ != nullptr; }
+
+    // --- 工厂函数 ---
+    // 按内容选择编码：可解析为整数的用共享整数或 INT，短字符串用 EMBSTR，否则 RAW
+    static ObjectPtr createString(std::string_view value);
+    static ObjectPtr createStringFromLongLong(long long value);
+    static ObjectPtr createHash();
+    static ObjectPtr createList();
+    static ObjectPtr createSet();
+    static ObjectPtr createZSet();
+
+    // 是否使用共享整数，启动时设置一次：共享对象没有自己的 lru 字段，
+    // 按 LRU / LFU 淘汰时会让这些 key 的访问信息失真（同 Redis），需要关闭
+    static void setSharedIntegers(bool enabled) { shared_integers_ = enabled; }
+
+private:
+    static inline bool shared_integers_ = true;
+
+    RedisObject* obj_ = nullptr;
+
+    static RedisObject* sharedInteger(long long value);
 };
+
+// 当前 LRU 时钟：单调时钟的秒数，取低 LRU_BITS 位（约 194 天回绕一次）
+uint32_t lruClock();
+// LFU 的时间：单调时钟的分钟数，取低 16 位（约 45 天回绕一次）
+uint32_t lfuTimeInMinutes();
+
+// TYPE / OBJECT ENCODING 使用的名字（小写）
+const char* objectTypeName(ObjectType type);
+const char* objectEncodingName(ObjectEncoding encoding);
@@ -3,22 +3,57 @@
 #include "utils.hpp"
 #include "Protocol.hpp"
 #include "Command.hpp"
-#include <sys/epoll.h>
+#include "Shard.hpp"
+#include "Database.hpp"
+#include "Memory.hpp"
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <unistd.h>
 #include <iostream>
 #include <csignal>
+#include <cstdint>
+#include <cstring>
 #include <vector>
 
-constexpr int MAX_EVENTS = 128;
 constexpr int BACKLOG = 128;
 
-Server::Server(int port) : port_(port), listen_fd_(-1), epoll_fd_(-1) {}
+Server::Server(const ServerConfig& config, CommandHandler& handler,
+               int shard_id, ShardRouter* router)
+    : config_(config), handler_(handler), shard_id_(shard_id), router_(router),
+      port_(config.port), listen_fd_(-1), wake_fd_(-1), timer_fd_(-1) {
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd_ == -1) handle_error("eventfd");
+
+    // 周期定时器：事件循环把它和其他 fd 一起等待，不需要计算 epoll_wait 的超时
+    timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (timer_fd_ == -1) handle_error("timerfd_create");
+    struct itimerspec spec{};
+    long period_ns = 1000000000L / config_.hz;
+    spec.it_interval.tv_sec = period_ns / 1000000000L;
+    spec.it_interval.tv_nsec = period_ns % 1000000000L;
+    spec.it_value = spec.it_interval;
+    if (timerfd_settime(timer_fd_, 0, &spec, nullptr) == -1) handle_error("timerfd_settime");
+}
 
 Server::~Server() {
+    loop_.reset(); // 先停掉事件循环，再释放连接
+    connections_.clear();
     if (listen_fd_ != -1) close(listen_fd_);
-    if (epoll_fd_ != -1) close(epoll_fd_);
+    if (wake_fd_ != -1) close(wake_fd_);
+    if (timer_fd_ != -1) close(timer_fd_);
+}
+
+void Server::wakeup() {
+    uint64_t one = 1;
+    ssize_t n = write(wake_fd_, &one, sizeof(one));
+    (void)n; // 计数器已满（EAGAIN）说明已有未处理的唤醒
+}
+
+void Server::requestStop() {
+    stop_requested_.store(true);
+    wakeup();
 }
 
 int Server::createListenSocket(int port) {
@@ -46,6 +81,10 @@ void Server::setup_listen_socket() {
     if (setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) == -1)
         handle_error("setsockopt SO_REUSEADDR");
 
+    // 多分片：每个分片各自 bind 同一端口，由内核在监听 socket 之间分配新连接
+    if (router_ && setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) == -1)
+        handle_error("setsockopt SO_REUSEPORT");
+
     struct sockaddr_in addr{};
     addr.sin_family = AF_INET;
     addr.sin_addr.s_addr = htonl(INADDR_ANY);
@@ -57,106 +96,241 @@ void Server::setup_listen_socket() {
     if (listen(listen_fd_, BACKLOG) == -1)
         handle_error("listen");
 
-    std::cout << "[INFO] Server listening on port " << port_ << std::endl;
+    if (router_) {
+        std::cout << "[INFO] Shard " << shard_id_ << " listening on port " << port_ << std::endl;
+    } else {
+        std::cout << "[INFO] Server listening on port " << port_ << std::endl;
+    }
 }
 
-void Server::accept_client() {
-    struct sockaddr_in client_addr;
-    socklen_t client_len = sizeof(client_addr);
-    int client_fd = accept(listen_fd_, (struct sockaddr*)&client_addr, &client_len);
-    if (client_fd == -1) {
-        if (errno != EAGAIN && errno != EWOULDBLOCK)
-            std::cerr << "[WARN] accept failed: " << std::strerror(errno) << std::endl;
-        return;
-    }
+Connection* Server::addConnection(int fd) {
+    auto conn = std::make_unique<Connection>(fd, next_conn_id_++);
+    Connection* raw = conn.get();
+    connections_[fd] = std::move(conn);
+    std::cout << "[INFO] Client connected, fd=" << fd << std::endl;
+    return raw;
+}
+
+Connection* Server::findConnection(int fd) {
+    auto it = connections_.find(fd);
+    return it == connections_.end() ? nullptr : it->second.get();
+}
+
+void Server::closeConnection(int fd) {
+    connections_.erase(fd); // Connection 析构时关闭 fd
+}
 
-    set_nonblocking(client_fd);
+void Server::run() {
+    setup_listen_socket();
 
-    // 创建 Connection 并加入管理
-    auto conn = std::make_unique<Connection>(client_fd);
-    connections_[client_fd] = std::move(conn);
+    loop_ = createEventLoop(config_.event_loop, *this);
+    std::cout << "[INFO] Event loop started (" << loop_->name() << ")." << std::endl;
+    loop_->run();
+}
 
-    // 将 client_fd 加入 epoll 监听（目前只监听可读，虽不做处理）
-    struct epoll_event ev{};
-    ev.events = EPOLLIN;
-    ev.data.fd = client_fd;
-    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, client_fd, &ev) == -1) {
-        std::cerr << "[WARN] epoll_ctl add client failed" << std::endl;
-        connections_.erase(client_fd);
-        close(client_fd);
-        return;
+void Server::processInputBuffer(Connection* conn) {
+    // 等待其他分片回复期间不执行新命令：已解析的命令和缓冲区原样保留，解除阻塞后接着执行
+    if (conn->blocked()) return;
+
+    bool blocked = false;
+    while (conn->hasPendingCommand() && !blocked) {
+        blocked = !dispatchCommand(conn, conn->nextCommand());
+        // 输出积压超过限制就断开，不再执行后续命令
+        if (closeIfOutputLimitReached(conn)) break;
     }
 
-    std::cout << "[INFO] Client connected, fd=" << client_fd << std::endl;
+    if (blocked) return;
+    if (conn->hasProtocolError() && !conn->shouldClose()) {
+        RespParser::writeError(conn->output(), "protocol error");
+    }
+    conn->finishCommands();
 }
 
-void Server::run() {
-    setup_listen_socket();
+bool Server::closeIfOutputLimitReached(Connection* conn) {
+    if (!conn->outputLimitReached(config_.outputLimit(conn->clientClass()))) return false;
+    std::cout << "[WARN] Client fd=" << conn->get_fd()
+              << " closed for overcoming of output buffer limits ("
+              << conn->pendingOutput() << " bytes)" << std::endl;
+    conn->markClosed();
+    return true;
+}
+
+// ========== 多分片路由 ==========
+
+bool Server::dispatchCommand(Connection* conn, const std::vector<std::string_view>& args) {
+    if (!router_ || router_->size() == 1) {
+        handler_.execute(args, conn->output());
+        return true;
+    }
 
-    epoll_fd_ = epoll_create1(0);
-    if (epoll_fd_ == -1) handle_error("epoll_create1");
+    // 路由由命令表中的 key 位置和标志决定；未知命令、参数个数错误由本地 handler 返回错误
+    const CommandSpec* cmd = CommandTable::instance().lookup(args[0]);
+    bool all_shards = cmd && (cmd->flags & CMD_ALL_SHARDS);
+    if (!cmd || !cmd->arityOk(args.size()) || (cmd->first_key == 0 && !all_shards)) {
+        handler_.execute(args, conn->output());
+        return true;
+    }
 
-    struct epoll_event ev{}, events[MAX_EVENTS];
-    ev.events = EPOLLIN;
-    ev.data.fd = listen_fd_;
-    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, &ev) == -1)
-        handle_error("epoll_ctl listen_fd");
+    // 可选 key 的命令（MEMORY STATS 之类）没有给出 key 时在本分片执行
+    if (!all_shards && cmd->first_key >= static_cast<int>(args.size())) {
+        handler_.execute(args, conn->output());
+        return true;
+    }
 
-    std::cout << "[INFO] Event loop started." << std::endl;
+    int n = router_->size();
+    int first = cmd->first_key;
+    int last = cmd->lastKeyIndex(args.size());
+    int step = cmd->key_step > 0 ? cmd->key_step : 1;
 
-    while (true) {
-        int nfds = epoll_wait(epoll_fd_, events, MAX_EVENTS, -1);
-        if (nfds == -1) {
-            if (errno == EINTR) continue; // 被信号中断，继续
-            handle_error("epoll_wait");
+    if (!all_shards && first == last) {
+        // 单 key 命令：key 在本分片直接执行，否则整条转发
+        int target = router_->shardOf(args[first]);
+        if (target == shard_id_) {
+            handler_.execute(args, conn->output());
+            return true;
         }
+        postRequest(conn, target, args);
+        conn->blockOn(std::make_unique<ShardFanout>(ShardFanout::Merge::FORWARD, 1));
+        return false;
+    }
 
-        for (int i = 0; i < nfds; ++i) {
-            int fd = events[i].data.fd;
-            if (fd == listen_fd_) {
-                accept_client();
-            // 在 Server::run() 的 for 循环内，替换原来的 else 块：
-            } else {
-                auto it = connections_.find(fd);
-                if (it == connections_.end()) continue;
-
-                Connection* conn = it->second.get();
-
-                // 1. 读取数据
-                if (!conn->readFromSocket()) {
-                    std::cout << "[INFO] Client disconnected, fd=" << fd << std::endl;
-                    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
-                    connections_.erase(it);
-                    continue;
-                }
-
-                // 2. 尝试解析命令
-                std::vector<std::string> args;
-                RespParser parser;
-                auto result = parser.parse(conn->getReadBuffer(), args);
-
-                if (result == RespParser::ParseResult::COMPLETE) {
-                // 3. 处理命令（阶段二：只处理 PING）
-                    // 调用全局命令处理器
-                    extern std::unique_ptr<CommandHandler> g_cmd_handler;
-                    std::string response = g_cmd_handler->execute(args);
-                    conn->sendResponse(response);
-
-                    // 临时：清空整个缓冲区（阶段三仍用此简化方案）
-                    conn->consumeInput(conn->getReadBuffer().size());
-                } else if (result == RespParser::ParseResult::ERROR) {
-                    conn->sendResponse(RespParser::encodeError("protocol error"));
-                    conn->consumeInput(conn->getReadBuffer().size()); // 清空
-                }
-                // INCOMPLETE: 等待更多数据
-
-                // 5. 尝试发送响应
-                if (!conn->writeToSocket()) {
-                    std::cout << "[INFO] Failed to write to client, closing fd=" << fd << std::endl;
-                    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
-                    connections_.erase(it);
-                }
+    // 拆分成每个分片一条子命令：命令名 + 属于该分片的 key（连同 key 之后 step-1 个参数）
+    std::vector<std::vector<std::string_view>> parts(n);
+    if (all_shards) {
+        for (auto& part : parts) part = args;
+    } else {
+        for (int i = first; i <= last; i += step) {
+            auto& part = parts[router_->shardOf(args[i])];
+            if (part.empty()) part.push_back(args[0]);
+            for (int j = i; j < i + step && j < static_cast<int>(args.size()); ++j) {
+                part.push_back(args[j]);
             }
         }
     }
+
+    int involved = 0;
+    int only = -1;
+    for (int shard = 0; shard < n; ++shard) {
+        if (!parts[shard].empty()) {
+            ++involved;
+            only = shard;
+        }
+    }
+
+    // 回复无法合并的多 key 命令（FORWARD）要求所有 key 落在同一分片
+    if (cmd->merge == ShardFanout::Merge::FORWARD && involved > 1) {
+        RespParser::writeRaw(conn->output(), "-CROSSSLOT Keys in request don't hash to the same shard\r\n");
+        return true;
+    }
+    if (cmd->merge == ShardFanout::Merge::FORWARD && only != shard_id_) {
+        postRequest(conn, only, args);
+        conn->blockOn(std::make_unique<ShardFanout>(ShardFanout::Merge::FORWARD, 1));
+        return false;
+    }
+    if (cmd->merge == ShardFanout::Merge::FORWARD) {
+        handler_.execute(args, conn->output());
+        return true;
+    }
+
+    auto fanout = std::make_unique<ShardFanout>(cmd->merge, involved);
+
+    // 本分片的部分直接执行，其余投递到对应分片
+    if (!parts[shard_id_].empty()) {
+        fanout->add(handler_.execute(parts[shard_id_]));
+    }
+    for (int shard = 0; shard < n; ++shard) {
+        if (shard != shard_id_ && !parts[shard].empty()) {
+            postRequest(conn, shard, parts[shard]);
+        }
+    }
+
+    if (fanout->done()) {
+        conn->sendResponse(fanout->result());
+        return true;
+    }
+    conn->blockOn(std::move(fanout));
+    return false;
+}
+
+void Server::postRequest(Connection* conn, int shard, const std::vector<std::string_view>& args) {
+    ShardMessage msg;
+    msg.kind = ShardMessage::Kind::REQUEST;
+    msg.from_shard = shard_id_;
+    msg.fd = conn->get_fd();
+    msg.conn_id = conn->id();
+    msg.args.assign(args.begin(), args.end()); // 参数指向本连接读缓冲区，必须拷贝
+    router_->post(shard, std::move(msg));
+}
+
+void Server::handleWakeup() {
+    if (router_) handleInbox();
+}
+
+void Server::cron() {
+    handler_.database().activeExpireCycle(false, config_.active_expire_effort, config_.hz);
+    // 上次淘汰因时间片用完而中断、之后又没有写命令时，在这里继续
+    handler_.database().performEvictions();
+    // INFO / MEMORY STATS 读取的进程合计与内存峰值
+    handler_.database().publishStats();
+    usedMemoryPeak();
+
+    // BGSAVE 子进程的写时复制上报与回收
+    handler_.database().checkBackgroundSave();
+
+    // 渐进式 rehash：写入停止后，键空间和对象内部的哈希表也会在空闲时迁移完，释放旧表。
+    // 有 BGSAVE 子进程时暂停（任一分片的子进程都共享整个进程的页），
+    // 否则迁移会写遍新旧两张表的页，把它们全部复制一份；命令触发的单步 rehash 不受影响
+    if (config_.active_rehash_us > 0 && !Database::childActive()) {
+        handler_.database().activeRehash(config_.active_rehash_us);
+    }
+}
+
+void Server::beforeSleep() {
+    // 是否真的运行由 Database 按上个周期的情况决定，大多数时候直接返回
+    handler_.database().activeExpireCycle(true, config_.active_expire_effort, config_.hz);
+}
+
+void Server::handleInbox() {
+    // 先清除唤醒标记再取消息，之后到达的消息会重新唤醒
+    router_->clearNotified(shard_id_);
+
+    std::vector<int> resumed;
+    std::vector<std::string_view> views;
+    ShardMessage msg;
+
+    while (router_->poll(shard_id_, msg)) {
+        if (msg.kind == ShardMessage::Kind::REQUEST) {
+            views.assign(msg.args.begin(), msg.args.end());
+            ShardMessage reply;
+            reply.kind = ShardMessage::Kind::REPLY;
+            reply.from_shard = shard_id_;
+            reply.fd = msg.fd;
+            reply.conn_id = msg.conn_id;
+            reply.reply = handler_.execute(views);
+            router_->post(msg.from_shard, std::move(reply));
+            continue;
+        }
+
+        auto it = connections_.find(msg.fd);
+        if (it == connections_.end() || it->second->id() != msg.conn_id) {
+            continue; // 发起请求的连接已关闭
+        }
+        if (it->second->addShardReply(msg.reply)) {
+            // 合并后的回复（例如跨分片的 MGET / KEYS）同样受输出缓冲区限制
+            closeIfOutputLimitReached(it->second.get());
+            resumed.push_back(msg.fd);
+        }
+    }
+
+    // 解除阻塞的连接：从阻塞处继续执行本批命令，然后交给事件循环写出
+    // （parseInput 只解析尚未解析的字节，并在缓冲区搬移过时重新定位已解析的命令）
+    for (int fd : resumed) {
+        Connection* conn = findConnection(fd);
+        if (!conn) continue;
+        if (!conn->shouldClose()) {
+            conn->parseInput();
+            processInputBuffer(conn);
+        }
+        loop_->flush(conn);
+    }
 }
\ No newline at end of file
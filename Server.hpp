@@ -2,25 +2,87 @@
 #pragma once
 #include <unordered_map>
 #include <memory>
+#include <atomic>
+#include <string_view>
+#include <vector>
 #include "Connection.hpp"
-#include "Database.hpp"
+#include "Config.hpp"
+#include "EventLoop.hpp"
+
+class CommandHandler;
+class ShardRouter;
 
 class Server {
 public:
-    Server(int port = 6380);
+    // 单 reactor：shard_id = 0，router 为空
+    // 多分片：每个分片一个 Server，共享同一个 router
+    Server(const ServerConfig& config, CommandHandler& handler,
+           int shard_id = 0, ShardRouter* router = nullptr);
     ~Server();
-    void run();  // 主事件循环
+    void run();  // 创建监听 socket 并运行事件循环（按配置选择后端），requestStop() 后返回
+
+    // 唤醒事件循环（写 eventfd），可在任意线程调用
+    void wakeup();
+
+    // 请求事件循环退出；只做原子写和 write()，可在信号处理函数中调用
+    void requestStop();
+
+    // ---- 供事件循环后端调用（均在事件循环线程） ----
+    const ServerConfig& config() const { return config_; }
+    int listenFd() const { return listen_fd_; }
+    int wakeFd() const { return wake_fd_; }
+    int timerFd() const { return timer_fd_; }
+    bool stopRequested() const { return stop_requested_.load(); }
+
+    // 新连接：创建 Connection 并纳入管理
+    Connection* addConnection(int fd);
+    Connection* findConnection(int fd);
+    // 释放连接（Connection 析构时关闭 fd）
+    void closeConnection(int fd);
+
+    // 在主线程执行已解析的全部命令，只消费实际解析的字节
+    void processInputBuffer(Connection* conn);
+
+    // wake_fd_ 可读（已读出计数）后调用：处理其他分片投递的请求和回复
+    void handleWakeup();
+
+    // 定时任务：timer_fd_ 到期（每秒 config.hz 次）后，由事件循环在本轮末尾调用，
+    // 空闲时也会执行。依次做主动过期（慢速周期）、未完成的淘汰和 active_rehash_us 时间片内的
+    // 渐进式 rehash
+    void cron();
+
+    // 每轮事件循环结束、再次等待事件之前调用：过期 key 积压时运行快速过期周期
+    void beforeSleep();
 
 private:
     void setup_listen_socket();
-    void accept_client();
     int createListenSocket(int port);
 
+    // 慢消费者：输出积压超过所属类别的限制时标记关闭并返回 true
+    bool closeIfOutputLimitReached(Connection* conn);
+
+    // 执行一条命令：多分片模式下按 key 路由，需要等待其他分片时返回 false（连接被阻塞）
+    bool dispatchCommand(Connection* conn, const std::vector<std::string_view>& args);
+    void postRequest(Connection* conn, int shard, const std::vector<std::string_view>& args);
+
+    // 处理其他分片投递的请求和回复
+    void handleInbox();
+
+    ServerConfig config_;
+    CommandHandler& handler_;
+    int shard_id_;
+    ShardRouter* router_;
     int port_;
     int listen_fd_;
-    int epoll_fd_;
-    Database db_;  
-    
+    int wake_fd_;             // eventfd：跨分片消息到达或请求停止时唤醒事件循环
+    int timer_fd_;            // timerfd：按 hz 周期触发 cron()
+    std::atomic<bool> stop_requested_{false};
+    uint64_t next_conn_id_ = 1;
+
+
     // 管理所有客户端连接：fd -> Connection
     std::unordered_map<int, std::unique_ptr<Connection>> connections_;
+
+    // 最后声明：先于连接销毁（io_uring 后端可能仍持有连接输出缓冲区的 iovec）
+    std::unique_ptr<EventLoop> loop_;
 };
\ No newline at end of file
@@ -1,143 +1,189 @@
 // SetObject.cpp
 #include "SetObject.hpp"
-#include <cctype>
-#include <cstdlib>
-#include <limits>
-#include <errno.h>
+#include "Protocol.hpp" // string2ll / ll2string
+#include <algorithm>
 
 SetObject::SetObject()
-    : RedisObject(ObjectType::SET)
-    , encoding_(ObjectEncoding::INTSET)
+    : encoding_(ObjectEncoding::INTSET)
     , storage_(intset{}) {}
 
-std::optional<int64_t> SetObject::tryParseInt(const std::string& s) {
-    if (s.empty()) return std::nullopt;
+void SetObject::promote_to_hashtable() {
+    if (encoding_ != ObjectEncoding::INTSET) return;
 
-    size_t start = 0;
-    if (s[0] == '+' || s[0] == '-') {
-        if (s.size() == 1) return std::nullopt;
-        start = 1;
-    }
+    Dict new_dict;
+    char buf[RedisObject::LONG_STR_SIZE];
+    get_intset().for_each([&](int64_t v) {
+        new_dict.set_field(std::string_view(buf, ll2string(buf, v)), {});
+    });
+
+    storage_ = std::move(new_dict);
+    encoding_ = ObjectEncoding::HASHTABLE;
+}
 
-    for (size_t i = start; i < s.size(); ++i) {
-        if (!std::isdigit(static_cast<unsigned char>(s[i]))) {
-            return std::nullopt;
+// 整数按严格格式解析（"007"、"+1" 之类不算整数），保证取出时与写入的字符串一致
+bool SetObject::add(std::string_view member) {
+    if (encoding_ == ObjectEncoding::INTSET) {
+        long long v;
+        if (string2ll(member, v)) {
+            intset& is = get_intset();
+            if (!is.insert(v)) return false;
+            if (is.size() > max_intset_entries_) promote_to_hashtable();
+            return true;
         }
+        // 非整数，必须升级
+        promote_to_hashtable();
     }
+    Dict& dict = get_hashtable();
+    std::string_view value;
+    if (dict.find_value(member, value)) return false;
+    dict.set_field(member, {});
+    return true;
+}
 
-    char* end;
-    const char* cstr = s.c_str();
-    errno = 0;
-    long long val = std::strtoll(cstr, &end, 10);
-
-    if (errno == ERANGE || end != cstr + s.size()) {
-        return std::nullopt;
+bool SetObject::remove(std::string_view member) {
+    if (encoding_ == ObjectEncoding::INTSET) {
+        long long v;
+        return string2ll(member, v) && get_intset().erase(v);
     }
+    return get_hashtable().del_field(member);
+}
 
-    if (val < std::numeric_limits<int64_t>::min() ||
-        val > std::numeric_limits<int64_t>::max()) {
-        return std::nullopt;
+bool SetObject::contains(std::string_view member) const {
+    if (encoding_ == ObjectEncoding::INTSET) {
+        long long v;
+        return string2ll(member, v) && get_intset().contains(v);
     }
-
-    return static_cast<int64_t>(val);
+    std::string_view value;
+    return get_hashtable().find_value(member, value);
 }
 
-bool SetObject::should_use_intset() const {
-    if (encoding_ != ObjectEncoding::INTSET) return false;
-    return get_intset().size() < INTSET_MAX_ENTRIES;
+size_t SetObject::size() const {
+    if (encoding_ == ObjectEncoding::INTSET) {
+        return get_intset().size();
+    }
+    return get_hashtable().size();
 }
 
-void SetObject::promote_to_strset() {
-    if (encoding_ != ObjectEncoding::INTSET) return;
+bool SetObject::is_rehashing() const {
+    return encoding_ == ObjectEncoding::HASHTABLE && get_hashtable().is_rehashing();
+}
 
-    std::unordered_set<std::string> new_set;
-    const auto& is = get_intset();
-    new_set.reserve(is.size());
-    for (int64_t v : is.data()) {
-        new_set.emplace(std::to_string(v));
-    }
+bool SetObject::rehash_step(int n) {
+    if (!is_rehashing()) return false;
+    get_hashtable().rehash_step(n);
+    return get_hashtable().is_rehashing();
+}
 
-    storage_ = std::move(new_set);
-    encoding_ = ObjectEncoding::STRSET;
+void SetObject::appendMembers(const intset& is, std::vector<std::string>& out) {
+    out.reserve(out.size() + is.size());
+    char buf[RedisObject::LONG_STR_SIZE];
+    is.for_each([&](int64_t v) { out.emplace_back(buf, ll2string(buf, v)); });
 }
 
-bool SetObject::add(const std::string& member) {
+std::vector<std::string> SetObject::members() const {
+    std::vector<std::string> result;
     if (encoding_ == ObjectEncoding::INTSET) {
-        auto intval = tryParseInt(member);
-        if (intval.has_value()) {
-            if (should_use_intset()) {
-                return get_intset().insert(*intval);
-            } else {
-                // 超过阈值，先升级再插入
-                promote_to_strset();
-                return get_strset().insert(member).second;
-            }
-        } else {
-            // 非整数，必须升级
-            promote_to_strset();
-            return get_strset().insert(member).second;
-        }
+        appendMembers(get_intset(), result);
     } else {
-        return get_strset().insert(member).second;
+        auto all = get_hashtable().get_all();
+        result.reserve(all.size());
+        for (auto& kv : all) {
+            result.push_back(std::move(kv.first));
+        }
     }
+    return result;
 }
 
-bool SetObject::remove(const std::string& member) {
+size_t SetObject::memory_usage() const {
     if (encoding_ == ObjectEncoding::INTSET) {
-        auto intval = tryParseInt(member);
-        if (intval.has_value()) {
-            return get_intset().erase(*intval);
-        }
-        return false;
-    } else {
-        return get_strset().erase(member) > 0;
+        return sizeof(*this) + get_intset().blob_bytes();
     }
+    return sizeof(*this) + get_hashtable().memory_usage();
 }
 
-bool SetObject::contains(const std::string& member) const {
-    if (encoding_ == ObjectEncoding::INTSET) {
-        auto intval = tryParseInt(member);
-        if (intval.has_value()) {
-            return get_intset().contains(*intval);
+// ================== 集合运算 ==================
+
+static bool allIntsets(const std::vector<const SetObject*>& sets) {
+    return std::all_of(sets.begin(), sets.end(),
+                       [](const SetObject* s) { return s->encoding() == ObjectEncoding::INTSET; });
+}
+
+void SetObject::intersect(std::vector<const SetObject*> sets, std::vector<std::string>& out) {
+    if (sets.empty()) return;
+    // 从最小的集合开始，中间结果只会越来越小
+    std::sort(sets.begin(), sets.end(),
+              [](const SetObject* a, const SetObject* b) { return a->size() < b->size(); });
+    if (sets[0]->size() == 0) return;
+
+    if (allIntsets(sets)) {
+        if (sets.size() == 1) {
+            appendMembers(sets[0]->get_intset(), out);
+            return;
         }
-        return false;
-    } else {
-        return get_strset().count(member) > 0;
+        intset acc, tmp;
+        intset::intersect(sets[0]->get_intset(), sets[1]->get_intset(), acc);
+        for (size_t i = 2; i < sets.size() && !acc.empty(); ++i) {
+            intset::intersect(acc, sets[i]->get_intset(), tmp);
+            std::swap(acc, tmp);
+        }
+        appendMembers(acc, out);
+        return;
     }
-}
 
-size_t SetObject::size() const {
-    if (encoding_ == ObjectEncoding::INTSET) {
-        return get_intset().size();
+    for (auto& member : sets[0]->members()) {
+        bool in_all = true;
+        for (size_t i = 1; i < sets.size() && in_all; ++i) {
+            in_all = sets[i]->contains(member);
+        }
+        if (in_all) out.push_back(std::move(member));
     }
-    return get_strset().size();
 }
 
-std::vector<std::string> SetObject::members() const {
-    std::vector<std::string> result;
-    if (encoding_ == ObjectEncoding::INTSET) {
-        const auto& is = get_intset();
-        result.reserve(is.size());
-        for (int64_t v : is.data()) {
-            result.push_back(std::to_string(v));
+void SetObject::unite(const std::vector<const SetObject*>& sets, std::vector<std::string>& out) {
+    if (sets.empty()) return;
+    if (allIntsets(sets)) {
+        intset acc, tmp;
+        for (const SetObject* s : sets) {
+            intset::unite(acc, s->get_intset(), tmp);
+            std::swap(acc, tmp);
         }
-    } else {
-        const auto& ss = get_strset();
-        result.assign(ss.begin(), ss.end());
+        appendMembers(acc, out);
+        return;
     }
-    return result;
+
+    // 有字符串成员：合并到一个临时集合里去重
+    SetObject acc;
+    for (const SetObject* s : sets) {
+        for (const auto& member : s->members()) {
+            acc.add(member);
+        }
+    }
+    auto result = acc.members();
+    out.insert(out.end(), std::make_move_iterator(result.begin()), std::make_move_iterator(result.end()));
 }
 
-size_t SetObject::memory_usage() const {
-    size_t base = sizeof(SetObject);
-    if (encoding_ == ObjectEncoding::INTSET) {
-        const auto& is = get_intset();
-        base += is.size() * sizeof(int64_t);
-    } else {
-        const auto& ss = get_strset();
-        for (const auto& s : ss) {
-            base += sizeof(std::string) + s.capacity();
+void SetObject::difference(const std::vector<const SetObject*>& sets, std::vector<std::string>& out) {
+    if (sets.empty() || sets[0]->size() == 0) return;
+    if (allIntsets(sets)) {
+        if (sets.size() == 1) {
+            appendMembers(sets[0]->get_intset(), out);
+            return;
+        }
+        intset acc, tmp;
+        intset::difference(sets[0]->get_intset(), sets[1]->get_intset(), acc);
+        for (size_t i = 2; i < sets.size() && !acc.empty(); ++i) {
+            intset::difference(acc, sets[i]->get_intset(), tmp);
+            std::swap(acc, tmp);
+        }
+        appendMembers(acc, out);
+        return;
+    }
+
+    for (auto& member : sets[0]->members()) {
+        bool found = false;
+        for (size_t i = 1; i < sets.size() && !found; ++i) {
+            found = sets[i]->contains(member);
         }
+        if (!found) out.push_back(std::move(member));
     }
-    return base;
-}
\ No newline at end of file
+}
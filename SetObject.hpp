@@ -1,53 +1,67 @@
 // SetObject.hpp
 #pragma once
 #include "RedisObject.hpp"
-#include "intset.hpp"  // 你的 intset 实现
-#include <unordered_set>
+#include "Dict.hpp"
+#include "intset.hpp"
 #include <variant>
 #include <vector>
 #include <string>
-#include <optional>
+#include <string_view>
 
-enum class ObjectEncoding {
-    INTSET,
-    STRSET  // 对应 unordered_set<std::string>
-};
-
-class SetObject : public RedisObject {
+// 集合对象的负载（由 RedisObject 的负载指针持有，对象头不在这里）
+// 成员全是整数且不超过 maxIntsetEntries() 个时用 intset（有序整数数组），
+// 出现非整数成员或成员数超过阈值后转换为 Dict（value 为空）
+class SetObject {
 public:
-    static constexpr size_t INTSET_MAX_ENTRIES = 512;
+    // 与 Redis 默认的 set-max-intset-entries 一致
+    static constexpr size_t DEFAULT_MAX_INTSET_ENTRIES = 512;
+
+    // 启动时按配置设置一次
+    static void setMaxIntsetEntries(size_t n) { max_intset_entries_ = n; }
+    static size_t maxIntsetEntries() { return max_intset_entries_; }
 
     SetObject();
 
-    size_t memory_usage() const override;
+    size_t memory_usage() const;
 
     // 核心操作
-    bool add(const std::string& member);
-    bool remove(const std::string& member);
-    bool contains(const std::string& member) const;
+    bool add(std::string_view member);
+    bool remove(std::string_view member);
+    bool contains(std::string_view member) const;
     size_t size() const;
     ObjectEncoding encoding() const { return encoding_; }
 
-    // 返回所有成员（统一为 string）
+    // hashtable 编码时由定时任务推进 rehash，用法同 HashObject
+    bool is_rehashing() const;
+    bool rehash_step(int n);
+
+    // 返回所有成员（intset 按升序，hashtable 无序）
     std::vector<std::string> members() const;
 
-    // 安全访问内部结构（用于调试或 RDB）
+    // 集合运算（SINTER / SUNION / SDIFF），结果追加到 out
+    // 参与运算的集合都是 intset 时直接在整数数组上归并，不经过字符串和哈希
+    static void intersect(std::vector<const SetObject*> sets, std::vector<std::string>& out);
+    static void unite(const std::vector<const SetObject*>& sets, std::vector<std::string>& out);
+    // sets[0] 减去其余集合
+    static void difference(const std::vector<const SetObject*>& sets, std::vector<std::string>& out);
+
+    // 安全访问内部结构（用于 rehash 和持久化）
     const intset& get_intset() const { return std::get<0>(storage_); }
-    const std::unordered_set<std::string>& get_strset() const { return std::get<1>(storage_); }
+    Dict& get_hashtable() { return std::get<1>(storage_); }
+    const Dict& get_hashtable() const { return std::get<1>(storage_); }
 
 private:
-    static std::optional<int64_t> tryParseInt(const std::string& s);
-    void promote_to_strset();
-
-    bool should_use_intset() const;
+    static inline size_t max_intset_entries_ = DEFAULT_MAX_INTSET_ENTRIES;
 
     ObjectEncoding encoding_;
     std::variant<
-        intset,                          // 编码: INTSET
-        std::unordered_set<std::string>  // 编码: STRSET
+        intset, // 编码: INTSET
+        Dict    // 编码: HASHTABLE
     > storage_;
 
-    // 辅助访问
     intset& get_intset() { return std::get<0>(storage_); }
-    std::unordered_set<std::string>& get_strset() { return std::get<1>(storage_); }
-};
\ No newline at end of file
+
+    void promote_to_hashtable();
+
+    static void appendMembers(const intset& is, std::vector<std::string>& out);
+};
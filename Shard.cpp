@@ -0,0 +1,138 @@
+// Shard.cpp
+#include "Shard.hpp"
+#include "Server.hpp"
+#include "Database.hpp"
+#include "Command.hpp"
+#include <pthread.h>
+#include <sched.h>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+
+// ========== ShardFanout ==========
+
+bool ShardFanout::add(std::string_view reply) {
+    if (remaining_ > 0) --remaining_;
+
+    if (!reply.empty() && reply[0] == '-') {
+        if (error_.empty()) error_.assign(reply);
+        return done();
+    }
+
+    switch (merge_) {
+    case Merge::FORWARD:
+    case Merge::STATUS:
+        if (body_.empty()) body_.assign(reply);
+        break;
+    case Merge::SUM:
+        // ":<n>\r\n"
+        if (reply.size() > 1 && reply[0] == ':') {
+            sum_ += std::strtoll(reply.data() + 1, nullptr, 10);
+        }
+        break;
+    case Merge::CONCAT: {
+        // "*<n>\r\n<elements...>"：累加元素个数，拼接头部之后的内容
+        size_t header_end = reply.find("\r\n");
+        if (reply.size() > 1 && reply[0] == '*' && header_end != std::string_view::npos) {
+            array_len_ += std::strtoull(reply.data() + 1, nullptr, 10);
+            body_.append(reply.substr(header_end + 2));
+        }
+        break;
+    }
+    }
+    return done();
+}
+
+std::string ShardFanout::result() const {
+    if (!error_.empty()) return error_;
+
+    switch (merge_) {
+    case Merge::SUM:
+        return RespParser::encodeInteger(sum_);
+    case Merge::CONCAT:
+        return "*" + std::to_string(array_len_) + "\r\n" + body_;
+    default:
+        return body_;
+    }
+}
+
+// ========== ShardRouter ==========
+
+ShardRouter::ShardRouter(int num_shards) : num_shards_(num_shards) {
+    for (int i = 0; i < num_shards; ++i) {
+        inboxes_.push_back(std::make_unique<Inbox>());
+    }
+}
+
+int ShardRouter::shardOf(std::string_view key) const {
+    return static_cast<int>(std::hash<std::string_view>{}(key) % num_shards_);
+}
+
+void ShardRouter::post(int shard, ShardMessage msg) {
+    Inbox& inbox = *inboxes_[shard];
+    inbox.queue.push(std::move(msg));
+    // 目标分片已被唤醒但尚未开始取消息时不再重复写 eventfd
+    if (!inbox.notified.exchange(true)) {
+        inbox.server->wakeup();
+    }
+}
+
+void ShardRouter::clearNotified(int shard) {
+    inboxes_[shard]->notified.store(false);
+}
+
+bool ShardRouter::poll(int shard, ShardMessage& out) {
+    return inboxes_[shard]->queue.pop(out);
+}
+
+// ========== ShardedServer ==========
+
+ShardedServer::ShardedServer(const ServerConfig& config)
+    : config_(config), router_(config.shards) {
+    for (int i = 0; i < config.shards; ++i) {
+        auto shard = std::make_unique<Shard>();
+        shard->db = std::make_unique<Database>("dump-" + std::to_string(i) + ".rdb", true);
+        shard->handler = std::make_unique<CommandHandler>(*shard->db);
+        shard->server = std::make_unique<Server>(config_, *shard->handler, i, &router_);
+        router_.attach(i, shard->server.get());
+        shards_.push_back(std::move(shard));
+    }
+}
+
+ShardedServer::~ShardedServer() {
+    stop();
+    for (auto& shard : shards_) {
+        if (shard->thread.joinable()) shard->thread.join();
+    }
+}
+
+void ShardedServer::run() {
+    unsigned ncpu = std::thread::hardware_concurrency();
+    if (ncpu == 0) ncpu = 1;
+
+    for (size_t i = 0; i < shards_.size(); ++i) {
+        Shard* shard = shards_[i].get();
+        shard->thread = std::thread([shard, i, ncpu] {
+            // 每个分片绑定一个核，减少迁移和缓存失效
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(i % ncpu, &set);
+            pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+
+            shard->server->run();
+            shard->db->killBackgroundSave();
+            shard->db->saveRdb();
+        });
+    }
+
+    for (auto& shard : shards_) {
+        shard->thread.join();
+    }
+    std::cout << "[INFO] All " << shards_.size() << " shards stopped." << std::endl;
+}
+
+void ShardedServer::stop() {
+    for (auto& shard : shards_) {
+        shard->server->requestStop();
+    }
+}
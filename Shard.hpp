@@ -0,0 +1,118 @@
+// Shard.hpp
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+#include "Config.hpp"
+#include "MpscQueue.hpp"
+
+class Server;
+class Database;
+class CommandHandler;
+
+// 分片之间传递的消息：请求由 key 所在分片执行，结果原路返回发起连接所在的分片
+struct ShardMessage {
+    enum class Kind {
+        REQUEST,
+        REPLY
+    };
+
+    Kind kind = Kind::REQUEST;
+    int from_shard = 0;             // 发送方分片
+    int fd = -1;                    // 发起请求的连接（回复时原样带回）
+    uint64_t conn_id = 0;           // 防止 fd 被复用后把回复发给新连接
+    std::vector<std::string> args;  // REQUEST：命令参数（拥有所有权，不能引用对方的读缓冲区）
+    std::string reply;              // REPLY：RESP 编码的结果
+};
+
+// 一条命令拆分到多个分片执行时，收集各分片的回复并合并成一个 RESP 响应
+class ShardFanout {
+public:
+    enum class Merge {
+        FORWARD,  // 只有一个分片参与，原样转发
+        SUM,      // 整数求和（DEL / EXISTS）
+        CONCAT,   // 数组拼接（KEYS）
+        STATUS    // 全部成功返回第一个状态回复，否则返回第一个错误（SAVE / FLUSHALL）
+    };
+
+    ShardFanout(Merge merge, int expected) : merge_(merge), remaining_(expected) {}
+
+    // 加入一个分片的回复，返回是否已收齐
+    bool add(std::string_view reply);
+    bool done() const { return remaining_ == 0; }
+    int remaining() const { return remaining_; }
+
+    // 收齐后调用，生成合并后的响应
+    std::string result() const;
+
+private:
+    Merge merge_;
+    int remaining_;
+    long long sum_ = 0;
+    size_t array_len_ = 0;
+    std::string body_;   // FORWARD/STATUS 的回复，或 CONCAT 拼接的数组元素
+    std::string error_;  // 第一个错误回复
+};
+
+// 分片路由：key -> 分片，以及每个分片的无锁收件箱
+class ShardRouter {
+public:
+    explicit ShardRouter(int num_shards);
+
+    int size() const { return num_shards_; }
+    int shardOf(std::string_view key) const;
+
+    // 注册分片对应的 reactor，用于投递消息后唤醒
+    void attach(int shard, Server* server) { inboxes_[shard]->server = server; }
+
+    // 投递消息；目标分片空闲时通过其 eventfd 唤醒（已有未处理的唤醒则不重复写）
+    void post(int shard, ShardMessage msg);
+
+    // 目标分片取消息前调用：清除唤醒标记，之后的投递会重新唤醒
+    void clearNotified(int shard);
+
+    bool poll(int shard, ShardMessage& out);
+
+private:
+    struct Inbox {
+        MpscQueue<ShardMessage> queue;
+        std::atomic<bool> notified{false};
+        Server* server = nullptr;
+    };
+
+    int num_shards_;
+    std::vector<std::unique_ptr<Inbox>> inboxes_;
+};
+
+// Shared-nothing 多 reactor 模式
+// - 每个分片一个线程（绑定到一个 CPU 核）、一个 epoll 循环、一个 SO_REUSEPORT 监听 socket，
+//   以及独立的 Database / CommandHandler，数据结构全部单线程访问
+// - 连接由内核按 REUSEPORT 分配到任意分片；key 按哈希路由，跨分片命令通过 ShardRouter 转发
+// - 每个分片持久化到自己的 dump-<i>.rdb；key 的归属取决于分片数，重启时分片数需保持不变
+class ShardedServer {
+public:
+    explicit ShardedServer(const ServerConfig& config);
+    ~ShardedServer();
+
+    // 启动所有分片并阻塞，直到 stop() 后全部退出
+    void run();
+
+    // 请求所有分片停止（只写 eventfd，可在信号处理函数中调用）
+    void stop();
+
+private:
+    struct Shard {
+        std::unique_ptr<Database> db;
+        std::unique_ptr<CommandHandler> handler;
+        std::unique_ptr<Server> server;
+        std::thread thread;
+    };
+
+    ServerConfig config_;
+    ShardRouter router_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+};
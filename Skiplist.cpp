@@ -0,0 +1,273 @@
+// Skiplist.cpp
+#include "Skiplist.hpp"
+#include "Hash.hpp"
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <utility>
+
+namespace {
+
+// 随机层数：每层晋升概率 1/4。一个 64 位随机数的尾部每有两个 0 位多一层，
+// 不需要像 Redis 那样循环调用 random()；最高位强制为 1，层数不超过 MAX_LEVEL
+uint32_t randomLevel() {
+    // xorshift64*，每个线程（分片）一份状态
+    thread_local uint64_t state = hashSeed() | 1;
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    uint64_t r = state * 0x2545F4914F6CDD1DULL;
+    return 1 + static_cast<uint32_t>(__builtin_ctzll(r | (1ULL << 62))) / 2;
+}
+
+// (score, member) 排序：分数相同按 member 字节序
+bool lessThan(const Skiplist::Node* node, double score, std::string_view member) {
+    return node->score < score || (node->score == score && node->member() < member);
+}
+
+} // namespace
+
+static_assert(1 + 62 / 2 == Skiplist::MAX_LEVEL, "randomLevel() caps at MAX_LEVEL");
+
+// ========== 节点 ==========
+
+size_t Skiplist::allocSize(uint32_t height, size_t len) {
+    return offsetof(Node, level) + height * sizeof(Node::Level) + len;
+}
+
+Skiplist::Node* Skiplist::createNode(uint32_t height, double score, std::string_view member, uint64_t hash) {
+    size_t bytes = allocSize(height, member.size());
+    auto* node = static_cast<Node*>(::operator new(bytes));
+    node->score = score;
+    node->backward = nullptr;
+    node->hnext = nullptr;
+    node->hash = hash;
+    node->len = static_cast<uint32_t>(member.size());
+    node->height = height;
+    for (uint32_t i = 0; i < height; ++i) {
+        node->level[i] = {nullptr, 0};
+    }
+    // 头节点的 member 是 {}，data() 为 nullptr，不能交给 memcpy
+    if (!member.empty()) std::memcpy(node->level + height, member.data(), member.size());
+    node_bytes_ += bytes;
+    return node;
+}
+
+void Skiplist::destroyNode(Node* node) {
+    node_bytes_ -= allocSize(node->height, node->len);
+    ::operator delete(node);
+}
+
+// ========== 构造 / 析构 ==========
+
+Skiplist::Skiplist() {
+    header_ = createNode(MAX_LEVEL, 0, {}, 0);
+}
+
+Skiplist::~Skiplist() {
+    freeAll();
+}
+
+void Skiplist::freeAll() {
+    if (!header_) return;
+    Node* node = header_->level[0].forward;
+    while (node) {
+        Node* next = node->level[0].forward;
+        destroyNode(node);
+        node = next;
+    }
+    destroyNode(header_);
+    header_ = nullptr;
+}
+
+Skiplist::Skiplist(Skiplist&& other) noexcept
+    : header_(std::exchange(other.header_, nullptr))
+    , tail_(std::exchange(other.tail_, nullptr))
+    , length_(std::exchange(other.length_, 0))
+    , level_(std::exchange(other.level_, 1))
+    , node_bytes_(std::exchange(other.node_bytes_, 0))
+    , index_(std::move(other.index_)) {}
+
+Skiplist& Skiplist::operator=(Skiplist&& other) noexcept {
+    if (this != &other) {
+        freeAll();
+        header_ = std::exchange(other.header_, nullptr);
+        tail_ = std::exchange(other.tail_, nullptr);
+        length_ = std::exchange(other.length_, 0);
+        level_ = std::exchange(other.level_, 1);
+        node_bytes_ = std::exchange(other.node_bytes_, 0);
+        index_ = std::move(other.index_); // 节点已由 freeAll 释放
+    }
+    return *this;
+}
+
+size_t Skiplist::memory_usage() const {
+    return sizeof(*this) + node_bytes_ + index_.bucket_count() * sizeof(Node*);
+}
+
+// ========== 跳表 ==========
+
+void Skiplist::locate(double score, std::string_view member, Node** update, size_t* rank) const {
+    Node* x = header_;
+    for (int i = level_ - 1; i >= 0; --i) {
+        rank[i] = i == level_ - 1 ? 0 : rank[i + 1];
+        while (x->level[i].forward && lessThan(x->level[i].forward, score, member)) {
+            rank[i] += x->level[i].span;
+            x = x->level[i].forward;
+        }
+        update[i] = x;
+    }
+}
+
+// 把 node 链到 update[] 之后；rank[i] 是 update[i] 的排名
+void Skiplist::link(Node* node, Node** update, const size_t* rank) {
+    int height = static_cast<int>(node->height);
+    size_t ranks[MAX_LEVEL];
+    std::memcpy(ranks, rank, sizeof(size_t) * level_);
+    if (height > level_) {
+        for (int i = level_; i < height; ++i) {
+            ranks[i] = 0;
+            update[i] = header_;
+            update[i]->level[i].span = length_;
+        }
+        level_ = height;
+    }
+    for (int i = 0; i < height; ++i) {
+        node->level[i].forward = update[i]->level[i].forward;
+        update[i]->level[i].forward = node;
+        // update[i] 到 node 之间隔了 ranks[0] - ranks[i] 个节点
+        node->level[i].span = update[i]->level[i].span - (ranks[0] - ranks[i]);
+        update[i]->level[i].span = ranks[0] - ranks[i] + 1;
+    }
+    // 更高的层从 node 上方跨过，跨度加一
+    for (int i = height; i < level_; ++i) {
+        update[i]->level[i].span++;
+    }
+    node->backward = update[0] == header_ ? nullptr : update[0];
+    if (node->level[0].forward) {
+        node->level[0].forward->backward = node;
+    } else {
+        tail_ = node;
+    }
+    length_++;
+}
+
+void Skiplist::unlink(Node* node, Node** update) {
+    for (int i = 0; i < level_; ++i) {
+        if (update[i]->level[i].forward == node) {
+            update[i]->level[i].span += node->level[i].span - 1;
+            update[i]->level[i].forward = node->level[i].forward;
+        } else {
+            update[i]->level[i].span--;
+        }
+    }
+    if (node->level[0].forward) {
+        node->level[0].forward->backward = node->backward;
+    } else {
+        tail_ = node->backward;
+    }
+    while (level_ > 1 && !header_->level[level_ - 1].forward) {
+        level_--;
+    }
+    length_--;
+}
+
+Skiplist::Node* Skiplist::insert(double score, std::string_view member) {
+    if (index_.is_rehashing()) index_.rehash_step(1);
+
+    Node* update[MAX_LEVEL];
+    size_t rank[MAX_LEVEL];
+    locate(score, member, update, rank);
+    Node* node = createNode(randomLevel(), score, member, hashString(member));
+    link(node, update, rank);
+    index_.insert(node);
+    return node;
+}
+
+void Skiplist::updateScore(Node* node, double score) {
+    // 新分数仍夹在前后节点之间：原地修改
+    if ((!node->backward || node->backward->score < score) &&
+        (!node->level[0].forward || node->level[0].forward->score > score)) {
+        node->score = score;
+        return;
+    }
+    Node* update[MAX_LEVEL];
+    size_t rank[MAX_LEVEL];
+    locate(node->score, node->member(), update, rank);
+    unlink(node, update);
+    node->score = score;
+    locate(score, node->member(), update, rank);
+    link(node, update, rank);
+}
+
+bool Skiplist::erase(std::string_view member) {
+    Node* node = find(member);
+    if (!node) return false;
+    Node* update[MAX_LEVEL];
+    size_t rank[MAX_LEVEL];
+    locate(node->score, member, update, rank);
+    unlink(node, update);
+    index_.remove(node->hash, [node](const Node* p) { return p == node; });
+    destroyNode(node);
+    return true;
+}
+
+size_t Skiplist::rank(const Node* node) const {
+    std::string_view member = node->member();
+    size_t rank = 0;
+    const Node* x = header_;
+    for (int i = level_ - 1; i >= 0; --i) {
+        // 前进到不超过 node 的最后一个节点
+        while (x->level[i].forward && (x->level[i].forward == node ||
+                                       lessThan(x->level[i].forward, node->score, member))) {
+            rank += x->level[i].span;
+            x = x->level[i].forward;
+        }
+        if (x == node) return rank;
+    }
+    return 0;
+}
+
+Skiplist::Node* Skiplist::byRank(size_t rank) const {
+    if (rank == 0 || rank > length_) return nullptr;
+    size_t traversed = 0;
+    Node* x = header_;
+    for (int i = level_ - 1; i >= 0; --i) {
+        while (x->level[i].forward && traversed + x->level[i].span <= rank) {
+            traversed += x->level[i].span;
+            x = x->level[i].forward;
+        }
+        if (traversed == rank) return x;
+    }
+    return nullptr;
+}
+
+Skiplist::Node* Skiplist::firstInRange(const ZRangeSpec& range) const {
+    if (range.empty() || !tail_ || !range.gteMin(tail_->score)) return nullptr;
+    Node* x = header_;
+    for (int i = level_ - 1; i >= 0; --i) {
+        while (x->level[i].forward && !range.gteMin(x->level[i].forward->score)) {
+            x = x->level[i].forward;
+        }
+    }
+    x = x->level[0].forward; // 一定存在：表尾在区间下界之上
+    return range.lteMax(x->score) ? x : nullptr;
+}
+
+Skiplist::Node* Skiplist::lastInRange(const ZRangeSpec& range) const {
+    Node* head = header_->level[0].forward;
+    if (range.empty() || !head || !range.lteMax(head->score)) return nullptr;
+    Node* x = header_;
+    for (int i = level_ - 1; i >= 0; --i) {
+        while (x->level[i].forward && range.lteMax(x->level[i].forward->score)) {
+            x = x->level[i].forward;
+        }
+    }
+    return range.gteMin(x->score) ? x : nullptr; // x 不是哨兵：表头在区间上界之下
+}
+
+// ========== member 索引 ==========
+
+Skiplist::Node* Skiplist::find(std::string_view member) const {
+    return index_.find(hashString(member), [&](const Node* p) { return p->member() == member; });
+}
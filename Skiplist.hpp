@@ -0,0 +1,104 @@
+// Skiplist.hpp
+#pragma once
+#include <vector>
+#include <string_view>
+#include <cstddef>
+#include <cstdint>
+#include "IncrementalTable.hpp"
+
+// 分数区间（ZRANGEBYSCORE / ZCOUNT 的 min max），minex / maxex 为开区间
+struct ZRangeSpec {
+    double min;
+    double max;
+    bool minex = false;
+    bool maxex = false;
+
+    bool gteMin(double v) const { return minex ? v > min : v >= min; }
+    bool lteMax(double v) const { return maxex ? v < max : v <= max; }
+    bool empty() const { return min > max || (min == max && (minex || maxex)); }
+};
+
+// 有序集合的大对象编码（Redis zset = zskiplist + dict）：
+// - 跳表按 (score, member) 升序排列，每层指针带跨度 span（跳过的节点数），
+//   查排名、按排名定位都是 O(log n)，范围查询为 O(log n + m)
+// - member -> 节点的索引是以节点为元素的链地址哈希表（节点自带链指针和哈希），
+//   member 的字节只在节点里存一份，索引不另外分配
+// - 索引与 KeySpace 一样是 IncrementalTable，在两张表之间渐进式 rehash，每次访问迁移一个 bucket
+class Skiplist {
+public:
+    static constexpr int MAX_LEVEL = 32; // 每层晋升概率 1/4，足够 2^64 个元素
+
+    struct Node {
+        struct Level {
+            Node* forward;
+            size_t span;    // 到 forward 跨过的节点数（forward 为空时为到表尾的距离）
+        };
+
+        double score;
+        Node* backward;     // 第 0 层的前一个节点，第一个节点为空
+        Node* hnext;        // 索引中同一 bucket 的下一个节点
+        uint64_t hash;      // member 的哈希：rehash 时不重算，查找时先比哈希
+        uint32_t len;       // member 长度
+        uint32_t height;    // 层数
+        Level level[1];     // 实际 height 层，member 的字节紧跟在最后一层之后
+
+        std::string_view member() const {
+            return {reinterpret_cast<const char*>(level + height), len};
+        }
+        Node* next() const { return level[0].forward; }
+        Node* prev() const { return backward; }
+    };
+
+    Skiplist();
+    ~Skiplist();
+
+    Skiplist(const Skiplist&) = delete;
+    Skiplist& operator=(const Skiplist&) = delete;
+    Skiplist(Skiplist&& other) noexcept;
+    Skiplist& operator=(Skiplist&& other) noexcept;
+
+    size_t size() const { return length_; }
+    size_t memory_usage() const;
+
+    Node* first() const { return header_->level[0].forward; }
+    Node* last() const { return tail_; }
+
+    // 按 member 查找（走索引），不存在返回 nullptr
+    Node* find(std::string_view member) const;
+    // 插入新 member，调用方保证它不存在
+    Node* insert(double score, std::string_view member);
+    // 修改分数：位置不变时原地更新，否则摘下节点按新分数重新链入（不重新分配）
+    void updateScore(Node* node, double score);
+    bool erase(std::string_view member);
+
+    // 排名从 1 开始
+    size_t rank(const Node* node) const;
+    Node* byRank(size_t rank) const;
+
+    // 区间内的第一个 / 最后一个节点，区间内没有元素返回 nullptr
+    Node* firstInRange(const ZRangeSpec& range) const;
+    Node* lastInRange(const ZRangeSpec& range) const;
+
+    bool is_rehashing() const { return index_.is_rehashing(); }
+    // 迁移最多 n 个 bucket，返回是否仍在 rehash
+    bool rehash_step(int n) const { return index_.rehash_step(n); }
+
+private:
+    Node* header_;          // 哨兵节点，MAX_LEVEL 层，不存元素
+    Node* tail_ = nullptr;
+    size_t length_ = 0;
+    int level_ = 1;         // 当前最高层数
+    size_t node_bytes_ = 0; // 所有节点（含哨兵）的分配字节数
+
+    IncrementalTable<Node, &Node::hnext, &Node::hash> index_; // member -> 节点
+
+    static size_t allocSize(uint32_t height, size_t len);
+    Node* createNode(uint32_t height, double score, std::string_view member, uint64_t hash);
+    void destroyNode(Node* node);
+    void freeAll();
+
+    // 找出每层中排在 (score, member) 之前的最后一个节点及其排名
+    void locate(double score, std::string_view member, Node** update, size_t* rank) const;
+    void link(Node* node, Node** update, const size_t* rank);
+    void unlink(Node* node, Node** update);
+};
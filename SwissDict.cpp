@@ -0,0 +1,357 @@
+// SwissDict.cpp
+#include "SwissDict.hpp"
+#include "Hash.hpp"
+#include <algorithm>
+#include <cstring>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+constexpr int8_t CTRL_EMPTY = -128;  // 0b10000000
+constexpr int8_t CTRL_DELETED = -2;  // 0b11111110
+// 有效槽的控制字节为 0..127（哈希低 7 位），最高位为 0
+
+inline int8_t h2(uint64_t hash) { return static_cast<int8_t>(hash & 0x7F); }
+inline size_t h1(uint64_t hash) { return static_cast<size_t>(hash >> 7); }
+
+// 一组 16 个控制字节；各 match 返回位掩码，第 i 位对应组内第 i 个槽
+class Group {
+public:
+#if defined(__SSE2__)
+    explicit Group(const int8_t* ctrl)
+        : v_(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl))) {}
+
+    uint32_t match(int8_t h) const {
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h), v_)));
+    }
+    uint32_t matchEmpty() const { return match(CTRL_EMPTY); }
+    // 空槽和已删除槽最高位都是 1
+    uint32_t matchEmptyOrDeleted() const { return static_cast<uint32_t>(_mm_movemask_epi8(v_)); }
+
+private:
+    __m128i v_;
+#else
+    explicit Group(const int8_t* ctrl) : ctrl_(ctrl) {}
+
+    uint32_t match(int8_t h) const {
+        uint32_t mask = 0;
+        for (int i = 0; i < 16; ++i) {
+            if (ctrl_[i] == h) mask |= 1u << i;
+        }
+        return mask;
+    }
+    uint32_t matchEmpty() const { return match(CTRL_EMPTY); }
+    uint32_t matchEmptyOrDeleted() const {
+        uint32_t mask = 0;
+        for (int i = 0; i < 16; ++i) {
+            if (ctrl_[i] < 0) mask |= 1u << i;
+        }
+        return mask;
+    }
+
+private:
+    const int8_t* ctrl_;
+#endif
+
+public:
+    uint32_t matchFull() const { return ~matchEmptyOrDeleted() & 0xFFFF; }
+};
+
+inline int lowestBit(uint32_t mask) { return __builtin_ctz(mask); }
+
+} // namespace
+
+// ========== Slot ==========
+
+void SwissDict::Slot::assign(std::string_view k, std::string_view v) {
+    // 先写到新位置再释放旧的堆内存，k 指向旧数据时也安全
+    char* old_heap = is_inline() ? nullptr : heap_data;
+    size_t total = k.size() + v.size();
+    if (old_heap && total == heap_size()) {
+        // 长度不变（常见于覆盖写同长度的 value），复用原来的堆内存
+        std::memmove(old_heap, k.data(), k.size());
+        std::memcpy(old_heap + k.size(), v.data(), v.size());
+        key_len = static_cast<uint32_t>(k.size());
+        value_len = static_cast<uint32_t>(v.size());
+        return;
+    }
+    if (total <= INLINE_CAPACITY) {
+        char buf[INLINE_CAPACITY];
+        std::memcpy(buf, k.data(), k.size());
+        std::memcpy(buf + k.size(), v.data(), v.size());
+        std::memcpy(inline_data, buf, total);
+    } else {
+        char* p = new char[total];
+        std::memcpy(p, k.data(), k.size());
+        std::memcpy(p + k.size(), v.data(), v.size());
+        heap_data = p;
+    }
+    key_len = static_cast<uint32_t>(k.size());
+    value_len = static_cast<uint32_t>(v.size());
+    delete[] old_heap;
+}
+
+void SwissDict::Slot::release() {
+    if (!is_inline()) delete[] heap_data;
+    key_len = 0;
+    value_len = 0;
+}
+
+// ========== Table ==========
+
+SwissDict::Table& SwissDict::Table::operator=(Table&& other) noexcept {
+    if (this != &other) {
+        release_all();
+        ctrl = std::move(other.ctrl);
+        slots = std::move(other.slots);
+        group_mask = other.group_mask;
+        used = other.used;
+        growth_left = other.growth_left;
+        other.ctrl.clear();
+        other.slots.clear();
+        other.used = 0;
+        other.growth_left = 0;
+    }
+    return *this;
+}
+
+void SwissDict::Table::release_all() {
+    for (size_t i = 0; i < ctrl.size(); ++i) {
+        if (ctrl[i] >= 0) slots[i].release();
+    }
+}
+
+void SwissDict::Table::init(size_t groups) {
+    release_all();
+    ctrl.assign(groups * GROUP_SIZE, CTRL_EMPTY);
+    slots.assign(groups * GROUP_SIZE, Slot{});
+    group_mask = groups - 1;
+    used = 0;
+    growth_left = capacity() * 7 / 8;
+}
+
+// 按组做三角数探测（g, g+1, g+3, g+6, ...），组数为 2 的幂时能覆盖所有组
+long long SwissDict::Table::find(std::string_view key, uint64_t hash) const {
+    if (empty()) return -1;
+    size_t g = h1(hash) & group_mask;
+    for (size_t step = 1;; ++step) {
+        size_t base = g * GROUP_SIZE;
+        Group group(&ctrl[base]);
+        for (uint32_t m = group.match(h2(hash)); m; m &= m - 1) {
+            size_t i = base + lowestBit(m);
+            if (slots[i].key() == key) return static_cast<long long>(i);
+        }
+        if (group.matchEmpty()) return -1;
+        g = (g + step) & group_mask;
+    }
+}
+
+size_t SwissDict::Table::insert(uint64_t hash) {
+    size_t g = h1(hash) & group_mask;
+    for (size_t step = 1;; ++step) {
+        size_t base = g * GROUP_SIZE;
+        uint32_t m = Group(&ctrl[base]).matchEmptyOrDeleted();
+        if (m) {
+            size_t i = base + lowestBit(m);
+            if (ctrl[i] == CTRL_EMPTY) growth_left--;
+            ctrl[i] = h2(hash);
+            used++;
+            return i;
+        }
+        g = (g + step) & group_mask;
+    }
+}
+
+void SwissDict::Table::erase(size_t index) {
+    slots[index].release();
+    used--;
+    // 组内还有空槽说明从未有探测越过这一组，可以直接标记为空；
+    // 否则必须留下墓碑，以免截断经过这一组的探测链
+    if (Group(&ctrl[index & ~(GROUP_SIZE - 1)]).matchEmpty()) {
+        ctrl[index] = CTRL_EMPTY;
+        growth_left++;
+    } else {
+        ctrl[index] = CTRL_DELETED;
+    }
+}
+
+// ========== SwissDict ==========
+
+SwissDict::SwissDict() {
+    ht_[0].init(1);
+    rehashidx_ = -1;
+}
+
+uint64_t SwissDict::hash_key(std::string_view key) {
+    return hashString(key);
+}
+
+// rehash 期间，key 可能在 ht[0] 或 ht[1]，所以要查两张表。
+SwissDict::Slot* SwissDict::find_slot(std::string_view key, uint64_t hash) const {
+    for (int table = 0; table <= 1; ++table) {
+        long long i = ht_[table].find(key, hash);
+        if (i >= 0) {
+            return const_cast<Slot*>(&ht_[table].slots[i]);
+        }
+        if (!is_rehashing()) break; // 只查 ht[0]
+    }
+    return nullptr;
+}
+
+void SwissDict::set_field(std::string_view key, std::string_view value) {
+    // 如果正在 rehash，先迁移一个组
+    if (is_rehashing()) {
+        rehash_step(1);
+    }
+
+    uint64_t hash = hash_key(key);
+    Slot* slot = find_slot(key, hash);
+    if (!slot) {
+        // 不存在，插入。rehash 期间直接插入新表
+        reserve_one();
+        Table& table = ht_[is_rehashing() ? 1 : 0];
+        slot = &table.slots[table.insert(hash)];
+        used_++;
+    }
+    heap_bytes_ -= slot->heap_size();
+    slot->assign(key, value);
+    heap_bytes_ += slot->heap_size();
+}
+
+// 保证插入前主表还有空槽；没有时开始渐进式扩容（或原大小重建以清理墓碑）
+// rehash 期间新表不会被填满：每次插入至少迁移一组，迁移完成前最多再插入 组数 个元素，
+// 而新表的可用槽数至少是旧表元素数加上这一数量
+void SwissDict::reserve_one() {
+    if (is_rehashing()) return;
+    Table& table = ht_[0];
+    if (table.empty()) {
+        table.init(1);
+        return;
+    }
+    if (table.growth_left > 0) return;
+
+    // 有效元素超过容量的 7/16 时翻倍，否则只是墓碑太多
+    size_t groups = table.groups();
+    if (table.used * 16 > table.capacity() * 7) groups *= 2;
+    start_resize(groups);
+}
+
+void SwissDict::start_resize(size_t groups) {
+    ht_[1].init(groups);
+    rehashidx_ = 0;
+}
+
+bool SwissDict::get_field(std::string_view key, std::string& out_value) const {
+    std::string_view value;
+    if (!find_value(key, value)) return false;
+    out_value.assign(value);
+    return true;
+}
+
+bool SwissDict::find_value(std::string_view key, std::string_view& out) const {
+    // 与 ChainedDict 一样，const 读操作不推进 rehash
+    Slot* slot = find_slot(key, hash_key(key));
+    if (!slot) return false;
+    out = slot->value();
+    return true;
+}
+
+bool SwissDict::del_field(std::string_view key) {
+    if (is_rehashing()) {
+        rehash_step(1);
+    }
+
+    uint64_t hash = hash_key(key);
+    for (int table = 0; table <= 1; ++table) {
+        long long i = ht_[table].find(key, hash);
+        if (i >= 0) {
+            heap_bytes_ -= ht_[table].slots[i].heap_size();
+            ht_[table].erase(static_cast<size_t>(i));
+            used_--;
+            shrink_if_needed();
+            return true;
+        }
+        if (!is_rehashing()) break;
+    }
+    return false;
+}
+
+// 缩容检查
+void SwissDict::shrink_if_needed() {
+    if (is_rehashing()) return;
+    if (ht_[0].groups() <= 1) return;
+    if (ht_[0].used * 100 / ht_[0].capacity() < HASHTABLE_MIN_FILL) {
+        start_resize(ht_[0].groups() / 2);
+    }
+}
+
+// 渐进式 rehash：每步迁移一整组（最多 16 个元素），已迁移的槽在旧表中标记为墓碑，
+// 保证旧表上仍在进行的探测链不被截断
+int SwissDict::rehash_step(int n) {
+    if (!is_rehashing()) return 0;
+
+    Table& from = ht_[0];
+    Table& to = ht_[1];
+    while (n-- > 0 && rehashidx_ < static_cast<long long>(from.groups()) && !from.empty()) {
+        size_t base = static_cast<size_t>(rehashidx_) * GROUP_SIZE;
+        for (uint32_t m = Group(&from.ctrl[base]).matchFull(); m; m &= m - 1) {
+            size_t i = base + lowestBit(m);
+            // 槽是平凡类型，直接按位搬过去；旧槽清零，不再持有堆内存
+            Slot& slot = from.slots[i];
+            to.slots[to.insert(hash_key(slot.key()))] = slot;
+            slot = Slot{};
+            from.ctrl[i] = CTRL_DELETED;
+            from.used--;
+        }
+        rehashidx_++;
+    }
+
+    if (from.empty() || rehashidx_ >= static_cast<long long>(from.groups())) {
+        // rehash 完成
+        ht_[0] = std::move(ht_[1]);
+        ht_[1] = Table();
+        rehashidx_ = -1;
+        return 0;
+    }
+    return 1; // 仍在 rehash
+}
+
+void SwissDict::try_rehash_for_ms(int ms) {
+    if (!is_rehashing()) return;
+
+    auto end = Clock::now() + std::chrono::milliseconds(ms);
+
+    int batch = 100; // 每次迁移 100 个组
+    while (is_rehashing()) {
+        rehash_step(batch);
+        if (Clock::now() >= end) break;
+    }
+}
+
+size_t SwissDict::memory_usage() const {
+    size_t total = sizeof(*this);
+    for (const auto& table : ht_) {
+        total += table.ctrl.capacity();
+        total += table.slots.capacity() * sizeof(Slot);
+    }
+    total += heap_bytes_;
+    return total;
+}
+
+std::vector<std::pair<std::string, std::string>> SwissDict::get_all() const {
+    std::vector<std::pair<std::string, std::string>> result;
+    result.reserve(used_);
+
+    for (const auto& table : ht_) {
+        for (size_t g = 0; g < table.groups() && !table.empty(); ++g) {
+            size_t base = g * GROUP_SIZE;
+            for (uint32_t m = Group(&table.ctrl[base]).matchFull(); m; m &= m - 1) {
+                const Slot& slot = table.slots[base + lowestBit(m)];
+                result.emplace_back(slot.key(), slot.value());
+            }
+        }
+    }
+    return result;
+}
@@ -0,0 +1,108 @@
+// SwissDict.hpp
+#pragma once
+#include <vector>
+#include <string>
+#include <string_view>
+#include <chrono>
+#include <cstdint>
+
+// 开放寻址哈希表（Swiss table 风格），接口与 ChainedDict 相同
+// - 槽按 16 个一组，每槽一个控制字节：空 / 已删除 / 哈希低 7 位（h2）
+// - 查找时用 SSE2 一次比较整组 16 个控制字节，只有 h2 相同的槽才比较 key；
+//   遇到含空槽的组即可判定不存在
+// - key/value 直接存放在 32 字节的槽里：两者合计不超过 24 字节时零分配，
+//   否则两者共用一块堆内存（一次分配），探测时只有 h2 命中才会访问
+// - 扩容/缩容与 ChainedDict 一样在两张表之间按组渐进迁移，避免一次性 rehash 的延迟尖刺
+class SwissDict {
+public:
+    SwissDict();
+    ~SwissDict() = default;
+
+    // 禁用拷贝
+    SwissDict(const SwissDict&) = delete;
+    SwissDict& operator=(const SwissDict&) = delete;
+
+    // 启用移动
+    SwissDict(SwissDict&&) noexcept = default;
+    SwissDict& operator=(SwissDict&&) noexcept = default;
+
+    void set_field(std::string_view key, std::string_view value);
+    bool get_field(std::string_view key, std::string& out_value) const;
+    // 不拷贝：out 指向表内的 value，下次修改前有效
+    bool find_value(std::string_view key, std::string_view& out) const;
+    bool del_field(std::string_view key);
+    size_t size() const { return used_; }
+
+    // rehash 相关
+    bool is_rehashing() const { return rehashidx_ != -1; }
+    int rehash_step(int n); // 迁移 n 个组
+
+    // 尝试在指定毫秒内推进 rehash
+    void try_rehash_for_ms(int ms);
+
+    size_t memory_usage() const;
+
+    std::vector<std::pair<std::string, std::string>> get_all() const;
+
+private:
+    static inline constexpr size_t GROUP_SIZE = 16;
+    static inline constexpr size_t HASHTABLE_MIN_FILL = 10; // 缩容阈值（used / capacity < 10%）
+
+    using Clock = std::chrono::steady_clock;
+
+    // 槽内 key 与 value 首尾相接；空槽和已删除槽的长度为 0（不持有堆内存）
+    struct Slot {
+        static constexpr size_t INLINE_CAPACITY = 24;
+
+        uint32_t key_len;
+        uint32_t value_len;
+        union {
+            char inline_data[INLINE_CAPACITY];
+            char* heap_data;
+        };
+
+        bool is_inline() const { return size_t(key_len) + value_len <= INLINE_CAPACITY; }
+        const char* data() const { return is_inline() ? inline_data : heap_data; }
+        std::string_view key() const { return {data(), key_len}; }
+        std::string_view value() const { return {data() + key_len, value_len}; }
+        size_t heap_size() const { return is_inline() ? 0 : size_t(key_len) + value_len; }
+
+        // key 可以指向本槽自己的数据（只更新 value 时）
+        void assign(std::string_view k, std::string_view v);
+        void release();
+    };
+
+    struct Table {
+        std::vector<int8_t> ctrl; // 每槽一个控制字节
+        std::vector<Slot> slots;
+        size_t group_mask = 0;    // 组数 - 1（组数是 2 的幂）
+        size_t used = 0;          // 有效元素数
+        size_t growth_left = 0;   // 还能占用的空槽数：保证装载率（含已删除槽）不超过 7/8
+
+        Table() = default;
+        Table(Table&&) noexcept = default;
+        Table& operator=(Table&& other) noexcept;
+        ~Table() { release_all(); }
+
+        void init(size_t groups);
+        void release_all(); // 释放所有有效槽的堆内存
+        bool empty() const { return slots.empty(); }
+        size_t groups() const { return group_mask + 1; }
+        size_t capacity() const { return slots.size(); }
+
+        long long find(std::string_view key, uint64_t hash) const; // 槽下标，不存在返回 -1
+        size_t insert(uint64_t hash);  // 找到空槽/已删除槽并写入控制字节，返回槽下标
+        void erase(size_t index);
+    };
+
+    Table ht_[2];              // ht[0] 主表，ht[1] 新表（rehash 时用）
+    long long used_ = 0;       // 总元素数
+    long long rehashidx_ = -1; // -1 表示未 rehash，否则表示下一个要迁移的组
+    size_t heap_bytes_ = 0;    // 放不进槽内的 key/value 占用的堆内存
+
+    static uint64_t hash_key(std::string_view key);
+    Slot* find_slot(std::string_view key, uint64_t hash) const;
+    void reserve_one();
+    void shrink_if_needed();
+    void start_resize(size_t groups);
+};
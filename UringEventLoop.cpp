@@ -0,0 +1,482 @@
+// UringEventLoop.cpp
+#include "UringEventLoop.hpp"
+#include "Server.hpp"
+#include "Connection.hpp"
+#include "utils.hpp"
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#endif
+
+// 编译环境的内核头文件太旧（没有 multishot recv / provided buffer ring）时只保留回退路径
+#if defined(IORING_RECV_MULTISHOT) && defined(IORING_ACCEPT_MULTISHOT)
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/utsname.h>
+#include <poll.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+int sys_io_uring_setup(unsigned entries, io_uring_params* p) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, p));
+}
+
+int sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+int sys_io_uring_register(int fd, unsigned opcode, void* arg, unsigned nr_args) {
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+}
+
+// multishot recv 需要 6.0+
+bool kernelSupportsMultishotRecv() {
+    struct utsname u;
+    if (uname(&u) != 0) return false;
+    int major = 0, minor = 0;
+    if (std::sscanf(u.release, "%d.%d", &major, &minor) != 2) return false;
+    return major > 6 || (major == 6 && minor >= 0);
+}
+
+} // namespace
+
+std::unique_ptr<UringEventLoop> UringEventLoop::create(Server& server) {
+    if (!kernelSupportsMultishotRecv()) return nullptr;
+    std::unique_ptr<UringEventLoop> loop(new UringEventLoop(server));
+    if (!loop->init()) return nullptr;
+    return loop;
+}
+
+UringEventLoop::UringEventLoop(Server& server) : EventLoop(server) {}
+
+UringEventLoop::~UringEventLoop() {
+    // 关闭 ring 会取消所有飞行中的请求，但内核异步回收，期间 multishot accept 仍持有监听 socket；
+    // 先 shutdown 让它立即退出 LISTEN 状态，进程重启时可以马上重新 bind
+    if (server_.listenFd() != -1) shutdown(server_.listenFd(), SHUT_RDWR);
+    if (ring_fd_ != -1) close(ring_fd_);
+    if (buf_ring_) munmap(buf_ring_, buf_ring_len_);
+    if (sqes_) munmap(sqes_, sqes_len_);
+    if (cq_ptr_ && cq_ptr_ != sq_ptr_) munmap(cq_ptr_, cq_len_);
+    if (sq_ptr_) munmap(sq_ptr_, sq_len_);
+}
+
+bool UringEventLoop::init() {
+    io_uring_params p{};
+    // SINGLE_ISSUER + DEFER_TASKRUN：只有本线程提交，完成事件推迟到 io_uring_enter 时处理，
+    // 省掉内核向事件循环线程发 IPI；老内核不支持时退回默认参数
+    p.flags = IORING_SETUP_SUBMIT_ALL | IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_DEFER_TASKRUN;
+    ring_fd_ = sys_io_uring_setup(RING_ENTRIES, &p);
+    if (ring_fd_ < 0) {
+        p = io_uring_params{};
+        ring_fd_ = sys_io_uring_setup(RING_ENTRIES, &p);
+    }
+    if (ring_fd_ < 0) {
+        std::cerr << "[WARN] io_uring_setup failed: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    sq_len_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    cq_len_ = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+    bool single_mmap = p.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap) sq_len_ = cq_len_ = std::max(sq_len_, cq_len_);
+
+    sq_ptr_ = mmap(nullptr, sq_len_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                   ring_fd_, IORING_OFF_SQ_RING);
+    if (sq_ptr_ == MAP_FAILED) {
+        sq_ptr_ = nullptr;
+        return false;
+    }
+    if (single_mmap) {
+        cq_ptr_ = sq_ptr_;
+    } else {
+        cq_ptr_ = mmap(nullptr, cq_len_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                       ring_fd_, IORING_OFF_CQ_RING);
+        if (cq_ptr_ == MAP_FAILED) {
+            cq_ptr_ = nullptr;
+            return false;
+        }
+    }
+    sqes_len_ = p.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = mmap(nullptr, sqes_len_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      ring_fd_, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) return false;
+    sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+    char* sq = static_cast<char*>(sq_ptr_);
+    sq_head_ = reinterpret_cast<unsigned*>(sq + p.sq_off.head);
+    sq_tail_ = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+    sq_array_ = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+    sq_mask_ = *reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+    sq_entries_ = *reinterpret_cast<unsigned*>(sq + p.sq_off.ring_entries);
+    sqe_tail_ = *sq_tail_;
+
+    char* cq = static_cast<char*>(cq_ptr_);
+    cq_head_ = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);
+
+    // provided buffer ring：环本身按页分配，缓冲区在一块连续内存里按 bid 切分
+    buf_ring_len_ = BUF_COUNT * sizeof(io_uring_buf);
+    void* br = mmap(nullptr, buf_ring_len_, PROT_READ | PROT_WRITE,
+                    MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+    if (br == MAP_FAILED) return false;
+    buf_ring_ = static_cast<io_uring_buf_ring*>(br);
+
+    io_uring_buf_reg reg{};
+    reg.ring_addr = reinterpret_cast<uint64_t>(buf_ring_);
+    reg.ring_entries = BUF_COUNT;
+    reg.bgid = BUF_GROUP;
+    if (sys_io_uring_register(ring_fd_, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        std::cerr << "[WARN] io_uring provided buffer ring unsupported: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    buf_pool_.reset(new char[BUF_COUNT * BUF_SIZE]);
+    for (unsigned i = 0; i < BUF_COUNT; ++i) {
+        recycleBuffer(static_cast<uint16_t>(i));
+    }
+    __atomic_store_n(&buf_ring_->tail, buf_tail_, __ATOMIC_RELEASE);
+    return true;
+}
+
+// ========== SQ / CQ ==========
+
+io_uring_sqe* UringEventLoop::getSqe() {
+    unsigned head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+    if (sqe_tail_ - head >= sq_entries_) {
+        // SQ 满了：先提交一批（不等待），内核会立即消费这些 SQE
+        submitAndWait(0);
+        head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+        if (sqe_tail_ - head >= sq_entries_) handle_error("io_uring submission queue full");
+    }
+    unsigned idx = sqe_tail_ & sq_mask_;
+    io_uring_sqe* sqe = &sqes_[idx];
+    std::memset(sqe, 0, sizeof(*sqe));
+    sq_array_[idx] = idx;
+    ++sqe_tail_;
+    return sqe;
+}
+
+void UringEventLoop::submitAndWait(unsigned wait_nr) {
+    __atomic_store_n(sq_tail_, sqe_tail_, __ATOMIC_RELEASE);
+    unsigned to_submit = sqe_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+    if (to_submit == 0 && wait_nr == 0) return;
+
+    unsigned flags = wait_nr > 0 ? IORING_ENTER_GETEVENTS : 0;
+    if (sys_io_uring_enter(ring_fd_, to_submit, wait_nr, flags) < 0) {
+        // EINTR：被信号打断，回到循环检查停止标记；EAGAIN/EBUSY：先处理已有的完成事件
+        if (errno != EINTR && errno != EAGAIN && errno != EBUSY) handle_error("io_uring_enter");
+    }
+}
+
+void UringEventLoop::reapCompletions() {
+    unsigned head = *cq_head_;
+    unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    while (head != tail) {
+        const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+        handleCompletion(cqe.user_data, cqe.res, cqe.flags);
+        ++head;
+    }
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+
+    // 本批处理中归还的接收缓冲区一次性发布
+    __atomic_store_n(&buf_ring_->tail, buf_tail_, __ATOMIC_RELEASE);
+}
+
+void UringEventLoop::recycleBuffer(uint16_t bid) {
+    // 不用 buf_ring_->bufs：C++ 下 __DECLARE_FLEX_ARRAY 的空结构体占 1 字节，数组会错位；
+    // 环就是从起始地址开始的 io_uring_buf 数组（tail 与 bufs[0].resv 重叠）
+    io_uring_buf* ring = reinterpret_cast<io_uring_buf*>(buf_ring_);
+    io_uring_buf* buf = &ring[buf_tail_ & (BUF_COUNT - 1)];
+    buf->addr = reinterpret_cast<uint64_t>(buf_pool_.get() + bid * BUF_SIZE);
+    buf->len = BUF_SIZE;
+    buf->bid = bid;
+    ++buf_tail_;
+}
+
+// ========== 提交请求 ==========
+
+static uint64_t packUserData(uint32_t op, int fd) {
+    return (static_cast<uint64_t>(op) << 32) | static_cast<uint32_t>(fd);
+}
+
+void UringEventLoop::armAccept() {
+    io_uring_sqe* sqe = getSqe();
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = server_.listenFd();
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->accept_flags = SOCK_CLOEXEC;
+    sqe->user_data = packUserData(static_cast<uint32_t>(Op::ACCEPT), server_.listenFd());
+}
+
+void UringEventLoop::armPoll(Op op, int fd) {
+    // eventfd / timerfd 是非阻塞的，用 multishot poll 等它可读，再同步 read 清零计数
+    io_uring_sqe* sqe = getSqe();
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = fd;
+    sqe->len = IORING_POLL_ADD_MULTI;
+    sqe->poll32_events = POLLIN;
+    sqe->user_data = packUserData(static_cast<uint32_t>(op), fd);
+}
+
+void UringEventLoop::armRecv(int fd, ConnState& st) {
+    io_uring_sqe* sqe = getSqe();
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = fd;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = BUF_GROUP;
+    sqe->user_data = packUserData(static_cast<uint32_t>(Op::RECV), fd);
+    st.recv_armed = true;
+    ++st.inflight;
+}
+
+void UringEventLoop::queueSend(Connection* conn, ConnState& st) {
+    int cnt = conn->prepareSend(st.iov, OutputBuffer::MAX_IOV);
+    if (cnt == 0) return;
+
+    io_uring_sqe* sqe = getSqe();
+    sqe->fd = conn->get_fd();
+    if (cnt == 1) {
+        sqe->opcode = IORING_OP_SEND;
+        sqe->addr = reinterpret_cast<uint64_t>(st.iov[0].iov_base);
+        sqe->len = static_cast<uint32_t>(st.iov[0].iov_len);
+    } else {
+        std::memset(&st.msg, 0, sizeof(st.msg));
+        st.msg.msg_iov = st.iov;
+        st.msg.msg_iovlen = cnt;
+        sqe->opcode = IORING_OP_SENDMSG;
+        sqe->addr = reinterpret_cast<uint64_t>(&st.msg);
+        sqe->len = 1;
+    }
+    sqe->msg_flags = MSG_NOSIGNAL;
+    sqe->user_data = packUserData(static_cast<uint32_t>(Op::SEND), conn->get_fd());
+    st.sending = true;
+    ++st.inflight;
+}
+
+// ========== 完成事件 ==========
+
+void UringEventLoop::handleCompletion(uint64_t user_data, int32_t res, uint32_t flags) {
+    Op op = static_cast<Op>(user_data >> 32);
+    int fd = static_cast<int>(static_cast<uint32_t>(user_data));
+
+    switch (op) {
+    case Op::ACCEPT:
+        if (res >= 0) {
+            onAccept(res);
+        } else {
+            std::cerr << "[WARN] accept failed: " << std::strerror(-res) << std::endl;
+        }
+        if (!(flags & IORING_CQE_F_MORE)) armAccept();
+        break;
+    case Op::WAKE: {
+        uint64_t count;
+        ssize_t n = read(server_.wakeFd(), &count, sizeof(count));
+        (void)n;
+        woken_ = true;
+        if (!(flags & IORING_CQE_F_MORE)) armPoll(Op::WAKE, fd);
+        break;
+    }
+    case Op::TIMER: {
+        uint64_t expirations;
+        ssize_t n = read(fd, &expirations, sizeof(expirations));
+        (void)n;
+        cron_due_ = true; // 错过的周期不补跑
+        if (!(flags & IORING_CQE_F_MORE)) armPoll(Op::TIMER, fd);
+        break;
+    }
+    case Op::RECV:
+        onRecv(fd, res, flags);
+        break;
+    case Op::SEND:
+        onSend(fd, res);
+        break;
+    }
+}
+
+void UringEventLoop::onAccept(int fd) {
+    set_nodelay(fd);
+    server_.addConnection(fd);
+    ConnState& st = states_[fd];
+    st = ConnState{};
+    armRecv(fd, st);
+}
+
+void UringEventLoop::onRecv(int fd, int32_t res, uint32_t flags) {
+    // 无论连接状态如何，用掉的缓冲区都要归还
+    if (flags & IORING_CQE_F_BUFFER) {
+        uint16_t bid = static_cast<uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT);
+        auto it = states_.find(fd);
+        Connection* conn = server_.findConnection(fd);
+        if (res > 0 && it != states_.end() && !it->second.closing && conn) {
+            conn->appendInput(buf_pool_.get() + bid * BUF_SIZE, static_cast<size_t>(res));
+        }
+        recycleBuffer(bid);
+    }
+
+    auto it = states_.find(fd);
+    if (it == states_.end()) return;
+    ConnState& st = it->second;
+
+    bool more = flags & IORING_CQE_F_MORE;
+    if (!more) {
+        st.recv_armed = false;
+        --st.inflight;
+    }
+
+    if (st.closing) {
+        releaseIfIdle(fd, st);
+        return;
+    }
+
+    Connection* conn = server_.findConnection(fd);
+    if (res > 0) {
+        st.readable = true;
+        markDirty(fd, st);
+        if (!more) armRecv(fd, st); // 内核结束了 multishot（例如 CQ 溢出），重新提交
+    } else if (res == -ENOBUFS) {
+        // 缓冲池暂时耗尽：本批处理结束时已归还的缓冲区会被发布，重新提交即可
+        if (!more) armRecv(fd, st);
+    } else {
+        // 0 = 对端关闭，其他为错误
+        conn->markClosed();
+        markDirty(fd, st);
+    }
+}
+
+void UringEventLoop::onSend(int fd, int32_t res) {
+    auto it = states_.find(fd);
+    if (it == states_.end()) return;
+    ConnState& st = it->second;
+    st.sending = false;
+    --st.inflight;
+
+    if (st.closing) {
+        releaseIfIdle(fd, st);
+        return;
+    }
+
+    Connection* conn = server_.findConnection(fd);
+    if (res >= 0) {
+        // 可能只发送了一部分，剩余的在收尾时继续提交
+        conn->completeSend(static_cast<size_t>(res));
+    } else {
+        conn->markClosed();
+    }
+    markDirty(fd, st);
+}
+
+void UringEventLoop::markDirty(int fd, ConnState& st) {
+    if (st.dirty) return;
+    st.dirty = true;
+    dirty_.push_back(fd);
+}
+
+// ========== 事件循环 ==========
+
+void UringEventLoop::run() {
+    // ring 内部以异步方式等待就绪，监听 socket 用阻塞模式即可
+    int listen_fd = server_.listenFd();
+    int fl = fcntl(listen_fd, F_GETFL, 0);
+    if (fl != -1) fcntl(listen_fd, F_SETFL, fl & ~O_NONBLOCK);
+
+    armAccept();
+    armPoll(Op::WAKE, server_.wakeFd());
+    armPoll(Op::TIMER, server_.timerFd());
+
+    while (!server_.stopRequested()) {
+        // 1. 一次 io_uring_enter：提交上一轮的全部 recv/send SQE，并等待新的完成事件
+        submitAndWait(1);
+
+        // 2. 处理完成事件：新连接、收到的数据、发送结果
+        reapCompletions();
+
+        // 3. 解析并执行收到数据的连接上的命令
+        for (int fd : dirty_) {
+            auto it = states_.find(fd);
+            if (it == states_.end() || !it->second.readable || it->second.closing) continue;
+            it->second.readable = false;
+            Connection* conn = server_.findConnection(fd);
+            if (conn->shouldClose()) continue;
+            conn->parseInput();
+            server_.processInputBuffer(conn);
+        }
+
+        // 4. 其他分片投递的请求/回复
+        if (woken_) {
+            woken_ = false;
+            server_.handleWakeup();
+        }
+
+        // 5. 关闭失效连接；有输出的连接各提交一个 send，留到下一次 enter 批量提交
+        for (int fd : dirty_) {
+            finishConnection(fd);
+        }
+        dirty_.clear();
+
+        // 6. 周期任务（定时器到期时执行）
+        if (cron_due_) {
+            cron_due_ = false;
+            server_.cron();
+        }
+
+        // 7. 进入下一次 io_uring_enter 之前
+        server_.beforeSleep();
+    }
+}
+
+void UringEventLoop::flush(Connection* conn) {
+    finishConnection(conn->get_fd());
+}
+
+void UringEventLoop::finishConnection(int fd) {
+    auto it = states_.find(fd);
+    if (it == states_.end()) return;
+    ConnState& st = it->second;
+    st.dirty = false;
+    st.readable = false;
+    if (st.closing) return;
+
+    Connection* conn = server_.findConnection(fd);
+    if (conn->shouldClose()) {
+        beginClose(fd, st);
+        return;
+    }
+    // 等待其他分片回复的连接先不发：本批恢复执行后由 handleInbox 一次发出
+    if (!st.sending && !conn->blocked() && conn->pendingOutput() > 0) {
+        queueSend(conn, st);
+    }
+}
+
+void UringEventLoop::beginClose(int fd, ConnState& st) {
+    std::cout << "[INFO] Client disconnected, fd=" << fd << std::endl;
+    st.closing = true;
+    // 让飞行中的 recv/send 尽快结束（recv 返回 0，send 返回 EPIPE），全部结束后再关闭 fd
+    if (st.inflight > 0) shutdown(fd, SHUT_RDWR);
+    releaseIfIdle(fd, st);
+}
+
+void UringEventLoop::releaseIfIdle(int fd, ConnState& st) {
+    if (!st.closing || st.inflight > 0) return;
+    states_.erase(fd);
+    server_.closeConnection(fd);
+}
+
+#else // 没有 io_uring 头文件
+
+std::unique_ptr<UringEventLoop> UringEventLoop::create(Server&) { return nullptr; }
+UringEventLoop::UringEventLoop(Server& server) : EventLoop(server) {}
+UringEventLoop::~UringEventLoop() {}
+void UringEventLoop::run() {}
+void UringEventLoop::flush(Connection*) {}
+
+#endif
@@ -0,0 +1,116 @@
+// UringEventLoop.hpp
+#pragma once
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include "EventLoop.hpp"
+#include "IoBuffer.hpp"
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+struct io_uring_buf_ring;
+
+// io_uring 后端（直接使用系统调用，不依赖 liburing）
+// - multishot accept：一个 SQE 持续产出新连接
+// - multishot recv + provided buffer ring：内核从共享缓冲池取空闲块接收数据，
+//   不需要为每个空闲连接预留接收缓冲区；处理 CQE 时拷入连接的读缓冲区并立即归还
+// - send：每个有输出的连接一个 SEND/SENDMSG（同一连接同时最多一个，保证顺序），
+//   本轮产生的全部 SQE 与等待下一批完成事件合并为一次 io_uring_enter
+// - 需要 Linux 6.0+（multishot recv）；create() 探测失败返回 nullptr，由调用方回退 epoll
+class UringEventLoop : public EventLoop {
+public:
+    static std::unique_ptr<UringEventLoop> create(Server& server);
+    ~UringEventLoop() override;
+
+    const char* name() const override { return "io_uring"; }
+    void run() override;
+    void flush(Connection* conn) override;
+
+private:
+    static constexpr unsigned RING_ENTRIES = 1024;
+    static constexpr unsigned BUF_COUNT = 256;          // 必须是 2 的幂
+    static constexpr size_t BUF_SIZE = 16 * 1024;
+    static constexpr uint16_t BUF_GROUP = 0;
+
+    // user_data 高 32 位是请求类型，低 32 位是 fd
+    enum class Op : uint32_t {
+        ACCEPT = 1,
+        WAKE,
+        TIMER,
+        RECV,
+        SEND
+    };
+
+    // 每个连接在 ring 中的状态
+    // 还有请求在飞行时不能关闭 fd：这样 fd 不会被复用，user_data 里只放 fd 就足够
+    struct ConnState {
+        int inflight = 0;         // 未结束的请求数（armed 的 multishot recv 算一个）
+        bool recv_armed = false;
+        bool sending = false;
+        bool readable = false;    // 本轮收到了新数据，待解析执行
+        bool dirty = false;       // 已加入 dirty_，本轮结束时收尾
+        bool closing = false;
+        struct msghdr msg;        // 飞行中的 SENDMSG 引用的 msghdr / iovec
+        struct iovec iov[OutputBuffer::MAX_IOV];
+    };
+
+    explicit UringEventLoop(Server& server);
+    bool init();
+
+    io_uring_sqe* getSqe();
+    // 提交所有已准备的 SQE，并等待至少 wait_nr 个完成事件
+    void submitAndWait(unsigned wait_nr);
+    void reapCompletions();
+    void handleCompletion(uint64_t user_data, int32_t res, uint32_t flags);
+
+    void onAccept(int fd);
+    void onRecv(int fd, int32_t res, uint32_t flags);
+    void onSend(int fd, int32_t res);
+
+    void armAccept();
+    // 等待 eventfd / timerfd 可读（WAKE / TIMER）
+    void armPoll(Op op, int fd);
+    void armRecv(int fd, ConnState& st);
+    void queueSend(Connection* conn, ConnState& st);
+    void recycleBuffer(uint16_t bid);
+    void markDirty(int fd, ConnState& st);
+
+    // 本轮收尾：关闭失效连接，或为待发送数据提交 send
+    void finishConnection(int fd);
+    void beginClose(int fd, ConnState& st);
+    // 连接已关闭且没有飞行中的请求：释放 Connection，st 随之失效
+    void releaseIfIdle(int fd, ConnState& st);
+
+    // ---- SQ / CQ（mmap 到用户态的共享环） ----
+    int ring_fd_ = -1;
+    void* sq_ptr_ = nullptr;
+    size_t sq_len_ = 0;
+    void* cq_ptr_ = nullptr;
+    size_t cq_len_ = 0;
+    io_uring_sqe* sqes_ = nullptr;
+    size_t sqes_len_ = 0;
+    unsigned* sq_head_ = nullptr;
+    unsigned* sq_tail_ = nullptr;
+    unsigned* sq_array_ = nullptr;
+    unsigned sq_mask_ = 0;
+    unsigned sq_entries_ = 0;
+    unsigned* cq_head_ = nullptr;
+    unsigned* cq_tail_ = nullptr;
+    unsigned cq_mask_ = 0;
+    io_uring_cqe* cqes_ = nullptr;
+    unsigned sqe_tail_ = 0;  // 本地 SQ 尾部，submitAndWait 时发布给内核
+
+    // ---- provided buffer ring ----
+    io_uring_buf_ring* buf_ring_ = nullptr;
+    size_t buf_ring_len_ = 0;
+    std::unique_ptr<char[]> buf_pool_;
+    uint16_t buf_tail_ = 0;  // 本地 buffer ring 尾部，每批 CQE 处理完后发布
+
+    std::unordered_map<int, ConnState> states_;
+    std::vector<int> dirty_;  // 本轮有事件的连接
+    bool woken_ = false;
+    bool cron_due_ = false;
+};
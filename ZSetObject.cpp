@@ -1,2 +1,182 @@
+// ZSetObject.cpp
 #include "ZSetObject.hpp"
+#include "Protocol.hpp" // d2string / string2d
+#include <cmath>
+#include <string>
+#include <stdexcept>
 
+ZSetObject::ZSetObject()
+    : encoding_(ObjectEncoding::LISTPACK)
+    , storage_(Listpack{}) {}
+
+size_t ZSetObject::size() const {
+    if (encoding_ == ObjectEncoding::LISTPACK) {
+        return get_listpack().size() / 2;
+    }
+    return get_skiplist().size();
+}
+
+size_t ZSetObject::memory_usage() const {
+    if (encoding_ == ObjectEncoding::LISTPACK) {
+        return sizeof(*this) + get_listpack().bytes();
+    }
+    return sizeof(*this) + get_skiplist().memory_usage();
+}
+
+// ================== listpack 辅助 ==================
+
+// 分数写入时是 d2string 的结果：整数值被 listpack 存成整数，其余是字符串
+double ZSetObject::lpScore(const Listpack& lp, size_t pos) {
+    long long n;
+    if (lp.getInteger(pos, n)) return static_cast<double>(n);
+    char buf[Listpack::INT_BUF_SIZE];
+    double score = 0;
+    string2d(lp.get(pos, buf), score);
+    return score;
+}
+
+size_t ZSetObject::lpInsertPos(const Listpack& lp, double score, std::string_view member) {
+    char buf[Listpack::INT_BUF_SIZE];
+    for (size_t pos = lp.first(); pos != Listpack::NPOS; pos = lp.next(lp.next(pos))) {
+        double s = lpScore(lp, lp.next(pos));
+        if (s > score || (s == score && lp.get(pos, buf) > member)) {
+            return pos;
+        }
+    }
+    return Listpack::NPOS;
+}
+
+void ZSetObject::lpInsert(Listpack& lp, double score, std::string_view member) {
+    char buf[MAX_D2STRING_CHARS];
+    std::string_view pair[2] = {member, {buf, d2string(buf, score)}};
+    lp.insert(lpInsertPos(lp, score, member), pair, 2);
+}
+
+void ZSetObject::convert_to_skiplist() {
+    if (encoding_ != ObjectEncoding::LISTPACK) return;
+
+    Skiplist sl;
+    const Listpack& lp = get_listpack();
+    char buf[Listpack::INT_BUF_SIZE];
+    for (size_t pos = lp.first(); pos != Listpack::NPOS; pos = lp.next(lp.next(pos))) {
+        sl.insert(lpScore(lp, lp.next(pos)), lp.get(pos, buf));
+    }
+
+    storage_ = std::move(sl);
+    encoding_ = ObjectEncoding::SKIPLIST;
+}
+
+// ================== 增删查 ==================
+
+ZAddResult ZSetObject::add(double score, std::string_view member, int flags, double& newscore) {
+    bool exists;
+    double current = 0;
+    Skiplist::Node* node = nullptr;
+    size_t pos = Listpack::NPOS;
+    if (encoding_ == ObjectEncoding::LISTPACK) {
+        const Listpack& lp = get_listpack();
+        pos = lp.find(member, 1);
+        exists = pos != Listpack::NPOS;
+        if (exists) current = lpScore(lp, lp.next(pos));
+    } else {
+        node = get_skiplist().find(member);
+        exists = node != nullptr;
+        if (exists) current = node->score;
+    }
+
+    if (!exists) {
+        if (flags & ZADD_XX) return ZAddResult::SKIPPED;
+        if (encoding_ == ObjectEncoding::LISTPACK &&
+            (size() + 1 > max_listpack_entries_ || member.size() > max_listpack_value_)) {
+            convert_to_skiplist();
+        }
+        if (encoding_ == ObjectEncoding::LISTPACK) {
+            lpInsert(get_listpack(), score, member);
+        } else {
+            get_skiplist().insert(score, member);
+        }
+        newscore = score;
+        return ZAddResult::ADDED;
+    }
+
+    if (flags & ZADD_NX) return ZAddResult::SKIPPED;
+    if (flags & ZADD_INCR) {
+        score += current;
+        if (std::isnan(score)) {
+            throw std::runtime_error("resulting score is not a number (NaN)");
+        }
+    }
+    if (((flags & ZADD_GT) && score <= current) || ((flags & ZADD_LT) && score >= current)) {
+        return ZAddResult::SKIPPED;
+    }
+    newscore = score;
+    if (score == current) return ZAddResult::UNCHANGED;
+
+    if (encoding_ == ObjectEncoding::LISTPACK) {
+        // 位置可能变化：删掉再按序插入（member 在删除前拷出，删除会使视图失效）
+        Listpack& lp = get_listpack();
+        std::string copy(member);
+        lp.erase(pos, 2);
+        lpInsert(lp, score, copy);
+    } else {
+        get_skiplist().updateScore(node, score);
+    }
+    return ZAddResult::UPDATED;
+}
+
+bool ZSetObject::remove(std::string_view member) {
+    if (encoding_ == ObjectEncoding::LISTPACK) {
+        Listpack& lp = get_listpack();
+        size_t pos = lp.find(member, 1);
+        if (pos == Listpack::NPOS) return false;
+        lp.erase(pos, 2);
+        return true;
+    }
+    return get_skiplist().erase(member);
+}
+
+bool ZSetObject::score(std::string_view member, double& out) const {
+    if (encoding_ == ObjectEncoding::LISTPACK) {
+        const Listpack& lp = get_listpack();
+        size_t pos = lp.find(member, 1);
+        if (pos == Listpack::NPOS) return false;
+        out = lpScore(lp, lp.next(pos));
+        return true;
+    }
+    const Skiplist::Node* node = get_skiplist().find(member);
+    if (!node) return false;
+    out = node->score;
+    return true;
+}
+
+bool ZSetObject::rank(std::string_view member, bool reverse, size_t& out) const {
+    size_t r = 0;
+    if (encoding_ == ObjectEncoding::LISTPACK) {
+        const Listpack& lp = get_listpack();
+        size_t pos = lp.first();
+        for (; pos != Listpack::NPOS && !lp.equals(pos, member); pos = lp.next(lp.next(pos))) {
+            r++;
+        }
+        if (pos == Listpack::NPOS) return false;
+    } else {
+        const Skiplist& sl = get_skiplist();
+        const Skiplist::Node* node = sl.find(member);
+        if (!node) return false;
+        r = sl.rank(node) - 1;
+    }
+    out = reverse ? size() - 1 - r : r;
+    return true;
+}
+
+size_t ZSetObject::count(const ZRangeSpec& range) const {
+    if (encoding_ == ObjectEncoding::LISTPACK) {
+        size_t n = 0;
+        rangeByScore(range, false, 0, -1, [&](std::string_view, double) { n++; });
+        return n;
+    }
+    // 两端各定位一次，用排名相减，不逐个遍历
+    const Skiplist& sl = get_skiplist();
+    const Skiplist::Node* first = sl.firstInRange(range);
+    if (!first) return 0;
+    return sl.rank(sl.lastInRange(range)) - sl.rank(first) + 1;
+}
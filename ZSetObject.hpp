@@ -1,41 +1,163 @@
+// ZSetObject.hpp
 #pragma once
 #include "RedisObject.hpp"
-#include <string>
-#include <unordered_map>
-#include <memory>
+#include "Listpack.hpp"
+#include "Skiplist.hpp"
+#include <variant>
+#include <string_view>
 
+// ZADD 的选项
+enum ZAddFlag : int {
+    ZADD_NX   = 1 << 0, // 只添加新成员
+    ZADD_XX   = 1 << 1, // 只更新已有成员
+    ZADD_GT   = 1 << 2, // 只在新分数更大时更新
+    ZADD_LT   = 1 << 3, // 只在新分数更小时更新
+    ZADD_INCR = 1 << 4, // score 为增量（ZINCRBY）
+};
 
-struct ZSetMemberCompare {
-    bool operator()(const std::pair<double, std::string>& a,
-                    const std::pair<double, std::string>& b) const {
-        if (a.first != b.first) return a.first < b.first;
-        return a.second < b.second; // score 相同时按 member 字典序
-    }
+enum class ZAddResult {
+    ADDED,      // 新成员
+    UPDATED,    // 分数变了
+    UNCHANGED,  // 已存在且分数相同
+    SKIPPED,    // 被 NX / XX / GT / LT 拦下
 };
 
-// 有序集合对象
-class ZSetObject : public RedisObject {
+// 有序集合对象的负载（由 RedisObject 的负载指针持有，对象头不在这里）
+// 小对象用 listpack：member、score 交替存放，按 (score, member) 升序，操作都是线性扫描；
+// 成员数或单个 member 的长度超过阈值后转换为跳表 + member 索引（见 Skiplist.hpp），不再转回
+// 排名从 0 开始，reverse 表示按分数从高到低
+class ZSetObject {
 public:
-    ZSetObject();
+    // 与 Redis 默认的 zset-max-listpack-entries / zset-max-listpack-value 一致
+    static constexpr size_t DEFAULT_MAX_LISTPACK_ENTRIES = 128;
+    static constexpr size_t DEFAULT_MAX_LISTPACK_VALUE = 64;
 
-    // 添加或更新 member 的 score
-    void add(double score, const std::string& member);
+    // 启动时按配置设置一次
+    static void setListpackLimits(size_t max_entries, size_t max_value) {
+        max_listpack_entries_ = max_entries;
+        max_listpack_value_ = max_value;
+    }
 
-    // 删除 member
-    bool remove(const std::string& member);
+    ZSetObject();
 
-    // 获取 member 的 score
-    bool get_score(const std::string& member, double& out_score) const;
+    size_t size() const;
+    ObjectEncoding encoding() const { return encoding_; }
+    size_t memory_usage() const;
 
-    // 按 score 范围获取 members（升序）
-    std::vector<std::string> range_by_score(double min, double max) const;
+    // 跳表编码的 member 索引也需要定时任务推进 rehash（返回是否仍在 rehash）
+    bool is_rehashing() const {
+        return encoding_ == ObjectEncoding::SKIPLIST && get_skiplist().is_rehashing();
+    }
+    bool rehash_step(int n) const { return is_rehashing() && get_skiplist().rehash_step(n); }
 
-    // 获取排名（从 0 开始）
-    bool rank(const std::string& member, size_t& out_rank) const;
+    // 添加或更新；flags 为 ZAddFlag 的组合，newscore 为操作后的分数（SKIPPED 时不变）
+    // 分数相加得到 NaN（inf + -inf）时抛出异常，不做修改
+    ZAddResult add(double score, std::string_view member, int flags, double& newscore);
+    bool remove(std::string_view member);
+    bool score(std::string_view member, double& out) const;
+    bool rank(std::string_view member, bool reverse, size_t& out) const;
 
-    size_t size() const;
+    // 按排名取闭区间 [start, stop]（调用方已规范到 [0, size())），依次调用 fn(member, score)
+    template <typename F>
+    void range(size_t start, size_t stop, bool reverse, F&& fn) const;
+    // 按分数区间取，跳过前 offset 个后最多 count 个（count < 0 不限）
+    template <typename F>
+    void rangeByScore(const ZRangeSpec& range, bool reverse, size_t offset, long long count, F&& fn) const;
+    size_t count(const ZRangeSpec& range) const;
+
+    // 按升序遍历所有成员（持久化用），视图只在回调内有效
+    template <typename F>
+    void for_each(F&& fn) const { if (size() > 0) range(0, size() - 1, false, fn); }
 
 private:
-    std::unordered_map<std::string, double> score_map_;           // member -> score
-    std::set<std::pair<double, std::string>, ZSetMemberCompare> sorted_set_; // (score, member)
-};
\ No newline at end of file
+    static inline size_t max_listpack_entries_ = DEFAULT_MAX_LISTPACK_ENTRIES;
+    static inline size_t max_listpack_value_ = DEFAULT_MAX_LISTPACK_VALUE;
+
+    ObjectEncoding encoding_;
+    std::variant<
+        Listpack, // listpack: [member1, score1, member2, score2, ...]
+        Skiplist  // skiplist
+    > storage_;
+
+    Listpack& get_listpack() { return std::get<0>(storage_); }
+    const Listpack& get_listpack() const { return std::get<0>(storage_); }
+    Skiplist& get_skiplist() { return std::get<1>(storage_); }
+    const Skiplist& get_skiplist() const { return std::get<1>(storage_); }
+
+    void convert_to_skiplist();
+
+    // listpack 辅助：读取 pos 处的分数；(score, member) 应插入的位置
+    static double lpScore(const Listpack& lp, size_t pos);
+    static size_t lpInsertPos(const Listpack& lp, double score, std::string_view member);
+    static void lpInsert(Listpack& lp, double score, std::string_view member);
+};
+
+// ========== 模板实现 ==========
+
+template <typename F>
+void ZSetObject::range(size_t start, size_t stop, bool reverse, F&& fn) const {
+    size_t n = stop - start + 1;
+    if (encoding_ == ObjectEncoding::LISTPACK) {
+        const Listpack& lp = get_listpack();
+        char buf[Listpack::INT_BUF_SIZE];
+        size_t len = lp.size() / 2;
+        size_t pos = lp.seek(static_cast<long long>(2 * (reverse ? len - 1 - start : start)));
+        while (n-- > 0 && pos != Listpack::NPOS) {
+            size_t score_pos = lp.next(pos);
+            fn(lp.get(pos, buf), lpScore(lp, score_pos));
+            pos = reverse ? lp.prev(pos) : lp.next(score_pos);
+            if (reverse && pos != Listpack::NPOS) pos = lp.prev(pos);
+        }
+        return;
+    }
+    const Skiplist& sl = get_skiplist();
+    // 排名从 1 开始，倒序时第 start 名是正序的第 size - start 名
+    auto* node = sl.byRank(reverse ? sl.size() - start : start + 1);
+    while (n-- > 0 && node) {
+        fn(node->member(), node->score);
+        node = reverse ? node->prev() : node->next();
+    }
+}
+
+template <typename F>
+void ZSetObject::rangeByScore(const ZRangeSpec& range, bool reverse, size_t offset, long long count,
+                              F&& fn) const {
+    if (range.empty() || count == 0) return;
+    if (encoding_ == ObjectEncoding::LISTPACK) {
+        const Listpack& lp = get_listpack();
+        char buf[Listpack::INT_BUF_SIZE];
+        // 有序，线性扫描到区间边界即可停止
+        size_t pos = reverse ? lp.seek(-2) : lp.first();
+        while (pos != Listpack::NPOS) {
+            double score = lpScore(lp, lp.next(pos));
+            if (reverse ? !range.gteMin(score) : !range.lteMax(score)) break;
+            if (reverse ? range.lteMax(score) : range.gteMin(score)) {
+                if (offset > 0) {
+                    offset--;
+                } else {
+                    fn(lp.get(pos, buf), score);
+                    if (count > 0 && --count == 0) break;
+                }
+            }
+            if (reverse) {
+                pos = lp.prev(pos);
+                if (pos != Listpack::NPOS) pos = lp.prev(pos);
+            } else {
+                pos = lp.next(lp.next(pos));
+            }
+        }
+        return;
+    }
+    const Skiplist& sl = get_skiplist();
+    auto* node = reverse ? sl.lastInRange(range) : sl.firstInRange(range);
+    if (node && offset > 0) {
+        // 按跨度直接跳过 offset 个，O(log n)
+        size_t r = sl.rank(node);
+        node = reverse ? (r > offset ? sl.byRank(r - offset) : nullptr) : sl.byRank(r + offset);
+    }
+    while (node && (reverse ? range.gteMin(node->score) : range.lteMax(node->score))) {
+        fn(node->member(), node->score);
+        if (count > 0 && --count == 0) break;
+        node = reverse ? node->prev() : node->next();
+    }
+}
@@ -0,0 +1,84 @@
+// bench_util.hpp
+// 微基准的公共部分：计时、内存统计、多轮取最小值、两种实现的对比表
+// 各 *_bench.cpp 只保留自己的数据结构适配、工作负载和每轮的测量内容
+#pragma once
+#include "../Memory.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+
+namespace bench {
+
+using Clock = std::chrono::steady_clock;
+
+template <typename F>
+double elapsedNs(F&& fn) {
+    auto start = Clock::now();
+    fn();
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+// 当前已分配的内存（Memory.cpp 的计数，含 slab 分配器和 memAlloc 的块）。
+// 不能用 mallinfo2：不超过 512 字节的分配走 slab（自己 mmap 的区域），malloc 看不到
+inline size_t memoryInUse() {
+    return usedMemory();
+}
+
+// 一种实现的测量结果：各阶段耗时取 rounds 轮中的最小值
+template <int PHASES>
+struct Result {
+    double ns[PHASES];          // 各阶段的总耗时，输出时按操作数折算
+    double bytes_per_item = 0;  // 每个元素（field / member）占用的内存
+    size_t checksum = 0;        // 查询结果的校验和，两种实现应一致
+};
+
+// 执行 rounds 轮：round(r, ns, best) 填写本轮各阶段耗时（内存和校验和直接写入 best），
+// 结果不对时返回 false
+template <int PHASES, typename RoundFn>
+bool runRounds(int rounds, Result<PHASES>& best, RoundFn&& round) {
+    std::fill(best.ns, best.ns + PHASES, std::numeric_limits<double>::max());
+    for (int r = 0; r < rounds; ++r) {
+        double ns[PHASES];
+        if (!round(r, ns, best)) return false;
+        for (int p = 0; p < PHASES; ++p) best.ns[p] = std::min(best.ns[p], ns[p]);
+    }
+    return true;
+}
+
+// 每轮结束时检查命中数
+inline bool checkFound(int round, size_t found, size_t expected) {
+    if (found == expected) return true;
+    std::fprintf(stderr, "round %d: wrong lookups (found %zu of %zu)\n", round, found, expected);
+    return false;
+}
+
+template <int PHASES>
+bool sameChecksum(const char* what, const Result<PHASES>& a, const Result<PHASES>& b) {
+    if (a.checksum == b.checksum) return true;
+    std::fprintf(stderr, "%s mismatch: %zu vs %zu\n", what, a.checksum, b.checksum);
+    return false;
+}
+
+inline int usage(const char* argv0, const char* args) {
+    std::fprintf(stderr, "usage: %s %s\n", argv0, args);
+    return EXIT_FAILURE;
+}
+
+// 对比表：每个阶段一行（总耗时除以 ops(phase)），最后一行为每元素字节数
+template <int PHASES, typename OpsFn>
+void printComparison(const char* unit, const char* const (&phase_names)[PHASES],
+                     const char* name_a, const Result<PHASES>& a,
+                     const char* name_b, const Result<PHASES>& b,
+                     const char* bytes_label, OpsFn&& ops) {
+    std::printf("%-16s %12s %12s\n", unit, name_a, name_b);
+    for (int p = 0; p < PHASES; ++p) {
+        double n = static_cast<double>(ops(p));
+        std::printf("%-16s %12.1f %12.1f\n", phase_names[p], a.ns[p] / n, b.ns[p] / n);
+    }
+    std::printf("%-16s %12.1f %12.1f\n", bytes_label, a.bytes_per_item, b.bytes_per_item);
+}
+
+} // namespace bench
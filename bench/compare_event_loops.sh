@@ -0,0 +1,26 @@
+#!/bin/bash
+# 对比 epoll 与 io_uring 事件循环后端
+# 用法：bench/compare_event_loops.sh [build_dir] [redis_bench 参数...]
+#   bench/compare_event_loops.sh build -c 50 -n 200000 -P 16 -t set,get
+set -e
+
+BUILD_DIR=${1:-build}
+shift || true
+BENCH_ARGS=${*:--c 50 -n 100000 -P 1 -t ping,set,get}
+PORT=${PORT:-6399}
+
+SERVER=$(realpath "$BUILD_DIR/bin/mini_redis_server")
+BENCH=$(realpath "$BUILD_DIR/bin/redis_bench")
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+for backend in epoll io_uring; do
+    echo "== $backend"
+    (cd "$WORK" && exec "$SERVER" --port "$PORT" --event-loop "$backend" > "$WORK/$backend.log" 2>&1) &
+    pid=$!
+    sleep 0.5
+    "$BENCH" -p "$PORT" $BENCH_ARGS || true
+    kill -INT $pid
+    wait $pid || true
+    grep -E "Event loop started|WARN" "$WORK/$backend.log" || true
+done
@@ -0,0 +1,159 @@
+// dict_bench.cpp
+// Dict 微基准：对比 ChainedDict 与 SwissDict 在大哈希表上的
+// 插入、剩余 rehash、命中/未命中查找、更新、删除耗时，以及每个 field 的堆内存和分配次数
+//   dict_bench [entries] [key_len] [rounds]
+// entries 默认 2^20：ChainedDict 最后一次插入恰好触发扩容，"rehash" 一项即迁移全部元素的耗时。
+// 每项取 rounds 轮中的最小值，减少噪声。
+#include "../ChainedDict.hpp"
+#include "../SwissDict.hpp"
+#include <malloc.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+// 统计堆分配：替换全局 operator new/delete
+static size_t g_live_bytes = 0;
+static size_t g_alloc_count = 0;
+
+void* operator new(size_t size) {
+    void* p = std::malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    g_live_bytes += malloc_usable_size(p);
+    g_alloc_count++;
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    if (!p) return;
+    g_live_bytes -= malloc_usable_size(p);
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    operator delete(p);
+}
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+enum Phase { INSERT, REHASH, LOOKUP_HIT, LOOKUP_MISS, UPDATE, DELETE, PHASE_COUNT };
+const char* const PHASE_NAMES[PHASE_COUNT] = {
+    "insert", "rehash", "lookup-hit", "lookup-miss", "update", "delete"
+};
+
+std::string makeKey(size_t i, size_t len) {
+    std::string key = "field:" + std::to_string(i);
+    if (key.size() < len) key.append(len - key.size(), 'x');
+    return key;
+}
+
+template <typename F>
+double elapsedNs(F&& fn) {
+    auto start = Clock::now();
+    fn();
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+struct Result {
+    double ns[PHASE_COUNT];
+    double bytes_per_field;   // 插入完成后 Dict 占用的堆内存 / 元素数
+    double allocs_per_insert;
+};
+
+struct Workload {
+    std::vector<std::string> keys;
+    std::vector<std::string> misses;
+    std::vector<size_t> order;
+};
+
+template <typename DictT>
+bool run(const Workload& w, int rounds, Result& best) {
+    size_t n = w.keys.size();
+    std::fill(best.ns, best.ns + PHASE_COUNT, std::numeric_limits<double>::max());
+
+    for (int round = 0; round < rounds; ++round) {
+        DictT dict;
+        size_t found = 0;
+        std::string_view value;
+        double ns[PHASE_COUNT];
+
+        size_t bytes_before = g_live_bytes;
+        size_t allocs_before = g_alloc_count;
+        ns[INSERT] = elapsedNs([&] {
+            for (size_t i = 0; i < n; ++i) dict.set_field(w.keys[i], "v");
+        });
+        // 把剩余的 rehash 做完，之后的查找只涉及一张表
+        ns[REHASH] = elapsedNs([&] {
+            while (dict.is_rehashing()) dict.rehash_step(1000);
+        });
+        best.bytes_per_field = double(g_live_bytes - bytes_before) / n;
+        best.allocs_per_insert = double(g_alloc_count - allocs_before) / n;
+
+        ns[LOOKUP_HIT] = elapsedNs([&] {
+            for (size_t i : w.order) found += dict.find_value(w.keys[i], value);
+        });
+        ns[LOOKUP_MISS] = elapsedNs([&] {
+            for (size_t i : w.order) found += dict.find_value(w.misses[i], value);
+        });
+        ns[UPDATE] = elapsedNs([&] {
+            for (size_t i : w.order) dict.set_field(w.keys[i], "w");
+        });
+        ns[DELETE] = elapsedNs([&] {
+            for (size_t i = 0; i < n / 2; ++i) found += dict.del_field(w.keys[w.order[i]]);
+        });
+
+        if (found != n + n / 2 || dict.size() != n - n / 2) {
+            std::fprintf(stderr, "round %d: lost entries (found %zu, size %zu)\n",
+                         round, found, dict.size());
+            return false;
+        }
+        for (int p = 0; p < PHASE_COUNT; ++p) best.ns[p] = std::min(best.ns[p], ns[p]);
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : (1u << 20);
+    size_t key_len = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 16;
+    int rounds = argc > 3 ? std::atoi(argv[3]) : 3;
+    if (n < 2 || rounds < 1) {
+        std::fprintf(stderr, "usage: %s [entries>=2] [key_len] [rounds>=1]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    Workload w;
+    w.keys.reserve(n);
+    w.misses.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        w.keys.push_back(makeKey(i, key_len));
+        w.misses.push_back(makeKey(i + n, key_len));
+    }
+    w.order.resize(n);
+    for (size_t i = 0; i < n; ++i) w.order[i] = i;
+    std::shuffle(w.order.begin(), w.order.end(), std::mt19937_64(42));
+
+    Result chained, swiss;
+    if (!run<ChainedDict>(w, rounds, chained) || !run<SwissDict>(w, rounds, swiss)) {
+        return EXIT_FAILURE;
+    }
+
+    size_t ops[PHASE_COUNT] = {n, n, n, n, n, n / 2};
+    std::printf("entries=%zu key_len=%zu rounds=%d\n", n, key_len, rounds);
+    std::printf("%-16s %10s %10s\n", "ns/op", "chained", "swiss");
+    for (int p = 0; p < PHASE_COUNT; ++p) {
+        std::printf("%-16s %10.1f %10.1f\n", PHASE_NAMES[p],
+                    chained.ns[p] / ops[p], swiss.ns[p] / ops[p]);
+    }
+    std::printf("%-16s %10.1f %10.1f\n", "bytes/field", chained.bytes_per_field, swiss.bytes_per_field);
+    std::printf("%-16s %10.2f %10.2f\n", "allocs/insert", chained.allocs_per_insert, swiss.allocs_per_insert);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,177 @@
+// intset_bench.cpp
+// 整数集合微基准：对比原来的 vector<int64_t> 形式与变宽编码的 intset
+// - 大量小集合的内存和 SADD / SISMEMBER 耗时
+// - 两个集合求交 / 并 / 差：大小相近（归并）与大小悬殊（galloping）两种情况
+//   intset_bench [sets] [members] [max_id] [rounds]
+// 成员取 [0, max_id) 内的随机整数；max_id 不超过 32767 时 intset 用 int16 编码。
+// 内存用 usedMemory() 统计（与服务器的 INFO 相同，含 slab 和 memAlloc 分配），每项取 rounds 轮中的最小值。
+#include "../intset.hpp"
+#include "bench_util.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+
+using bench::elapsedNs;
+
+// 原来的 intset：升序的 vector<int64_t>，二分查找 + vector::insert
+class VectorIntset {
+public:
+    bool insert(int64_t value) {
+        auto it = std::lower_bound(data_.begin(), data_.end(), value);
+        if (it != data_.end() && *it == value) return false;
+        data_.insert(it, value);
+        return true;
+    }
+    bool contains(int64_t value) const {
+        return std::binary_search(data_.begin(), data_.end(), value);
+    }
+    size_t size() const { return data_.size(); }
+
+    static void intersect(const VectorIntset& a, const VectorIntset& b, VectorIntset& out) {
+        out.data_.clear();
+        std::set_intersection(a.data_.begin(), a.data_.end(), b.data_.begin(), b.data_.end(),
+                              std::back_inserter(out.data_));
+    }
+    static void unite(const VectorIntset& a, const VectorIntset& b, VectorIntset& out) {
+        out.data_.clear();
+        std::set_union(a.data_.begin(), a.data_.end(), b.data_.begin(), b.data_.end(),
+                       std::back_inserter(out.data_));
+    }
+    static void difference(const VectorIntset& a, const VectorIntset& b, VectorIntset& out) {
+        out.data_.clear();
+        std::set_difference(a.data_.begin(), a.data_.end(), b.data_.begin(), b.data_.end(),
+                            std::back_inserter(out.data_));
+    }
+
+private:
+    std::vector<int64_t> data_;
+};
+
+enum Phase { INSERT, LOOKUP_HIT, LOOKUP_MISS, INTER_EVEN, INTER_SKEWED, UNION_EVEN, DIFF_SKEWED, PHASE_COUNT };
+const char* const PHASE_NAMES[PHASE_COUNT] = {
+    "sadd", "sismember-hit", "sismember-miss",
+    "sinter-even", "sinter-skewed", "sunion-even", "sdiff-skewed"
+};
+
+// 单成员操作按成员数折算为 ns/op，集合运算按对数折算为 ns/次；校验和为运算结果大小之和
+using Result = bench::Result<PHASE_COUNT>;
+
+struct Workload {
+    std::vector<std::vector<int64_t>> sets;
+    std::vector<std::pair<size_t, int64_t>> hits;   // (集合, 成员)，打乱
+    std::vector<std::pair<size_t, int64_t>> misses;
+    std::vector<int64_t> big;                       // 大小悬殊的运算用的大集合
+    size_t ops() const { return hits.size(); }
+};
+
+template <typename SetT>
+bool run(const Workload& w, int rounds, Result& best) {
+    size_t pairs = w.sets.size() / 2;
+
+    return bench::runRounds(rounds, best, [&](int round, double* ns, Result& result) {
+        size_t found = 0;
+        size_t checksum = 0;
+
+        size_t before = bench::memoryInUse();
+        std::vector<std::unique_ptr<SetT>> sets;
+        sets.reserve(w.sets.size());
+        ns[INSERT] = elapsedNs([&] {
+            for (const auto& members : w.sets) {
+                auto s = std::make_unique<SetT>();
+                for (int64_t v : members) s->insert(v);
+                sets.push_back(std::move(s));
+            }
+        });
+        result.bytes_per_item = double(bench::memoryInUse() - before - sets.capacity() * sizeof(void*)) / w.ops();
+
+        ns[LOOKUP_HIT] = elapsedNs([&] {
+            for (auto [s, v] : w.hits) found += sets[s]->contains(v);
+        });
+        ns[LOOKUP_MISS] = elapsedNs([&] {
+            for (auto [s, v] : w.misses) found += sets[s]->contains(v);
+        });
+
+        SetT big, out;
+        for (int64_t v : w.big) big.insert(v);
+        ns[INTER_EVEN] = elapsedNs([&] {
+            for (size_t i = 0; i < pairs; ++i) {
+                SetT::intersect(*sets[2 * i], *sets[2 * i + 1], out);
+                checksum += out.size();
+            }
+        });
+        ns[INTER_SKEWED] = elapsedNs([&] {
+            for (size_t i = 0; i < pairs; ++i) {
+                SetT::intersect(*sets[i], big, out);
+                checksum += out.size();
+            }
+        });
+        ns[UNION_EVEN] = elapsedNs([&] {
+            for (size_t i = 0; i < pairs; ++i) {
+                SetT::unite(*sets[2 * i], *sets[2 * i + 1], out);
+                checksum += out.size();
+            }
+        });
+        ns[DIFF_SKEWED] = elapsedNs([&] {
+            for (size_t i = 0; i < pairs; ++i) {
+                SetT::difference(*sets[i], big, out);
+                checksum += out.size();
+            }
+        });
+
+        result.checksum = checksum;
+        return bench::checkFound(round, found, w.ops());
+    });
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t nsets = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000;
+    size_t members = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 256;
+    long long max_id = argc > 3 ? std::atoll(argv[3]) : 30000;
+    int rounds = argc > 4 ? std::atoi(argv[4]) : 3;
+    if (nsets < 2 || members < 1 || max_id < static_cast<long long>(members) * 2 || rounds < 1) {
+        return bench::usage(argv[0], "[sets>=2] [members>=1] [max_id>=2*members] [rounds>=1]");
+    }
+
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<long long> id(0, max_id - 1);
+    Workload w;
+    for (size_t s = 0; s < nsets; ++s) {
+        std::vector<int64_t> m;
+        while (m.size() < members) {
+            int64_t v = id(rng);
+            if (std::find(m.begin(), m.end(), v) == m.end()) m.push_back(v);
+        }
+        for (int64_t v : m) {
+            w.hits.emplace_back(s, v);
+            // 未命中：取一个不在集合里的值
+            int64_t miss = id(rng);
+            while (std::find(m.begin(), m.end(), miss) != m.end()) miss = id(rng);
+            w.misses.emplace_back(s, miss);
+        }
+        w.sets.push_back(std::move(m));
+    }
+    std::shuffle(w.hits.begin(), w.hits.end(), rng);
+    std::shuffle(w.misses.begin(), w.misses.end(), rng);
+    for (long long v = 0; v < max_id; v += 2) w.big.push_back(v); // 一半的 id，远大于小集合
+
+    Result vec, is;
+    if (!run<VectorIntset>(w, rounds, vec) || !run<intset>(w, rounds, is) ||
+        !bench::sameChecksum("set algebra", vec, is)) {
+        return EXIT_FAILURE;
+    }
+
+    size_t pairs = nsets / 2;
+    std::printf("sets=%zu members=%zu max_id=%lld big=%zu rounds=%d\n",
+                nsets, members, max_id, w.big.size(), rounds);
+    bench::printComparison("ns", PHASE_NAMES, "vector", vec, "intset", is, "bytes/member",
+                           [&](int p) { return p <= LOOKUP_MISS ? w.ops() : pairs; });
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,158 @@
+// listpack_bench.cpp
+// 小 hash 编码微基准：对比原来的 vector<pair<string, string>> 形式与 listpack 编码的
+// HashObject 在大量小 hash 上的内存和 HSET/HGET/HDEL 耗时
+//   listpack_bench [hashes] [fields] [value_kind] [rounds]
+// value_kind: str（8 字节字符串，默认）、int（数字）、mixed（一半数字）
+// 内存用 usedMemory() 统计（与服务器的 INFO 相同，含 slab 和 memAlloc 分配），每项取 rounds 轮中的最小值。
+#include "../HashObject.hpp"
+#include "bench_util.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using bench::elapsedNs;
+
+// 原来的 "ZIPLIST"：每个 field、value 各是一个 std::string
+class VectorHash {
+public:
+    void set_field(std::string field, std::string value) {
+        auto it = find(field);
+        if (it != entries_.end()) {
+            it->second = std::move(value);
+        } else {
+            entries_.emplace_back(std::move(field), std::move(value));
+        }
+    }
+    bool find_field(std::string_view field, std::string_view& out, char*) const {
+        auto it = find(field);
+        if (it == entries_.end()) return false;
+        out = it->second;
+        return true;
+    }
+    bool del_field(std::string_view field) {
+        auto it = find(field);
+        if (it == entries_.end()) return false;
+        entries_.erase(it);
+        return true;
+    }
+    size_t size() const { return entries_.size(); }
+
+private:
+    using Entries = std::vector<std::pair<std::string, std::string>>;
+    Entries entries_;
+
+    Entries::const_iterator find(std::string_view field) const {
+        return std::find_if(entries_.begin(), entries_.end(),
+            [&](const auto& kv) { return kv.first == field; });
+    }
+    Entries::iterator find(std::string_view field) {
+        return std::find_if(entries_.begin(), entries_.end(),
+            [&](const auto& kv) { return kv.first == field; });
+    }
+};
+
+enum Phase { INSERT, LOOKUP_HIT, LOOKUP_MISS, UPDATE, DELETE, PHASE_COUNT };
+const char* const PHASE_NAMES[PHASE_COUNT] = {
+    "hset-new", "hget-hit", "hget-miss", "hset-update", "hdel"
+};
+
+using Result = bench::Result<PHASE_COUNT>;
+
+struct Workload {
+    size_t hashes;
+    std::vector<std::string> fields;
+    std::vector<std::string> values;
+    std::vector<std::string> updates;
+    std::vector<std::pair<size_t, size_t>> order; // (hash, field)，打乱
+};
+
+template <typename HashT>
+bool run(const Workload& w, int rounds, Result& best) {
+    size_t f = w.fields.size();
+    size_t ops = w.hashes * f;
+
+    return bench::runRounds(rounds, best, [&](int round, double* ns, Result& result) {
+        size_t found = 0;
+        char buf[Listpack::INT_BUF_SIZE];
+        std::string_view value;
+
+        size_t before = bench::memoryInUse();
+        std::vector<std::unique_ptr<HashT>> hashes;
+        hashes.reserve(w.hashes);
+        ns[INSERT] = elapsedNs([&] {
+            for (size_t h = 0; h < w.hashes; ++h) {
+                auto hash = std::make_unique<HashT>();
+                for (size_t i = 0; i < f; ++i) hash->set_field(w.fields[i], w.values[i]);
+                hashes.push_back(std::move(hash));
+            }
+        });
+        result.bytes_per_item = double(bench::memoryInUse() - before - hashes.capacity() * sizeof(void*)) / ops;
+
+        ns[LOOKUP_HIT] = elapsedNs([&] {
+            for (auto [h, i] : w.order) found += hashes[h]->find_field(w.fields[i], value, buf);
+        });
+        ns[LOOKUP_MISS] = elapsedNs([&] {
+            for (auto [h, i] : w.order) found += hashes[h]->find_field("missing", value, buf);
+        });
+        ns[UPDATE] = elapsedNs([&] {
+            for (auto [h, i] : w.order) hashes[h]->set_field(w.fields[i], w.updates[i]);
+        });
+        ns[DELETE] = elapsedNs([&] {
+            for (auto [h, i] : w.order) found += hashes[h]->del_field(w.fields[i]);
+        });
+
+        return bench::checkFound(round, found, 2 * ops);
+    });
+}
+
+std::string makeValue(size_t i, const std::string& kind) {
+    bool numeric = kind == "int" || (kind == "mixed" && i % 2 == 0);
+    if (numeric) return std::to_string(1000 + i * 37);
+    char buf[16];
+    std::snprintf(buf, sizeof(buf), "val-%04zu", i % 10000);
+    return buf;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t hashes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    size_t fields = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 16;
+    std::string kind = argc > 3 ? argv[3] : "str";
+    int rounds = argc > 4 ? std::atoi(argv[4]) : 3;
+    if (hashes < 1 || fields < 1 || fields > HashObject::LISTPACK_MAX_ENTRIES || rounds < 1 ||
+        (kind != "str" && kind != "int" && kind != "mixed")) {
+        char args[96];
+        std::snprintf(args, sizeof(args), "[hashes>=1] [fields 1..%zu] [str|int|mixed] [rounds>=1]",
+                      HashObject::LISTPACK_MAX_ENTRIES);
+        return bench::usage(argv[0], args);
+    }
+
+    Workload w;
+    w.hashes = hashes;
+    for (size_t i = 0; i < fields; ++i) {
+        w.fields.push_back("field:" + std::to_string(i));
+        w.values.push_back(makeValue(i, kind));
+        w.updates.push_back(makeValue(i + fields, kind));
+    }
+    for (size_t h = 0; h < hashes; ++h) {
+        for (size_t i = 0; i < fields; ++i) w.order.emplace_back(h, i);
+    }
+    std::shuffle(w.order.begin(), w.order.end(), std::mt19937_64(42));
+
+    Result vec, lp;
+    if (!run<VectorHash>(w, rounds, vec) || !run<HashObject>(w, rounds, lp)) {
+        return EXIT_FAILURE;
+    }
+
+    std::printf("hashes=%zu fields=%zu values=%s rounds=%d\n", hashes, fields, kind.c_str(), rounds);
+    bench::printComparison("ns/op", PHASE_NAMES, "vector", vec, "listpack", lp, "bytes/field",
+                           [&](int) { return w.order.size(); });
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,253 @@
+// redis_bench.cpp
+// 简单的 RESP 压测客户端（单线程 epoll，多连接，支持 pipeline），用于对比不同服务端配置，
+// 例如 epoll / io_uring 事件循环后端：
+//   redis_bench -c 50 -n 200000 -P 16 -t set,get
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::string host = "127.0.0.1";
+    int port = 6379;
+    int clients = 50;
+    long requests = 100000;
+    int pipeline = 1;
+    size_t data_size = 16;
+    long keyspace = 10000;
+    std::vector<std::string> tests = {"ping", "set", "get"};
+};
+
+struct Client {
+    int fd = -1;
+    std::string out;
+    size_t out_pos = 0;
+    std::string in;
+    int waiting = 0;                  // 本批还差几个回复
+    Clock::time_point batch_start;
+};
+
+void usage() {
+    std::cerr << "usage: redis_bench [-h host] [-p port] [-c clients] [-n requests] [-P pipeline]\n"
+                 "                   [-d datasize] [-r keyspace] [-t ping,set,get,hset,hget]" << std::endl;
+}
+
+bool parseOptions(int argc, char* argv[], Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (i + 1 >= argc) {
+            usage();
+            return false;
+        }
+        std::string v = argv[++i];
+        if (a == "-h") opt.host = v;
+        else if (a == "-p") opt.port = std::atoi(v.c_str());
+        else if (a == "-c") opt.clients = std::max(1, std::atoi(v.c_str()));
+        else if (a == "-n") opt.requests = std::max(1L, std::atol(v.c_str()));
+        else if (a == "-P") opt.pipeline = std::max(1, std::atoi(v.c_str()));
+        else if (a == "-d") opt.data_size = static_cast<size_t>(std::max(1, std::atoi(v.c_str())));
+        else if (a == "-r") opt.keyspace = std::max(1L, std::atol(v.c_str()));
+        else if (a == "-t") {
+            opt.tests.clear();
+            std::stringstream ss(v);
+            std::string t;
+            while (std::getline(ss, t, ',')) opt.tests.push_back(t);
+        } else {
+            usage();
+            return false;
+        }
+    }
+    return true;
+}
+
+void appendCommand(std::string& out, const std::vector<std::string>& args) {
+    out += "*" + std::to_string(args.size()) + "\r\n";
+    for (const auto& a : args) {
+        out += "$" + std::to_string(a.size()) + "\r\n";
+        out += a;
+        out += "\r\n";
+    }
+}
+
+std::vector<std::string> makeCommand(const std::string& test, long seq, const Options& opt,
+                                     const std::string& value) {
+    std::string key = "key:" + std::to_string(seq % opt.keyspace);
+    if (test == "set") return {"SET", key, value};
+    if (test == "get") return {"GET", key};
+    if (test == "hset") return {"HSET", "hash:" + std::to_string(seq % 64), key, value};
+    if (test == "hget") return {"HGET", "hash:" + std::to_string(seq % 64), key};
+    return {"PING"};
+}
+
+// 跳过一个完整的回复，返回其长度；数据不完整返回 0
+// 只需要处理本工具会收到的类型：+ - : $
+size_t replyLength(const std::string& buf, size_t pos) {
+    size_t eol = buf.find("\r\n", pos);
+    if (eol == std::string::npos) return 0;
+    if (buf[pos] != '$') return eol + 2 - pos;
+    long len = std::atol(buf.c_str() + pos + 1);
+    if (len < 0) return eol + 2 - pos;
+    size_t end = eol + 2 + static_cast<size_t>(len) + 2;
+    return end <= buf.size() ? end - pos : 0;
+}
+
+int connectTo(const Options& opt) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (fd == -1) return -1;
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(opt.port);
+    inet_pton(AF_INET, opt.host.c_str(), &addr.sin_addr);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == -1 && errno != EINPROGRESS) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// 运行一项测试，返回是否成功
+bool runTest(const std::string& test, const Options& opt) {
+    int ep = epoll_create1(0);
+    std::vector<Client> clients(opt.clients);
+    std::string value(opt.data_size, 'x');
+
+    for (int i = 0; i < opt.clients; ++i) {
+        clients[i].fd = connectTo(opt);
+        if (clients[i].fd == -1) {
+            std::cerr << "connect failed: " << std::strerror(errno) << std::endl;
+            return false;
+        }
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLOUT;
+        ev.data.u32 = static_cast<uint32_t>(i);
+        epoll_ctl(ep, EPOLL_CTL_ADD, clients[i].fd, &ev);
+    }
+
+    long issued = 0;
+    long completed = 0;
+    std::vector<double> latencies; // 每批（pipeline）往返时间，微秒
+    latencies.reserve(opt.requests / opt.pipeline + opt.clients);
+
+    auto startBatch = [&](Client& c) {
+        int n = static_cast<int>(std::min<long>(opt.pipeline, opt.requests - issued));
+        if (n <= 0) return;
+        c.out.clear();
+        c.out_pos = 0;
+        for (int k = 0; k < n; ++k) {
+            appendCommand(c.out, makeCommand(test, issued++, opt, value));
+        }
+        c.waiting = n;
+        c.batch_start = Clock::now();
+    };
+
+    auto flushOut = [&](Client& c) -> bool {
+        while (c.out_pos < c.out.size()) {
+            ssize_t w = write(c.fd, c.out.data() + c.out_pos, c.out.size() - c.out_pos);
+            if (w < 0) return errno == EAGAIN;
+            c.out_pos += static_cast<size_t>(w);
+        }
+        return true;
+    };
+
+    for (auto& c : clients) startBatch(c);
+
+    auto t0 = Clock::now();
+    epoll_event events[256];
+    char buf[64 * 1024];
+    bool ok = true;
+
+    while (completed < opt.requests && ok) {
+        int nfds = epoll_wait(ep, events, 256, 5000);
+        if (nfds <= 0) {
+            std::cerr << "timeout waiting for replies" << std::endl;
+            ok = false;
+            break;
+        }
+        for (int e = 0; e < nfds; ++e) {
+            Client& c = clients[events[e].data.u32];
+            if (events[e].events & EPOLLOUT) {
+                if (!flushOut(c)) ok = false;
+            }
+            if (!(events[e].events & EPOLLIN)) continue;
+
+            while (true) {
+                ssize_t r = read(c.fd, buf, sizeof(buf));
+                if (r > 0) {
+                    c.in.append(buf, static_cast<size_t>(r));
+                    continue;
+                }
+                if (r == 0 || errno != EAGAIN) ok = false;
+                break;
+            }
+
+            size_t pos = 0;
+            while (c.waiting > 0 && pos < c.in.size()) {
+                size_t len = replyLength(c.in, pos);
+                if (len == 0) break;
+                if (c.in[pos] == '-') {
+                    std::cerr << "error reply: " << c.in.substr(pos, len - 2) << std::endl;
+                    ok = false;
+                }
+                pos += len;
+                --c.waiting;
+                ++completed;
+            }
+            c.in.erase(0, pos);
+
+            if (c.waiting == 0) {
+                auto us = std::chrono::duration<double, std::micro>(Clock::now() - c.batch_start).count();
+                latencies.push_back(us);
+                startBatch(c);
+                if (!flushOut(c)) ok = false;
+            }
+        }
+    }
+
+    double secs = std::chrono::duration<double>(Clock::now() - t0).count();
+    for (auto& c : clients) close(c.fd);
+    close(ep);
+    if (!ok) return false;
+
+    std::sort(latencies.begin(), latencies.end());
+    auto pct = [&](double p) {
+        if (latencies.empty()) return 0.0;
+        size_t idx = static_cast<size_t>(p * (latencies.size() - 1));
+        return latencies[idx] / 1000.0;
+    };
+
+    std::string name = test;
+    std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+    std::printf("%-5s %10.0f requests/sec   p50=%.3f ms  p99=%.3f ms  max=%.3f ms  (%ld requests, %d clients, pipeline %d)\n",
+                name.c_str(), completed / secs, pct(0.50), pct(0.99), pct(1.0),
+                completed, opt.clients, opt.pipeline);
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options opt;
+    if (!parseOptions(argc, argv, opt)) return EXIT_FAILURE;
+
+    for (const auto& test : opt.tests) {
+        if (!runTest(test, opt)) return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,168 @@
+// zset_bench.cpp
+// 有序集合微基准：对比原来的 std::set + unordered_map 形式与跳表编码的 ZSetObject
+// - ZADD / ZSCORE 耗时，每个成员的内存
+// - ZRANK 和 ZRANGE（从随机排名开始取一页）：std::set 只能从头数，O(n)；跳表按跨度定位，O(log n)
+//   zset_bench [members] [queries] [page] [rounds]
+// member 为 "player:<id>" 形式，分数为随机整数（模拟排行榜）。
+// 内存用 usedMemory() 统计（与服务器的 INFO 相同，含 slab 和 memAlloc 分配），每项取 rounds 轮中的最小值。
+#include "../ZSetObject.hpp"
+#include "bench_util.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <random>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+using bench::elapsedNs;
+
+// 原来的 ZSetObject：成员在 set 和 map 中各存一份
+class SetMapZSet {
+public:
+    void add(double score, const std::string& member) {
+        auto it = scores_.find(member);
+        if (it != scores_.end()) {
+            sorted_.erase({it->second, member});
+            it->second = score;
+        } else {
+            scores_.emplace(member, score);
+        }
+        sorted_.emplace(score, member);
+    }
+    bool score(const std::string& member, double& out) const {
+        auto it = scores_.find(member);
+        if (it == scores_.end()) return false;
+        out = it->second;
+        return true;
+    }
+    bool rank(const std::string& member, size_t& out) const {
+        auto it = scores_.find(member);
+        if (it == scores_.end()) return false;
+        out = static_cast<size_t>(std::distance(sorted_.begin(), sorted_.find({it->second, member})));
+        return true;
+    }
+    template <typename F>
+    void range(size_t start, size_t n, F&& fn) const {
+        auto it = std::next(sorted_.begin(), static_cast<long>(std::min(start, sorted_.size())));
+        for (; n-- > 0 && it != sorted_.end(); ++it) fn(it->second, it->first);
+    }
+
+private:
+    std::unordered_map<std::string, double> scores_;
+    std::set<std::pair<double, std::string>> sorted_;
+};
+
+enum Phase { ADD, SCORE, RANK, RANGE, PHASE_COUNT };
+const char* const PHASE_NAMES[PHASE_COUNT] = {"zadd", "zscore", "zrank", "zrange-page"};
+
+using Result = bench::Result<PHASE_COUNT>;
+
+struct Workload {
+    std::vector<std::string> members;
+    std::vector<double> scores;
+    std::vector<size_t> lookups;    // 查询的成员下标
+    std::vector<size_t> starts;     // ZRANGE 的起始排名
+    size_t page;
+};
+
+// 适配两种实现的接口
+struct Old {
+    SetMapZSet z;
+    void add(double s, const std::string& m) { z.add(s, m); }
+    bool score(const std::string& m, double& out) const { return z.score(m, out); }
+    bool rank(const std::string& m, size_t& out) const { return z.rank(m, out); }
+    template <typename F>
+    void range(size_t start, size_t n, F&& fn) const { z.range(start, n, fn); }
+};
+
+struct New {
+    ZSetObject z;
+    void add(double s, const std::string& m) {
+        double newscore;
+        z.add(s, m, 0, newscore);
+    }
+    bool score(const std::string& m, double& out) const { return z.score(m, out); }
+    bool rank(const std::string& m, size_t& out) const { return z.rank(m, false, out); }
+    template <typename F>
+    void range(size_t start, size_t n, F&& fn) const {
+        if (start < z.size()) z.range(start, std::min(start + n, z.size()) - 1, false, fn);
+    }
+};
+
+template <typename Z>
+bool run(const Workload& w, int rounds, Result& best) {
+    return bench::runRounds(rounds, best, [&](int round, double* ns, Result& result) {
+        size_t checksum = 0;
+        size_t found = 0;
+
+        size_t before = bench::memoryInUse();
+        auto* z = new Z();
+        ns[ADD] = elapsedNs([&] {
+            for (size_t i = 0; i < w.members.size(); ++i) z->add(w.scores[i], w.members[i]);
+        });
+        result.bytes_per_item = double(bench::memoryInUse() - before) / w.members.size();
+
+        ns[SCORE] = elapsedNs([&] {
+            for (size_t i : w.lookups) {
+                double s;
+                found += z->score(w.members[i], s);
+            }
+        });
+        ns[RANK] = elapsedNs([&] {
+            for (size_t i : w.lookups) {
+                size_t r = 0;
+                found += z->rank(w.members[i], r);
+                checksum += r;
+            }
+        });
+        ns[RANGE] = elapsedNs([&] {
+            for (size_t start : w.starts) {
+                z->range(start, w.page, [&](std::string_view m, double) { checksum += m.size(); });
+            }
+        });
+        delete z;
+
+        result.checksum = checksum;
+        return bench::checkFound(round, found, 2 * w.lookups.size());
+    });
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t members = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    size_t queries = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 200;
+    size_t page = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 10;
+    int rounds = argc > 4 ? std::atoi(argv[4]) : 3;
+    if (members < 1 || queries < 1 || page < 1 || rounds < 1) {
+        return bench::usage(argv[0], "[members>=1] [queries>=1] [page>=1] [rounds>=1]");
+    }
+
+    std::mt19937_64 rng(42);
+    Workload w;
+    w.page = page;
+    for (size_t i = 0; i < members; ++i) {
+        w.members.push_back("player:" + std::to_string(i));
+        w.scores.push_back(static_cast<double>(rng() % 1000000));
+    }
+    for (size_t i = 0; i < queries; ++i) {
+        w.lookups.push_back(rng() % members);
+        w.starts.push_back(rng() % members);
+    }
+
+    Result old_result, new_result;
+    if (!run<Old>(w, rounds, old_result) || !run<New>(w, rounds, new_result) ||
+        !bench::sameChecksum("query", old_result, new_result)) {
+        return EXIT_FAILURE;
+    }
+
+    std::printf("members=%zu queries=%zu page=%zu rounds=%d\n", members, queries, page, rounds);
+    bench::printComparison("ns/op", PHASE_NAMES, "set+map", old_result, "skiplist", new_result, "bytes/member",
+                           [&](int p) { return p == ADD ? members : queries; });
+    return EXIT_SUCCESS;
+}
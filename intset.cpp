@@ -1,32 +1,377 @@
 // intset.cpp
 #include "intset.hpp"
-#include <algorithm> // for lower_bound
+#include "Memory.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
-bool intset::binary_search(int64_t value, size_t& pos) const {
-    auto it = std::lower_bound(data_.begin(), data_.end(), value);
-    pos = static_cast<size_t>(it - data_.begin());
-    return (it != data_.end() && *it == value);
+namespace {
+
+// 一边的元素数是另一边的这么多倍以上时改用 galloping
+constexpr size_t GALLOP_RATIO = 16;
+
+uint8_t valueEncoding(int64_t v) {
+    if (v < INT32_MIN || v > INT32_MAX) return sizeof(int64_t);
+    if (v < INT16_MIN || v > INT16_MAX) return sizeof(int32_t);
+    return sizeof(int16_t);
+}
+
+// 二分到剩下一个窗口后整段比较：int16 一个窗口是两个 SSE 寄存器（16 个），int32 / int64 为 8 个
+template <typename T>
+constexpr size_t WINDOW = sizeof(T) == sizeof(int16_t) ? 16 : 8;
+
+// 数出 p[0, WINDOW) 中小于 v 的元素个数（调用方保证读满一个窗口不越界）
+template <typename T>
+size_t countLess(const T* p, T v) {
+#if defined(__SSE2__)
+    if constexpr (sizeof(T) == sizeof(int16_t)) {
+        __m128i needle = _mm_set1_epi16(v);
+        __m128i lo = _mm_cmplt_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), needle);
+        __m128i hi = _mm_cmplt_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 8)), needle);
+        // packs 把两个比较结果压成 16 个字节，每个元素对应 movemask 的一位
+        return static_cast<size_t>(__builtin_popcount(_mm_movemask_epi8(_mm_packs_epi16(lo, hi))));
+    } else if constexpr (sizeof(T) == sizeof(int32_t)) {
+        __m128i needle = _mm_set1_epi32(v);
+        __m128i lo = _mm_cmplt_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), needle);
+        __m128i hi = _mm_cmplt_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 4)), needle);
+        return static_cast<size_t>(__builtin_popcount(_mm_movemask_epi8(_mm_packs_epi32(lo, hi)))) / 2;
+    }
+#endif
+    // int64 没有 SSE2 的比较指令：无分支累加，编译器可以展开
+    size_t n = 0;
+    for (size_t i = 0; i < WINDOW<T>; ++i) n += p[i] < v;
+    return n;
+}
+
+// 返回第一个 >= v 的下标
+template <typename T>
+size_t lowerBound(const T* p, size_t len, T v) {
+    const T* base = p;
+    size_t n = len;
+    // 无分支二分：答案始终在 [base, base + n] 内
+    while (n > WINDOW<T>) {
+        size_t half = n / 2;
+        base = base[half] < v ? base + half : base;
+        n -= half;
+    }
+    // base + n 之后的元素都 >= v，所以数满一个窗口也只会数到 [base, base + n) 里的
+    size_t offset = static_cast<size_t>(base - p);
+    if (offset + WINDOW<T> <= len) {
+        return offset + countLess(base, v);
+    }
+    size_t less = 0;
+    for (size_t i = 0; i < n; ++i) less += base[i] < v;
+    return offset + less;
+}
+
+// 在 b[lo, n) 中找第一个 >= v 的位置：步长 1, 2, 4 ... 向后跳，越过 v 后在最后一步内二分
+template <typename T>
+size_t gallop(const T* b, size_t lo, size_t n, int64_t v) {
+    size_t hi = lo;
+    size_t step = 1;
+    while (hi < n && b[hi] < v) {
+        lo = hi + 1;
+        hi += step;
+        step <<= 1;
+    }
+    if (hi > n) hi = n;
+    return static_cast<size_t>(
+        std::lower_bound(b + lo, b + hi, v, [](T x, int64_t y) { return x < y; }) - b);
+}
+
+// 把 b[from, to) 追加到 out[k...]，返回新的 k
+template <typename TB, typename TO>
+size_t copyRun(const TB* b, size_t from, size_t to, TO* out, size_t k) {
+    for (size_t j = from; j < to; ++j) out[k++] = static_cast<TO>(b[j]);
+    return k;
+}
+
+// 交集：调用方保证 na <= nb，输出容量 na
+template <typename TA, typename TB, typename TO>
+size_t intersectKernel(const TA* a, size_t na, const TB* b, size_t nb, TO* out) {
+    size_t k = 0;
+    if (nb / GALLOP_RATIO >= na) {
+        size_t j = 0;
+        for (size_t i = 0; i < na && j < nb; ++i) {
+            j = gallop(b, j, nb, a[i]);
+            if (j < nb && b[j] == a[i]) out[k++] = static_cast<TO>(a[i]);
+        }
+        return k;
+    }
+    // 归并：每轮无条件写 out[k]，只有相等时才让 k 前进，循环内没有难预测的分支
+    size_t i = 0, j = 0;
+    while (i < na && j < nb) {
+        int64_t x = a[i];
+        int64_t y = b[j];
+        out[k] = static_cast<TO>(x);
+        k += x == y;
+        i += x <= y;
+        j += y <= x;
+    }
+    return k;
+}
+
+// 并集：调用方保证 na <= nb，输出容量 na + nb
+template <typename TA, typename TB, typename TO>
+size_t uniteKernel(const TA* a, size_t na, const TB* b, size_t nb, TO* out) {
+    size_t k = 0;
+    size_t j = 0;
+    if (nb / GALLOP_RATIO >= na) {
+        // a 很小：b 中两个 a 元素之间的整段直接拷贝
+        for (size_t i = 0; i < na; ++i) {
+            size_t next = gallop(b, j, nb, a[i]);
+            k = copyRun(b, j, next, out, k);
+            out[k++] = static_cast<TO>(a[i]);
+            j = (next < nb && b[next] == a[i]) ? next + 1 : next;
+        }
+        return copyRun(b, j, nb, out, k);
+    }
+    size_t i = 0;
+    while (i < na && j < nb) {
+        int64_t x = a[i];
+        int64_t y = b[j];
+        out[k++] = static_cast<TO>(x < y ? x : y);
+        i += x <= y;
+        j += y <= x;
+    }
+    k = copyRun(a, i, na, out, k);
+    return copyRun(b, j, nb, out, k);
+}
+
+// 差集 a - b，输出容量 na
+template <typename TA, typename TB, typename TO>
+size_t differenceKernel(const TA* a, size_t na, const TB* b, size_t nb, TO* out) {
+    size_t k = 0;
+    if (nb / GALLOP_RATIO >= na) {
+        // a 很小：逐个到 b 里找
+        size_t j = 0;
+        for (size_t i = 0; i < na; ++i) {
+            j = gallop(b, j, nb, a[i]);
+            if (j >= nb || b[j] != a[i]) out[k++] = static_cast<TO>(a[i]);
+        }
+        return k;
+    }
+    if (na / GALLOP_RATIO >= nb) {
+        // b 很小：a 中两个 b 元素之间的整段直接拷贝
+        size_t i = 0;
+        for (size_t j = 0; j < nb && i < na; ++j) {
+            size_t next = gallop(a, i, na, b[j]);
+            k = copyRun(a, i, next, out, k);
+            i = (next < na && a[next] == b[j]) ? next + 1 : next;
+        }
+        return copyRun(a, i, na, out, k);
+    }
+    size_t i = 0, j = 0;
+    while (i < na && j < nb) {
+        int64_t x = a[i];
+        int64_t y = b[j];
+        out[k] = static_cast<TO>(x);
+        k += x < y;
+        i += x <= y;
+        j += y <= x;
+    }
+    return copyRun(a, i, na, out, k);
+}
+
+} // namespace
+
+template <typename F>
+void intset::visit(const intset& s, F&& fn) {
+    switch (s.encoding_) {
+    case sizeof(int16_t):
+        fn(static_cast<const int16_t*>(s.contents_));
+        break;
+    case sizeof(int32_t):
+        fn(static_cast<const int32_t*>(s.contents_));
+        break;
+    default:
+        fn(static_cast<const int64_t*>(s.contents_));
+        break;
+    }
+}
+
+// 对 a、b、out 三者的编码组合分派到对应的 kernel，结果长度写入 out
+#define INTSET_DISPATCH(kernel, a, b, out)                                              \
+    visit(a, [&](const auto* pa) {                                                      \
+        visit(b, [&](const auto* pb) {                                                  \
+            visit(out, [&](const auto* po) {                                            \
+                using TO = std::remove_const_t<std::remove_pointer_t<decltype(po)>>;    \
+                size_t n = kernel(pa, (a).size(), pb, (b).size(), const_cast<TO*>(po)); \
+                (out).resize(n);                                                        \
+            });                                                                         \
+        });                                                                             \
+    })
+
+intset::~intset() {
+    memFree(contents_);
+}
+
+intset::intset(intset&& other) noexcept
+    : contents_(std::exchange(other.contents_, nullptr)),
+      length_(std::exchange(other.length_, 0)),
+      encoding_(std::exchange(other.encoding_, sizeof(int16_t))) {}
+
+intset& intset::operator=(intset&& other) noexcept {
+    if (this != &other) {
+        memFree(contents_);
+        contents_ = std::exchange(other.contents_, nullptr);
+        length_ = std::exchange(other.length_, 0);
+        encoding_ = std::exchange(other.encoding_, sizeof(int16_t));
+    }
+    return *this;
+}
+
+// 按实际大小 realloc（与 Redis 相同，不预留空间）
+void intset::resize(size_t length) {
+    if (length == 0) {
+        memFree(contents_);
+        contents_ = nullptr;
+    } else {
+        void* p = memRealloc(contents_, length * encoding_);
+        if (!p) throw std::bad_alloc();
+        contents_ = p;
+    }
+    length_ = static_cast<uint32_t>(length);
+}
+
+int64_t intset::get(size_t index) const {
+    switch (encoding_) {
+    case sizeof(int16_t):
+        return static_cast<const int16_t*>(contents_)[index];
+    case sizeof(int32_t):
+        return static_cast<const int32_t*>(contents_)[index];
+    default:
+        return static_cast<const int64_t*>(contents_)[index];
+    }
+}
+
+void intset::set(size_t index, int64_t value) {
+    switch (encoding_) {
+    case sizeof(int16_t):
+        static_cast<int16_t*>(contents_)[index] = static_cast<int16_t>(value);
+        break;
+    case sizeof(int32_t):
+        static_cast<int32_t*>(contents_)[index] = static_cast<int32_t>(value);
+        break;
+    default:
+        static_cast<int64_t*>(contents_)[index] = value;
+        break;
+    }
+}
+
+bool intset::search(int64_t value, size_t& pos) const {
+    // 放不下的值一定比所有元素都大或都小
+    if (valueEncoding(value) > encoding_) {
+        pos = value < 0 ? 0 : length_;
+        return false;
+    }
+    if (length_ == 0) {
+        pos = 0;
+        return false;
+    }
+    visit(*this, [&](const auto* p) {
+        using T = std::remove_const_t<std::remove_pointer_t<decltype(p)>>;
+        pos = lowerBound(p, length_, static_cast<T>(value));
+    });
+    return pos < length_ && get(pos) == value;
+}
+
+void intset::upgradeAndAdd(int64_t value) {
+    uint8_t old_encoding = encoding_;
+    size_t length = length_;
+    bool prepend = value < 0;
+
+    encoding_ = valueEncoding(value);
+    resize(length + 1);
+    // 新编码更宽，从后往前逐个展开不会覆盖还没读的旧元素
+    for (size_t i = length; i-- > 0;) {
+        int64_t v;
+        switch (old_encoding) {
+        case sizeof(int16_t):
+            v = static_cast<const int16_t*>(contents_)[i];
+            break;
+        case sizeof(int32_t):
+            v = static_cast<const int32_t*>(contents_)[i];
+            break;
+        default:
+            v = static_cast<const int64_t*>(contents_)[i];
+            break;
+        }
+        set(i + prepend, v);
+    }
+    set(prepend ? 0 : length, value);
 }
 
 bool intset::insert(int64_t value) {
+    if (valueEncoding(value) > encoding_) {
+        upgradeAndAdd(value);
+        return true;
+    }
     size_t pos;
-    if (binary_search(value, pos)) {
+    if (search(value, pos)) {
         return false; // 已存在，不插入
     }
-    data_.insert(data_.begin() + pos, value);
+    resize(length_ + 1);
+    auto* bytes = static_cast<unsigned char*>(contents_);
+    std::memmove(bytes + (pos + 1) * encoding_, bytes + pos * encoding_, (length_ - 1 - pos) * encoding_);
+    set(pos, value);
     return true;
 }
 
 bool intset::erase(int64_t value) {
     size_t pos;
-    if (!binary_search(value, pos)) {
+    if (!search(value, pos)) {
         return false; // 不存在
     }
-    data_.erase(data_.begin() + pos);
+    auto* bytes = static_cast<unsigned char*>(contents_);
+    std::memmove(bytes + pos * encoding_, bytes + (pos + 1) * encoding_, (length_ - 1 - pos) * encoding_);
+    resize(length_ - 1);
     return true;
 }
 
 bool intset::contains(int64_t value) const {
     size_t pos;
-    return binary_search(value, pos);
-}
\ No newline at end of file
+    return search(value, pos);
+}
+
+void intset::clear() noexcept {
+    memFree(contents_);
+    contents_ = nullptr;
+    length_ = 0;
+    encoding_ = sizeof(int16_t);
+}
+
+void intset::reset(uint8_t encoding, size_t capacity) {
+    clear();
+    encoding_ = encoding;
+    resize(capacity);
+}
+
+void intset::intersect(const intset& a, const intset& b, intset& out) {
+    // 交集里的值两边都有，较窄的编码就放得下
+    const intset& small = a.size() <= b.size() ? a : b;
+    const intset& large = a.size() <= b.size() ? b : a;
+    out.reset(std::min(a.encoding_, b.encoding_), small.size());
+    if (small.empty()) return;
+    INTSET_DISPATCH(intersectKernel, small, large, out);
+}
+
+void intset::unite(const intset& a, const intset& b, intset& out) {
+    const intset& small = a.size() <= b.size() ? a : b;
+    const intset& large = a.size() <= b.size() ? b : a;
+    out.reset(std::max(a.encoding_, b.encoding_), a.size() + b.size());
+    if (out.length_ == 0) return;
+    INTSET_DISPATCH(uniteKernel, small, large, out);
+}
+
+void intset::difference(const intset& a, const intset& b, intset& out) {
+    out.reset(a.encoding_, a.size());
+    if (a.empty()) return;
+    INTSET_DISPATCH(differenceKernel, a, b, out);
+}
@@ -1,12 +1,22 @@
 // intset.hpp
 #pragma once
 #include <cstdint>
-#include <vector>
 #include <cstddef>
 
+// 整数集合（与 Redis intset 相同的做法）：升序排列的整数存在一块连续内存里，
+// 元素宽度取能放下所有元素的最小宽度（int16 / int32 / int64）：
+// - 插入放不下的值时整块升级为更宽的编码（新值一定比所有元素都大或都小，放到一端），不降级
+// - 查找先二分缩小到一小段，再用 SSE2 一次比较一整段
+// - 交 / 并 / 差直接在两个有序数组上归并；大小悬殊时对大的一边做 galloping（指数 + 二分）查找
 class intset {
 public:
     intset() = default;
+    ~intset();
+
+    intset(const intset&) = delete;
+    intset& operator=(const intset&) = delete;
+    intset(intset&& other) noexcept;
+    intset& operator=(intset&& other) noexcept;
 
     // 插入一个整数，返回 true 表示成功插入（未重复）
     bool insert(int64_t value);
@@ -17,21 +27,51 @@ public:
     // 检查是否包含该整数
     bool contains(int64_t value) const;
 
-    // 获取所有元素（用于升级时遍历）
-    const std::vector<int64_t>& data() const noexcept { return data_; }
+    // 第 index 个元素（升序）
+    int64_t get(size_t index) const;
 
     // 元素个数
-    size_t size() const noexcept { return data_.size(); }
+    size_t size() const noexcept { return length_; }
 
     // 是否为空
-    bool empty() const noexcept { return data_.empty(); }
+    bool empty() const noexcept { return length_ == 0; }
+
+    // 清空集合（编码恢复为 int16）
+    void clear() noexcept;
+
+    // 当前元素宽度（2 / 4 / 8 字节）
+    uint8_t encoding() const noexcept { return encoding_; }
+
+    // 元素数组占用的字节数
+    size_t blob_bytes() const noexcept { return static_cast<size_t>(length_) * encoding_; }
 
-    // 清空集合
-    void clear() noexcept { data_.clear(); }
+    // 按升序依次调用 fn(int64_t)
+    template <typename F>
+    void for_each(F&& fn) const {
+        for (size_t i = 0; i < length_; ++i) fn(get(i));
+    }
+
+    // 集合运算，结果写入 out（原内容被替换，out 不能是 a 或 b）
+    static void intersect(const intset& a, const intset& b, intset& out);
+    static void unite(const intset& a, const intset& b, intset& out);
+    static void difference(const intset& a, const intset& b, intset& out);
 
 private:
-    std::vector<int64_t> data_;  // 保持升序排列
+    void* contents_ = nullptr;             // memAlloc 分配，length_ * encoding_ 字节
+    uint32_t length_ = 0;
+    uint8_t encoding_ = sizeof(int16_t);
+
+    void resize(size_t length);
+    void set(size_t index, int64_t value);
+    // 升级到能放下 value 的编码并插入 value
+    void upgradeAndAdd(int64_t value);
+    // 若找到返回 true 并设置 pos 为索引；否则 pos 为插入位置
+    bool search(int64_t value, size_t& pos) const;
+
+    // 集合运算的输出：按 encoding 预分配 capacity 个元素，写完后收缩到实际长度
+    void reset(uint8_t encoding, size_t capacity);
 
-    // 二分查找：若找到返回 true 并设置 pos 为索引；否则 pos 为插入位置
-    bool binary_search(int64_t value, size_t& pos) const;
-};
\ No newline at end of file
+    // 按当前编码以 const int16_t* / int32_t* / int64_t* 调用 fn
+    template <typename F>
+    static void visit(const intset& s, F&& fn);
+};
@@ -2,37 +2,85 @@
 #include "Server.hpp"
 #include "Database.hpp"
 #include "Command.hpp"
+#include "Config.hpp"
+#include "Shard.hpp"
+#include "Quicklist.hpp"
+#include "SetObject.hpp"
+#include "ZSetObject.hpp"
 #include <iostream>
 #include <csignal>
 #include <memory>
 
-// 全局单例（阶段三简单起见，后续可注入）
-Database g_db;
+// 单 reactor 模式下的全局实例；多分片模式下每个分片各自持有 Database / CommandHandler
+std::unique_ptr<Database> g_db;
 std::unique_ptr<CommandHandler> g_cmd_handler;
+static Server* g_server = nullptr;
+static ShardedServer* g_sharded_server = nullptr;
 
 static volatile sig_atomic_t shutdown_flag = 0;
 
+// 只通知事件循环退出（原子写 + eventfd），保存数据在循环返回后进行，
+// 不在信号处理函数里做 I/O 和内存分配
 void signal_handler(int sig) {
-    std::cout << "\n[INFO] Received signal " << sig << ", shutting down..." << std::endl;
-    shutdown_flag = 1;
-    g_db.saveRdb();
-    exit(EXIT_SUCCESS);
+    shutdown_flag = sig;
+    if (g_sharded_server) {
+        // 多分片：通知各分片退出，由分片线程自己保存数据，run() 随后返回
+        g_sharded_server->stop();
+    } else if (g_server) {
+        g_server->requestStop();
+    }
 }
 
-int main() {
-    std::signal(SIGINT, signal_handler);
-    std::signal(SIGTERM, signal_handler);
+int main(int argc, char* argv[]) {
+    ServerConfig config;
+    if (!parseCommandLine(argc, argv, config)) {
+        return EXIT_FAILURE;
+    }
+    // 新建对象（包括加载 RDB 时）都按配置的编码参数
+    Quicklist::setDefaultOptions({config.list_max_listpack_size, config.list_compress_depth});
+    SetObject::setMaxIntsetEntries(config.set_max_intset_entries);
+    ZSetObject::setListpackLimits(config.zset_max_listpack_entries, config.zset_max_listpack_value);
+    // 按 LRU / LFU 淘汰时每个 key 要有自己的访问信息，不能共享整数对象
+    bool track_access = config.maxmemory > 0 && (config.maxmemory_policy == MaxmemoryPolicy::ALLKEYS_LRU ||
+                                                 config.maxmemory_policy == MaxmemoryPolicy::ALLKEYS_LFU);
+    ObjectPtr::setSharedIntegers(!track_access);
+    RedisObject::setLfuMode(config.maxmemory_policy == MaxmemoryPolicy::ALLKEYS_LFU);
+    Database::setMaxmemory(config.maxmemory, config.maxmemory_policy, config.maxmemory_samples, config.shards);
+    Database::setLazyfree(config.lazyfree_lazy_eviction, config.lazyfree_lazy_expire, config.lazyfree_lazy_server_del,
+                          config.lazyfree_lazy_user_del, config.lazyfree_lazy_user_flush);
 
-    // 初始化命令处理器
-    g_cmd_handler = std::make_unique<CommandHandler>(g_db);
+    std::signal(SIGPIPE, SIG_IGN); // 对端已关闭时 write 返回 EPIPE，而不是杀死进程
 
     try {
-        Server server(6379);
+        if (config.shards > 1) {
+            ShardedServer sharded(config);
+            g_sharded_server = &sharded;
+            std::signal(SIGINT, signal_handler);
+            std::signal(SIGTERM, signal_handler);
+            sharded.run();
+            g_sharded_server = nullptr;
+            return EXIT_SUCCESS;
+        }
+
+        // 初始化数据库（从 dump.rdb 恢复）和命令处理器
+        g_db = std::make_unique<Database>();
+        g_cmd_handler = std::make_unique<CommandHandler>(*g_db);
+
+        Server server(config, *g_cmd_handler);
+        g_server = &server;
+        std::signal(SIGINT, signal_handler);
+        std::signal(SIGTERM, signal_handler);
         server.run();
+        g_server = nullptr;
+
+        std::cout << "\n[INFO] Received signal " << shutdown_flag << ", shutting down..." << std::endl;
+        // 正在进行的 BGSAVE 作废，直接前台保存最新数据
+        g_db->killBackgroundSave();
+        g_db->saveRdb();
     } catch (const std::exception& e) {
         std::cerr << "[FATAL] Exception: " << e.what() << std::endl;
         return EXIT_FAILURE;
     }
 
     return EXIT_SUCCESS;
-}
\ No newline at end of file
+}
@@ -1,6 +1,8 @@
 // utils.hpp
 #pragma once
 #include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <cerrno>
@@ -18,3 +20,9 @@ inline void set_nonblocking(int fd) {
     if (fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1)
         handle_error("fcntl F_SETFL O_NONBLOCK");
 }
+
+// 关闭 Nagle：一批响应只写一次，不能让小包等对端的延迟 ACK（失败不影响正确性，忽略）
+inline void set_nodelay(int fd) {
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+}